@@ -3,8 +3,6 @@
 #include <stdlib.h>
 #include <math.h>
 
-TypeInfo* COMPLEX_TYPE_INFO = NULL;
-
 void complex_add(const void* a, const void* b, void* result) {
     const Complex* ca = a;
     const Complex* cb = b;
@@ -40,15 +38,15 @@ void complex_print(const void* data) {
     }
 }
 
-TypeInfo* GetComplexTypeInfo() {
-    if (!COMPLEX_TYPE_INFO) {
-        COMPLEX_TYPE_INFO = malloc(sizeof(TypeInfo));
-        COMPLEX_TYPE_INFO->size = sizeof(Complex);
-        COMPLEX_TYPE_INFO->add = complex_add;
-        COMPLEX_TYPE_INFO->multiply = complex_multiply;
-        COMPLEX_TYPE_INFO->multiplyScalar = complex_multiply_scalar;
-        COMPLEX_TYPE_INFO->evaluate = complex_evaluate;
-        COMPLEX_TYPE_INFO->print = complex_print;
-    }
-    return COMPLEX_TYPE_INFO;
+const TypeInfo COMPLEX_TYPE_INFO = {
+    sizeof(Complex),
+    complex_add,
+    complex_multiply,
+    complex_multiply_scalar,
+    complex_evaluate,
+    complex_print
+};
+
+const TypeInfo* GetComplexTypeInfo() {
+    return &COMPLEX_TYPE_INFO;
 }
\ No newline at end of file
@@ -8,13 +8,13 @@ typedef struct {
     double imag;
 } Complex;
 
-extern TypeInfo* COMPLEX_TYPE_INFO;
+extern const TypeInfo COMPLEX_TYPE_INFO;
 
 void complex_add(const void*, const void*, void*);
 void complex_multiply(const void*, const void*, void*);
 void complex_multiply_scalar(const void*, const void*, void*);
 void complex_evaluate(const void*, const void*, void*);
 void complex_print(const void*);
-TypeInfo* GetComplexTypeInfo();
+const TypeInfo* GetComplexTypeInfo();
 
 #endif
\ No newline at end of file
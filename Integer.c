@@ -2,37 +2,112 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-TypeInfo* INT_TYPE_INFO = NULL;
-
+// The arithmetic wraps through unsigned types, where overflow is defined
 void int_add(const void* a, const void* b, void* result) {
-    *((int*)result) = *((const int*)a) + *((const int*)b);
+    *((int*)result) = (int)((unsigned)*((const int*)a) + (unsigned)*((const int*)b));
 }
 
 void int_multiply(const void* a, const void* b, void* result) {
-    *((int*)result) = *((const int*)a) * *((const int*)b);
+    *((int*)result) = (int)((unsigned)*((const int*)a) * (unsigned)*((const int*)b));
 }
 
 void int_multiply_scalar(const void* a, const void* scalar, void* result) {
-    *((int*)result) = *((const int*)a) * *((const int*)scalar);
+    int_multiply(a, scalar, result);
 }
 
 void int_evaluate(const void* coeff, const void* x, void* result) {
-    *((int*)result) = *((const int*)coeff) * *((const int*)x);
+    int_multiply(coeff, x, result);
 }
 
 void int_print(const void* data) {
     printf("%d", *((const int*)data));
 }
 
-TypeInfo* GetIntTypeInfo() {
-    if (!INT_TYPE_INFO) {
-        INT_TYPE_INFO = malloc(sizeof(TypeInfo));
-        INT_TYPE_INFO->size = sizeof(int);
-        INT_TYPE_INFO->add = int_add;
-        INT_TYPE_INFO->multiply = int_multiply;
-        INT_TYPE_INFO->multiplyScalar = int_multiply_scalar;
-        INT_TYPE_INFO->evaluate = int_evaluate;
-        INT_TYPE_INFO->print = int_print;
-    }
-    return INT_TYPE_INFO;
-}
\ No newline at end of file
+const TypeInfo INT_TYPE_INFO = {
+    sizeof(int),
+    int_add,
+    int_multiply,
+    int_multiply_scalar,
+    int_evaluate,
+    int_print
+};
+
+const TypeInfo* GetIntTypeInfo() {
+    return &INT_TYPE_INFO;
+}
+
+void int64_add(const void* a, const void* b, void* result) {
+    *((int64_t*)result) = (int64_t)((uint64_t)*((const int64_t*)a) + (uint64_t)*((const int64_t*)b));
+}
+
+void int64_multiply(const void* a, const void* b, void* result) {
+    *((int64_t*)result) = (int64_t)((uint64_t)*((const int64_t*)a) * (uint64_t)*((const int64_t*)b));
+}
+
+void int64_print(const void* data) {
+    printf("%lld", (long long)*((const int64_t*)data));
+}
+
+const TypeInfo INT64_TYPE_INFO = {
+    sizeof(int64_t),
+    int64_add,
+    int64_multiply,
+    int64_multiply,
+    int64_multiply,
+    int64_print
+};
+
+const TypeInfo* GetInt64TypeInfo() {
+    return &INT64_TYPE_INFO;
+}
+
+__extension__ typedef unsigned __int128 UInt128;
+
+void int128_add(const void* a, const void* b, void* result) {
+    *((Int128*)result) = (Int128)((UInt128)*((const Int128*)a) + (UInt128)*((const Int128*)b));
+}
+
+void int128_multiply(const void* a, const void* b, void* result) {
+    *((Int128*)result) = (Int128)((UInt128)*((const Int128*)a) * (UInt128)*((const Int128*)b));
+}
+
+void int128_print(const void* data) {
+    char buf[40];
+    int n = int128_to_chars(*((const Int128*)data), buf);
+    printf("%.*s", n, buf);
+}
+
+const TypeInfo INT128_TYPE_INFO = {
+    sizeof(Int128),
+    int128_add,
+    int128_multiply,
+    int128_multiply,
+    int128_multiply,
+    int128_print
+};
+
+const TypeInfo* GetInt128TypeInfo() {
+    return &INT128_TYPE_INFO;
+}
+
+int int_type_width(const TypeInfo* typeInfo) {
+    if (typeInfo == &INT_TYPE_INFO) return 32;
+    if (typeInfo == &INT64_TYPE_INFO) return 64;
+    if (typeInfo == &INT128_TYPE_INFO) return 128;
+    return 0;
+}
+
+int int128_to_chars(Int128 v, char* buf) {
+    UInt128 magnitude = v < 0 ? (UInt128)0 - (UInt128)v : (UInt128)v;
+    char digits[39];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + (int)(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    int length = 0;
+    if (v < 0) buf[length++] = '-';
+    while (n > 0) buf[length++] = digits[--n];
+    return length;
+}
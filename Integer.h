@@ -2,14 +2,36 @@
 #define INTEGER_H
 
 #include "TypeInfo.h"
+#include <stdint.h>
 
-extern TypeInfo* INT_TYPE_INFO;
+// Wider integer coefficients that poly_add, poly_multiply and
+// poly_scalar_multiply promote int results to instead of wrapping
+__extension__ typedef __int128 Int128;
+
+extern const TypeInfo INT_TYPE_INFO;
+extern const TypeInfo INT64_TYPE_INFO;
+extern const TypeInfo INT128_TYPE_INFO;
 
 void int_add(const void*, const void*, void*);
 void int_multiply(const void*, const void*, void*);
 void int_multiply_scalar(const void*, const void*, void*);
 void int_evaluate(const void*, const void*, void*);
 void int_print(const void*);
-TypeInfo* GetIntTypeInfo();
+const TypeInfo* GetIntTypeInfo();
+
+void int64_add(const void*, const void*, void*);
+void int64_multiply(const void*, const void*, void*);
+void int64_print(const void*);
+const TypeInfo* GetInt64TypeInfo();
+
+void int128_add(const void*, const void*, void*);
+void int128_multiply(const void*, const void*, void*);
+void int128_print(const void*);
+const TypeInfo* GetInt128TypeInfo();
+
+// Bits in the integer coefficient type (32, 64 or 128), 0 for other types
+int int_type_width(const TypeInfo* typeInfo);
+// Decimal text of v without a terminator, returns its length; buf needs 40 bytes
+int int128_to_chars(Int128 v, char* buf);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,58 @@
+#include "ModInt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+void modint_add(const void* a, const void* b, void* result) {
+    uint32_t sum = *((const ModInt*)a) + *((const ModInt*)b);
+    *((ModInt*)result) = sum >= MODINT_MODULUS ? sum - MODINT_MODULUS : sum;
+}
+
+void modint_multiply(const void* a, const void* b, void* result) {
+    *((ModInt*)result) = (ModInt)((uint64_t)*((const ModInt*)a) * *((const ModInt*)b) % MODINT_MODULUS);
+}
+
+void modint_multiply_scalar(const void* a, const void* scalar, void* result) {
+    modint_multiply(a, scalar, result);
+}
+
+void modint_evaluate(const void* coeff, const void* x_power, void* result) {
+    modint_multiply(coeff, x_power, result);
+}
+
+void modint_print(const void* data) {
+    printf("%" PRIu32, *((const ModInt*)data));
+}
+
+ModInt modint_from_int(long long value) {
+    long long r = value % (long long)MODINT_MODULUS;
+    return (ModInt)(r < 0 ? r + MODINT_MODULUS : r);
+}
+
+ModInt modint_pow(ModInt base, uint64_t exponent) {
+    uint64_t result = 1;
+    uint64_t b = base;
+    while (exponent) {
+        if (exponent & 1) result = result * b % MODINT_MODULUS;
+        b = b * b % MODINT_MODULUS;
+        exponent >>= 1;
+    }
+    return (ModInt)result;
+}
+
+ModInt modint_inverse(ModInt value) {
+    return modint_pow(value, MODINT_MODULUS - 2);
+}
+
+const TypeInfo MODINT_TYPE_INFO = {
+    sizeof(ModInt),
+    modint_add,
+    modint_multiply,
+    modint_multiply_scalar,
+    modint_evaluate,
+    modint_print
+};
+
+const TypeInfo* GetModIntTypeInfo() {
+    return &MODINT_TYPE_INFO;
+}
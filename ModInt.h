@@ -0,0 +1,25 @@
+#ifndef MODINT_H
+#define MODINT_H
+
+#include "TypeInfo.h"
+#include <stdint.h>
+
+// Integers modulo an NTT-friendly prime, 998244353 = 119 * 2^23 + 1
+#define MODINT_MODULUS 998244353u
+#define MODINT_ROOT 3u
+
+typedef uint32_t ModInt;
+
+extern const TypeInfo MODINT_TYPE_INFO;
+
+void modint_add(const void*, const void*, void*);
+void modint_multiply(const void*, const void*, void*);
+void modint_multiply_scalar(const void*, const void*, void*);
+void modint_evaluate(const void*, const void*, void*);
+void modint_print(const void*);
+ModInt modint_from_int(long long value);
+ModInt modint_pow(ModInt base, uint64_t exponent);
+ModInt modint_inverse(ModInt value);
+const TypeInfo* GetModIntTypeInfo();
+
+#endif
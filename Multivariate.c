@@ -0,0 +1,612 @@
+#include "Multivariate.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "ThreadPool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COEFF(base, i, size) ((char*)(base) + (size_t)(i) * (size))
+
+// Growing list of terms; outputs are built here and then moved into the result
+typedef struct {
+    uint64_t* monomials;
+    char* coeffs;
+    int length;
+    int capacity;
+    size_t size;
+} TermBuffer;
+
+static int mpoly_shift(const MPolynomial* poly, int var) {
+    return (poly->nvars - 1 - var) * poly->bits;
+}
+
+static uint64_t mpoly_guard_mask(const MPolynomial* poly) {
+    uint64_t mask = 0;
+    for (int v = 0; v < poly->nvars; v++) {
+        mask |= (uint64_t)1 << (mpoly_shift(poly, v) + poly->bits - 1);
+    }
+    return mask;
+}
+
+static int mpoly_exponent(const MPolynomial* poly, uint64_t mono, int var) {
+    uint64_t fieldMask = ((uint64_t)1 << poly->bits) - 1;
+    return (int)((mono >> mpoly_shift(poly, var)) & fieldMask);
+}
+
+static PolynomialError mpoly_pack(const MPolynomial* poly, const int* exps, uint64_t* mono) {
+    uint64_t packed = 0;
+    for (int v = 0; v < poly->nvars; v++) {
+        if (exps[v] < 0 || (unsigned)exps[v] > MPOLY_MAX_EXPONENT(poly->bits)) return POLYNOMIAL_INVALID_DEGREE;
+        packed |= (uint64_t)exps[v] << mpoly_shift(poly, v);
+    }
+    *mono = packed;
+    return POLYNOMIAL_OK;
+}
+
+static int mpoly_coeff_is_zero(const TypeInfo* typeInfo, const void* c) {
+    switch (poly_kernel_type(typeInfo)) {
+    case POLY_KERNEL_int: return *(const int*)c == 0;
+    case POLY_KERNEL_modint: return *(const ModInt*)c == 0;
+    case POLY_KERNEL_complex: return ((const Complex*)c)->real == 0.0 && ((const Complex*)c)->imag == 0.0;
+    default: break;
+    }
+    const unsigned char* bytes = c;
+    for (size_t i = 0; i < typeInfo->size; i++) {
+        if (bytes[i]) return 0;
+    }
+    return 1;
+}
+
+static int mpoly_compatible(const MPolynomial* a, const MPolynomial* b) {
+    return a->typeInfo == b->typeInfo && a->nvars == b->nvars && a->bits == b->bits;
+}
+
+static PolynomialError term_buffer_push(TermBuffer* buf, uint64_t mono, const void* coeff) {
+    if (buf->length == buf->capacity) {
+        int capacity = buf->capacity ? 2 * buf->capacity : 16;
+        uint64_t* monomials = poly_mem_realloc(buf->monomials, capacity * sizeof(uint64_t));
+        if (!monomials) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        buf->monomials = monomials;
+        char* coeffs = poly_mem_realloc(buf->coeffs, capacity * buf->size);
+        if (!coeffs) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        buf->coeffs = coeffs;
+        buf->capacity = capacity;
+    }
+    buf->monomials[buf->length] = mono;
+    memcpy(COEFF(buf->coeffs, buf->length, buf->size), coeff, buf->size);
+    buf->length++;
+    return POLYNOMIAL_OK;
+}
+
+static void term_buffer_free(TermBuffer* buf) {
+    poly_mem_free(buf->monomials);
+    poly_mem_free(buf->coeffs);
+}
+
+// Replaces the terms of result with the buffer's, which result takes over
+static void term_buffer_install(TermBuffer* buf, MPolynomial* result) {
+    poly_mem_free(result->monomials);
+    poly_mem_free(result->coeffs);
+    result->monomials = buf->monomials;
+    result->coeffs = buf->coeffs;
+    result->length = buf->length;
+    result->capacity = buf->capacity;
+}
+
+static MPolynomial* mpoly_create_unscoped(const TypeInfo* typeInfo, int nvars, int bits, PolynomialError* err) {
+    if (!typeInfo) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    // one variable cannot take the whole word; fields are at most 32 bits
+    if (bits == 0 && nvars > 0) bits = 64 / nvars < 32 ? 64 / nvars : 32;
+    if (nvars < 1 || bits < 2 || bits > 32 || nvars * bits > 64) {
+        if (err) *err = POLYNOMIAL_INVALID_INPUT;
+        return NULL;
+    }
+
+    MPolynomial* poly = poly_mem_calloc(1, sizeof(MPolynomial));
+    if (!poly) {
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    poly->nvars = nvars;
+    poly->bits = bits;
+    poly->typeInfo = typeInfo;
+    if (err) *err = POLYNOMIAL_OK;
+    return poly;
+}
+
+MPolynomial* mpoly_create(const TypeInfo* typeInfo, int nvars, int bits, PolynomialError* err) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIVARIATE, typeInfo);
+    MPolynomial* created = mpoly_create_unscoped(typeInfo, nvars, bits, err);
+    poly_mem_leave(&scope);
+    return created;
+}
+
+void mpoly_free(MPolynomial* poly) {
+    if (!poly) return;
+    poly_mem_free(poly->monomials);
+    poly_mem_free(poly->coeffs);
+    poly_mem_free(poly);
+}
+
+static PolynomialError mpoly_add_term_unscoped(MPolynomial* poly, const int* exps, const void* coeff) {
+    if (!poly || !exps || !coeff) return POLYNOMIAL_NULL_PTR;
+
+    uint64_t mono;
+    PolynomialError err = mpoly_pack(poly, exps, &mono);
+    if (err != POLYNOMIAL_OK) return err;
+
+    size_t size = poly->typeInfo->size;
+    // binary search in the decreasing monomial order
+    int lo = 0, hi = poly->length;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (poly->monomials[mid] > mono) lo = mid + 1;
+        else hi = mid;
+    }
+
+    if (lo < poly->length && poly->monomials[lo] == mono) {
+        char* cell = COEFF(poly->coeffs, lo, size);
+        poly->typeInfo->add(cell, coeff, cell);
+        if (mpoly_coeff_is_zero(poly->typeInfo, cell)) {
+            memmove(poly->monomials + lo, poly->monomials + lo + 1, (poly->length - lo - 1) * sizeof(uint64_t));
+            memmove(cell, cell + size, (poly->length - lo - 1) * size);
+            poly->length--;
+        }
+        return POLYNOMIAL_OK;
+    }
+    if (mpoly_coeff_is_zero(poly->typeInfo, coeff)) return POLYNOMIAL_OK;
+
+    if (poly->length == poly->capacity) {
+        int capacity = poly->capacity ? 2 * poly->capacity : 8;
+        uint64_t* monomials = poly_mem_realloc(poly->monomials, capacity * sizeof(uint64_t));
+        if (!monomials) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        poly->monomials = monomials;
+        void* coeffs = poly_mem_realloc(poly->coeffs, capacity * size);
+        if (!coeffs) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        poly->coeffs = coeffs;
+        poly->capacity = capacity;
+    }
+
+    memmove(poly->monomials + lo + 1, poly->monomials + lo, (poly->length - lo) * sizeof(uint64_t));
+    memmove(COEFF(poly->coeffs, lo + 1, size), COEFF(poly->coeffs, lo, size), (poly->length - lo) * size);
+    poly->monomials[lo] = mono;
+    memcpy(COEFF(poly->coeffs, lo, size), coeff, size);
+    poly->length++;
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError mpoly_add_term(MPolynomial* poly, const int* exps, const void* coeff) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIVARIATE, poly ? poly->typeInfo : NULL);
+    PolynomialError status = mpoly_add_term_unscoped(poly, exps, coeff);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+PolynomialError mpoly_get_term(const MPolynomial* poly, int i, int* exps, void* coeff) {
+    if (!poly) return POLYNOMIAL_NULL_PTR;
+    if (i < 0 || i >= poly->length) return POLYNOMIAL_INVALID_INPUT;
+
+    if (exps) {
+        for (int v = 0; v < poly->nvars; v++) exps[v] = mpoly_exponent(poly, poly->monomials[i], v);
+    }
+    if (coeff) memcpy(coeff, COEFF(poly->coeffs, i, poly->typeInfo->size), poly->typeInfo->size);
+    return POLYNOMIAL_OK;
+}
+
+static PolynomialError mpoly_add_unscoped(const MPolynomial* a, const MPolynomial* b, MPolynomial* result) {
+    if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
+    if (!mpoly_compatible(a, b) || !mpoly_compatible(a, result)) return POLYNOMIAL_TYPE_MISMATCH;
+
+    size_t size = a->typeInfo->size;
+    TermBuffer buf = {NULL, NULL, 0, 0, size};
+    void* sum = poly_mem_alloc(size);
+    if (!sum) return POLYNOMIAL_MEM_ALLOC_FAIL;
+
+    PolynomialError err = POLYNOMIAL_OK;
+    int i = 0, j = 0;
+    while (err == POLYNOMIAL_OK && (i < a->length || j < b->length)) {
+        if (j == b->length || (i < a->length && a->monomials[i] > b->monomials[j])) {
+            err = term_buffer_push(&buf, a->monomials[i], COEFF(a->coeffs, i, size));
+            i++;
+        } else if (i == a->length || b->monomials[j] > a->monomials[i]) {
+            err = term_buffer_push(&buf, b->monomials[j], COEFF(b->coeffs, j, size));
+            j++;
+        } else {
+            a->typeInfo->add(COEFF(a->coeffs, i, size), COEFF(b->coeffs, j, size), sum);
+            if (!mpoly_coeff_is_zero(a->typeInfo, sum)) err = term_buffer_push(&buf, a->monomials[i], sum);
+            i++;
+            j++;
+        }
+    }
+
+    poly_mem_free(sum);
+    if (err != POLYNOMIAL_OK) {
+        term_buffer_free(&buf);
+        return err;
+    }
+    term_buffer_install(&buf, result);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError mpoly_add(const MPolynomial* a, const MPolynomial* b, MPolynomial* result) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIVARIATE, a ? a->typeInfo : NULL);
+    PolynomialError status = mpoly_add_unscoped(a, b, result);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+typedef struct {
+    uint64_t mono;
+    int i;
+    int j;
+} HeapEntry;
+
+static void heap_push(HeapEntry* heap, int* size, HeapEntry entry) {
+    int k = (*size)++;
+    while (k > 0) {
+        int parent = (k - 1) / 2;
+        if (heap[parent].mono >= entry.mono) break;
+        heap[k] = heap[parent];
+        k = parent;
+    }
+    heap[k] = entry;
+}
+
+static HeapEntry heap_pop(HeapEntry* heap, int* size) {
+    HeapEntry top = heap[0];
+    HeapEntry last = heap[--(*size)];
+    int k = 0;
+    for (;;) {
+        int child = 2 * k + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && heap[child + 1].mono > heap[child].mono) child++;
+        if (heap[child].mono <= last.mono) break;
+        heap[k] = heap[child];
+        k = child;
+    }
+    if (*size > 0) heap[k] = last;
+    return top;
+}
+
+// Johnson's algorithm: one heap entry per term of a walks along b, so the
+// products come out in decreasing order and like terms arrive together.
+static PolynomialError mpoly_multiply_terms(const MPolynomial* a, int aBegin, int aEnd,
+                                            const MPolynomial* b, TermBuffer* out) {
+    size_t size = a->typeInfo->size;
+    int rows = aEnd - aBegin;
+    if (rows <= 0 || b->length == 0) return POLYNOMIAL_OK;
+
+    uint64_t guard = mpoly_guard_mask(a);
+    HeapEntry* heap = poly_mem_alloc(rows * sizeof(HeapEntry));
+    char* scratch = poly_mem_alloc(3 * size);
+    if (!heap || !scratch) {
+        poly_mem_free(heap);
+        poly_mem_free(scratch);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+    char* acc = scratch;
+    char* term = scratch + size;
+    char* sum = scratch + 2 * size;
+
+    PolynomialError err = POLYNOMIAL_OK;
+    int heapSize = 0;
+    for (int i = aBegin; i < aEnd; i++) {
+        HeapEntry entry = {a->monomials[i] + b->monomials[0], i, 0};
+        if (entry.mono & guard) err = POLYNOMIAL_INVALID_DEGREE;
+        heap_push(heap, &heapSize, entry);
+    }
+
+    while (err == POLYNOMIAL_OK && heapSize > 0) {
+        uint64_t mono = heap[0].mono;
+        memset(acc, 0, size);
+        while (heapSize > 0 && heap[0].mono == mono) {
+            HeapEntry top = heap_pop(heap, &heapSize);
+            a->typeInfo->multiply(COEFF(a->coeffs, top.i, size), COEFF(b->coeffs, top.j, size), term);
+            a->typeInfo->add(acc, term, sum);
+            memcpy(acc, sum, size);
+            if (top.j + 1 < b->length) {
+                HeapEntry next = {a->monomials[top.i] + b->monomials[top.j + 1], top.i, top.j + 1};
+                if (next.mono & guard) err = POLYNOMIAL_INVALID_DEGREE;
+                heap_push(heap, &heapSize, next);
+            }
+        }
+        if (err == POLYNOMIAL_OK && !mpoly_coeff_is_zero(a->typeInfo, acc)) {
+            err = term_buffer_push(out, mono, acc);
+        }
+    }
+
+    poly_mem_free(heap);
+    poly_mem_free(scratch);
+    return err;
+}
+
+static PolynomialError mpoly_multiply_unscoped(const MPolynomial* a, const MPolynomial* b, MPolynomial* result) {
+    if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
+    if (!mpoly_compatible(a, b) || !mpoly_compatible(a, result)) return POLYNOMIAL_TYPE_MISMATCH;
+
+    // iterate over the shorter operand's terms to keep the heap small
+    if (b->length < a->length) {
+        const MPolynomial* swap = a; a = b; b = swap;
+    }
+
+    TermBuffer buf = {NULL, NULL, 0, 0, a->typeInfo->size};
+    PolynomialError err = mpoly_multiply_terms(a, 0, a->length, b, &buf);
+    if (err != POLYNOMIAL_OK) {
+        term_buffer_free(&buf);
+        return err;
+    }
+    term_buffer_install(&buf, result);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError mpoly_multiply(const MPolynomial* a, const MPolynomial* b, MPolynomial* result) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIVARIATE, a ? a->typeInfo : NULL);
+    PolynomialError status = mpoly_multiply_unscoped(a, b, result);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+typedef struct {
+    const MPolynomial* a;
+    const MPolynomial* b;
+    MPolynomial** parts;
+    int blockSize;
+    int stride;
+    PolynomialError status;
+} MultiplyJob;
+
+static void mpoly_multiply_block(void* ctx, int begin, int end) {
+    MultiplyJob* job = ctx;
+    for (int k = begin; k < end; k++) {
+        int aBegin = k * job->blockSize;
+        int aEnd = aBegin + job->blockSize < job->a->length ? aBegin + job->blockSize : job->a->length;
+        TermBuffer buf = {NULL, NULL, 0, 0, job->a->typeInfo->size};
+        PolynomialError err = mpoly_multiply_terms(job->a, aBegin, aEnd, job->b, &buf);
+        if (err == POLYNOMIAL_OK) term_buffer_install(&buf, job->parts[k]);
+        else {
+            term_buffer_free(&buf);
+            __atomic_store_n(&job->status, err, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// parts[k] += parts[k + stride] for every k that starts a pair at this level
+static void mpoly_merge_pairs(void* ctx, int begin, int end) {
+    MultiplyJob* job = ctx;
+    for (int p = begin; p < end; p++) {
+        int k = p * 2 * job->stride;
+        PolynomialError err = mpoly_add(job->parts[k], job->parts[k + job->stride], job->parts[k]);
+        if (err != POLYNOMIAL_OK) __atomic_store_n(&job->status, err, __ATOMIC_RELAXED);
+    }
+}
+
+static PolynomialError mpoly_multiply_parallel_unscoped(const MPolynomial* a, const MPolynomial* b, MPolynomial* result) {
+    if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
+    if (!mpoly_compatible(a, b) || !mpoly_compatible(a, result)) return POLYNOMIAL_TYPE_MISMATCH;
+
+    ThreadPool* pool = thread_pool_shared();
+    int threads = thread_pool_size(pool);
+    if (b->length > a->length) {
+        const MPolynomial* swap = a; a = b; b = swap;
+    }
+    // a few blocks per thread balance uneven blocks; tiny inputs stay serial
+    int blocks = 4 * threads;
+    if (blocks > a->length / 16) blocks = a->length / 16;
+    if (blocks < 2) return mpoly_multiply(a, b, result);
+
+    MPolynomial** parts = poly_mem_calloc(blocks, sizeof(MPolynomial*));
+    if (!parts) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    PolynomialError err = POLYNOMIAL_OK;
+    for (int k = 0; k < blocks && err == POLYNOMIAL_OK; k++) {
+        parts[k] = mpoly_create(a->typeInfo, a->nvars, a->bits, &err);
+    }
+
+    MultiplyJob job = {a, b, parts, (a->length + blocks - 1) / blocks, 1, POLYNOMIAL_OK};
+    if (err == POLYNOMIAL_OK) {
+        thread_pool_parallel_for(pool, blocks, 1, mpoly_multiply_block, &job);
+        // pairwise tree reduction, each level in parallel
+        for (job.stride = 1; job.stride < blocks && job.status == POLYNOMIAL_OK; job.stride *= 2) {
+            int pairs = (blocks - job.stride + 2 * job.stride - 1) / (2 * job.stride);
+            thread_pool_parallel_for(pool, pairs, 1, mpoly_merge_pairs, &job);
+        }
+        err = job.status;
+    }
+
+    if (err == POLYNOMIAL_OK) {
+        TermBuffer buf = {parts[0]->monomials, parts[0]->coeffs, parts[0]->length, parts[0]->capacity,
+                          a->typeInfo->size};
+        term_buffer_install(&buf, result);
+        parts[0]->monomials = NULL;
+        parts[0]->coeffs = NULL;
+    }
+    for (int k = 0; k < blocks; k++) mpoly_free(parts[k]);
+    poly_mem_free(parts);
+    return err;
+}
+
+PolynomialError mpoly_multiply_parallel(const MPolynomial* a, const MPolynomial* b, MPolynomial* result) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIVARIATE, a ? a->typeInfo : NULL);
+    PolynomialError status = mpoly_multiply_parallel_unscoped(a, b, result);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+// table[v][e - 1] = values[v]^e for 1 <= e <= maxExp[v], packed one variable after another
+static PolynomialError mpoly_power_tables(const MPolynomial* poly, const char* values, int onlyVar,
+                                          char** tableOut, int** offsetsOut) {
+    size_t size = poly->typeInfo->size;
+    int* offsets = poly_mem_calloc(poly->nvars + 1, sizeof(int));
+    if (!offsets) return POLYNOMIAL_MEM_ALLOC_FAIL;
+
+    for (int v = 0; v < poly->nvars; v++) {
+        int maxExp = 0;
+        if (onlyVar < 0 || onlyVar == v) {
+            for (int i = 0; i < poly->length; i++) {
+                int e = mpoly_exponent(poly, poly->monomials[i], v);
+                if (e > maxExp) maxExp = e;
+            }
+        }
+        offsets[v + 1] = offsets[v] + maxExp;
+    }
+
+    char* table = poly_mem_alloc((size_t)(offsets[poly->nvars] + 1) * size);
+    if (!table) {
+        poly_mem_free(offsets);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+    for (int v = 0; v < poly->nvars; v++) {
+        int count = offsets[v + 1] - offsets[v];
+        const char* x = onlyVar < 0 ? COEFF(values, v, size) : values;
+        for (int e = 0; e < count; e++) {
+            char* cell = COEFF(table, offsets[v] + e, size);
+            if (e == 0) memcpy(cell, x, size);
+            else poly->typeInfo->multiply(cell - size, x, cell);
+        }
+    }
+
+    *tableOut = table;
+    *offsetsOut = offsets;
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError mpoly_evaluate(const MPolynomial* poly, const void* values, void* result) {
+    if (!poly || !values || !result) return POLYNOMIAL_NULL_PTR;
+
+    size_t size = poly->typeInfo->size;
+    char* table;
+    int* offsets;
+    PolynomialError err = mpoly_power_tables(poly, values, -1, &table, &offsets);
+    if (err != POLYNOMIAL_OK) return err;
+
+    char* scratch = poly_mem_alloc(3 * size);
+    if (!scratch) {
+        poly_mem_free(table);
+        poly_mem_free(offsets);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+    char* acc = scratch;
+    char* term = scratch + size;
+    char* tmp = scratch + 2 * size;
+
+    memset(acc, 0, size);
+    for (int i = 0; i < poly->length; i++) {
+        memcpy(term, COEFF(poly->coeffs, i, size), size);
+        for (int v = 0; v < poly->nvars; v++) {
+            int e = mpoly_exponent(poly, poly->monomials[i], v);
+            if (e == 0) continue;
+            poly->typeInfo->multiply(term, COEFF(table, offsets[v] + e - 1, size), tmp);
+            memcpy(term, tmp, size);
+        }
+        poly->typeInfo->add(acc, term, tmp);
+        memcpy(acc, tmp, size);
+    }
+
+    memcpy(result, acc, size);
+    poly_mem_free(scratch);
+    poly_mem_free(table);
+    poly_mem_free(offsets);
+    return POLYNOMIAL_OK;
+}
+
+typedef struct {
+    uint64_t mono;
+    int index;
+} SortedTerm;
+
+static int sorted_term_compare(const void* a, const void* b) {
+    uint64_t ma = ((const SortedTerm*)a)->mono;
+    uint64_t mb = ((const SortedTerm*)b)->mono;
+    return ma < mb ? 1 : ma > mb ? -1 : 0;
+}
+
+static PolynomialError mpoly_partial_evaluate_unscoped(const MPolynomial* poly, int var, const void* value, MPolynomial* result) {
+    if (!poly || !value || !result) return POLYNOMIAL_NULL_PTR;
+    if (!mpoly_compatible(poly, result)) return POLYNOMIAL_TYPE_MISMATCH;
+    if (var < 0 || var >= poly->nvars) return POLYNOMIAL_INVALID_INPUT;
+
+    size_t size = poly->typeInfo->size;
+    int n = poly->length;
+    char* table;
+    int* offsets;
+    PolynomialError err = mpoly_power_tables(poly, value, var, &table, &offsets);
+    if (err != POLYNOMIAL_OK) return err;
+
+    SortedTerm* order = poly_mem_alloc((n ? n : 1) * sizeof(SortedTerm));
+    char* coeffs = poly_mem_alloc((size_t)(n + 1) * size);
+    if (!order || !coeffs) {
+        poly_mem_free(order);
+        poly_mem_free(coeffs);
+        poly_mem_free(table);
+        poly_mem_free(offsets);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    uint64_t fieldMask = (((uint64_t)1 << poly->bits) - 1) << mpoly_shift(poly, var);
+    for (int i = 0; i < n; i++) {
+        int e = mpoly_exponent(poly, poly->monomials[i], var);
+        order[i].mono = poly->monomials[i] & ~fieldMask;
+        order[i].index = i;
+        if (e == 0) memcpy(COEFF(coeffs, i, size), COEFF(poly->coeffs, i, size), size);
+        else poly->typeInfo->multiply(COEFF(poly->coeffs, i, size), COEFF(table, offsets[var] + e - 1, size),
+                                      COEFF(coeffs, i, size));
+    }
+    qsort(order, n, sizeof(SortedTerm), sorted_term_compare);
+
+    // like terms are now adjacent; combine them and drop cancellations
+    TermBuffer buf = {NULL, NULL, 0, 0, size};
+    char* acc = COEFF(coeffs, n, size);
+    for (int i = 0; i < n && err == POLYNOMIAL_OK;) {
+        memcpy(acc, COEFF(coeffs, order[i].index, size), size);
+        int j = i + 1;
+        for (; j < n && order[j].mono == order[i].mono; j++) {
+            poly->typeInfo->add(acc, COEFF(coeffs, order[j].index, size), acc);
+        }
+        if (!mpoly_coeff_is_zero(poly->typeInfo, acc)) err = term_buffer_push(&buf, order[i].mono, acc);
+        i = j;
+    }
+
+    poly_mem_free(order);
+    poly_mem_free(coeffs);
+    poly_mem_free(table);
+    poly_mem_free(offsets);
+    if (err != POLYNOMIAL_OK) {
+        term_buffer_free(&buf);
+        return err;
+    }
+    term_buffer_install(&buf, result);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError mpoly_partial_evaluate(const MPolynomial* poly, int var, const void* value, MPolynomial* result) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIVARIATE, poly ? poly->typeInfo : NULL);
+    PolynomialError status = mpoly_partial_evaluate_unscoped(poly, var, value, result);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+void mpoly_print(const MPolynomial* poly) {
+    if (!poly) {
+        printf("Null polynomial\n");
+        return;
+    }
+    if (poly->length == 0) {
+        printf("0\n");
+        return;
+    }
+
+    for (int i = 0; i < poly->length; i++) {
+        if (i > 0) printf(" + ");
+        poly->typeInfo->print(COEFF(poly->coeffs, i, poly->typeInfo->size));
+        for (int v = 0; v < poly->nvars; v++) {
+            int e = mpoly_exponent(poly, poly->monomials[i], v);
+            if (e == 0) continue;
+            printf("*x%d", v);
+            if (e > 1) printf("^%d", e);
+        }
+    }
+    printf("\n");
+}
@@ -0,0 +1,47 @@
+#ifndef MULTIVARIATE_H
+#define MULTIVARIATE_H
+
+#include "TypeInfo.h"
+#include "PolynomialDefines.h"
+#include <stdint.h>
+
+// Sparse polynomial in nvars variables. Each monomial's exponent vector is
+// packed into one 64-bit word, variable 0 in the most significant field, so
+// lexicographic comparison is an integer compare and multiplying monomials
+// is an integer add. Every field has a guard bit on top that catches
+// exponent overflow. Terms are kept sorted by decreasing monomial, with no
+// zero coefficients.
+typedef struct {
+    int nvars;
+    int bits;
+    int length;
+    int capacity;
+    uint64_t* monomials;
+    void* coeffs;
+    const TypeInfo* typeInfo;
+} MPolynomial;
+
+// Largest exponent a field of the given width holds (the top bit is the guard)
+#define MPOLY_MAX_EXPONENT(bits) ((1u << ((bits) - 1)) - 1)
+
+// Creates the zero polynomial; bits = 0 spreads the word evenly over nvars,
+// up to 32 bits a variable
+MPolynomial* mpoly_create(const TypeInfo* typeInfo, int nvars, int bits, PolynomialError* err);
+void mpoly_free(MPolynomial* poly);
+// Adds coeff * x^exps, combining with an existing term of the same monomial
+PolynomialError mpoly_add_term(MPolynomial* poly, const int* exps, const void* coeff);
+// Reads term i (0 <= i < length); either output may be NULL
+PolynomialError mpoly_get_term(const MPolynomial* poly, int i, int* exps, void* coeff);
+
+PolynomialError mpoly_add(const MPolynomial* a, const MPolynomial* b, MPolynomial* result);
+// Heap-based (Johnson) multiplication, producing terms already in order
+PolynomialError mpoly_multiply(const MPolynomial* a, const MPolynomial* b, MPolynomial* result);
+// Splits a into term blocks multiplied on the shared thread pool, then merges
+PolynomialError mpoly_multiply_parallel(const MPolynomial* a, const MPolynomial* b, MPolynomial* result);
+// values holds one coefficient per variable
+PolynomialError mpoly_evaluate(const MPolynomial* poly, const void* values, void* result);
+// Substitutes x_var = value; result keeps nvars variables with x_var absent
+PolynomialError mpoly_partial_evaluate(const MPolynomial* poly, int var, const void* value, MPolynomial* result);
+void mpoly_print(const MPolynomial* poly);
+
+#endif
@@ -1,13 +1,59 @@
 #include "Polynomial.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "PolynomialFFT.h"
+#include "PolynomialConvolve.h"
+#include "PolynomialFormat.h"
+#include "PolynomialTrace.h"
 #include "Integer.h"
 #include "Complex.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <limits.h>
 #include <stdbool.h> 
 
-Polynomial* poly_create(TypeInfo* typeInfo, int degree, PolynomialError* err) {
+// One block of coefficients, so specialized kernels can run over a flat
+// array, and the pointer to each in the same allocation as the header.
+// Views point into pointers at their offset.
+struct PolyBuffer {
+    int refs;
+    int length;
+    size_t size;
+    char* data;
+    void* pointers[];
+};
+
+static PolyBuffer* poly_buffer_create(size_t size, int length) {
+    PolyBuffer* buffer = poly_mem_alloc(sizeof(PolyBuffer) + (size_t)length * sizeof(void*));
+    if (!buffer) return NULL;
+    buffer->data = poly_mem_calloc(length, size);
+    if (!buffer->data) {
+        poly_mem_free(buffer);
+        return NULL;
+    }
+    buffer->refs = 1;
+    buffer->length = length;
+    buffer->size = size;
+    for (int i = 0; i < length; i++) buffer->pointers[i] = buffer->data + (size_t)i * size;
+    return buffer;
+}
+
+// Copies are made before the last reference is dropped, so the release
+// orders them before the buffer is freed
+static void poly_buffer_release(PolyBuffer* buffer) {
+    if (buffer && __atomic_sub_fetch(&buffer->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        poly_mem_free(buffer->data);
+        poly_mem_free(buffer);
+    }
+}
+
+static size_t poly_buffer_bytes(size_t size, int length) {
+    return sizeof(PolyBuffer) + (size_t)length * (size + sizeof(void*));
+}
+
+Polynomial* poly_create(const TypeInfo* typeInfo, int degree, PolynomialError* err) {
     if (!typeInfo) {
         if (err) *err = POLYNOMIAL_NULL_PTR;
         return NULL;
@@ -18,31 +64,18 @@ Polynomial* poly_create(TypeInfo* typeInfo, int degree, PolynomialError* err) {
         return NULL;
     }
     
-    Polynomial* poly = malloc(sizeof(Polynomial));
-    if (!poly) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_CREATE, typeInfo);
+    Polynomial* poly = poly_mem_alloc(sizeof(Polynomial));
+    PolyBuffer* buffer = poly ? poly_buffer_create(typeInfo->size, degree + 1) : NULL;
+    poly_mem_leave(&scope);
+    if (!buffer) {
+        poly_mem_free(poly);
         if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
         return NULL;
     }
-    
-    poly->coefficients = malloc((degree + 1) * sizeof(void*));
-    if (!poly->coefficients) {
-        free(poly);
-        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
-        return NULL;
-    }
-    
-    for (int i = 0; i <= degree; i++) {
-        poly->coefficients[i] = malloc(typeInfo->size);
-        if (!poly->coefficients[i]) {
-            for (int j = 0; j < i; j++) free(poly->coefficients[j]);
-            free(poly->coefficients);
-            free(poly);
-            if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
-            return NULL;
-        }
-        memset(poly->coefficients[i], 0, typeInfo->size);
-    }
-    
+
+    poly->buffer = buffer;
+    poly->coefficients = poly->buffer->pointers;
     poly->degree = degree;
     poly->typeInfo = typeInfo;
     if (err) *err = POLYNOMIAL_OK;
@@ -54,26 +87,24 @@ bool poly_is_equal(const Polynomial* a, const Polynomial* b) {
 
     if (a->degree != b->degree || a->typeInfo != b->typeInfo) return false;
 
-    for (int i = 0; i <= a->degree; i++) {
-        if (a->typeInfo == GetIntTypeInfo()) {
-            if (*(int*)a->coefficients[i] != *(int*)b->coefficients[i]) return false;
-        } else if (a->typeInfo == GetComplexTypeInfo()) {
-            const Complex* ca = a->coefficients[i];
-            const Complex* cb = b->coefficients[i];
-            if (fabs(ca->real - cb->real) > 1e-6 || fabs(ca->imag - cb->imag) > 1e-6) return false;
-        }
+    switch (poly_kernel_type(a->typeInfo)) {
+#define POLY_EQUAL_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        return NAME##_kernel_equal(POLY_COEFFS(a, const T), POLY_COEFFS(b, const T), a->degree + 1);
+    POLY_BUILTIN_TYPES(POLY_EQUAL_CASE)
+#undef POLY_EQUAL_CASE
+    default:
+        break;
     }
 
-    return true;
+    return memcmp(a->coefficients[0], b->coefficients[0], (a->degree + 1) * a->typeInfo->size) == 0;
 }
 
-Polynomial* poly_create_with_coeffs(TypeInfo* typeInfo, int degree, const void* coeffs, PolynomialError* err) {
+Polynomial* poly_create_with_coeffs(const TypeInfo* typeInfo, int degree, const void* coeffs, PolynomialError* err) {
     Polynomial* poly = poly_create(typeInfo, degree, err);
     if (!poly) return NULL;
     
-    for (int i = 0; i <= degree; i++) {
-        memcpy(poly->coefficients[i], (const char*)coeffs + i * typeInfo->size, typeInfo->size);
-    }
+    memcpy(poly->coefficients[0], coeffs, (degree + 1) * typeInfo->size);
     
     if (err) *err = POLYNOMIAL_OK;
     return poly;
@@ -81,134 +112,1069 @@ Polynomial* poly_create_with_coeffs(TypeInfo* typeInfo, int degree, const void*
 
 void poly_free(Polynomial* poly) {
     if (!poly) return;
-    for (int i = 0; i <= poly->degree; i++) {
-        free(poly->coefficients[i]);
+    poly_buffer_release(poly->buffer);
+    poly_mem_free(poly);
+}
+
+Polynomial* poly_view(const Polynomial* poly, int offset, int degree, PolynomialError* err) {
+    if (!poly) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
     }
-    free(poly->coefficients);
-    free(poly);
+    if (offset < 0 || degree < 0 || offset > poly->degree - degree) {
+        if (err) *err = POLYNOMIAL_INVALID_DEGREE;
+        return NULL;
+    }
+
+    // borrowed storage may go away, so views of it are copies
+    if (!poly->buffer) {
+        return poly_create_with_coeffs(poly->typeInfo, degree, poly->coefficients[offset], err);
+    }
+
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_CREATE, poly->typeInfo);
+    Polynomial* view = poly_mem_alloc(sizeof(Polynomial));
+    poly_mem_leave(&scope);
+    if (!view) {
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    __atomic_add_fetch(&poly->buffer->refs, 1, __ATOMIC_RELAXED);
+    view->buffer = poly->buffer;
+    view->coefficients = poly->coefficients + offset;
+    view->degree = degree;
+    view->typeInfo = poly->typeInfo;
+    if (err) *err = POLYNOMIAL_OK;
+    return view;
 }
 
-PolynomialError poly_add(const Polynomial* a, const Polynomial* b, Polynomial* result) {
+Polynomial* poly_clone(const Polynomial* poly, PolynomialError* err) {
+    if (!poly) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    return poly_view(poly, 0, poly->degree, err);
+}
+
+bool poly_is_shared(const Polynomial* poly) {
+    return poly && poly->buffer && __atomic_load_n(&poly->buffer->refs, __ATOMIC_ACQUIRE) > 1;
+}
+
+PolynomialError poly_make_unique(Polynomial* poly) {
+    if (!poly) return POLYNOMIAL_NULL_PTR;
+    if (!poly_is_shared(poly)) return POLYNOMIAL_OK;
+
+    size_t size = poly->typeInfo->size;
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_CREATE, poly->typeInfo);
+    PolyBuffer* fresh = poly_buffer_create(size, poly->degree + 1);
+    poly_mem_leave(&scope);
+    if (!fresh) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    memcpy(fresh->data, poly->coefficients[0], (size_t)(poly->degree + 1) * size);
+    poly_buffer_release(poly->buffer);
+    poly->buffer = fresh;
+    poly->coefficients = fresh->pointers;
+    return POLYNOMIAL_OK;
+}
+
+size_t poly_unique_bytes(const Polynomial* poly) {
+    return poly_is_shared(poly) ? poly_buffer_bytes(poly->typeInfo->size, poly->degree + 1) : 0;
+}
+
+static int poly_compare_buffers(const void* x, const void* y) {
+    const PolyBuffer* a = *(const PolyBuffer* const*)x;
+    const PolyBuffer* b = *(const PolyBuffer* const*)y;
+    return (a > b) - (a < b);
+}
+
+PolynomialError poly_memory_report(const Polynomial* const* polys, int count, PolyMemoryReport* report) {
+    if (!report || (count > 0 && !polys)) return POLYNOMIAL_NULL_PTR;
+    if (count < 0) return POLYNOMIAL_INVALID_INPUT;
+    memset(report, 0, sizeof(*report));
+
+    const PolyBuffer** buffers = poly_mem_alloc((count > 0 ? count : 1) * sizeof(PolyBuffer*));
+    if (!buffers) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        const Polynomial* poly = polys[i];
+        if (!poly) continue;
+        report->polynomials++;
+        report->logicalBytes += poly_buffer_bytes(poly->typeInfo->size, poly->degree + 1);
+        if (poly->buffer) {
+            buffers[n++] = poly->buffer;
+        } else {
+            report->allocatedBytes += poly_buffer_bytes(poly->typeInfo->size, poly->degree + 1);
+            report->buffers++;
+        }
+    }
+    // each distinct buffer counted once, however many polynomials use it
+    qsort(buffers, n, sizeof(PolyBuffer*), poly_compare_buffers);
+    for (int i = 0; i < n; i++) {
+        if (i > 0 && buffers[i] == buffers[i - 1]) continue;
+        report->allocatedBytes += poly_buffer_bytes(buffers[i]->size, buffers[i]->length);
+        report->buffers++;
+    }
+    poly_mem_free(buffers);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_copy_coeffs(const Polynomial* src, Polynomial* dst) {
+    if (!src || !dst) return POLYNOMIAL_NULL_PTR;
+    if (src->typeInfo != dst->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (dst->degree < src->degree) return POLYNOMIAL_INVALID_DEGREE;
+    // made writable even when src is dst: callers go on to write dst
+    PolynomialError err = poly_make_unique(dst);
+    if (err != POLYNOMIAL_OK || src == dst) return err;
+
+    size_t size = src->typeInfo->size;
+    memcpy(dst->coefficients[0], src->coefficients[0], (src->degree + 1) * size);
+    memset((char*)dst->coefficients[0] + (src->degree + 1) * size, 0, (dst->degree - src->degree) * size);
+    return POLYNOMIAL_OK;
+}
+
+// Integer polynomials. Add, multiply and scalar multiply widen the result
+// (int, then int64, then int128) when a coefficient would not fit instead
+// of wrapping. Ranks 1..3 stand for the three widths, 0 for other types.
+static int int_rank(const TypeInfo* typeInfo) {
+    return int_type_width(typeInfo) == 128 ? 3 : int_type_width(typeInfo) / 32;
+}
+
+static const TypeInfo* int_rank_type(int rank) {
+    return rank == 1 ? GetIntTypeInfo() : rank == 2 ? GetInt64TypeInfo() : GetInt128TypeInfo();
+}
+
+static int int_family(const Polynomial* a, const Polynomial* b, const Polynomial* result) {
+    return int_rank(a->typeInfo) && int_rank(b->typeInfo) && int_rank(result->typeInfo);
+}
+
+static Int128 int_load_raw(const void* c, int rank, int i) {
+    if (rank == 1) return ((const int*)c)[i];
+    if (rank == 2) return ((const int64_t*)c)[i];
+    return ((const Int128*)c)[i];
+}
+
+static void int_store_raw(void* c, int rank, int i, Int128 v) {
+    if (rank == 1) ((int*)c)[i] = (int)v;
+    else if (rank == 2) ((int64_t*)c)[i] = (int64_t)v;
+    else ((Int128*)c)[i] = v;
+}
+
+static int int_rank_of_value(Int128 v) {
+    if (v >= INT_MIN && v <= INT_MAX) return 1;
+    if (v >= INT64_MIN && v <= INT64_MAX) return 2;
+    return 3;
+}
+
+// Smallest and largest coefficient, in loops over the native width
+static void int_range(const void* c, int rank, int n, Int128* lo, Int128* hi) {
+#define POLY_INT_RANGE(T) { \
+    const T* v = c; \
+    T min = 0, max = 0; \
+    for (int i = 0; i < n; i++) { \
+        min = v[i] < min ? v[i] : min; \
+        max = v[i] > max ? v[i] : max; \
+    } \
+    *lo = min; \
+    *hi = max; \
+}
+    if (rank == 1) POLY_INT_RANGE(int)
+    else if (rank == 2) POLY_INT_RANGE(int64_t)
+    else POLY_INT_RANGE(Int128)
+#undef POLY_INT_RANGE
+}
+
+static PolyUInt128 int_magnitude(const void* c, int rank, int n) {
+    Int128 lo, hi;
+    int_range(c, rank, n, &lo, &hi);
+    PolyUInt128 neg = (PolyUInt128)0 - (PolyUInt128)lo;
+    return neg > (PolyUInt128)hi ? neg : (PolyUInt128)hi;
+}
+
+PolynomialError poly_promote(Polynomial* poly, const TypeInfo* typeInfo) {
+    if (!poly || !typeInfo) return POLYNOMIAL_NULL_PTR;
+    int from = int_rank(poly->typeInfo);
+    int to = int_rank(typeInfo);
+    if (!from || !to) return POLYNOMIAL_TYPE_MISMATCH;
+    if (to < from) return POLYNOMIAL_INVALID_INPUT;
+    if (to == from) return POLYNOMIAL_OK;
+
+    int n = poly->degree + 1;
+    PolyBuffer* buffer = poly->buffer;
+    if (buffer && !poly_is_shared(poly) && poly->coefficients == buffer->pointers && buffer->length == n) {
+        // the whole buffer is poly's alone: widen it in place
+        PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_CREATE, typeInfo);
+        char* data = poly_mem_realloc(buffer->data, n * typeInfo->size);
+        poly_mem_leave(&scope);
+        if (!data) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        // widened from the top, so every value is read before its bytes are reused
+        for (int i = n - 1; i >= 0; i--) int_store_raw(data, to, i, int_load_raw(data, from, i));
+        for (int i = 0; i < n; i++) buffer->pointers[i] = data + i * typeInfo->size;
+        buffer->data = data;
+        buffer->size = typeInfo->size;
+    } else {
+        // shared, a view, or borrowed: widen into storage of its own
+        PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_CREATE, typeInfo);
+        PolyBuffer* fresh = poly_buffer_create(typeInfo->size, n);
+        poly_mem_leave(&scope);
+        if (!fresh) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        for (int i = 0; i < n; i++) int_store_raw(fresh->data, to, i, int_load_raw(poly->coefficients[0], from, i));
+        poly_buffer_release(buffer);
+        poly->buffer = fresh;
+        poly->coefficients = fresh->pointers;
+    }
+    poly->typeInfo = typeInfo;
+    return POLYNOMIAL_OK;
+}
+
+// Stores v, widening result first if v does not fit its coefficients
+static PolynomialError int_store_promoting(Polynomial* result, int i, Int128 v) {
+    int need = int_rank_of_value(v);
+    if (need > int_rank(result->typeInfo)) {
+        PolynomialError err = poly_promote(result, int_rank_type(need));
+        if (err != POLYNOMIAL_OK) return err;
+    }
+    int_store_raw(result->coefficients[0], int_rank(result->typeInfo), i, v);
+    return POLYNOMIAL_OK;
+}
+
+// Overflow is tested once per block of sums: a sum overflowed when its sign
+// differs from both operands', which the branch-free loop collects. Blocks
+// have a fixed length so the loop vectorizes, and are staged on the stack
+// so r may alias an input. Returns how many coefficients were written: all
+// of them, or the start of the first block that overflowed.
+#define POLY_ADD_CHECK_BLOCK 256
+static int int_add_checked(const int* a, int na, const int* b, int nb, int* r) {
+    int common = na < nb ? na : nb;
+    int sums[POLY_ADD_CHECK_BLOCK];
+    int base = 0;
+    for (; base < common; base += POLY_ADD_CHECK_BLOCK) {
+        const int* x = a + base;
+        const int* y = b + base;
+        int signs = 0;
+        if (common - base >= POLY_ADD_CHECK_BLOCK) {
+            for (int i = 0; i < POLY_ADD_CHECK_BLOCK; i++) {
+                sums[i] = int_k_add(x[i], y[i]);
+                signs |= (x[i] ^ sums[i]) & (y[i] ^ sums[i]);
+            }
+        } else {
+            for (int i = 0; i < common - base; i++) {
+                sums[i] = int_k_add(x[i], y[i]);
+                signs |= (x[i] ^ sums[i]) & (y[i] ^ sums[i]);
+            }
+        }
+        if (signs < 0) return base;
+        int len = common - base < POLY_ADD_CHECK_BLOCK ? common - base : POLY_ADD_CHECK_BLOCK;
+        memmove(r + base, sums, len * sizeof(int));
+    }
+    for (int i = common; i < na; i++) r[i] = a[i];
+    for (int i = common; i < nb; i++) r[i] = b[i];
+    return na > nb ? na : nb;
+}
+
+static PolynomialError int_poly_add(const Polynomial* a, const Polynomial* b, Polynomial* result) {
+    int na = a->degree + 1;
+    int nb = b->degree + 1;
+    int n = na > nb ? na : nb;
+    int done = 0;
+    if (int_rank(a->typeInfo) == 1 && int_rank(b->typeInfo) == 1 && int_rank(result->typeInfo) == 1) {
+        done = int_add_checked(POLY_COEFFS(a, const int), na, POLY_COEFFS(b, const int), nb, POLY_COEFFS(result, int));
+    }
+
+    // The rest one coefficient at a time. Earlier coefficients are final and
+    // later ones untouched, so this holds when result aliases an input, whose
+    // type then changes along with result's.
+    for (int i = done; i < n; i++) {
+        Int128 x = i < na ? int_load_raw(a->coefficients[0], int_rank(a->typeInfo), i) : 0;
+        Int128 y = i < nb ? int_load_raw(b->coefficients[0], int_rank(b->typeInfo), i) : 0;
+        Int128 sum;
+        if (__builtin_add_overflow(x, y, &sum)) return POLYNOMIAL_CALC_ERROR;
+        PolynomialError err = int_store_promoting(result, i, sum);
+        if (err != POLYNOMIAL_OK) return err;
+    }
+    return POLYNOMIAL_OK;
+}
+
+// Coefficients of p as an array of the given rank; *owned says whether it was allocated
+static const void* int_widen(const Polynomial* p, int rank, int* owned) {
+    int from = int_rank(p->typeInfo);
+    *owned = from != rank;
+    if (!*owned) return p->coefficients[0];
+    void* data = poly_mem_alloc((p->degree + 1) * int_rank_type(rank)->size);
+    if (!data) return NULL;
+    for (int i = 0; i <= p->degree; i++) int_store_raw(data, rank, i, int_load_raw(p->coefficients[0], from, i));
+    return data;
+}
+
+// Schoolbook int128 product for inputs whose bound exceeds 127 bits: the
+// exact result may still fit, so each step is checked
+static PolynomialError int128_mullow_checked(const Int128* a, int na, const Int128* b, int nb, Int128* out, int nout) {
+    memset(out, 0, nout * sizeof(Int128));
+    int rowsPerCheck = 1 + POLY_JOB_CHECK_WORK / (nb > 0 ? nb : 1);
+    for (int i = 0; i < na && i < nout; i++) {
+        if (i % rowsPerCheck == 0 && poly_job_checkpoint(i, na)) return POLYNOMIAL_CANCELLED;
+        int overflow = 0;
+        for (int j = 0; j < nb && i + j < nout; j++) {
+            Int128 term;
+            overflow |= __builtin_mul_overflow(a[i], b[j], &term);
+            overflow |= __builtin_add_overflow(out[i + j], term, &out[i + j]);
+        }
+        if (overflow) return POLYNOMIAL_CALC_ERROR;
+    }
+    return POLYNOMIAL_OK;
+}
+
+// The rank a * b is computed in: max|a| max|b| min(na, nb) bounds every
+// product coefficient, which picks the narrowest width the whole product
+// can be computed in. *checked is set when even int128 may overflow.
+static int int_product_rank(const Polynomial* a, const Polynomial* b, int* checked) {
+    int ra = int_rank(a->typeInfo), rb = int_rank(b->typeInfo);
+    int na = a->degree + 1, nb = b->degree + 1;
+    PolyUInt128 bound = 0;
+    int shorter = na < nb ? na : nb;
+    *checked = __builtin_mul_overflow(int_magnitude(a->coefficients[0], ra, na),
+                                      int_magnitude(b->coefficients[0], rb, nb), &bound) ||
+               __builtin_mul_overflow(bound, (PolyUInt128)shorter, &bound) ||
+               bound > (((PolyUInt128)1 << 127) - 1);
+    int work = *checked || bound > INT64_MAX ? 3 : bound > INT_MAX ? 2 : 1;
+    if (ra > work) work = ra;
+    if (rb > work) work = rb;
+    return work;
+}
+
+// What int_poly_multiply allocates at once: the operands widened to the
+// working rank, the product at that rank when result is narrower, result
+// widened to hold it, and the scratch of the product itself
+static size_t int_multiply_bytes(const Polynomial* a, const Polynomial* b, const Polynomial* result,
+                                 int work, int checked) {
+    int ra = int_rank(a->typeInfo), rb = int_rank(b->typeInfo), rr = int_rank(result->typeInfo);
+    int na = a->degree + 1, nb = b->degree + 1, nout = result->degree + 1;
+    if (work == 1 && rr == 1) return poly_mullow_raw_bytes(GetIntTypeInfo(), na, nb, nout, 1);
+
+    size_t size = int_rank_type(work)->size;
+    int direct = work == 2 && ra == 1 && rb == 1;
+    size_t bytes = 0;
+    if (!direct && ra != work) bytes += (size_t)na * size;
+    if (!direct && rb != work) bytes += (size_t)nb * size;
+    if (work != rr) bytes += (size_t)nout * size + poly_buffer_bytes(size, nout);
+    if (direct) bytes += poly_convolve_bytes(nb, nout, sizeof(int));
+    else if (!checked) bytes += poly_mullow_raw_bytes(int_rank_type(work), na, nb, nout, 1);
+    return bytes;
+}
+
+// result must not alias a or b
+static PolynomialError int_poly_multiply(const Polynomial* a, const Polynomial* b, Polynomial* result) {
+    int ra = int_rank(a->typeInfo), rb = int_rank(b->typeInfo), rr = int_rank(result->typeInfo);
+    int na = a->degree + 1, nb = b->degree + 1, nout = result->degree + 1;
+
+    int checked;
+    int work = int_product_rank(a, b, &checked);
+    PolynomialError err = poly_mem_check(int_multiply_bytes(a, b, result, work, checked));
+    if (err != POLYNOMIAL_OK) return err;
+
+    if (work == 1 && rr == 1) {
+        return poly_mullow_raw(GetIntTypeInfo(), a->coefficients[0], na, b->coefficients[0], nb,
+                               result->coefficients[0], nout);
+    }
+
+    // int operands with a 64-bit product accumulate it directly, unwidened
+    int direct = work == 2 && ra == 1 && rb == 1;
+    int ownA = 0, ownB = 0;
+    const void* wa = direct ? a->coefficients[0] : int_widen(a, work, &ownA);
+    const void* wb = direct ? b->coefficients[0] : int_widen(b, work, &ownB);
+    void* out = work == rr ? result->coefficients[0] : poly_mem_alloc(nout * int_rank_type(work)->size);
+    err = POLYNOMIAL_MEM_ALLOC_FAIL;
+    if (wa && wb && out) {
+        if (checked) {
+            err = int128_mullow_checked(wa, na, wb, nb, out, nout);
+        } else if (direct) {
+            poly_convolve_int_wide(out, nout, wa, na, wb, nb);
+            err = poly_job_cancelled() ? POLYNOMIAL_CANCELLED : POLYNOMIAL_OK;
+        } else {
+            err = poly_mullow_raw(int_rank_type(work), wa, na, wb, nb, out, nout);
+        }
+    }
+
+    // a product computed wider than result is stored at the width it needs
+    if (err == POLYNOMIAL_OK && out != result->coefficients[0]) {
+        Int128 lo, hi;
+        int_range(out, work, nout, &lo, &hi);
+        int final = int_rank_of_value(lo) > int_rank_of_value(hi) ? int_rank_of_value(lo) : int_rank_of_value(hi);
+        if (final < rr) final = rr;
+        err = poly_promote(result, int_rank_type(final));
+        for (int i = 0; err == POLYNOMIAL_OK && i < nout; i++) {
+            int_store_raw(result->coefficients[0], final, i, int_load_raw(out, work, i));
+        }
+    }
+
+    if (ownA) poly_mem_free((void*)wa);
+    if (ownB) poly_mem_free((void*)wb);
+    if (out != result->coefficients[0]) poly_mem_free(out);
+    return err;
+}
+
+static PolynomialError int_poly_scale(const Polynomial* poly, const void* scalar, Polynomial* result) {
+    int rp = int_rank(poly->typeInfo);
+    int n = poly->degree + 1;
+    Int128 s = int_load_raw(scalar, rp, 0);
+
+    PolyUInt128 bound;
+    PolyUInt128 magnitude = s < 0 ? (PolyUInt128)0 - (PolyUInt128)s : (PolyUInt128)s;
+    if (rp == 1 && int_rank(result->typeInfo) == 1 &&
+        !__builtin_mul_overflow(int_magnitude(poly->coefficients[0], 1, n), magnitude, &bound) && bound <= INT_MAX) {
+        int_kernel_scale(POLY_COEFFS(poly, const int), n, (int)s, POLY_COEFFS(result, int));
+    } else {
+        // element by element as in int_poly_add, so result may alias poly
+        for (int i = 0; i < n; i++) {
+            Int128 product;
+            if (__builtin_mul_overflow(int_load_raw(poly->coefficients[0], int_rank(poly->typeInfo), i), s, &product))
+                return POLYNOMIAL_CALC_ERROR;
+            PolynomialError err = int_store_promoting(result, i, product);
+            if (err != POLYNOMIAL_OK) return err;
+        }
+    }
+
+    size_t size = result->typeInfo->size;
+    memset((char*)result->coefficients[0] + n * size, 0, (result->degree + 1 - n) * size);
+    return POLYNOMIAL_OK;
+}
+
+static PolynomialError poly_add_untraced(const Polynomial* a, const Polynomial* b, Polynomial* result) {
     if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
-    if (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo) 
-        return POLYNOMIAL_TYPE_MISMATCH;
-    
     int max_degree = a->degree > b->degree ? a->degree : b->degree;
+    int integers = int_family(a, b, result);
+    if (!integers && (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo))
+        return POLYNOMIAL_TYPE_MISMATCH;
     if (result->degree < max_degree) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(result);
+    if (unique != POLYNOMIAL_OK) return unique;
+    if (integers) return int_poly_add(a, b, result);
+
+    switch (poly_kernel_type(a->typeInfo)) {
+#define POLY_ADD_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_add(POLY_COEFFS(a, const T), a->degree + 1, \
+                          POLY_COEFFS(b, const T), b->degree + 1, POLY_COEFFS(result, T)); \
+        return POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_ADD_CASE)
+#undef POLY_ADD_CASE
+    default:
+        break;
+    }
     
     for (int i = 0; i <= max_degree; i++) {
         if (i <= a->degree && i <= b->degree) {
             a->typeInfo->add(a->coefficients[i], b->coefficients[i], result->coefficients[i]);
         }
         else if (i <= a->degree) {
-            memcpy(result->coefficients[i], a->coefficients[i], a->typeInfo->size);
+            if (result != a) memcpy(result->coefficients[i], a->coefficients[i], a->typeInfo->size);
         }
         else {
-            memcpy(result->coefficients[i], b->coefficients[i], b->typeInfo->size);
+            if (result != b) memcpy(result->coefficients[i], b->coefficients[i], b->typeInfo->size);
         }
     }
     return POLYNOMIAL_OK;
 }
 
-PolynomialError poly_multiply(const Polynomial* a, const Polynomial* b, Polynomial* result) {
+// Each traced operation is its untraced body inside a trace span and a
+// memory scope
+PolynomialError poly_add(const Polynomial* a, const Polynomial* b, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_ADD, a ? a->typeInfo : NULL);
+    PolynomialError err = poly_add_untraced(a, b, result);
+    poly_trace_end(&span, POLY_TRACE_ADD, a, b, b ? b->degree : -1, 0, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
+PolynomialError poly_mullow_raw(const TypeInfo* typeInfo, const void* a, int na,
+                                const void* b, int nb, void* out, int nout) {
+    PolyKernelType type = poly_kernel_type(typeInfo);
+    int shorter = na < nb ? na : nb;
+    // under a memory budget the transforms' scratch may not fit, where the
+    // direct kernels below need next to none
+    if (shorter >= POLY_FFT_THRESHOLD && nout >= POLY_FFT_THRESHOLD) {
+        if (type == POLY_KERNEL_complex && poly_mem_fits(poly_fft_mullow_bytes(na, nb, nout)))
+            return poly_fft_mullow_complex(a, na, b, nb, out, nout);
+        // products longer than the largest NTT fall through to the direct kernel
+        if (type == POLY_KERNEL_modint && poly_mem_fits(poly_ntt_mullow_bytes(na, nb, nout))) {
+            PolynomialError err = poly_ntt_mullow_modint(a, na, b, nb, out, nout);
+            if (err == POLYNOMIAL_OK || err == POLYNOMIAL_CANCELLED) return err;
+        }
+    }
+
+    // the tiled kernels, where one exists and the operands are long enough
+    if (shorter >= POLY_CONVOLVE_MIN) {
+        if (type == POLY_KERNEL_int) poly_convolve_int(out, nout, a, na, b, nb);
+        else if (type == POLY_KERNEL_int64) poly_convolve_int64(out, nout, a, na, b, nb);
+        else if (type == POLY_KERNEL_complex) poly_convolve_complex(out, nout, a, na, b, nb);
+        if (type == POLY_KERNEL_int || type == POLY_KERNEL_int64 || type == POLY_KERNEL_complex) {
+            return poly_job_cancelled() ? POLYNOMIAL_CANCELLED : POLYNOMIAL_OK;
+        }
+    }
+
+    switch (type) {
+#define POLY_MULLOW_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_mullow(out, nout, a, na, b, nb); \
+        return poly_job_cancelled() ? POLYNOMIAL_CANCELLED : POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_MULLOW_CASE)
+#undef POLY_MULLOW_CASE
+    default:
+        break;
+    }
+
+    size_t size = typeInfo->size;
+    void* term = poly_mem_alloc(size);
+    void* sum = poly_mem_alloc(size);
+    if (!term || !sum) {
+        poly_mem_free(term);
+        poly_mem_free(sum);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    memset(out, 0, nout * size);
+    int rowsPerCheck = 1 + POLY_JOB_CHECK_WORK / (nb > 0 ? nb : 1);
+    for (int i = 0; i < na && i < nout; i++) {
+        if (i % rowsPerCheck == 0 && poly_job_checkpoint(i, na)) break;
+        for (int j = 0; j < nb && i + j < nout; j++) {
+            char* cell = (char*)out + (i + j) * size;
+            typeInfo->multiply((const char*)a + i * size, (const char*)b + j * size, term);
+            typeInfo->add(cell, term, sum);
+            memcpy(cell, sum, size);
+        }
+    }
+
+    poly_mem_free(term);
+    poly_mem_free(sum);
+    return poly_job_cancelled() ? POLYNOMIAL_CANCELLED : POLYNOMIAL_OK;
+}
+
+size_t poly_mullow_raw_bytes(const TypeInfo* typeInfo, int na, int nb, int nout, int transform) {
+    PolyKernelType type = poly_kernel_type(typeInfo);
+    int shorter = na < nb ? na : nb;
+    size_t direct = type == POLY_KERNEL_GENERIC ? 2 * typeInfo->size : 0;
+    if (shorter >= POLY_CONVOLVE_MIN &&
+        (type == POLY_KERNEL_int || type == POLY_KERNEL_int64 || type == POLY_KERNEL_complex)) {
+        direct = poly_convolve_bytes(nb, nout, typeInfo->size);
+    }
+    if (!transform || shorter < POLY_FFT_THRESHOLD || nout < POLY_FFT_THRESHOLD) return direct;
+    if (type == POLY_KERNEL_complex) return poly_fft_mullow_bytes(na, nb, nout);
+    if (type == POLY_KERNEL_modint) return poly_ntt_mullow_bytes(na, nb, nout);
+    return direct;
+}
+
+PolynomialError poly_axpy_raw(const TypeInfo* typeInfo, void* r, const void* x, int n, const void* s) {
+    switch (poly_kernel_type(typeInfo)) {
+#define POLY_AXPY_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_axpy(r, x, n, *(const T*)s); \
+        return POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_AXPY_CASE)
+#undef POLY_AXPY_CASE
+    default:
+        break;
+    }
+
+    size_t size = typeInfo->size;
+    void* term = poly_mem_alloc(size);
+    void* sum = poly_mem_alloc(size);
+    if (!term || !sum) {
+        poly_mem_free(term);
+        poly_mem_free(sum);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        char* cell = (char*)r + i * size;
+        typeInfo->multiplyScalar((const char*)x + i * size, s, term);
+        typeInfo->add(cell, term, sum);
+        memcpy(cell, sum, size);
+    }
+
+    poly_mem_free(term);
+    poly_mem_free(sum);
+    return POLYNOMIAL_OK;
+}
+
+void poly_add_raw(const TypeInfo* typeInfo, void* r, const void* x, int n) {
+    switch (poly_kernel_type(typeInfo)) {
+#define POLY_ADD_RAW_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_add(r, n, x, n, r); \
+        return;
+    POLY_BUILTIN_TYPES(POLY_ADD_RAW_CASE)
+#undef POLY_ADD_RAW_CASE
+    default:
+        break;
+    }
+
+    for (int i = 0; i < n; i++) {
+        char* cell = (char*)r + i * typeInfo->size;
+        typeInfo->add(cell, (const char*)x + i * typeInfo->size, cell);
+    }
+}
+
+PolynomialError poly_one_raw(const TypeInfo* typeInfo, void* out) {
+    switch (poly_kernel_type(typeInfo)) {
+#define POLY_ONE_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        *(T*)out = NAME##_k_one(); \
+        return POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_ONE_CASE)
+#undef POLY_ONE_CASE
+    default:
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+}
+
+static PolynomialError poly_multiply_untraced(const Polynomial* a, const Polynomial* b, Polynomial* result) {
     if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
-    if (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo)
+    int integers = int_family(a, b, result);
+    if (!integers && (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo))
         return POLYNOMIAL_TYPE_MISMATCH;
     if (result->degree < a->degree + b->degree)
         return POLYNOMIAL_INVALID_DEGREE;
-    
-    for (int i = 0; i <= result->degree; i++) {
-        memset(result->coefficients[i], 0, result->typeInfo->size);
+    PolynomialError unique = poly_make_unique(result);
+    if (unique != POLYNOMIAL_OK) return unique;
+
+    // the product is written while the inputs are read, so it must not alias them
+    if (result == a || result == b) {
+        PolynomialError err;
+        Polynomial* product = poly_create(result->typeInfo, result->degree, &err);
+        if (!product) return err;
+        err = poly_multiply(a, b, product);
+        // an integer product may have been promoted past result's width
+        if (err == POLYNOMIAL_OK && product->typeInfo != result->typeInfo) err = poly_promote(result, product->typeInfo);
+        if (err == POLYNOMIAL_OK) err = poly_copy_coeffs(product, result);
+        poly_free(product);
+        return err;
     }
-    
+
+    if (integers) return int_poly_multiply(a, b, result);
+    PolynomialError err = poly_mem_check(poly_mullow_raw_bytes(a->typeInfo, a->degree + 1, b->degree + 1,
+                                                               result->degree + 1, 0));
+    if (err != POLYNOMIAL_OK) return err;
+    return poly_mullow_raw(a->typeInfo, a->coefficients[0], a->degree + 1,
+                           b->coefficients[0], b->degree + 1,
+                           result->coefficients[0], result->degree + 1);
+}
+
+size_t poly_multiply_peak_bytes(const Polynomial* a, const Polynomial* b, const Polynomial* result) {
+    if (!a || !b || !result) return 0;
+    int nout = result->degree + 1;
+    size_t unique = poly_unique_bytes(result);
+
+    size_t product;
+    if (int_family(a, b, result)) {
+        int checked;
+        int work = int_product_rank(a, b, &checked);
+        product = int_multiply_bytes(a, b, result, work, checked);
+    } else {
+        product = poly_mullow_raw_bytes(a->typeInfo, a->degree + 1, b->degree + 1, nout, 1);
+    }
+    if (result != a && result != b) return unique + product;
+
+    // an aliased result is computed into a new polynomial, which result is
+    // then widened to hold
+    size_t promote = int_family(a, b, result) ? poly_buffer_bytes(sizeof(Int128), nout) : 0;
+    return unique + sizeof(Polynomial) + poly_buffer_bytes(result->typeInfo->size, nout) +
+           (product > promote ? product : promote);
+}
+
+PolynomialError poly_multiply(const Polynomial* a, const Polynomial* b, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIPLY, a ? a->typeInfo : NULL);
+    PolynomialError err = poly_multiply_untraced(a, b, result);
+    poly_trace_end(&span, POLY_TRACE_MULTIPLY, a, b, b ? b->degree : -1, 0, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
+// Scaling by one into a result of the same type and degree shares poly's
+// storage instead of copying it
+static int poly_share_if_identity(const Polynomial* poly, const void* scalar, Polynomial* result) {
+    if (!poly->buffer || !result->buffer || poly->typeInfo != result->typeInfo || poly->degree != result->degree)
+        return 0;
+    Int128 one;
+    if (poly_one_raw(poly->typeInfo, &one) != POLYNOMIAL_OK || memcmp(&one, scalar, poly->typeInfo->size) != 0)
+        return 0;
+    if (result->buffer != poly->buffer) {
+        __atomic_add_fetch(&poly->buffer->refs, 1, __ATOMIC_RELAXED);
+        poly_buffer_release(result->buffer);
+        result->buffer = poly->buffer;
+    }
+    result->coefficients = poly->coefficients;
+    return 1;
+}
+
+static PolynomialError poly_scalar_multiply_untraced(const Polynomial* poly, const void* scalar, Polynomial* result) {
+    if (!poly || !scalar || !result) return POLYNOMIAL_NULL_PTR;
+    if (poly_share_if_identity(poly, scalar, result)) return POLYNOMIAL_OK;
+    int integers = int_family(poly, poly, result);
+    if (!integers && poly->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (result->degree < poly->degree) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(result);
+    if (unique != POLYNOMIAL_OK) return unique;
+    if (integers) return int_poly_scale(poly, scalar, result);
+
+    size_t size = poly->typeInfo->size;
+    void* s = poly_mem_alloc(size);
+    void* term = poly_mem_alloc(size);
+    if (!s || !term) {
+        poly_mem_free(s);
+        poly_mem_free(term);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+    // scalar may point into result, copy it before the first write
+    memcpy(s, scalar, size);
+
+    switch (poly_kernel_type(poly->typeInfo)) {
+#define POLY_SCALE_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_scale(POLY_COEFFS(poly, const T), poly->degree + 1, *(const T*)s, \
+                            POLY_COEFFS(result, T)); \
+        break;
+    POLY_BUILTIN_TYPES(POLY_SCALE_CASE)
+#undef POLY_SCALE_CASE
+    default:
+        for (int i = 0; i <= poly->degree; i++) {
+            poly->typeInfo->multiplyScalar(poly->coefficients[i], s, term);
+            memcpy(result->coefficients[i], term, size);
+        }
+        break;
+    }
+
+    memset((char*)result->coefficients[0] + (poly->degree + 1) * size, 0, (result->degree - poly->degree) * size);
+
+    poly_mem_free(s);
+    poly_mem_free(term);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_scalar_multiply(const Polynomial* poly, const void* scalar, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_SCALAR_MULTIPLY, poly ? poly->typeInfo : NULL);
+    PolynomialError err = poly_scalar_multiply_untraced(poly, scalar, result);
+    poly_trace_end(&span, POLY_TRACE_SCALAR_MULTIPLY, poly, NULL, -1, 0, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
+PolynomialError poly_add_inplace(Polynomial* acc, const Polynomial* b) {
+    return poly_add(acc, b, acc);
+}
+
+PolynomialError poly_scale_inplace(Polynomial* poly, const void* scalar) {
+    return poly_scalar_multiply(poly, scalar, poly);
+}
+
+static PolynomialError poly_fma_untraced(Polynomial* acc, const Polynomial* a, const Polynomial* b) {
+    if (!acc || !a || !b) return POLYNOMIAL_NULL_PTR;
+    if (a->typeInfo != b->typeInfo || a->typeInfo != acc->typeInfo)
+        return POLYNOMIAL_TYPE_MISMATCH;
+    if (acc->degree < a->degree + b->degree)
+        return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(acc);
+    if (unique != POLYNOMIAL_OK) return unique;
+
+    // acc is updated while a and b are still being read, snapshot aliased inputs
+    Polynomial* snapshot = NULL;
+    if (acc == a || acc == b) {
+        PolynomialError err;
+        snapshot = poly_clone(acc, &err);
+        if (!snapshot) return err;
+        // a clone shares acc's buffer until one of them is written
+        err = poly_make_unique(snapshot);
+        if (err != POLYNOMIAL_OK) {
+            poly_free(snapshot);
+            return err;
+        }
+        if (acc == a) a = snapshot;
+        if (acc == b) b = snapshot;
+    }
+
+    switch (poly_kernel_type(acc->typeInfo)) {
+#define POLY_FMA_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_fma(POLY_COEFFS(acc, T), POLY_COEFFS(a, const T), a->degree + 1, \
+                          POLY_COEFFS(b, const T), b->degree + 1); \
+        poly_free(snapshot); \
+        return POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_FMA_CASE)
+#undef POLY_FMA_CASE
+    default:
+        break;
+    }
+
+    size_t size = acc->typeInfo->size;
+    void* term = poly_mem_alloc(size);
+    void* sum = poly_mem_alloc(size);
+    if (!term || !sum) {
+        poly_mem_free(term);
+        poly_mem_free(sum);
+        poly_free(snapshot);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
     for (int i = 0; i <= a->degree; i++) {
         for (int j = 0; j <= b->degree; j++) {
-            void* temp = malloc(result->typeInfo->size);
-            if (!temp) return POLYNOMIAL_MEM_ALLOC_FAIL;
-            
-            a->typeInfo->multiply(a->coefficients[i], b->coefficients[j], temp);
-            
-            void* sum = malloc(result->typeInfo->size);
-            if (!sum) {
-                free(temp);
-                return POLYNOMIAL_MEM_ALLOC_FAIL;
-            }
-            
-            a->typeInfo->add(result->coefficients[i+j], temp, sum);
-            memcpy(result->coefficients[i+j], sum, result->typeInfo->size);
-            
-            free(temp);
-            free(sum);
+            a->typeInfo->multiply(a->coefficients[i], b->coefficients[j], term);
+            a->typeInfo->add(acc->coefficients[i+j], term, sum);
+            memcpy(acc->coefficients[i+j], sum, size);
         }
     }
+
+    poly_mem_free(term);
+    poly_mem_free(sum);
+    poly_free(snapshot);
     return POLYNOMIAL_OK;
 }
 
-PolynomialError poly_scalar_multiply(const Polynomial* poly, const void* scalar, Polynomial* result) {
+PolynomialError poly_fma(Polynomial* acc, const Polynomial* a, const Polynomial* b) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolynomialError err = poly_fma_untraced(acc, a, b);
+    poly_trace_end(&span, POLY_TRACE_FMA, a, b, b ? b->degree : -1, 0, err);
+    return err;
+}
+
+PolynomialError poly_linear_combination(Polynomial* out, const Polynomial* const* polys, const void* scalars, int k) {
+    if (!out || (k > 0 && (!polys || !scalars))) return POLYNOMIAL_NULL_PTR;
+    if (k < 0) return POLYNOMIAL_INVALID_INPUT;
+
+    int max_degree = 0;
+    for (int p = 0; p < k; p++) {
+        if (!polys[p]) return POLYNOMIAL_NULL_PTR;
+        if (polys[p]->typeInfo != out->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+        if (polys[p]->degree > max_degree) max_degree = polys[p]->degree;
+    }
+    if (out->degree < max_degree) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(out);
+    if (unique != POLYNOMIAL_OK) return unique;
+
+    size_t size = out->typeInfo->size;
+    // scalars may live inside out, so they are copied up front
+    char* s = poly_mem_alloc(k * size + 3 * size);
+    if (!s) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    if (k > 0) memcpy(s, scalars, k * size);
+    void* acc = s + k * size;
+    void* term = s + (k + 1) * size;
+    void* sum = s + (k + 2) * size;
+
+    switch (poly_kernel_type(out->typeInfo)) {
+#define POLY_LINCOMB_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_lincomb(POLY_COEFFS(out, T), out->degree + 1, polys, (const T*)s, k); \
+        poly_mem_free(s); \
+        return POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_LINCOMB_CASE)
+#undef POLY_LINCOMB_CASE
+    default:
+        break;
+    }
+
+    // coefficient-major order: every input at index i is read before out[i] is written
+    for (int i = 0; i <= out->degree; i++) {
+        memset(acc, 0, size);
+        for (int p = 0; p < k && i <= max_degree; p++) {
+            if (i > polys[p]->degree) continue;
+            out->typeInfo->multiplyScalar(polys[p]->coefficients[i], s + p * size, term);
+            out->typeInfo->add(acc, term, sum);
+            memcpy(acc, sum, size);
+        }
+        memcpy(out->coefficients[i], acc, size);
+    }
+
+    poly_mem_free(s);
+    return POLYNOMIAL_OK;
+}
+
+// out = v * x for a non-negative integer v, by doubling with the add callback
+static PolynomialError poly_times_int_generic(const TypeInfo* typeInfo, const void* x, int v, void* out) {
+    size_t size = typeInfo->size;
+    char* scratch = poly_mem_alloc(2 * size);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* doubling = scratch;
+    char* sum = scratch + size;
+
+    memcpy(doubling, x, size);
+    memset(out, 0, size);
+    while (v > 0) {
+        if (v & 1) {
+            typeInfo->add(out, doubling, sum);
+            memcpy(out, sum, size);
+        }
+        v >>= 1;
+        if (v) {
+            typeInfo->add(doubling, doubling, sum);
+            memcpy(doubling, sum, size);
+        }
+    }
+
+    poly_mem_free(scratch);
+    return POLYNOMIAL_OK;
+}
+
+static PolynomialError poly_derivative_untraced(const Polynomial* poly, Polynomial* result) {
     if (!poly || !result) return POLYNOMIAL_NULL_PTR;
     if (poly->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
-    if (result->degree < poly->degree) return POLYNOMIAL_INVALID_DEGREE;
+    if (result->degree < poly->degree - 1) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(result);
+    if (unique != POLYNOMIAL_OK) return unique;
+
+    size_t size = poly->typeInfo->size;
+    int n = poly->degree;
 
-    for (int i = 0; i <= poly->degree; i++) {
-        poly->typeInfo->multiplyScalar(poly->coefficients[i], scalar, result->coefficients[i]);
+    switch (poly_kernel_type(poly->typeInfo)) {
+#define POLY_DERIVATIVE_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_derivative(POLY_COEFFS(poly, const T), n + 1, POLY_COEFFS(result, T)); \
+        break;
+    POLY_BUILTIN_TYPES(POLY_DERIVATIVE_CASE)
+#undef POLY_DERIVATIVE_CASE
+    default:
+        for (int i = 1; i <= n; i++) {
+            PolynomialError err = poly_times_int_generic(poly->typeInfo, poly->coefficients[i], i,
+                                                         result->coefficients[i - 1]);
+            if (err != POLYNOMIAL_OK) return err;
+        }
+        break;
     }
 
-    for (int i = poly->degree + 1; i <= result->degree; i++) {
-        memset(result->coefficients[i], 0, result->typeInfo->size);
+    // a constant differentiates to zero, which still occupies coefficient 0
+    int written = n > 0 ? n : 0;
+    memset((char*)result->coefficients[0] + written * size, 0, (result->degree + 1 - written) * size);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_derivative(const Polynomial* poly, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_DERIVATIVE, poly ? poly->typeInfo : NULL);
+    PolynomialError err = poly_derivative_untraced(poly, result);
+    poly_trace_end(&span, POLY_TRACE_DERIVATIVE, poly, NULL, -1, 0, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
+PolynomialError poly_deflate(const Polynomial* poly, const void* root, Polynomial* quotient, void* remainder) {
+    if (!poly || !root || !quotient) return POLYNOMIAL_NULL_PTR;
+    if (poly->typeInfo != quotient->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (quotient->degree < poly->degree - 1) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(quotient);
+    if (unique != POLYNOMIAL_OK) return unique;
+
+    const TypeInfo* ti = poly->typeInfo;
+    size_t size = ti->size;
+    int n = poly->degree;
+
+    // the root and the leading coefficient may live inside quotient
+    char* scratch = poly_mem_alloc(4 * size);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* r = scratch;
+    char* acc = scratch + size;
+    char* term = scratch + 2 * size;
+    char* ci = scratch + 3 * size;
+    memcpy(r, root, size);
+
+    switch (poly_kernel_type(ti)) {
+#define POLY_DEFLATE_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        *(T*)acc = NAME##_kernel_deflate(POLY_COEFFS(poly, const T), n + 1, *(const T*)r, \
+                                         POLY_COEFFS(quotient, T)); \
+        break;
+    POLY_BUILTIN_TYPES(POLY_DEFLATE_CASE)
+#undef POLY_DEFLATE_CASE
+    default:
+        memcpy(acc, poly->coefficients[n], size);
+        for (int i = n - 1; i >= 0; i--) {
+            memcpy(ci, poly->coefficients[i], size);
+            memcpy(quotient->coefficients[i], acc, size);
+            ti->multiply(r, acc, term);
+            ti->add(ci, term, acc);
+        }
+        break;
     }
 
+    int written = n > 0 ? n : 0;
+    memset((char*)quotient->coefficients[0] + written * size, 0, (quotient->degree + 1 - written) * size);
+    if (remainder) memcpy(remainder, acc, size);
+    poly_mem_free(scratch);
     return POLYNOMIAL_OK;
 }
 
+// Picks the evaluator for poly_evaluate from the measured crossovers in
+// bench_evaluation_schemes
+static PolyEvalScheme poly_auto_eval_scheme(PolyKernelType type, int degree) {
+    int split = type == POLY_KERNEL_complex ? POLY_EVAL_SPLIT_MIN_DEGREE_COMPLEX : POLY_EVAL_SPLIT_MIN_DEGREE;
+    if (type == POLY_KERNEL_GENERIC || degree < POLY_EVAL_ESTRIN_MIN_DEGREE) return POLY_EVAL_HORNER;
+    if (degree < split) return POLY_EVAL_ESTRIN;
+    return POLY_EVAL_SPLIT_HORNER;
+}
+
 PolynomialError poly_evaluate(const Polynomial* poly, const void* x, void* result) {
+    return poly_evaluate_scheme(poly, x, result, POLY_EVAL_AUTO);
+}
+
+static PolynomialError poly_evaluate_scheme_untraced(const Polynomial* poly, const void* x, void* result, PolyEvalScheme scheme) {
     if (!poly || !x || !result) return POLYNOMIAL_NULL_PTR;
 
-    memset(result, 0, poly->typeInfo->size);
+    PolyKernelType type = poly_kernel_type(poly->typeInfo);
+    if (scheme == POLY_EVAL_AUTO) scheme = poly_auto_eval_scheme(type, poly->degree);
 
-    void* x_power = malloc(poly->typeInfo->size);
-    void* term = malloc(poly->typeInfo->size);
-    if (!x_power || !term) {
-        free(x_power);
-        free(term);
+    switch (type) {
+#define POLY_EVALUATE_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: { \
+        const T* c = POLY_COEFFS(poly, const T); \
+        int n = poly->degree + 1; \
+        T xv = *(const T*)x; \
+        if (scheme == POLY_EVAL_ESTRIN) *(T*)result = NAME##_kernel_estrin(c, n, xv); \
+        else if (scheme == POLY_EVAL_SPLIT_HORNER) *(T*)result = NAME##_kernel_split_horner(c, n, xv); \
+        else *(T*)result = NAME##_kernel_horner(c, n, xv); \
+        return POLYNOMIAL_OK; \
+    }
+    POLY_BUILTIN_TYPES(POLY_EVALUATE_CASE)
+#undef POLY_EVALUATE_CASE
+    default:
+        break;
+    }
+
+    // Horner's rule through the TypeInfo callbacks
+    size_t size = poly->typeInfo->size;
+    void* acc = poly_mem_alloc(size);
+    void* term = poly_mem_alloc(size);
+    if (!acc || !term) {
+        poly_mem_free(acc);
+        poly_mem_free(term);
         return POLYNOMIAL_MEM_ALLOC_FAIL;
     }
 
-    if (poly->typeInfo == GetIntTypeInfo()) {
-        *(int*)x_power = 1;
-    } else {
-        Complex* cx = (Complex*)x_power;
-        cx->real = 1.0;
-        cx->imag = 0.0;
-    }
-
-    for (int i = 0; i <= poly->degree; i++) {
-        poly->typeInfo->evaluate(poly->coefficients[i], x_power, term);
-        poly->typeInfo->add(result, term, result);
-        
-        if (i < poly->degree) {
-            void* temp = malloc(poly->typeInfo->size);
-            if (!temp) {
-                free(x_power);
-                free(term);
-                return POLYNOMIAL_MEM_ALLOC_FAIL;
-            }
-            poly->typeInfo->multiply(x_power, x, temp);
-            memcpy(x_power, temp, poly->typeInfo->size);
-            free(temp);
-        }
+    memcpy(acc, poly->coefficients[poly->degree], size);
+    for (int i = poly->degree - 1; i >= 0; i--) {
+        poly->typeInfo->multiply(acc, x, term);
+        poly->typeInfo->add(term, poly->coefficients[i], acc);
     }
 
-    free(x_power);
-    free(term);
+    memcpy(result, acc, size);
+    poly_mem_free(acc);
+    poly_mem_free(term);
     return POLYNOMIAL_OK;
 }
 
+PolynomialError poly_evaluate_scheme(const Polynomial* poly, const void* x, void* result, PolyEvalScheme scheme) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_EVALUATE, poly ? poly->typeInfo : NULL);
+    PolynomialError err = poly_evaluate_scheme_untraced(poly, x, result, scheme);
+    poly_trace_end(&span, POLY_TRACE_EVALUATE, poly, NULL, -1, scheme, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
 void poly_print(const Polynomial* poly) {
     if (!poly) {
         printf("Null polynomial\n");
         return;
     }
-    
+    // built-in types go through the buffered formatter, and through the
+    // coefficient callbacks when it fails, e.g. for want of its buffer
+    if (poly_write(poly, stdout, NULL) == POLYNOMIAL_OK) return;
+
     int first = 1;
     for (int i = poly->degree; i >= 0; i--) {
         if (!first) {
@@ -4,22 +4,93 @@
 #include "TypeInfo.h"
 #include "PolynomialDefines.h"
 #include <stdbool.h> 
+#include <stddef.h>
+
+typedef enum {
+    POLY_EVAL_AUTO = 0,
+    POLY_EVAL_HORNER,
+    POLY_EVAL_ESTRIN,
+    POLY_EVAL_SPLIT_HORNER
+} PolyEvalScheme;
+
+// Crossovers for poly_evaluate: Horner below the Estrin degree, Estrin up to
+// the split degree of the coefficient type, split Horner above
+#define POLY_EVAL_ESTRIN_MIN_DEGREE 16
+#define POLY_EVAL_SPLIT_MIN_DEGREE 32
+#define POLY_EVAL_SPLIT_MIN_DEGREE_COMPLEX 48
+
+// Reference-counted coefficient storage, shared copy-on-write between a
+// polynomial and its clones and views
+typedef struct PolyBuffer PolyBuffer;
 
 typedef struct {
     void** coefficients;
     int degree;
-    TypeInfo* typeInfo;
+    const TypeInfo* typeInfo;
+    PolyBuffer* buffer;    // NULL when coefficients is borrowed storage
 } Polynomial;
 
-Polynomial* poly_create(TypeInfo*, int, PolynomialError*);
-Polynomial* poly_create_with_coeffs(TypeInfo*, int, const void*, PolynomialError*);
+Polynomial* poly_create(const TypeInfo*, int, PolynomialError*);
+Polynomial* poly_create_with_coeffs(const TypeInfo*, int, const void*, PolynomialError*);
+// O(1): the copy shares poly's coefficients until either is written
+Polynomial* poly_clone(const Polynomial*, PolynomialError*);
+// O(1) view of coefficients offset..offset + degree of poly as a polynomial
+// of that degree, shared the same way; offset 0 truncates
+Polynomial* poly_view(const Polynomial* poly, int offset, int degree, PolynomialError* err);
 void poly_free(Polynomial*);
+// Every operation that writes a polynomial first gives it storage of its
+// own if it shares any; code that writes coefficients directly must call
+// this first. Polynomials fresh from poly_create are never shared.
+PolynomialError poly_make_unique(Polynomial* poly);
+bool poly_is_shared(const Polynomial* poly);
+// Bytes poly_make_unique would allocate for poly now
+size_t poly_unique_bytes(const Polynomial* poly);
+PolynomialError poly_copy_coeffs(const Polynomial* src, Polynomial* dst);
+
+// Storage behind a set of polynomials: logicalBytes is what they would
+// take with a buffer each, allocatedBytes what their distinct buffers
+// take, so sharing saved the difference
+typedef struct {
+    size_t logicalBytes;
+    size_t allocatedBytes;
+    int polynomials;
+    int buffers;
+} PolyMemoryReport;
+
+// NULL entries are skipped
+PolynomialError poly_memory_report(const Polynomial* const* polys, int count, PolyMemoryReport* report);
+// Integer polynomials of any width may be mixed in poly_add, poly_multiply
+// and poly_scalar_multiply (the scalar has the input's width). Instead of
+// wrapping, these widen result from int to int64 to int128 as the values
+// require; only a value beyond int128 fails, with POLYNOMIAL_CALC_ERROR.
+// Other operations wrap within the coefficient type.
 PolynomialError poly_add(const Polynomial*, const Polynomial*, Polynomial*);
 PolynomialError poly_multiply(const Polynomial*, const Polynomial*, Polynomial*);
 PolynomialError poly_scalar_multiply(const Polynomial*, const void*, Polynomial*);
+PolynomialError poly_add_inplace(Polynomial* acc, const Polynomial* b);
+PolynomialError poly_scale_inplace(Polynomial* poly, const void* scalar);
+PolynomialError poly_fma(Polynomial* acc, const Polynomial* a, const Polynomial* b);
+PolynomialError poly_linear_combination(Polynomial* out, const Polynomial* const* polys, const void* scalars, int k);
+PolynomialError poly_pow(const Polynomial* p, int k, int truncDegree, Polynomial* result);
+PolynomialError poly_compose(const Polynomial* p, const Polynomial* q, Polynomial* result);
+PolynomialError poly_taylor_shift(const Polynomial* p, const void* a, Polynomial* result);
+PolynomialError poly_scale_var(const Polynomial* p, const void* c, Polynomial* result);
+PolynomialError poly_derivative(const Polynomial* poly, Polynomial* result);
+PolynomialError poly_deflate(const Polynomial* poly, const void* root, Polynomial* quotient, void* remainder);
 PolynomialError poly_evaluate(const Polynomial*, const void*, void*);
+// Evaluators other than Horner apply to the built-in types; others always use Horner
+PolynomialError poly_evaluate_scheme(const Polynomial*, const void*, void*, PolyEvalScheme);
 PolynomialError poly_compare(const Polynomial*, const Polynomial*);
 void poly_print(const Polynomial*);
 bool poly_is_equal(const Polynomial* a, const Polynomial* b);
+// Widens the coefficients of an integer polynomial in place to typeInfo
+PolynomialError poly_promote(Polynomial* poly, const TypeInfo* typeInfo);
+// The most poly_multiply, poly_pow and poly_compose allocate at once for
+// these operands, on their fastest path. Under a memory budget they first
+// check what their leanest path needs, failing with
+// POLYNOMIAL_MEM_ALLOC_FAIL before any work when even that would not fit.
+size_t poly_multiply_peak_bytes(const Polynomial* a, const Polynomial* b, const Polynomial* result);
+size_t poly_pow_peak_bytes(const Polynomial* p, int k, int truncDegree, const Polynomial* result);
+size_t poly_compose_peak_bytes(const Polynomial* p, const Polynomial* q, const Polynomial* result);
 
 #endif
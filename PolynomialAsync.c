@@ -0,0 +1,252 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "PolynomialAsync.h"
+#include "PolynomialJob.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "PolynomialRoots.h"
+#include "ThreadPool.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+__thread PolyJob* POLY_CURRENT_JOB = NULL;
+
+#define POLY_JOB_PROGRESS_SCALE 1000000
+
+int poly_job_update(PolyJob* job, long long done, long long total) {
+    double fraction = total > 0 ? (double)done / total : 1.0;
+    int progress = (int)((job->base + job->span * fraction) * POLY_JOB_PROGRESS_SCALE);
+    int old = __atomic_load_n(&job->progress, __ATOMIC_RELAXED);
+    while (progress > old &&
+           !__atomic_compare_exchange_n(&job->progress, &old, progress, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return __atomic_load_n(&job->cancelled, __ATOMIC_RELAXED);
+}
+
+PolyJobPhase poly_job_enter(int index, int count) {
+    PolyJob* job = POLY_CURRENT_JOB;
+    PolyJobPhase saved = {0.0, 1.0};
+    if (!job) return saved;
+    saved.base = job->base;
+    saved.span = job->span;
+    job->base += job->span * index / count;
+    job->span /= count;
+    return saved;
+}
+
+void poly_job_leave(PolyJobPhase saved) {
+    PolyJob* job = POLY_CURRENT_JOB;
+    if (!job) return;
+    poly_job_update(job, 1, 1);
+    job->base = saved.base;
+    job->span = saved.span;
+}
+
+typedef PolynomialError (*PolyFutureBody)(PolyFuture* future);
+
+// Shared by the caller's handle and the pool task, like ParallelJob in
+// ThreadPool.c; whichever lets go last frees it
+struct PolyFuture {
+    PolyJob job;
+    pthread_mutex_t lock;
+    pthread_cond_t ended;
+    int done;
+    int refs;
+    PolynomialError status;
+    PolyFutureBody body;
+    const Polynomial* poly;
+    const Polynomial* other;
+    Polynomial* result;
+    const void* points;
+    void* values;
+    int count;
+    int evaluated;
+    Complex* roots;
+};
+
+static void poly_future_release(PolyFuture* future) {
+    pthread_mutex_lock(&future->lock);
+    int last = --future->refs == 0;
+    pthread_mutex_unlock(&future->lock);
+    if (last) {
+        pthread_mutex_destroy(&future->lock);
+        pthread_cond_destroy(&future->ended);
+        poly_mem_free(future);
+    }
+}
+
+static void poly_future_run(void* arg) {
+    PolyFuture* future = arg;
+    PolynomialError status = POLYNOMIAL_CANCELLED;
+
+    if (!__atomic_load_n(&future->job.cancelled, __ATOMIC_RELAXED)) {
+        PolyJob* outer = POLY_CURRENT_JOB;
+        POLY_CURRENT_JOB = &future->job;
+        status = future->body(future);
+        POLY_CURRENT_JOB = outer;
+    }
+    if (status == POLYNOMIAL_OK) __atomic_store_n(&future->job.progress, POLY_JOB_PROGRESS_SCALE, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&future->lock);
+    future->status = status;
+    future->done = 1;
+    pthread_cond_broadcast(&future->ended);
+    pthread_mutex_unlock(&future->lock);
+    poly_future_release(future);
+}
+
+static PolyFuture* poly_future_start(PolyFutureBody body, PolyFuture* args, PolynomialError* err) {
+    PolyFuture* future = poly_mem_alloc(sizeof(PolyFuture));
+    if (!future) {
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    *future = *args;
+    future->job.cancelled = 0;
+    future->job.progress = 0;
+    future->job.base = 0.0;
+    future->job.span = 1.0;
+    future->done = 0;
+    future->refs = 2;
+    future->status = POLYNOMIAL_OK;
+    future->body = body;
+    future->evaluated = 0;
+    pthread_mutex_init(&future->lock, NULL);
+    pthread_cond_init(&future->ended, NULL);
+
+    PolynomialError status = thread_pool_submit(thread_pool_shared(), poly_future_run, future);
+    if (status != POLYNOMIAL_OK) {
+        pthread_mutex_destroy(&future->lock);
+        pthread_cond_destroy(&future->ended);
+        poly_mem_free(future);
+        if (err) *err = status;
+        return NULL;
+    }
+    if (err) *err = POLYNOMIAL_OK;
+    return future;
+}
+
+static PolynomialError poly_multiply_body(PolyFuture* future) {
+    return poly_multiply(future->poly, future->other, future->result);
+}
+
+PolyFuture* poly_multiply_async(const Polynomial* a, const Polynomial* b, Polynomial* result, PolynomialError* err) {
+    PolynomialError status = POLYNOMIAL_OK;
+    if (!a || !b || !result) status = POLYNOMIAL_NULL_PTR;
+    else if (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo) status = POLYNOMIAL_TYPE_MISMATCH;
+    else if (result->degree < a->degree + b->degree) status = POLYNOMIAL_INVALID_DEGREE;
+    if (status != POLYNOMIAL_OK) {
+        if (err) *err = status;
+        return NULL;
+    }
+
+    PolyFuture args = {0};
+    args.poly = a;
+    args.other = b;
+    args.result = result;
+    return poly_future_start(poly_multiply_body, &args, err);
+}
+
+typedef struct {
+    PolyFuture* future;
+    PolynomialError status;
+} EvaluateMany;
+
+static void poly_evaluate_many_chunk(void* ctx, int begin, int end) {
+    EvaluateMany* many = ctx;
+    PolyFuture* future = many->future;
+    // runs on other pool threads too, which do not have the job attached
+    if (__atomic_load_n(&future->job.cancelled, __ATOMIC_RELAXED)) return;
+
+    size_t size = future->poly->typeInfo->size;
+    for (int i = begin; i < end; i++) {
+        PolynomialError err = poly_evaluate(future->poly, (const char*)future->points + i * size,
+                                            (char*)future->values + i * size);
+        if (err != POLYNOMIAL_OK) __atomic_store_n(&many->status, err, __ATOMIC_RELAXED);
+    }
+    int done = __atomic_add_fetch(&future->evaluated, end - begin, __ATOMIC_RELAXED);
+    poly_job_update(&future->job, done, future->count);
+}
+
+static PolynomialError poly_evaluate_many_body(PolyFuture* future) {
+    EvaluateMany many = {future, POLYNOMIAL_OK};
+    // chunks of roughly POLY_JOB_CHECK_WORK coefficient operations
+    int grain = 1 + POLY_JOB_CHECK_WORK / (future->poly->degree + 1);
+    PolynomialError err = thread_pool_parallel_for(thread_pool_shared(), future->count, grain,
+                                                   poly_evaluate_many_chunk, &many);
+    if (err != POLYNOMIAL_OK) return err;
+    if (poly_job_cancelled()) return POLYNOMIAL_CANCELLED;
+    return many.status;
+}
+
+PolyFuture* poly_evaluate_many_async(const Polynomial* poly, const void* points, int count, void* values,
+                                     PolynomialError* err) {
+    PolynomialError status = POLYNOMIAL_OK;
+    if (!poly || (count > 0 && (!points || !values))) status = POLYNOMIAL_NULL_PTR;
+    else if (count < 0) status = POLYNOMIAL_INVALID_INPUT;
+    if (status != POLYNOMIAL_OK) {
+        if (err) *err = status;
+        return NULL;
+    }
+
+    PolyFuture args = {0};
+    args.poly = poly;
+    args.points = points;
+    args.values = values;
+    args.count = count;
+    return poly_future_start(poly_evaluate_many_body, &args, err);
+}
+
+static PolynomialError poly_roots_body(PolyFuture* future) {
+    return poly_roots(future->poly, future->roots);
+}
+
+PolyFuture* poly_roots_async(const Polynomial* poly, Complex* roots_out, PolynomialError* err) {
+    PolynomialError status = POLYNOMIAL_OK;
+    if (!poly || !roots_out) status = POLYNOMIAL_NULL_PTR;
+    else if (!int_type_width(poly->typeInfo) &&
+             poly_kernel_type(poly->typeInfo) != POLY_KERNEL_complex) status = POLYNOMIAL_TYPE_MISMATCH;
+    if (status != POLYNOMIAL_OK) {
+        if (err) *err = status;
+        return NULL;
+    }
+
+    PolyFuture args = {0};
+    args.poly = poly;
+    args.roots = roots_out;
+    return poly_future_start(poly_roots_body, &args, err);
+}
+
+PolynomialError poly_future_wait(PolyFuture* future) {
+    if (!future) return POLYNOMIAL_NULL_PTR;
+    pthread_mutex_lock(&future->lock);
+    while (!future->done) pthread_cond_wait(&future->ended, &future->lock);
+    PolynomialError status = future->status;
+    pthread_mutex_unlock(&future->lock);
+    return status;
+}
+
+int poly_future_try_get(PolyFuture* future, PolynomialError* status) {
+    if (!future) return 0;
+    pthread_mutex_lock(&future->lock);
+    int done = future->done;
+    if (done && status) *status = future->status;
+    pthread_mutex_unlock(&future->lock);
+    return done;
+}
+
+void poly_future_cancel(PolyFuture* future) {
+    if (future) __atomic_store_n(&future->job.cancelled, 1, __ATOMIC_RELAXED);
+}
+
+double poly_future_progress(const PolyFuture* future) {
+    if (!future) return 0.0;
+    return (double)__atomic_load_n(&future->job.progress, __ATOMIC_RELAXED) / POLY_JOB_PROGRESS_SCALE;
+}
+
+void poly_future_free(PolyFuture* future) {
+    if (!future) return;
+    poly_future_cancel(future);
+    poly_future_wait(future);
+    poly_future_release(future);
+}
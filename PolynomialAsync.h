@@ -0,0 +1,34 @@
+#ifndef POLYNOMIAL_ASYNC_H
+#define POLYNOMIAL_ASYNC_H
+
+#include "Polynomial.h"
+#include "Complex.h"
+
+// Handle to an operation running on the shared thread pool. The operation
+// reads the caller's inputs and writes the caller's outputs in place, so
+// they must stay alive and unmodified until the future has ended. Waiting on
+// a future from inside a pool task can deadlock the pool.
+typedef struct PolyFuture PolyFuture;
+
+// Each starter checks its arguments up front; on failure it returns NULL
+// and stores the reason in err.
+PolyFuture* poly_multiply_async(const Polynomial* a, const Polynomial* b, Polynomial* result, PolynomialError* err);
+// values[i] = poly(points[i]) for count points of the polynomial's type
+PolyFuture* poly_evaluate_many_async(const Polynomial* poly, const void* points, int count, void* values,
+                                     PolynomialError* err);
+// roots_out must hold poly->degree values, as for poly_roots
+PolyFuture* poly_roots_async(const Polynomial* poly, Complex* roots_out, PolynomialError* err);
+
+// Blocks until the operation ends and returns its status, which is
+// POLYNOMIAL_CANCELLED if it stopped early
+PolynomialError poly_future_wait(PolyFuture* future);
+// Returns 1 and stores the status if the operation has ended, 0 while it runs
+int poly_future_try_get(PolyFuture* future, PolynomialError* status);
+// Asks the operation to stop at its next block boundary; its outputs are then unspecified
+void poly_future_cancel(PolyFuture* future);
+// Fraction of the work done, in [0, 1]
+double poly_future_progress(const PolyFuture* future);
+// Cancels the operation if it is still running, waits for it and releases the handle
+void poly_future_free(PolyFuture* future);
+
+#endif
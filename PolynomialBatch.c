@@ -0,0 +1,258 @@
+#include "PolynomialBatch.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "ThreadPool.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Items handled together: a slice of every term a kernel touches stays in
+// L1 while the slice is processed, and each slice is one parallel index
+#define BATCH_SLICE 256
+
+typedef enum { BATCH_ADD, BATCH_MULTIPLY, BATCH_EVALUATE } BatchOp;
+
+typedef struct {
+    BatchOp op;
+    PolyKernelType type;
+    const PolyBatch* a;
+    const PolyBatch* b;
+    PolyBatch* result;
+    const void* points;
+    void* values;
+} BatchJob;
+
+static PolyBatch* poly_batch_create_unscoped(const TypeInfo* typeInfo, int count, int degree, PolynomialError* err) {
+    if (!typeInfo) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    if (poly_kernel_type(typeInfo) == POLY_KERNEL_GENERIC) {
+        if (err) *err = POLYNOMIAL_TYPE_MISMATCH;
+        return NULL;
+    }
+    if (degree < 0) {
+        if (err) *err = POLYNOMIAL_INVALID_DEGREE;
+        return NULL;
+    }
+    if (count <= 0 || (size_t)count > SIZE_MAX / typeInfo->size / ((size_t)degree + 1)) {
+        if (err) *err = POLYNOMIAL_INVALID_INPUT;
+        return NULL;
+    }
+
+    PolyBatch* batch = poly_mem_alloc(sizeof(PolyBatch));
+    if (batch) batch->coefficients = poly_mem_calloc((size_t)(degree + 1) * count, typeInfo->size);
+    if (!batch || !batch->coefficients) {
+        poly_mem_free(batch);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    batch->count = count;
+    batch->degree = degree;
+    batch->typeInfo = typeInfo;
+    if (err) *err = POLYNOMIAL_OK;
+    return batch;
+}
+
+PolyBatch* poly_batch_create(const TypeInfo* typeInfo, int count, int degree, PolynomialError* err) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_BATCH, typeInfo);
+    PolyBatch* created = poly_batch_create_unscoped(typeInfo, count, degree, err);
+    poly_mem_leave(&scope);
+    return created;
+}
+
+void poly_batch_free(PolyBatch* batch) {
+    if (!batch) return;
+    poly_mem_free(batch->coefficients);
+    poly_mem_free(batch);
+}
+
+static char* batch_slot(const PolyBatch* batch, int term, int index) {
+    return (char*)batch->coefficients + ((size_t)term * batch->count + index) * batch->typeInfo->size;
+}
+
+PolynomialError poly_batch_set(PolyBatch* batch, int index, const Polynomial* poly) {
+    if (!batch || !poly) return POLYNOMIAL_NULL_PTR;
+    if (poly->typeInfo != batch->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (index < 0 || index >= batch->count) return POLYNOMIAL_INVALID_INPUT;
+    if (poly->degree > batch->degree) return POLYNOMIAL_INVALID_DEGREE;
+
+    size_t size = batch->typeInfo->size;
+    for (int i = 0; i <= batch->degree; i++) {
+        if (i <= poly->degree) memcpy(batch_slot(batch, i, index), poly->coefficients[i], size);
+        else memset(batch_slot(batch, i, index), 0, size);
+    }
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_batch_get(const PolyBatch* batch, int index, Polynomial* result) {
+    if (!batch || !result) return POLYNOMIAL_NULL_PTR;
+    if (result->typeInfo != batch->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (index < 0 || index >= batch->count) return POLYNOMIAL_INVALID_INPUT;
+    if (result->degree < batch->degree) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError err = poly_make_unique(result);
+    if (err != POLYNOMIAL_OK) return err;
+
+    size_t size = batch->typeInfo->size;
+    for (int i = 0; i <= result->degree; i++) {
+        if (i <= batch->degree) memcpy(result->coefficients[i], batch_slot(batch, i, index), size);
+        else memset(result->coefficients[i], 0, size);
+    }
+    return POLYNOMIAL_OK;
+}
+
+// Per-type kernels over n items starting at the given pointers, with term
+// i of a batch stride * i values further on. Full slices are instantiated
+// with the constant BATCH_SLICE as their length, which lets the loops
+// vectorize without a remainder; the last, partial slice uses n.
+#define BATCH_DEFINE_OPS(NAME, T, SUFFIX, LEN) \
+static void NAME##_batch_sum##SUFFIX(const T* restrict x, const T* restrict y, T* restrict r, int n) { \
+    (void)n; \
+    for (int k = 0; k < LEN; k++) r[k] = NAME##_k_add(x[k], y[k]); \
+} \
+\
+static void NAME##_batch_accumulate##SUFFIX(T* restrict r, const T* restrict x, int n) { \
+    (void)n; \
+    for (int k = 0; k < LEN; k++) r[k] = NAME##_k_add(r[k], x[k]); \
+} \
+\
+static void NAME##_batch_multiply##SUFFIX(const T* restrict a, int da, const T* restrict b, int db, T* restrict r, \
+                                          int dr, size_t stride, int n) { \
+    (void)n; \
+    for (int i = 0; i <= dr; i++) memset(r + i * stride, 0, LEN * sizeof(T)); \
+    for (int i = 0; i <= da; i++) { \
+        const T* ai = a + i * stride; \
+        for (int j = 0; j <= db; j++) { \
+            const T* bj = b + j * stride; \
+            T* rij = r + (i + j) * stride; \
+            for (int k = 0; k < LEN; k++) rij[k] = NAME##_k_add(rij[k], NAME##_k_mul(ai[k], bj[k])); \
+        } \
+    } \
+} \
+\
+static void NAME##_batch_evaluate##SUFFIX(const T* restrict a, int d, size_t stride, const T* restrict x, \
+                                          T* restrict v, int n) { \
+    (void)n; \
+    memcpy(v, a + d * stride, LEN * sizeof(T)); \
+    for (int i = d - 1; i >= 0; i--) { \
+        const T* ai = a + i * stride; \
+        for (int k = 0; k < LEN; k++) v[k] = NAME##_k_add(NAME##_k_mul(v[k], x[k]), ai[k]); \
+    } \
+}
+
+#define BATCH_DEFINE_KERNELS(NAME, T, GETTER) \
+    BATCH_DEFINE_OPS(NAME, T, _slice, BATCH_SLICE) \
+    BATCH_DEFINE_OPS(NAME, T, _tail, n)
+
+POLY_BUILTIN_TYPES(BATCH_DEFINE_KERNELS)
+#undef BATCH_DEFINE_KERNELS
+#undef BATCH_DEFINE_OPS
+
+// Term by term: both inputs summed, or accumulated into the one the result
+// aliases; a lone input copied; otherwise zeros (all-zero bytes for every
+// built-in type)
+#define BATCH_ADD_TERMS(NAME, T, SUFFIX) \
+    for (int i = 0; i <= r->degree; i++) { \
+        const T* ai = i <= a->degree ? (const T*)a->coefficients + i * stride + begin : NULL; \
+        const T* bi = i <= b->degree ? (const T*)b->coefficients + i * stride + begin : NULL; \
+        T* ri = (T*)r->coefficients + i * stride + begin; \
+        if (ai && bi) { \
+            if (ai != ri && bi != ri) NAME##_batch_sum##SUFFIX(ai, bi, ri, n); \
+            else if (ai != ri) NAME##_batch_accumulate##SUFFIX(ri, ai, n); \
+            else if (bi != ri) NAME##_batch_accumulate##SUFFIX(ri, bi, n); \
+            else for (int k = 0; k < n; k++) ri[k] = NAME##_k_add(ri[k], ri[k]); \
+        } else if (ai || bi) { \
+            if ((ai ? ai : bi) != ri) memcpy(ri, ai ? ai : bi, n * sizeof(T)); \
+        } else { \
+            memset(ri, 0, n * sizeof(T)); \
+        } \
+    }
+
+#define BATCH_RUN(NAME, T, SUFFIX) \
+    if (job->op == BATCH_ADD) { \
+        BATCH_ADD_TERMS(NAME, T, SUFFIX) \
+    } else if (job->op == BATCH_MULTIPLY) { \
+        NAME##_batch_multiply##SUFFIX((const T*)a->coefficients + begin, a->degree, (const T*)b->coefficients + begin, \
+                                      b->degree, (T*)r->coefficients + begin, r->degree, stride, n); \
+    } else { \
+        NAME##_batch_evaluate##SUFFIX((const T*)a->coefficients + begin, a->degree, stride, \
+                                      (const T*)job->points + begin, (T*)job->values + begin, n); \
+    }
+
+static void batch_body(void* ctx, int first, int last) {
+    const BatchJob* job = ctx;
+    const PolyBatch* a = job->a;
+    const PolyBatch* b = job->b;
+    const PolyBatch* r = job->result;
+    size_t stride = a->count;
+    for (int slice = first; slice < last; slice++) {
+        int begin = slice * BATCH_SLICE;
+        int n = a->count - begin < BATCH_SLICE ? a->count - begin : BATCH_SLICE;
+        switch (job->type) {
+#define BATCH_CASE(NAME, T, GETTER) \
+        case POLY_KERNEL_##NAME: \
+            if (n == BATCH_SLICE) { \
+                BATCH_RUN(NAME, T, _slice) \
+            } else { \
+                BATCH_RUN(NAME, T, _tail) \
+            } \
+            break;
+        POLY_BUILTIN_TYPES(BATCH_CASE)
+#undef BATCH_CASE
+        default:
+            break;
+        }
+    }
+}
+
+#undef BATCH_RUN
+#undef BATCH_ADD_TERMS
+
+// Runs the slices inline, or on the shared pool when there is enough work
+static PolynomialError batch_run(BatchJob* job, long long work) {
+    int slices = (job->a->count + BATCH_SLICE - 1) / BATCH_SLICE;
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_BATCH, job->a->typeInfo);
+    PolynomialError err = POLYNOMIAL_OK;
+    if (work < POLY_BATCH_PARALLEL_WORK || slices == 1) {
+        batch_body(job, 0, slices);
+    } else {
+        long long perSlice = work / slices + 1;
+        int grain = (int)(POLY_BATCH_PARALLEL_WORK / 4 / perSlice) + 1;
+        err = thread_pool_parallel_for(thread_pool_shared(), slices, grain, batch_body, job);
+    }
+    poly_mem_leave(&scope);
+    return err;
+}
+
+static PolynomialError batch_check(const PolyBatch* a, const PolyBatch* b, const PolyBatch* result) {
+    if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
+    if (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (a->count != b->count || a->count != result->count) return POLYNOMIAL_INVALID_INPUT;
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_batch_add(const PolyBatch* a, const PolyBatch* b, PolyBatch* result) {
+    PolynomialError err = batch_check(a, b, result);
+    if (err != POLYNOMIAL_OK) return err;
+    if (result->degree < a->degree || result->degree < b->degree) return POLYNOMIAL_INVALID_DEGREE;
+    BatchJob job = {BATCH_ADD, poly_kernel_type(a->typeInfo), a, b, result, NULL, NULL};
+    return batch_run(&job, (long long)a->count * (result->degree + 1));
+}
+
+PolynomialError poly_batch_multiply(const PolyBatch* a, const PolyBatch* b, PolyBatch* result) {
+    PolynomialError err = batch_check(a, b, result);
+    if (err != POLYNOMIAL_OK) return err;
+    if (result->degree < a->degree + b->degree) return POLYNOMIAL_INVALID_DEGREE;
+    if (result == a || result == b || result->coefficients == a->coefficients ||
+        result->coefficients == b->coefficients) {
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+    BatchJob job = {BATCH_MULTIPLY, poly_kernel_type(a->typeInfo), a, b, result, NULL, NULL};
+    return batch_run(&job, (long long)a->count * (a->degree + 1) * (b->degree + 1));
+}
+
+PolynomialError poly_batch_evaluate(const PolyBatch* batch, const void* points, void* values) {
+    if (!batch || !points || !values) return POLYNOMIAL_NULL_PTR;
+    BatchJob job = {BATCH_EVALUATE, poly_kernel_type(batch->typeInfo), batch, batch, NULL, points, values};
+    return batch_run(&job, (long long)batch->count * (batch->degree + 1));
+}
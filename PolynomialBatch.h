@@ -0,0 +1,46 @@
+#ifndef POLYNOMIAL_BATCH_H
+#define POLYNOMIAL_BATCH_H
+
+#include "Polynomial.h"
+
+// Many small polynomials of one built-in type, stored structure-of-arrays:
+// coefficient i of every item is contiguous, so the batch operations run
+// their inner loops across items, where the compiler vectorizes them.
+// Every item has degree + 1 slots; shorter polynomials are zero-padded.
+// Arithmetic is that of the kernels: integers wrap instead of promoting,
+// so use an int64 or int128 batch when results may not fit.
+typedef struct {
+    void* coefficients;    // (degree + 1) * count values, one block
+    int count;
+    int degree;
+    const TypeInfo* typeInfo;
+} PolyBatch;
+
+// Coefficient term of item index
+#define POLY_BATCH_COEFF(batch, T, term, index) \
+    (((T*)(batch)->coefficients)[(size_t)(term) * (batch)->count + (index)])
+
+// Batches spread over the shared thread pool above this many coefficient
+// operations
+#define POLY_BATCH_PARALLEL_WORK (1 << 18)
+
+// A batch of count zero polynomials; fails with POLYNOMIAL_TYPE_MISMATCH
+// for types without kernels
+PolyBatch* poly_batch_create(const TypeInfo* typeInfo, int count, int degree, PolynomialError* err);
+void poly_batch_free(PolyBatch* batch);
+
+// Packs poly into slot index (its degree must fit) and unpacks it again;
+// result needs the batch's degree
+PolynomialError poly_batch_set(PolyBatch* batch, int index, const Polynomial* poly);
+PolynomialError poly_batch_get(const PolyBatch* batch, int index, Polynomial* result);
+
+// Item by item over equally long batches, validated once per call. Results
+// go into the preallocated result batch, which for add needs degree at
+// least that of both inputs and for multiply at least their sum; higher
+// slots are zeroed. result may alias an input for add only.
+PolynomialError poly_batch_add(const PolyBatch* a, const PolyBatch* b, PolyBatch* result);
+PolynomialError poly_batch_multiply(const PolyBatch* a, const PolyBatch* b, PolyBatch* result);
+// values[k] = item k at points[k], separate arrays of count values of the type
+PolynomialError poly_batch_evaluate(const PolyBatch* batch, const void* points, void* values);
+
+#endif
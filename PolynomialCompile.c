@@ -0,0 +1,648 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "PolynomialCompile.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+#define COMPILE_PATH_MAX 4096
+// Powers x^(2^k) an Estrin tree of POLY_COMPILE_MAX_DEGREE can use
+#define COMPILE_MAX_LEVELS 16
+
+// The compiler's arguments before the output and source paths; they are
+// part of the hash, so changing them rebuilds every cached evaluator.
+// COMPILE_NATIVE_FLAG is added only when the host CPU is known
+static const char* const COMPILE_FLAGS[] = {
+    "-std=c99", "-O3", "-fopenmp-simd", "-fPIC", "-shared", "-w",
+};
+#define COMPILE_FLAG_COUNT ((int)(sizeof(COMPILE_FLAGS) / sizeof(COMPILE_FLAGS[0])))
+#define COMPILE_NATIVE_FLAG "-march=native"
+// /proc/cpuinfo fields naming the instruction set of x86 and ARM processors
+static const char* const COMPILE_CPU_FIELDS[] = {
+    "vendor_id", "model name", "flags", "Features", "CPU implementer", "CPU architecture", "CPU part",
+};
+#define COMPILE_CPU_FIELD_COUNT ((int)(sizeof(COMPILE_CPU_FIELDS) / sizeof(COMPILE_CPU_FIELDS[0])))
+
+static pthread_mutex_t COMPILE_LOCK = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t COMPILE_CPU_ONCE = PTHREAD_ONCE_INIT;
+// The host CPU's fields in hex, empty when they cannot be read
+static char COMPILE_CPU[17];
+static char* COMPILE_CACHE_DIR;
+static unsigned long long COMPILE_SEQUENCE;
+
+// Per type: U is the type the arithmetic is done in (unsigned for the
+// integers, so they wrap like the kernels), T the stored coefficient
+static const char* const COMPILE_PRELUDE[POLY_KERNEL_COUNT] = {
+    [POLY_KERNEL_int] =
+        "typedef int T;\n"
+        "typedef unsigned int U;\n"
+        "#define ZERO 0u\n"
+        "#define ONE 1u\n"
+        "#define MINUS_ONE 0xffffffffu\n"
+        "#define ADD(a, b) ((a) + (b))\n"
+        "#define SUB(a, b) ((a) - (b))\n"
+        "#define MUL(a, b) ((a) * (b))\n"
+        "#define NEG(a) (0u - (a))\n"
+        "#define LOAD(x) ((U)(x))\n"
+        "#define STORE(v) ((T)(v))\n",
+    [POLY_KERNEL_complex] =
+        "typedef struct { double real; double imag; } T;\n"
+        "typedef T U;\n"
+        "#define ZERO ((U){0.0, 0.0})\n"
+        "#define ONE ((U){1.0, 0.0})\n"
+        "#define MINUS_ONE ((U){-1.0, 0.0})\n"
+        "static inline U ADD(U a, U b) { U r = {a.real + b.real, a.imag + b.imag}; return r; }\n"
+        "static inline U SUB(U a, U b) { U r = {a.real - b.real, a.imag - b.imag}; return r; }\n"
+        "static inline U MUL(U a, U b) {\n"
+        "    U r = {a.real * b.real - a.imag * b.imag, a.real * b.imag + a.imag * b.real};\n"
+        "    return r;\n"
+        "}\n"
+        "static inline U NEG(U a) { U r = {-a.real, -a.imag}; return r; }\n"
+        "#define LOAD(x) (x)\n"
+        "#define STORE(v) (v)\n",
+    [POLY_KERNEL_modint] =
+        "#include <stdint.h>\n"
+        "typedef uint32_t T;\n"
+        "typedef uint32_t U;\n"
+        "#define M 998244353u\n"
+        "#define ZERO 0u\n"
+        "#define ONE 1u\n"
+        "#define MINUS_ONE (M - 1u)\n"
+        "static inline U ADD(U a, U b) { U s = a + b; return s >= M ? s - M : s; }\n"
+        "static inline U SUB(U a, U b) { return a >= b ? a - b : a + (M - b); }\n"
+        "static inline U MUL(U a, U b) { return (U)((uint64_t)a * b % M); }\n"
+        "static inline U NEG(U a) { return a ? M - a : 0u; }\n"
+        "#define LOAD(x) (x)\n"
+        "#define STORE(v) (v)\n",
+    [POLY_KERNEL_int64] =
+        "#include <stdint.h>\n"
+        "typedef int64_t T;\n"
+        "typedef uint64_t U;\n"
+        "#define ZERO 0ull\n"
+        "#define ONE 1ull\n"
+        "#define MINUS_ONE 0xffffffffffffffffull\n"
+        "#define ADD(a, b) ((a) + (b))\n"
+        "#define SUB(a, b) ((a) - (b))\n"
+        "#define MUL(a, b) ((a) * (b))\n"
+        "#define NEG(a) (0ull - (a))\n"
+        "#define LOAD(x) ((U)(x))\n"
+        "#define STORE(v) ((T)(v))\n",
+    [POLY_KERNEL_int128] =
+        "typedef __int128 T;\n"
+        "typedef unsigned __int128 U;\n"
+        "#define ZERO ((U)0)\n"
+        "#define ONE ((U)1)\n"
+        "#define MINUS_ONE (~(U)0)\n"
+        "#define ADD(a, b) ((a) + (b))\n"
+        "#define SUB(a, b) ((a) - (b))\n"
+        "#define MUL(a, b) ((a) * (b))\n"
+        "#define NEG(a) ((U)0 - (a))\n"
+        "#define LOAD(x) ((U)(x))\n"
+        "#define STORE(v) ((T)(v))\n",
+};
+
+static const char* const COMPILE_TYPE_NAME[POLY_KERNEL_COUNT] = {
+    [POLY_KERNEL_int] = "int",
+    [POLY_KERNEL_complex] = "complex",
+    [POLY_KERNEL_modint] = "modint",
+    [POLY_KERNEL_int64] = "int64",
+    [POLY_KERNEL_int128] = "int128",
+};
+
+// The points are independent, so the loop over them is vectorized with
+// the whole straight-line evaluation inlined into it
+static const char COMPILE_ENTRY[] =
+    "void poly_compiled_entry(const T* restrict points, T* restrict values, int count) {\n"
+    "#pragma omp simd\n"
+    "    for (int j = 0; j < count; j++) values[j] = STORE(eval(LOAD(points[j])));\n"
+    "}\n";
+
+// A value in the evaluator as it is emitted: a known constant, a
+// coefficient, or a temporary t<index> (t0 is x)
+typedef enum { NODE_ZERO, NODE_ONE, NODE_MINUS_ONE, NODE_CONST, NODE_TEMP } NodeKind;
+
+typedef struct {
+    NodeKind kind;
+    int index;
+} Node;
+
+typedef struct {
+    FILE* out;
+    const Polynomial* poly;
+    PolyKernelType type;
+    int temps;
+    Node powers[COMPILE_MAX_LEVELS];  // x^(2^k) once emitted
+    int havePowers;
+} Emitter;
+
+static NodeKind compile_classify(PolyKernelType type, const void* c) {
+    switch (type) {
+#define COMPILE_CLASSIFY(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: { \
+        T zero = NAME##_k_zero(); \
+        T one = NAME##_k_one(); \
+        T minusOne = NAME##_k_sub(zero, one); \
+        if (memcmp(c, &zero, sizeof(T)) == 0) return NODE_ZERO; \
+        if (memcmp(c, &one, sizeof(T)) == 0) return NODE_ONE; \
+        if (memcmp(c, &minusOne, sizeof(T)) == 0) return NODE_MINUS_ONE; \
+        return NODE_CONST; \
+    }
+    POLY_BUILTIN_TYPES(COMPILE_CLASSIFY)
+#undef COMPILE_CLASSIFY
+    default:
+        return NODE_CONST;
+    }
+}
+
+static void compile_put_const(Emitter* e, const void* c) {
+    switch (e->type) {
+    case POLY_KERNEL_int:
+        fprintf(e->out, "%uu", (unsigned)*(const int*)c);
+        break;
+    case POLY_KERNEL_complex:
+        fprintf(e->out, "((U){%a, %a})", ((const Complex*)c)->real, ((const Complex*)c)->imag);
+        break;
+    case POLY_KERNEL_modint:
+        fprintf(e->out, "%uu", (unsigned)*(const ModInt*)c);
+        break;
+    case POLY_KERNEL_int64:
+        fprintf(e->out, "0x%llxull", (unsigned long long)*(const int64_t*)c);
+        break;
+    case POLY_KERNEL_int128: {
+        PolyUInt128 v = (PolyUInt128)*(const Int128*)c;
+        fprintf(e->out, "((U)0x%llxull << 64 | 0x%llxull)", (unsigned long long)(v >> 64),
+                (unsigned long long)v);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void compile_put(Emitter* e, Node n) {
+    switch (n.kind) {
+    case NODE_ZERO: fputs("ZERO", e->out); break;
+    case NODE_ONE: fputs("ONE", e->out); break;
+    case NODE_MINUS_ONE: fputs("MINUS_ONE", e->out); break;
+    case NODE_CONST: compile_put_const(e, e->poly->coefficients[n.index]); break;
+    case NODE_TEMP: fprintf(e->out, "t%d", n.index); break;
+    }
+}
+
+static Node compile_emit(Emitter* e, const char* op, Node a, const Node* b) {
+    Node r = {NODE_TEMP, ++e->temps};
+    fprintf(e->out, "    U t%d = %s(", r.index, op);
+    compile_put(e, a);
+    if (b) {
+        fputs(", ", e->out);
+        compile_put(e, *b);
+    }
+    fputs(");\n", e->out);
+    return r;
+}
+
+static Node compile_leaf(Emitter* e, int i) {
+    Node n = {NODE_ZERO, i};
+    if (i <= e->poly->degree) n.kind = compile_classify(e->type, e->poly->coefficients[i]);
+    return n;
+}
+
+static Node compile_neg(Emitter* e, Node a) {
+    if (a.kind == NODE_ZERO) return a;
+    if (a.kind == NODE_ONE || a.kind == NODE_MINUS_ONE) {
+        a.kind = a.kind == NODE_ONE ? NODE_MINUS_ONE : NODE_ONE;
+        return a;
+    }
+    return compile_emit(e, "NEG", a, NULL);
+}
+
+static Node compile_mul(Emitter* e, Node a, Node b) {
+    if (a.kind == NODE_ZERO || b.kind == NODE_ONE) return a;
+    if (b.kind == NODE_ZERO || a.kind == NODE_ONE) return b;
+    if (a.kind == NODE_MINUS_ONE) return compile_neg(e, b);
+    if (b.kind == NODE_MINUS_ONE) return compile_neg(e, a);
+    return compile_emit(e, "MUL", a, &b);
+}
+
+// c + a * b, with a factor of -1 turned into a subtraction
+static Node compile_mul_add(Emitter* e, Node c, Node a, Node b) {
+    if (a.kind == NODE_ZERO || b.kind == NODE_ZERO) return c;
+    if (a.kind == NODE_MINUS_ONE || b.kind == NODE_MINUS_ONE) {
+        Node v = a.kind == NODE_MINUS_ONE ? b : a;
+        if (c.kind == NODE_ZERO) return compile_neg(e, v);
+        return compile_emit(e, "SUB", c, &v);
+    }
+    Node v = compile_mul(e, a, b);
+    if (c.kind == NODE_ZERO) return v;
+    return compile_emit(e, "ADD", c, &v);
+}
+
+// x^(2^level), squared up from x on first use
+static Node compile_power(Emitter* e, int level) {
+    while (e->havePowers <= level) {
+        Node prev = e->powers[e->havePowers - 1];
+        e->powers[e->havePowers++] = compile_mul(e, prev, prev);
+    }
+    return e->powers[level];
+}
+
+static Node compile_horner(Emitter* e) {
+    Node x = {NODE_TEMP, 0};
+    Node r = compile_leaf(e, e->poly->degree);
+    for (int i = e->poly->degree - 1; i >= 0; i--) r = compile_mul_add(e, compile_leaf(e, i), r, x);
+    return r;
+}
+
+// The 2^level coefficients from lo, as low + high * x^(2^(level-1));
+// blocks past the degree or of zeros emit nothing
+static Node compile_estrin(Emitter* e, int lo, int level) {
+    if (lo > e->poly->degree) {
+        Node zero = {NODE_ZERO, 0};
+        return zero;
+    }
+    if (level == 0) return compile_leaf(e, lo);
+    Node low = compile_estrin(e, lo, level - 1);
+    Node high = compile_estrin(e, lo + (1 << (level - 1)), level - 1);
+    if (high.kind == NODE_ZERO) return low;
+    return compile_mul_add(e, low, high, compile_power(e, level - 1));
+}
+
+char* poly_compile_source(const Polynomial* poly, PolynomialError* err) {
+    if (!poly) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    PolyKernelType type = poly_kernel_type(poly->typeInfo);
+    if (type == POLY_KERNEL_GENERIC) {
+        if (err) *err = POLYNOMIAL_TYPE_MISMATCH;
+        return NULL;
+    }
+    if (poly->degree > POLY_COMPILE_MAX_DEGREE) {
+        if (err) *err = POLYNOMIAL_INVALID_DEGREE;
+        return NULL;
+    }
+    // infinities and NaNs have no literal
+    for (int i = 0; type == POLY_KERNEL_complex && i <= poly->degree; i++) {
+        const Complex* c = poly->coefficients[i];
+        if (!isfinite(c->real) || !isfinite(c->imag)) {
+            if (err) *err = POLYNOMIAL_INVALID_INPUT;
+            return NULL;
+        }
+    }
+
+    char* text = NULL;
+    size_t length = 0;
+    FILE* out = open_memstream(&text, &length);
+    if (!out) {
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    int estrin = poly->degree >= POLY_EVAL_ESTRIN_MIN_DEGREE;
+    fprintf(out, "/* poly_compile: %s polynomial of degree %d, %s */\n\n", COMPILE_TYPE_NAME[type], poly->degree,
+            estrin ? "Estrin" : "Horner");
+    fputs(COMPILE_PRELUDE[type], out);
+    fputs("\nstatic inline __attribute__((always_inline)) U eval(U t0) {\n    (void)t0;\n", out);
+
+    Emitter e = {out, poly, type, 0, {{NODE_TEMP, 0}}, 1};
+    Node result;
+    if (estrin) {
+        int levels = 0;
+        while ((1 << levels) < poly->degree + 1) levels++;
+        result = compile_estrin(&e, 0, levels);
+    } else {
+        result = compile_horner(&e);
+    }
+    fputs("    return ", out);
+    compile_put(&e, result);
+    fputs(";\n}\n\n", out);
+    fputs(COMPILE_ENTRY, out);
+
+    if (fclose(out) != 0) {
+        free(text);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    if (err) *err = POLYNOMIAL_OK;
+    return text;
+}
+
+static const char* compile_compiler(void) {
+    const char* cc = getenv("POLY_COMPILE_CC");
+    return cc && *cc ? cc : "cc";
+}
+
+#define COMPILE_FNV_BASIS 14695981039346656037ull
+
+// FNV-1a over text and its terminating NUL, which separates the parts
+static uint64_t compile_fnv(uint64_t h, const char* text) {
+    const unsigned char* s = (const unsigned char*)text;
+    do {
+        h ^= *s;
+        h *= 1099511628211ull;
+    } while (*s++);
+    return h;
+}
+
+// Objects are built for the CPU that compiles them, and a cache shared
+// between machines (a home directory on NFS) must not hand one built for a
+// newer instruction set to an older CPU, so the CPU is part of the hash.
+// Only the first processor is read; every processor of a host runs the
+// same instruction set
+static void compile_cpu_init(void) {
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    uint64_t h = COMPILE_FNV_BASIS;
+    int found = 0;
+    char* line = NULL;
+    size_t cap = 0;
+    while (getline(&line, &cap, f) > 0 && line[0] != '\n') {
+        for (int i = 0; i < COMPILE_CPU_FIELD_COUNT; i++) {
+            size_t n = strlen(COMPILE_CPU_FIELDS[i]);
+            if (strncmp(line, COMPILE_CPU_FIELDS[i], n) == 0 && (line[n] == '\t' || line[n] == ' ' || line[n] == ':')) {
+                h = compile_fnv(h, line);
+                found = 1;
+            }
+        }
+    }
+    free(line);
+    fclose(f);
+    if (found) snprintf(COMPILE_CPU, sizeof(COMPILE_CPU), "%016llx", (unsigned long long)h);
+}
+
+static const char* compile_cpu(void) {
+    pthread_once(&COMPILE_CPU_ONCE, compile_cpu_init);
+    return COMPILE_CPU;
+}
+
+// Fills args with the compiler and its flags and returns how many; an
+// unknown CPU gets portable code, since the hash cannot tell CPUs apart
+#define COMPILE_ARG_MAX (COMPILE_FLAG_COUNT + 2)
+static int compile_args(const char* compiler, const char** args) {
+    int count = 0;
+    args[count++] = compiler;
+    for (int i = 0; i < COMPILE_FLAG_COUNT; i++) args[count++] = COMPILE_FLAGS[i];
+    if (compile_cpu()[0]) args[count++] = COMPILE_NATIVE_FLAG;
+    return count;
+}
+
+// FNV-1a over the source, the command that builds it and the CPU it runs on
+static uint64_t compile_hash(const char* source, const char* compiler) {
+    const char* args[COMPILE_ARG_MAX];
+    int count = compile_args(compiler, args);
+    uint64_t h = COMPILE_FNV_BASIS;
+    for (int i = 0; i < count; i++) h = compile_fnv(h, args[i]);
+    h = compile_fnv(h, compile_cpu());
+    return compile_fnv(h, source);
+}
+
+// Whatever is loaded from the cache runs in this process, so the cache and
+// its objects must be ours and writable by no one else: anyone who could
+// write there could place an object under a hash they can compute
+static int compile_trusted(const struct stat* st, mode_t type) {
+    return (st->st_mode & S_IFMT) == type && st->st_uid == geteuid() && !(st->st_mode & (S_IWGRP | S_IWOTH));
+}
+
+static PolynomialError compile_make_dir(const char* dir) {
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) return POLYNOMIAL_CALC_ERROR;
+    return POLYNOMIAL_OK;
+}
+
+// The directory objects are cached in, which must be trusted
+static PolynomialError compile_make_cache_dir(const char* dir) {
+    PolynomialError err = compile_make_dir(dir);
+    if (err != POLYNOMIAL_OK) return err;
+    struct stat st;
+    if (lstat(dir, &st) != 0 || !compile_trusted(&st, S_IFDIR)) return POLYNOMIAL_CALC_ERROR;
+    return POLYNOMIAL_OK;
+}
+
+// The cache directory, created if it does not exist yet
+static PolynomialError compile_cache_dir(char* dir, size_t cap) {
+    pthread_mutex_lock(&COMPILE_LOCK);
+    int n = COMPILE_CACHE_DIR ? snprintf(dir, cap, "%s", COMPILE_CACHE_DIR) : 0;
+    pthread_mutex_unlock(&COMPILE_LOCK);
+    if (n > 0) return (size_t)n < cap ? compile_make_cache_dir(dir) : POLYNOMIAL_INVALID_INPUT;
+
+    const char* env = getenv("POLY_COMPILE_CACHE");
+    if (env && *env) {
+        n = snprintf(dir, cap, "%s", env);
+        return n > 0 && (size_t)n < cap ? compile_make_cache_dir(dir) : POLYNOMIAL_INVALID_INPUT;
+    }
+    const char* home = getenv("HOME");
+    if (!home || !*home) return POLYNOMIAL_CALC_ERROR;
+    n = snprintf(dir, cap, "%s/.cache", home);
+    if (n <= 0 || (size_t)n >= cap) return POLYNOMIAL_INVALID_INPUT;
+    PolynomialError err = compile_make_dir(dir);
+    if (err != POLYNOMIAL_OK) return err;
+    n = snprintf(dir, cap, "%s/.cache/polynomial-calculator", home);
+    if (n <= 0 || (size_t)n >= cap) return POLYNOMIAL_INVALID_INPUT;
+    return compile_make_cache_dir(dir);
+}
+
+PolynomialError poly_compile_set_cache_dir(const char* dir) {
+    char* copy = NULL;
+    if (dir) {
+        if (!*dir) return POLYNOMIAL_INVALID_INPUT;
+        copy = strdup(dir);
+        if (!copy) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+    pthread_mutex_lock(&COMPILE_LOCK);
+    free(COMPILE_CACHE_DIR);
+    COMPILE_CACHE_DIR = copy;
+    pthread_mutex_unlock(&COMPILE_LOCK);
+    return POLYNOMIAL_OK;
+}
+
+static int compile_has_suffix(const char* name, const char* suffix) {
+    size_t n = strlen(name), s = strlen(suffix);
+    return n >= s && strcmp(name + n - s, suffix) == 0;
+}
+
+PolynomialError poly_compile_clear_cache(void) {
+    char dir[COMPILE_PATH_MAX];
+    PolynomialError err = compile_cache_dir(dir, sizeof(dir));
+    if (err != POLYNOMIAL_OK) return err;
+    DIR* d = opendir(dir);
+    if (!d) return POLYNOMIAL_CALC_ERROR;
+    char path[2 * COMPILE_PATH_MAX];
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        const char* name = entry->d_name;
+        if (strncmp(name, "poly-", 5) != 0) continue;
+        if (!compile_has_suffix(name, ".c") && !compile_has_suffix(name, ".so") && !compile_has_suffix(name, ".log"))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (unlink(path) != 0 && errno != ENOENT) err = POLYNOMIAL_CALC_ERROR;
+    }
+    closedir(d);
+    return err;
+}
+
+static PolynomialError compile_write_file(const char* path, const char* data, size_t length) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return POLYNOMIAL_CALC_ERROR;
+    size_t put = fwrite(data, 1, length, f);
+    if (fclose(f) != 0 || put != length) {
+        unlink(path);
+        return POLYNOMIAL_CALC_ERROR;
+    }
+    return POLYNOMIAL_OK;
+}
+
+// Whether the cached source at path is exactly this one, which rules out
+// hash collisions and files left half written
+static int compile_file_matches(const char* path, const char* data, size_t length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    char buf[4096];
+    size_t offset = 0, got;
+    int same = 1;
+    while (same && (got = fread(buf, 1, sizeof(buf), f)) > 0) {
+        same = offset + got <= length && memcmp(buf, data + offset, got) == 0;
+        offset += got;
+    }
+    fclose(f);
+    return same && offset == length;
+}
+
+// Runs the compiler with its output going to log
+static PolynomialError compile_run(const char* compiler, const char* source, const char* object, const char* log) {
+    const char* args[COMPILE_ARG_MAX];
+    int count = compile_args(compiler, args);
+    char* argv[COMPILE_ARG_MAX + 4];
+    int argc = 0;
+    for (int i = 0; i < count; i++) argv[argc++] = (char*)args[i];
+    argv[argc++] = "-o";
+    argv[argc++] = (char*)object;
+    argv[argc++] = (char*)source;
+    argv[argc] = NULL;
+
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, log, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    pid_t pid;
+    int rc = posix_spawnp(&pid, compiler, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (rc != 0) return POLYNOMIAL_CALC_ERROR;
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return POLYNOMIAL_CALC_ERROR;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? POLYNOMIAL_OK : POLYNOMIAL_CALC_ERROR;
+}
+
+// The directory is trusted, so the object cannot be swapped after the check
+static PolynomialError compile_open(PolyCompiled* compiled, const char* object) {
+    struct stat st;
+    if (lstat(object, &st) != 0 || !compile_trusted(&st, S_IFREG)) return POLYNOMIAL_CALC_ERROR;
+    void* handle = dlopen(object, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) return POLYNOMIAL_CALC_ERROR;
+    PolyCompiledFn fn = (PolyCompiledFn)dlsym(handle, "poly_compiled_entry");
+    if (!fn) {
+        dlclose(handle);
+        return POLYNOMIAL_CALC_ERROR;
+    }
+    compiled->handle = handle;
+    compiled->evaluate = fn;
+    return POLYNOMIAL_OK;
+}
+
+// Loads the cached object for source, building it first if needed. A build
+// writes under names no other build uses, then publishes the object before
+// the source, whose presence marks the object complete.
+static PolynomialError compile_load(PolyCompiled* compiled, const char* source, const char* compiler) {
+    char dir[COMPILE_PATH_MAX];
+    PolynomialError err = compile_cache_dir(dir, sizeof(dir));
+    if (err != POLYNOMIAL_OK) return err;
+
+    char base[COMPILE_PATH_MAX + 32], src[COMPILE_PATH_MAX + 64], obj[COMPILE_PATH_MAX + 64];
+    snprintf(base, sizeof(base), "%s/poly-%016llx", dir, (unsigned long long)compiled->hash);
+    snprintf(src, sizeof(src), "%s.c", base);
+    snprintf(obj, sizeof(obj), "%s.so", base);
+    size_t length = strlen(source);
+    if (compile_file_matches(src, source, length) && compile_open(compiled, obj) == POLYNOMIAL_OK) {
+        compiled->cached = 1;
+        return POLYNOMIAL_OK;
+    }
+
+    char tmpSrc[COMPILE_PATH_MAX + 96], tmpObj[COMPILE_PATH_MAX + 96], tmpLog[COMPILE_PATH_MAX + 96];
+    char log[COMPILE_PATH_MAX + 64];
+    unsigned long long seq = __atomic_fetch_add(&COMPILE_SEQUENCE, 1, __ATOMIC_RELAXED);
+    snprintf(tmpSrc, sizeof(tmpSrc), "%s.%d.%llu.c", base, (int)getpid(), seq);
+    snprintf(tmpObj, sizeof(tmpObj), "%s.%d.%llu.so", base, (int)getpid(), seq);
+    snprintf(tmpLog, sizeof(tmpLog), "%s.%d.%llu.log", base, (int)getpid(), seq);
+    snprintf(log, sizeof(log), "%s.log", base);
+
+    err = compile_write_file(tmpSrc, source, length);
+    if (err != POLYNOMIAL_OK) return err;
+    err = compile_run(compiler, tmpSrc, tmpObj, tmpLog);
+    // whatever the umask, the published object must pass compile_trusted
+    if (err == POLYNOMIAL_OK && chmod(tmpObj, 0700) != 0) err = POLYNOMIAL_CALC_ERROR;
+    if (err == POLYNOMIAL_OK && (rename(tmpObj, obj) != 0 || rename(tmpSrc, src) != 0)) err = POLYNOMIAL_CALC_ERROR;
+    if (err == POLYNOMIAL_OK) {
+        unlink(tmpLog);
+        err = compile_open(compiled, obj);
+    } else {
+        rename(tmpLog, log);
+        unlink(tmpObj);
+    }
+    unlink(tmpSrc);
+    return err;
+}
+
+PolyCompiled* poly_compile(const Polynomial* poly, PolynomialError* err) {
+    PolynomialError status;
+    char* source = poly_compile_source(poly, &status);
+    if (!source) {
+        if (err) *err = status;
+        return NULL;
+    }
+    PolyCompiled* compiled = poly_mem_calloc(1, sizeof(PolyCompiled));
+    if (!compiled) {
+        free(source);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    const char* compiler = compile_compiler();
+    compiled->typeInfo = poly->typeInfo;
+    compiled->degree = poly->degree;
+    compiled->hash = compile_hash(source, compiler);
+
+    status = compile_load(compiled, source, compiler);
+    free(source);
+    if (status != POLYNOMIAL_OK) {
+        poly_mem_free(compiled);
+        compiled = NULL;
+    }
+    if (err) *err = status;
+    return compiled;
+}
+
+PolynomialError poly_compiled_evaluate(const PolyCompiled* compiled, const void* points, void* values, int count) {
+    if (!compiled || !points || !values) return POLYNOMIAL_NULL_PTR;
+    if (count < 0) return POLYNOMIAL_INVALID_INPUT;
+    compiled->evaluate(points, values, count);
+    return POLYNOMIAL_OK;
+}
+
+void poly_compiled_free(PolyCompiled* compiled) {
+    if (!compiled) return;
+    if (compiled->handle) dlclose(compiled->handle);
+    poly_mem_free(compiled);
+}
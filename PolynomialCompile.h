@@ -0,0 +1,57 @@
+#ifndef POLYNOMIAL_COMPILE_H
+#define POLYNOMIAL_COMPILE_H
+
+#include "Polynomial.h"
+#include <stdint.h>
+
+// Compiles a fixed polynomial into native code. poly_compile emits C for a
+// straight-line evaluator with the coefficients baked in: Horner below
+// POLY_EVAL_ESTRIN_MIN_DEGREE, Estrin from there on, unrolled for that
+// exact degree. Zero coefficients, and whole Estrin blocks of them, are
+// left out, and multiplications by 1 and -1 become nothing or a negation.
+// The evaluator runs over a batch of points in a loop marked for SIMD, so
+// several points are evaluated per instruction where the type allows it.
+//
+// The source is built with the local C compiler (cc, or the program named
+// by POLY_COMPILE_CC) into a shared object and loaded with dlopen. Objects
+// are cached on disk under a hash of their source and of the host CPU they
+// are tuned for, so a polynomial compiled before, by any process on the
+// same kind of CPU sharing the cache, is only loaded. When the CPU cannot
+// be identified the objects are built for the generic instruction set.
+//
+// Only built-in types are supported. Integer results wrap exactly as
+// poly_evaluate's do; Complex results can differ from it in the last bits.
+typedef void (*PolyCompiledFn)(const void* points, void* values, int count);
+
+typedef struct {
+    PolyCompiledFn evaluate;   // values[j] = p(points[j]) for j < count
+    const TypeInfo* typeInfo;
+    int degree;
+    uint64_t hash;             // of the source and CPU, names the cached files
+    int cached;                // loaded from the cache without compiling
+    void* handle;
+} PolyCompiled;
+
+// Longest straight-line evaluator poly_compile emits
+#define POLY_COMPILE_MAX_DEGREE 4096
+
+// The source of poly's evaluator; free() it
+char* poly_compile_source(const Polynomial* poly, PolynomialError* err);
+
+// Compiles and loads poly's evaluator, which no longer depends on poly.
+// A failed build leaves the compiler's output in the cache directory and
+// reports POLYNOMIAL_CALC_ERROR.
+PolyCompiled* poly_compile(const Polynomial* poly, PolynomialError* err);
+PolynomialError poly_compiled_evaluate(const PolyCompiled* compiled, const void* points, void* values, int count);
+void poly_compiled_free(PolyCompiled* compiled);
+
+// The cache lives in dir, created if missing; NULL restores the default,
+// $POLY_COMPILE_CACHE or else $HOME/.cache/polynomial-calculator. Objects
+// are only loaded from a directory, and only as files, that the effective
+// user owns and no group or other user may write; compiling with any other
+// cache fails with POLYNOMIAL_CALC_ERROR.
+PolynomialError poly_compile_set_cache_dir(const char* dir);
+// Removes every file poly_compile has left in the cache directory
+PolynomialError poly_compile_clear_cache(void);
+
+#endif
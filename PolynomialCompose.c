@@ -0,0 +1,466 @@
+#include "Polynomial.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "PolynomialTrace.h"
+#include "ModInt.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Below this degree of p, poly_compose runs Horner's rule on polynomials
+#define POLY_COMPOSE_BK_THRESHOLD 32
+// From this degree on, poly_taylor_shift switches to convolution
+#define POLY_TAYLOR_SHIFT_THRESHOLD 128
+// Block size of the Horner base case in the divide-and-conquer shift
+#define POLY_TAYLOR_SHIFT_BLOCK 64
+
+#define CELL(buf, i, size) ((char*)(buf) + (size_t)(i) * (size))
+
+static PolynomialError poly_store_result(const void* src, int len, Polynomial* result) {
+    PolynomialError err = poly_make_unique(result);
+    if (err != POLYNOMIAL_OK) return err;
+    size_t size = result->typeInfo->size;
+    int n = len < result->degree + 1 ? len : result->degree + 1;
+    memcpy(result->coefficients[0], src, n * size);
+    memset(CELL(result->coefficients[0], n, size), 0, (result->degree + 1 - n) * size);
+    return POLYNOMIAL_OK;
+}
+
+// The base, the power and its next value, and the largest product's scratch
+static size_t pow_bytes(const TypeInfo* ti, int baseLen, int cap, int transform) {
+    return (size_t)(2 * cap + baseLen) * ti->size + poly_mullow_raw_bytes(ti, cap, cap, cap, transform);
+}
+
+static PolynomialError poly_pow_untraced(const Polynomial* p, int k, int truncDegree, Polynomial* result) {
+    if (!p || !result) return POLYNOMIAL_NULL_PTR;
+    if (p->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (k < 0) return POLYNOMIAL_INVALID_INPUT;
+
+    long long full = (long long)p->degree * k;
+    int target = truncDegree >= 0 && truncDegree < full ? truncDegree : (int)full;
+    if (full > 0x7fffffff && truncDegree < 0) return POLYNOMIAL_INVALID_DEGREE;
+    if (result->degree < target) return POLYNOMIAL_INVALID_DEGREE;
+
+    const TypeInfo* ti = p->typeInfo;
+    size_t size = ti->size;
+    int cap = target + 1;
+
+    if (k == 0) {
+        char* one = poly_mem_calloc(1, size);
+        if (!one) return POLYNOMIAL_MEM_ALLOC_FAIL;
+        PolynomialError err = poly_one_raw(ti, one);
+        if (err == POLYNOMIAL_OK) err = poly_store_result(one, 1, result);
+        poly_mem_free(one);
+        return err;
+    }
+
+    // p may alias result, so the base is copied into scratch up front
+    int baseLen = p->degree + 1 < cap ? p->degree + 1 : cap;
+    PolynomialError err = poly_mem_check(pow_bytes(ti, baseLen, cap, 0) + poly_unique_bytes(result));
+    if (err != POLYNOMIAL_OK) return err;
+    char* scratch = poly_mem_alloc((size_t)(2 * cap + baseLen) * size);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* base = scratch;
+    char* acc = base + (size_t)baseLen * size;
+    char* tmp = acc + (size_t)cap * size;
+    memcpy(base, p->coefficients[0], baseLen * size);
+    memcpy(acc, base, baseLen * size);
+    int accLen = baseLen;
+
+    // left-to-right binary exponentiation: square, then multiply by the small base
+    int bit = 30;
+    while (!((k >> bit) & 1)) bit--;
+
+    for (bit--; bit >= 0 && err == POLYNOMIAL_OK; bit--) {
+        int len = 2 * accLen - 1 < cap ? 2 * accLen - 1 : cap;
+        err = poly_mullow_raw(ti, acc, accLen, acc, accLen, tmp, len);
+        char* swap = acc; acc = tmp; tmp = swap;
+        accLen = len;
+
+        if (err == POLYNOMIAL_OK && ((k >> bit) & 1)) {
+            len = accLen + baseLen - 1 < cap ? accLen + baseLen - 1 : cap;
+            err = poly_mullow_raw(ti, acc, accLen, base, baseLen, tmp, len);
+            swap = acc; acc = tmp; tmp = swap;
+            accLen = len;
+        }
+    }
+
+    if (err == POLYNOMIAL_OK) err = poly_store_result(acc, accLen, result);
+    poly_mem_free(scratch);
+    return err;
+}
+
+size_t poly_pow_peak_bytes(const Polynomial* p, int k, int truncDegree, const Polynomial* result) {
+    if (!p || !result || k < 0) return 0;
+    long long full = (long long)p->degree * k;
+    if (full > 0x7fffffff && truncDegree < 0) return 0;
+    int cap = (truncDegree >= 0 && truncDegree < full ? truncDegree : (int)full) + 1;
+    if (k == 0) return p->typeInfo->size + poly_unique_bytes(result);
+    int baseLen = p->degree + 1 < cap ? p->degree + 1 : cap;
+    return pow_bytes(p->typeInfo, baseLen, cap, 1) + poly_unique_bytes(result);
+}
+
+// Each traced operation is its untraced body inside a trace span and a
+// memory scope
+PolynomialError poly_pow(const Polynomial* p, int k, int truncDegree, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_POW, p ? p->typeInfo : NULL);
+    PolynomialError err = poly_pow_untraced(p, k, truncDegree, result);
+    poly_trace_end(&span, POLY_TRACE_POW, p, NULL, truncDegree, k, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
+// r = p(q) by Horner's rule with polynomial steps: r = r * q + p_i
+static PolynomialError poly_compose_horner(const TypeInfo* ti, const char* p, int n, const char* q, int m,
+                                           char** r, char** tmp, int* outLen) {
+    size_t size = ti->size;
+    memcpy(*r, CELL(p, n, size), size);
+    int len = 1;
+
+    for (int i = n - 1; i >= 0; i--) {
+        PolynomialError err = poly_mullow_raw(ti, *r, len, q, m + 1, *tmp, len + m);
+        if (err != POLYNOMIAL_OK) return err;
+        poly_add_raw(ti, *tmp, CELL(p, i, size), 1);
+        len += m;
+        char* swap = *r; *r = *tmp; *tmp = swap;
+    }
+
+    *outLen = len;
+    return POLYNOMIAL_OK;
+}
+
+// Brent-Kung baby-step/giant-step: p is split into t blocks of s coefficients,
+// each block is a linear combination of the baby steps q^1..q^(s-1), and the
+// blocks are combined by Horner's rule in the giant step Q = q^s.
+static PolynomialError poly_compose_brent_kung(const TypeInfo* ti, const char* p, int n, const char* q, int m,
+                                               char** r, char** tmp, int* outLen) {
+    size_t size = ti->size;
+    int s = (int)ceil(sqrt((double)(n + 1)));
+    int t = (n + s) / s;
+    int blockLen = (s - 1) * m + 1;
+    int giantLen = s * m + 1;
+
+    // q^j lives in slot j-1, every slot is giantLen coefficients wide
+    char* powers = poly_mem_alloc((size_t)s * giantLen * size);
+    char* block = poly_mem_alloc((size_t)blockLen * size);
+    if (!powers || !block) {
+        poly_mem_free(powers);
+        poly_mem_free(block);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    PolynomialError err = POLYNOMIAL_OK;
+    memcpy(powers, q, (m + 1) * size);
+    for (int j = 2; j <= s && err == POLYNOMIAL_OK; j++) {
+        err = poly_mullow_raw(ti, CELL(powers, (size_t)(j - 2) * giantLen, size), (j - 1) * m + 1,
+                              q, m + 1, CELL(powers, (size_t)(j - 1) * giantLen, size), j * m + 1);
+    }
+    const char* giant = CELL(powers, (size_t)(s - 1) * giantLen, size);
+
+    int len = 0;
+    for (int i = t - 1; i >= 0 && err == POLYNOMIAL_OK; i--) {
+        // block = sum_j p[i*s + j] * q^j
+        memset(block, 0, blockLen * size);
+        memcpy(block, CELL(p, i * s, size), size);
+        for (int j = 1; j < s && i * s + j <= n && err == POLYNOMIAL_OK; j++) {
+            err = poly_axpy_raw(ti, block, CELL(powers, (size_t)(j - 1) * giantLen, size), j * m + 1,
+                                CELL(p, i * s + j, size));
+        }
+        if (err != POLYNOMIAL_OK) break;
+
+        if (i == t - 1) {
+            memcpy(*r, block, blockLen * size);
+            len = blockLen;
+        } else {
+            err = poly_mullow_raw(ti, *r, len, giant, giantLen, *tmp, len + giantLen - 1);
+            if (err != POLYNOMIAL_OK) break;
+            len += giantLen - 1;
+            poly_add_raw(ti, *tmp, block, blockLen);
+            char* swap = *r; *r = *tmp; *tmp = swap;
+        }
+    }
+
+    poly_mem_free(powers);
+    poly_mem_free(block);
+    *outLen = len;
+    return err;
+}
+
+// Brent-Kung overshoots the final length by up to one block; the result
+// is sized for the worst case
+static int compose_cap(int n, int m) {
+    int s = (int)ceil(sqrt((double)(n + 1)));
+    int t = (n + s) / s;
+    int cap = (t * s - 1) * m + 1;
+    return cap < n * m + 1 ? n * m + 1 : cap;
+}
+
+// The result and its next value, the copied inputs and the largest
+// product's scratch, plus the powers of q and a block for Brent-Kung
+static size_t compose_bytes(const TypeInfo* ti, int n, int m, int brentKung, int transform) {
+    size_t size = ti->size;
+    int cap = compose_cap(n, m);
+    size_t bytes = (size_t)(2 * cap + n + m + 2) * size;
+    if (!brentKung) return bytes + poly_mullow_raw_bytes(ti, cap, m + 1, cap, transform);
+
+    int s = (int)ceil(sqrt((double)(n + 1)));
+    int giantLen = s * m + 1;
+    size_t product = poly_mullow_raw_bytes(ti, cap, giantLen, cap, transform);
+    // poly_axpy_raw's two temporaries for types without a kernel
+    size_t axpy = poly_kernel_type(ti) == POLY_KERNEL_GENERIC ? 2 * size : 0;
+    bytes += ((size_t)s * giantLen + (size_t)(s - 1) * m + 1) * size;
+    return bytes + (product > axpy ? product : axpy);
+}
+
+static PolynomialError poly_compose_untraced(const Polynomial* p, const Polynomial* q, Polynomial* result) {
+    if (!p || !q || !result) return POLYNOMIAL_NULL_PTR;
+    if (p->typeInfo != q->typeInfo || p->typeInfo != result->typeInfo)
+        return POLYNOMIAL_TYPE_MISMATCH;
+    if (result->degree < p->degree * q->degree) return POLYNOMIAL_INVALID_DEGREE;
+
+    const TypeInfo* ti = p->typeInfo;
+    size_t size = ti->size;
+    int n = p->degree;
+    int m = q->degree;
+
+    int cap = compose_cap(n, m);
+
+    // Brent-Kung keeps s powers of q; when they would not fit, Horner's
+    // rule needs none
+    size_t unique = poly_unique_bytes(result);
+    int brentKung = n >= POLY_COMPOSE_BK_THRESHOLD && m > 0 && poly_mem_fits(compose_bytes(ti, n, m, 1, 0) + unique);
+    PolynomialError err = poly_mem_check(compose_bytes(ti, n, m, brentKung, 0) + unique);
+    if (err != POLYNOMIAL_OK) return err;
+
+    // inputs are copied first so that result may alias p or q
+    char* scratch = poly_mem_alloc((size_t)(2 * cap + n + m + 2) * size);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* r = scratch;
+    char* tmp = r + (size_t)cap * size;
+    char* pc = tmp + (size_t)cap * size;
+    char* qc = pc + (size_t)(n + 1) * size;
+    memcpy(pc, p->coefficients[0], (n + 1) * size);
+    memcpy(qc, q->coefficients[0], (m + 1) * size);
+
+    int len = 0;
+    if (brentKung) {
+        err = poly_compose_brent_kung(ti, pc, n, qc, m, &r, &tmp, &len);
+    } else {
+        err = poly_compose_horner(ti, pc, n, qc, m, &r, &tmp, &len);
+    }
+
+    if (err == POLYNOMIAL_OK) err = poly_store_result(r, len, result);
+    poly_mem_free(scratch);
+    return err;
+}
+
+size_t poly_compose_peak_bytes(const Polynomial* p, const Polynomial* q, const Polynomial* result) {
+    if (!p || !q || !result) return 0;
+    int brentKung = p->degree >= POLY_COMPOSE_BK_THRESHOLD && q->degree > 0;
+    return compose_bytes(p->typeInfo, p->degree, q->degree, brentKung, 1) + poly_unique_bytes(result);
+}
+
+PolynomialError poly_compose(const Polynomial* p, const Polynomial* q, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_COMPOSE, p ? p->typeInfo : NULL);
+    PolynomialError err = poly_compose_untraced(p, q, result);
+    poly_trace_end(&span, POLY_TRACE_COMPOSE, p, q, q ? q->degree : -1, 0, err);
+    poly_mem_leave(&scope);
+    return err;
+}
+
+// c(x) <- c(x + a) in place by Horner's rule. Allocation-free for the
+// built-in types; below the convolution threshold the whole array stays
+// resident in L1, so no further blocking is done.
+static PolynomialError taylor_shift_horner_raw(const TypeInfo* ti, void* c, int n, const void* a) {
+    switch (poly_kernel_type(ti)) {
+#define POLY_SHIFT_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_taylor_shift(c, n, *(const T*)a); \
+        return POLYNOMIAL_OK;
+    POLY_BUILTIN_TYPES(POLY_SHIFT_CASE)
+#undef POLY_SHIFT_CASE
+    default:
+        break;
+    }
+
+    size_t size = ti->size;
+    void* term = poly_mem_alloc(size);
+    if (!term) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    for (int k = 0; k < n - 1; k++) {
+        for (int j = n - 2; j >= k; j--) {
+            ti->multiply(a, CELL(c, j + 1, size), term);
+            ti->add(CELL(c, j, size), term, CELL(c, j, size));
+        }
+    }
+    poly_mem_free(term);
+    return POLYNOMIAL_OK;
+}
+
+// Modular shift in O(M(n)): with u_i = c_i i! and v_j = a^j / j!,
+// k! b_k = sum_i u_i v_(i-k), a correlation computed as one product.
+static PolynomialError taylor_shift_factorial_modint(ModInt* c, int n, ModInt a) {
+    ModInt* scratch = poly_mem_alloc((size_t)4 * n * sizeof(ModInt));
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    ModInt* fact = scratch;
+    ModInt* invFact = fact + n;
+    ModInt* u = invFact + n;
+    ModInt* v = u + n;
+
+    fact[0] = 1;
+    for (int i = 1; i < n; i++) fact[i] = modint_k_mul(fact[i - 1], (ModInt)i);
+    invFact[n - 1] = modint_inverse(fact[n - 1]);
+    for (int i = n - 1; i > 0; i--) invFact[i - 1] = modint_k_mul(invFact[i], (ModInt)i);
+
+    ModInt power = 1;
+    for (int i = 0; i < n; i++) {
+        u[n - 1 - i] = modint_k_mul(c[i], fact[i]);
+        v[i] = modint_k_mul(power, invFact[i]);
+        power = modint_k_mul(power, a);
+    }
+
+    PolynomialError err = poly_mullow_raw(GetModIntTypeInfo(), u, n, v, n, c, n);
+    if (err == POLYNOMIAL_OK) {
+        // c now holds the reversed correlation, undo the reversal in u
+        memcpy(u, c, n * sizeof(ModInt));
+        for (int k = 0; k < n; k++) c[k] = modint_k_mul(u[n - 1 - k], invFact[k]);
+    }
+
+    poly_mem_free(scratch);
+    return err;
+}
+
+// Divide and conquer over any ring: blocks of B coefficients are shifted by
+// Horner, then neighbouring blocks merge as lo(x + a) + (x + a)^L hi(x + a),
+// doubling L each level. Costs O(M(n) log n) and needs no division.
+static PolynomialError taylor_shift_divide_conquer(const TypeInfo* ti, void* c, int n, const void* a) {
+    size_t size = ti->size;
+    int block = POLY_TAYLOR_SHIFT_BLOCK;
+    int total = block;
+    while (total < n) total <<= 1;
+
+    char* scratch = poly_mem_calloc((size_t)total * 3 + 2 * (total + 1), size);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* buf = scratch;
+    char* tmp = CELL(buf, total, size);
+    char* power = CELL(tmp, 2 * total, size);
+    char* nextPower = CELL(power, total + 1, size);
+    memcpy(buf, c, n * size);
+
+    PolynomialError err = POLYNOMIAL_OK;
+    for (int o = 0; o < total && err == POLYNOMIAL_OK; o += block) {
+        err = taylor_shift_horner_raw(ti, CELL(buf, o, size), block, a);
+    }
+
+    // (x + a)^block is the Horner shift of x^block
+    if (err == POLYNOMIAL_OK) err = poly_one_raw(ti, CELL(power, block, size));
+    if (err == POLYNOMIAL_OK) err = taylor_shift_horner_raw(ti, power, block + 1, a);
+
+    for (int len = block; len < total && err == POLYNOMIAL_OK; len <<= 1) {
+        for (int o = 0; o < total && err == POLYNOMIAL_OK; o += 2 * len) {
+            err = poly_mullow_raw(ti, power, len + 1, CELL(buf, o + len, size), len, tmp, 2 * len);
+            if (err != POLYNOMIAL_OK) break;
+            poly_add_raw(ti, tmp, CELL(buf, o, size), len);
+            memcpy(CELL(buf, o, size), tmp, 2 * len * size);
+        }
+        if (err == POLYNOMIAL_OK && 2 * len < total) {
+            err = poly_mullow_raw(ti, power, len + 1, power, len + 1, nextPower, 2 * len + 1);
+            char* swap = power; power = nextPower; nextPower = swap;
+        }
+    }
+
+    if (err == POLYNOMIAL_OK) memcpy(c, buf, n * size);
+    poly_mem_free(scratch);
+    return err;
+}
+
+static PolynomialError poly_taylor_shift_unscoped(const Polynomial* p, const void* a, Polynomial* result) {
+    if (!p || !a || !result) return POLYNOMIAL_NULL_PTR;
+    if (p->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (result->degree < p->degree) return POLYNOMIAL_INVALID_DEGREE;
+
+    const TypeInfo* ti = p->typeInfo;
+    void* av = poly_mem_alloc(ti->size);
+    if (!av) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    // a may point into result, which is about to be overwritten
+    memcpy(av, a, ti->size);
+
+    PolynomialError err = poly_copy_coeffs(p, result);
+    int n = p->degree + 1;
+    void* c = result->coefficients[0];
+    PolyKernelType type = poly_kernel_type(ti);
+
+    if (err != POLYNOMIAL_OK) {
+        // nothing to do
+    } else if (p->degree < POLY_TAYLOR_SHIFT_THRESHOLD || type == POLY_KERNEL_GENERIC) {
+        err = taylor_shift_horner_raw(ti, c, n, av);
+    } else if (type == POLY_KERNEL_modint && (unsigned)n < MODINT_MODULUS) {
+        err = taylor_shift_factorial_modint(c, n, *(const ModInt*)av);
+    } else {
+        err = taylor_shift_divide_conquer(ti, c, n, av);
+    }
+
+    poly_mem_free(av);
+    return err;
+}
+
+PolynomialError poly_taylor_shift(const Polynomial* p, const void* a, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_COMPOSE, p ? p->typeInfo : NULL);
+    PolynomialError status = poly_taylor_shift_unscoped(p, a, result);
+    poly_trace_end(&span, POLY_TRACE_TAYLOR_SHIFT, p, NULL, -1, 0, status);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+static PolynomialError poly_scale_var_untraced(const Polynomial* p, const void* c, Polynomial* result) {
+    if (!p || !c || !result) return POLYNOMIAL_NULL_PTR;
+    if (p->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (result->degree < p->degree) return POLYNOMIAL_INVALID_DEGREE;
+    PolynomialError unique = poly_make_unique(result);
+    if (unique != POLYNOMIAL_OK) return unique;
+
+    const TypeInfo* ti = p->typeInfo;
+    size_t size = ti->size;
+    int n = p->degree + 1;
+
+    // c may point into result, keep a copy alongside the running power
+    char* scratch = poly_mem_alloc(3 * size);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* s = scratch;
+    char* power = scratch + size;
+    char* term = scratch + 2 * size;
+    memcpy(s, c, size);
+
+    switch (poly_kernel_type(ti)) {
+#define POLY_SCALE_VAR_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        NAME##_kernel_scale_var(POLY_COEFFS(p, const T), n, *(const T*)s, POLY_COEFFS(result, T)); \
+        break;
+    POLY_BUILTIN_TYPES(POLY_SCALE_VAR_CASE)
+#undef POLY_SCALE_VAR_CASE
+    default:
+        // the generic path has no multiplicative identity, start at x^1
+        if (result != p) memcpy(result->coefficients[0], p->coefficients[0], size);
+        memcpy(power, s, size);
+        for (int i = 1; i < n; i++) {
+            ti->multiply(p->coefficients[i], power, term);
+            memcpy(result->coefficients[i], term, size);
+            ti->multiply(power, s, term);
+            memcpy(power, term, size);
+        }
+        break;
+    }
+
+    memset(CELL(result->coefficients[0], n, size), 0, (result->degree + 1 - n) * size);
+    poly_mem_free(scratch);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_scale_var(const Polynomial* p, const void* c, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolynomialError err = poly_scale_var_untraced(p, c, result);
+    poly_trace_end(&span, POLY_TRACE_SCALE_VAR, p, NULL, -1, 0, err);
+    return err;
+}
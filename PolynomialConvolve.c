@@ -0,0 +1,207 @@
+#include "PolynomialConvolve.h"
+#include "PolynomialJob.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Outputs per register tile: 16 ints in four SSE registers, 8 Complex
+// values as four registers each of real and imaginary parts, and 8
+// 64-bit values in general registers (SSE2 has no 64-bit multiply)
+#define CONV_TILE 16
+#define CONV_TILE_COMPLEX 8
+#define CONV_TILE_WIDE 8
+// Padded copies of b up to this many elements live on the stack
+#define CONV_STACK_PAD 1024
+
+// The a indices whose terms reach outputs [o, o + tile)
+static void conv_tile_range(int o, int tile, int na, int nb, int* lo, int* hi) {
+    *lo = o - nb + 1 > 0 ? o - nb + 1 : 0;
+    *hi = o + tile - 1 < na - 1 ? o + tile - 1 : na - 1;
+}
+
+// Tiles between two polls of the current job
+static int conv_tiles_per_check(int na, int tile) {
+    return 1 + POLY_JOB_CHECK_WORK / (na * tile > 0 ? na * tile : 1);
+}
+
+// b with tile zeros on each side, so that the window b[o - i .. o - i + tile)
+// is always in bounds; falls back to the heap when the stack buffer is short
+#define CONV_PAD_B(T, padded, stack, b, nb, tile) \
+    T* padded = (nb) + 2 * (tile) <= CONV_STACK_PAD ? (stack) : poly_mem_alloc(((nb) + 2 * (tile)) * sizeof(T)); \
+    if (padded) { \
+        memset(padded, 0, (tile) * sizeof(T)); \
+        memcpy(padded + (tile), (b), (nb) * sizeof(T)); \
+        memset(padded + (tile) + (nb), 0, (tile) * sizeof(T)); \
+    }
+
+// Scalar kernel for 64-bit accumulators; the unrolled tile keeps acc out
+// of memory
+#define CONV_DEFINE_INTEGER(LINKAGE, NAME, TIN, TACC) \
+LINKAGE void NAME(TACC* out, int nout, const TIN* a, int na, const TIN* b, int nb) { \
+    if (na > nout) na = nout; \
+    if (nb > nout) nb = nout; \
+    TIN stack[CONV_STACK_PAD]; \
+    CONV_PAD_B(TIN, padded, stack, b, nb, CONV_TILE_WIDE) \
+    if (!padded) { \
+        /* no room for the padded copy: one output at a time */ \
+        for (int k = 0; k < nout; k++) { \
+            int lo, hi; \
+            conv_tile_range(k, 1, na, nb, &lo, &hi); \
+            TACC sum = 0; \
+            for (int i = lo; i <= hi; i++) sum += (TACC)a[i] * b[k - i]; \
+            out[k] = sum; \
+        } \
+        return; \
+    } \
+    const TIN* bp = padded + CONV_TILE_WIDE; \
+    int tilesPerCheck = conv_tiles_per_check(na, CONV_TILE_WIDE); \
+    for (int o = 0, tile = 0; o < nout; o += CONV_TILE_WIDE, tile++) { \
+        if (tile % tilesPerCheck == 0 && poly_job_checkpoint(o, nout)) break; \
+        TACC acc[CONV_TILE_WIDE] = {0}; \
+        int lo, hi; \
+        conv_tile_range(o, CONV_TILE_WIDE, na, nb, &lo, &hi); \
+        for (int i = lo; i <= hi; i++) { \
+            TACC ai = a[i]; \
+            const TIN* window = bp + o - i; \
+            _Pragma("GCC unroll 8") \
+            for (int t = 0; t < CONV_TILE_WIDE; t++) acc[t] += ai * window[t]; \
+        } \
+        int count = nout - o < CONV_TILE_WIDE ? nout - o : CONV_TILE_WIDE; \
+        for (int t = 0; t < count; t++) out[o + t] = acc[t]; \
+    } \
+    if (padded != stack) poly_mem_free(padded); \
+}
+
+// GCC vector types hold the accumulators, one register per 16 bytes
+typedef unsigned ConvU32x4 __attribute__((vector_size(16)));
+typedef double ConvF64x2 __attribute__((vector_size(16)));
+
+static inline ConvU32x4 conv_load_u32(const unsigned* p) {
+    ConvU32x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline ConvF64x2 conv_load_f64(const double* p) {
+    ConvF64x2 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+CONV_DEFINE_INTEGER(static, conv_uint64, uint64_t, uint64_t)
+
+// Signed overflow would be undefined, so the int kernel accumulates in
+// unsigned arithmetic, which wraps to the same bits
+void poly_convolve_int(int* out, int nout, const int* a, int na, const int* b, int nb) {
+    if (na > nout) na = nout;
+    if (nb > nout) nb = nout;
+    unsigned stack[CONV_STACK_PAD];
+    CONV_PAD_B(unsigned, padded, stack, b, nb, CONV_TILE)
+    if (!padded) {
+        int_kernel_mullow(out, nout, a, na, b, nb);
+        return;
+    }
+    const unsigned* bp = padded + CONV_TILE;
+    const unsigned* ua = (const unsigned*)a;
+    int tilesPerCheck = conv_tiles_per_check(na, CONV_TILE);
+    for (int o = 0, tile = 0; o < nout; o += CONV_TILE, tile++) {
+        if (tile % tilesPerCheck == 0 && poly_job_checkpoint(o, nout)) break;
+        ConvU32x4 acc0 = {0}, acc1 = {0}, acc2 = {0}, acc3 = {0};
+        int lo, hi;
+        conv_tile_range(o, CONV_TILE, na, nb, &lo, &hi);
+        for (int i = lo; i <= hi; i++) {
+            ConvU32x4 ai = (ConvU32x4){0} + ua[i];
+            const unsigned* window = bp + o - i;
+            acc0 += ai * conv_load_u32(window);
+            acc1 += ai * conv_load_u32(window + 4);
+            acc2 += ai * conv_load_u32(window + 8);
+            acc3 += ai * conv_load_u32(window + 12);
+        }
+        unsigned acc[CONV_TILE];
+        memcpy(acc, &acc0, sizeof(acc0));
+        memcpy(acc + 4, &acc1, sizeof(acc1));
+        memcpy(acc + 8, &acc2, sizeof(acc2));
+        memcpy(acc + 12, &acc3, sizeof(acc3));
+        int count = nout - o < CONV_TILE ? nout - o : CONV_TILE;
+        memcpy(out + o, acc, count * sizeof(int));
+    }
+    if (padded != stack) poly_mem_free(padded);
+}
+
+void poly_convolve_int64(int64_t* out, int nout, const int64_t* a, int na, const int64_t* b, int nb) {
+    conv_uint64((uint64_t*)out, nout, (const uint64_t*)a, na, (const uint64_t*)b, nb);
+}
+
+// The caller has bounded the products and sums to 64 bits
+CONV_DEFINE_INTEGER(, poly_convolve_int_wide, int, int64_t)
+
+void poly_convolve_complex(Complex* out, int nout, const Complex* a, int na, const Complex* b, int nb) {
+    if (na > nout) na = nout;
+    if (nb > nout) nb = nout;
+    // b split into real and imaginary parts, each padded
+    const int tile = CONV_TILE_COMPLEX;
+    double stack[CONV_STACK_PAD];
+    int padLength = nb + 2 * tile;
+    double* re = 2 * padLength <= CONV_STACK_PAD ? stack : poly_mem_alloc(2 * padLength * sizeof(double));
+    if (!re) {
+        complex_kernel_mullow(out, nout, a, na, b, nb);
+        return;
+    }
+    double* im = re + padLength;
+    memset(re, 0, 2 * padLength * sizeof(double));
+    for (int j = 0; j < nb; j++) {
+        re[tile + j] = b[j].real;
+        im[tile + j] = b[j].imag;
+    }
+
+    int tilesPerCheck = conv_tiles_per_check(na, tile);
+    for (int o = 0, t0 = 0; o < nout; o += tile, t0++) {
+        if (t0 % tilesPerCheck == 0 && poly_job_checkpoint(o, nout)) break;
+        ConvF64x2 re0 = {0}, re1 = {0}, re2 = {0}, re3 = {0};
+        ConvF64x2 im0 = {0}, im1 = {0}, im2 = {0}, im3 = {0};
+        int lo, hi;
+        conv_tile_range(o, tile, na, nb, &lo, &hi);
+        for (int i = lo; i <= hi; i++) {
+            ConvF64x2 ar = (ConvF64x2){0} + a[i].real;
+            ConvF64x2 ai = (ConvF64x2){0} + a[i].imag;
+            const double* wr = re + tile + o - i;
+            const double* wi = im + tile + o - i;
+            ConvF64x2 r0 = conv_load_f64(wr), r1 = conv_load_f64(wr + 2);
+            ConvF64x2 r2 = conv_load_f64(wr + 4), r3 = conv_load_f64(wr + 6);
+            ConvF64x2 i0 = conv_load_f64(wi), i1 = conv_load_f64(wi + 2);
+            ConvF64x2 i2 = conv_load_f64(wi + 4), i3 = conv_load_f64(wi + 6);
+            re0 += ar * r0 - ai * i0;
+            re1 += ar * r1 - ai * i1;
+            re2 += ar * r2 - ai * i2;
+            re3 += ar * r3 - ai * i3;
+            im0 += ar * i0 + ai * r0;
+            im1 += ar * i1 + ai * r1;
+            im2 += ar * i2 + ai * r2;
+            im3 += ar * i3 + ai * r3;
+        }
+        double accRe[CONV_TILE_COMPLEX], accIm[CONV_TILE_COMPLEX];
+        memcpy(accRe, &re0, sizeof(re0));
+        memcpy(accRe + 2, &re1, sizeof(re1));
+        memcpy(accRe + 4, &re2, sizeof(re2));
+        memcpy(accRe + 6, &re3, sizeof(re3));
+        memcpy(accIm, &im0, sizeof(im0));
+        memcpy(accIm + 2, &im1, sizeof(im1));
+        memcpy(accIm + 4, &im2, sizeof(im2));
+        memcpy(accIm + 6, &im3, sizeof(im3));
+        int count = nout - o < tile ? nout - o : tile;
+        for (int t = 0; t < count; t++) {
+            out[o + t].real = accRe[t];
+            out[o + t].imag = accIm[t];
+        }
+    }
+    if (re != stack) poly_mem_free(re);
+}
+
+// The padded copy of b, counted with the widest tile; copies that fit the
+// smallest of the kernels' stack buffers allocate nothing
+size_t poly_convolve_bytes(int nb, int nout, size_t size) {
+    if (nb > nout) nb = nout;
+    size_t padded = (size_t)(nb + 2 * CONV_TILE) * size;
+    return padded <= CONV_STACK_PAD * sizeof(unsigned) ? 0 : padded;
+}
@@ -0,0 +1,30 @@
+#ifndef POLYNOMIAL_CONVOLVE_H
+#define POLYNOMIAL_CONVOLVE_H
+
+#include "Complex.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Direct convolution kernels for the range below the FFT/NTT crossovers.
+// Each computes out[0..nout) = (a * b) mod x^nout one tile of outputs at
+// a time: the tile's accumulators stay in registers while every a[i] that
+// reaches it is multiplied into a contiguous window of a zero-padded copy
+// of b, so the inner loop runs along the output index with no bounds
+// checks and vectorizes. Tiles are cut short only at the end of out.
+//
+// out must not alias the inputs. Like the other kernels they poll the
+// current job between tiles and stop early if it is cancelled.
+
+// Operands shorter than this gain nothing from tiling
+#define POLY_CONVOLVE_MIN 8
+
+// int products wrap exactly like int_kernel_mullow
+void poly_convolve_int(int* out, int nout, const int* a, int na, const int* b, int nb);
+// int inputs with 64-bit accumulators and results
+void poly_convolve_int_wide(int64_t* out, int nout, const int* a, int na, const int* b, int nb);
+void poly_convolve_int64(int64_t* out, int nout, const int64_t* a, int na, const int64_t* b, int nb);
+void poly_convolve_complex(Complex* out, int nout, const Complex* a, int na, const Complex* b, int nb);
+// Bytes any of them allocates at most for b's length and coefficient size
+size_t poly_convolve_bytes(int nb, int nout, size_t size);
+
+#endif
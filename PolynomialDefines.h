@@ -13,6 +13,7 @@ typedef enum {
     POLYNOMIAL_INVALID_INPUT = 500,
     POLYNOMIAL_CALC_ERROR = 600,
     POLYNOMIAL_NOT_EQUAL = 700,
+    POLYNOMIAL_CANCELLED = 800,
     POLYNOMIAL_EQUAL = 0
 } PolynomialError;
 
@@ -30,6 +31,7 @@ static const PolynomialErrorInfo ERROR_TABLE[] = {
     {POLYNOMIAL_INVALID_INPUT, "Invalid input"},
     {POLYNOMIAL_CALC_ERROR, "Calculation error"},
     {POLYNOMIAL_NOT_EQUAL, "Polynomials are not equal"},
+    {POLYNOMIAL_CANCELLED, "Operation cancelled"},
     {POLYNOMIAL_EQUAL, "Polynomials are equal"}
 };
 
@@ -0,0 +1,521 @@
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include "PolynomialDisk.h"
+#include "PolynomialJob.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "Integer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Block pairs read ahead of the computation, and finished blocks waiting
+// to be written
+#define DISK_READ_AHEAD 2
+#define DISK_WRITE_BEHIND 2
+// Buffers per block of the budget: the read-ahead pairs, the product, the
+// accumulator and carry, the write-behind blocks and FFT/NTT scratch
+#define DISK_BLOCKS_PER_BUDGET 16
+
+static double disk_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static PolynomialError disk_pread_all(int fd, void* buf, size_t bytes, off_t offset) {
+    char* p = buf;
+    while (bytes > 0) {
+        ssize_t got = pread(fd, p, bytes, offset);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return POLYNOMIAL_CALC_ERROR;
+        p += got;
+        bytes -= got;
+        offset += got;
+    }
+    return POLYNOMIAL_OK;
+}
+
+static PolynomialError disk_pwrite_all(int fd, const void* buf, size_t bytes, off_t offset) {
+    const char* p = buf;
+    while (bytes > 0) {
+        ssize_t put = pwrite(fd, p, bytes, offset);
+        if (put < 0 && errno == EINTR) continue;
+        if (put <= 0) return POLYNOMIAL_CALC_ERROR;
+        p += put;
+        bytes -= put;
+        offset += put;
+    }
+    return POLYNOMIAL_OK;
+}
+
+static DiskPolynomial* disk_poly_wrap(int fd, const TypeInfo* typeInfo, int64_t degree, PolynomialError* err) {
+    DiskPolynomial* poly = poly_mem_alloc(sizeof(DiskPolynomial));
+    if (!poly) {
+        close(fd);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    poly->fd = fd;
+    poly->degree = degree;
+    poly->typeInfo = typeInfo;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    if (err) *err = POLYNOMIAL_OK;
+    return poly;
+}
+
+DiskPolynomial* disk_poly_create(const char* path, const TypeInfo* typeInfo, int64_t degree, PolynomialError* err) {
+    if (!path || !typeInfo) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    if (degree < 0 || degree >= INT64_MAX / (int64_t)typeInfo->size) {
+        if (err) *err = POLYNOMIAL_INVALID_DEGREE;
+        return NULL;
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, (off_t)((degree + 1) * (int64_t)typeInfo->size)) != 0) {
+        if (fd >= 0) close(fd);
+        if (err) *err = POLYNOMIAL_CALC_ERROR;
+        return NULL;
+    }
+    return disk_poly_wrap(fd, typeInfo, degree, err);
+}
+
+DiskPolynomial* disk_poly_open(const char* path, const TypeInfo* typeInfo, PolynomialError* err) {
+    if (!path || !typeInfo) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    int fd = open(path, O_RDWR);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) close(fd);
+        if (err) *err = POLYNOMIAL_CALC_ERROR;
+        return NULL;
+    }
+    if (st.st_size == 0 || st.st_size % (off_t)typeInfo->size != 0) {
+        close(fd);
+        if (err) *err = POLYNOMIAL_INVALID_INPUT;
+        return NULL;
+    }
+    return disk_poly_wrap(fd, typeInfo, st.st_size / (off_t)typeInfo->size - 1, err);
+}
+
+void disk_poly_free(DiskPolynomial* poly) {
+    if (!poly) return;
+    close(poly->fd);
+    poly_mem_free(poly);
+}
+
+static PolynomialError disk_check_range(const DiskPolynomial* poly, int64_t offset, int64_t count) {
+    if (offset < 0 || count < 0 || offset > poly->degree + 1 - count) return POLYNOMIAL_INVALID_INPUT;
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError disk_poly_write(DiskPolynomial* poly, int64_t offset, const void* coeffs, int64_t count) {
+    if (!poly || (!coeffs && count > 0)) return POLYNOMIAL_NULL_PTR;
+    PolynomialError err = disk_check_range(poly, offset, count);
+    if (err != POLYNOMIAL_OK) return err;
+    size_t size = poly->typeInfo->size;
+    return disk_pwrite_all(poly->fd, coeffs, (size_t)count * size, (off_t)(offset * (int64_t)size));
+}
+
+PolynomialError disk_poly_read(const DiskPolynomial* poly, int64_t offset, void* coeffs, int64_t count) {
+    if (!poly || (!coeffs && count > 0)) return POLYNOMIAL_NULL_PTR;
+    PolynomialError err = disk_check_range(poly, offset, count);
+    if (err != POLYNOMIAL_OK) return err;
+    size_t size = poly->typeInfo->size;
+    return disk_pread_all(poly->fd, coeffs, (size_t)count * size, (off_t)(offset * (int64_t)size));
+}
+
+/* ---- Bounded queues between the I/O threads and the computation ---- */
+
+// A ring of capacity slots owned by the caller; produced - consumed slots
+// are full. close ends the stream after the last slot, abort drops it.
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    long long produced;
+    long long consumed;
+    int capacity;
+    int closed;
+    int aborted;
+} DiskQueue;
+
+static void disk_queue_init(DiskQueue* queue, int capacity) {
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    queue->produced = queue->consumed = 0;
+    queue->capacity = capacity;
+    queue->closed = queue->aborted = 0;
+}
+
+static void disk_queue_destroy(DiskQueue* queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->changed);
+}
+
+// Slot to fill next, or -1 once aborted; *waited gets the time blocked
+static int disk_queue_reserve(DiskQueue* queue, double* waited) {
+    double start = disk_now();
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->aborted && queue->produced - queue->consumed == queue->capacity) {
+        pthread_cond_wait(&queue->changed, &queue->lock);
+    }
+    int slot = queue->aborted ? -1 : (int)(queue->produced % queue->capacity);
+    pthread_mutex_unlock(&queue->lock);
+    if (waited) *waited += disk_now() - start;
+    return slot;
+}
+
+// Slot to drain next, or -1 at the end of the stream
+static int disk_queue_take(DiskQueue* queue, double* waited) {
+    double start = disk_now();
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->aborted && !queue->closed && queue->produced == queue->consumed) {
+        pthread_cond_wait(&queue->changed, &queue->lock);
+    }
+    int slot = queue->aborted || queue->produced == queue->consumed ? -1 : (int)(queue->consumed % queue->capacity);
+    pthread_mutex_unlock(&queue->lock);
+    if (waited) *waited += disk_now() - start;
+    return slot;
+}
+
+static void disk_queue_update(DiskQueue* queue, long long* counter, int* flag) {
+    pthread_mutex_lock(&queue->lock);
+    if (counter) (*counter)++;
+    if (flag) *flag = 1;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static void disk_queue_publish(DiskQueue* queue) {
+    disk_queue_update(queue, &queue->produced, NULL);
+}
+
+static void disk_queue_release(DiskQueue* queue) {
+    disk_queue_update(queue, &queue->consumed, NULL);
+}
+
+static void disk_queue_close(DiskQueue* queue) {
+    disk_queue_update(queue, NULL, &queue->closed);
+}
+
+static void disk_queue_abort(DiskQueue* queue) {
+    disk_queue_update(queue, NULL, &queue->aborted);
+}
+
+/* ---- The blocked convolution ---- */
+
+typedef struct {
+    void* a;
+    void* b;
+    int na;
+    int nb;
+} DiskPair;
+
+typedef struct {
+    void* data;
+    int64_t offset;
+    int count;
+} DiskBlock;
+
+typedef struct {
+    const DiskPolynomial* a;
+    const DiskPolynomial* b;
+    DiskPolynomial* result;
+    const TypeInfo* typeInfo;    // of the result, which blocks are widened to
+    int block;
+    int64_t blocksA;
+    int64_t blocksB;
+    int64_t blocksOut;
+
+    DiskQueue pairs;
+    DiskPair pairSlots[DISK_READ_AHEAD];
+    void* staging;               // raw input block before widening
+    PolynomialError readError;
+    long long bytesRead;
+    double readSeconds;
+
+    DiskQueue blocks;
+    DiskBlock blockSlots[DISK_WRITE_BEHIND];
+    PolynomialError writeError;
+    long long bytesWritten;
+    double writeSeconds;
+} DiskMultiply;
+
+static int64_t disk_block_count(int64_t n, int block) {
+    return (n + block - 1) / block;
+}
+
+// Copies n coefficients, widening integers when the types differ
+static void disk_widen(const TypeInfo* from, const void* src, const TypeInfo* to, void* dst, int n) {
+    if (from == to) {
+        memcpy(dst, src, (size_t)n * to->size);
+        return;
+    }
+    int width = int_type_width(from);
+    for (int i = 0; i < n; i++) {
+        Int128 v = width == 32 ? ((const int*)src)[i] : ((const int64_t*)src)[i];
+        if (int_type_width(to) == 64) ((int64_t*)dst)[i] = (int64_t)v;
+        else ((Int128*)dst)[i] = v;
+    }
+}
+
+static PolynomialError disk_read_block(DiskMultiply* job, const DiskPolynomial* poly, int64_t index, void* out,
+                                       int* count) {
+    int64_t start = index * job->block;
+    int64_t n = poly->degree + 1 - start;
+    *count = (int)(n < job->block ? n : job->block);
+    void* raw = poly->typeInfo == job->typeInfo ? out : job->staging;
+    size_t bytes = (size_t)*count * poly->typeInfo->size;
+
+    double begin = disk_now();
+    PolynomialError err = disk_pread_all(poly->fd, raw, bytes, (off_t)(start * (int64_t)poly->typeInfo->size));
+    job->readSeconds += disk_now() - begin;
+    job->bytesRead += bytes;
+    if (err == POLYNOMIAL_OK && raw != out) disk_widen(poly->typeInfo, raw, job->typeInfo, out, *count);
+    return err;
+}
+
+// Largest |coefficient| of an integer polynomial, read block by block
+// through the staging buffer
+static PolynomialError disk_magnitude(DiskMultiply* job, const DiskPolynomial* poly, PolyUInt128* magnitude) {
+    int width = int_type_width(poly->typeInfo);
+    size_t size = poly->typeInfo->size;
+    *magnitude = 0;
+    for (int64_t start = 0; start <= poly->degree; start += job->block) {
+        int count = (int)(poly->degree + 1 - start < job->block ? poly->degree + 1 - start : job->block);
+        double begin = disk_now();
+        PolynomialError err = disk_pread_all(poly->fd, job->staging, (size_t)count * size, (off_t)(start * (int64_t)size));
+        job->readSeconds += disk_now() - begin;
+        job->bytesRead += (long long)count * size;
+        if (err != POLYNOMIAL_OK) return err;
+        for (int i = 0; i < count; i++) {
+            Int128 v = width == 32 ? ((const int*)job->staging)[i]
+                     : width == 64 ? ((const int64_t*)job->staging)[i] : ((const Int128*)job->staging)[i];
+            PolyUInt128 m = v < 0 ? (PolyUInt128)0 - (PolyUInt128)v : (PolyUInt128)v;
+            if (m > *magnitude) *magnitude = m;
+        }
+    }
+    return POLYNOMIAL_OK;
+}
+
+// Integer products are formed in the result's type, so max|a| max|b|
+// min(na, nb), which bounds every coefficient and every partial sum of one,
+// must fit it
+static PolynomialError disk_check_bound(DiskMultiply* job) {
+    PolyUInt128 magA, magB, bound;
+    PolynomialError err = disk_magnitude(job, job->a, &magA);
+    if (err == POLYNOMIAL_OK) err = disk_magnitude(job, job->b, &magB);
+    if (err != POLYNOMIAL_OK) return err;
+    int64_t shorter = job->a->degree < job->b->degree ? job->a->degree + 1 : job->b->degree + 1;
+    int width = int_type_width(job->typeInfo);
+    PolyUInt128 limit = width == 32 ? INT_MAX : width == 64 ? INT64_MAX : ((PolyUInt128)1 << 127) - 1;
+    if (__builtin_mul_overflow(magA, magB, &bound) || __builtin_mul_overflow(bound, (PolyUInt128)shorter, &bound) ||
+        bound > limit) {
+        return POLYNOMIAL_CALC_ERROR;
+    }
+    return POLYNOMIAL_OK;
+}
+
+// Output block k collects the products of blocks i and k - i, in the
+// order the computation consumes them
+static void* disk_reader_run(void* arg) {
+    DiskMultiply* job = arg;
+    for (int64_t k = 0; k < job->blocksOut && job->readError == POLYNOMIAL_OK; k++) {
+        int64_t first = k - job->blocksB + 1 > 0 ? k - job->blocksB + 1 : 0;
+        int64_t last = k < job->blocksA - 1 ? k : job->blocksA - 1;
+        for (int64_t i = first; i <= last; i++) {
+            int slot = disk_queue_reserve(&job->pairs, NULL);
+            if (slot < 0) return NULL;
+            DiskPair* pair = &job->pairSlots[slot];
+            job->readError = disk_read_block(job, job->a, i, pair->a, &pair->na);
+            if (job->readError == POLYNOMIAL_OK) job->readError = disk_read_block(job, job->b, k - i, pair->b, &pair->nb);
+            if (job->readError != POLYNOMIAL_OK) break;
+            disk_queue_publish(&job->pairs);
+        }
+    }
+    if (job->readError != POLYNOMIAL_OK) disk_queue_abort(&job->pairs);
+    else disk_queue_close(&job->pairs);
+    return NULL;
+}
+
+static void* disk_writer_run(void* arg) {
+    DiskMultiply* job = arg;
+    size_t size = job->typeInfo->size;
+    int slot;
+    while ((slot = disk_queue_take(&job->blocks, NULL)) >= 0) {
+        DiskBlock* block = &job->blockSlots[slot];
+        double begin = disk_now();
+        job->writeError = disk_pwrite_all(job->result->fd, block->data, (size_t)block->count * size,
+                                          (off_t)(block->offset * (int64_t)size));
+        job->writeSeconds += disk_now() - begin;
+        job->bytesWritten += (long long)block->count * size;
+        if (job->writeError != POLYNOMIAL_OK) {
+            disk_queue_abort(&job->blocks);
+            return NULL;
+        }
+        disk_queue_release(&job->blocks);
+    }
+    double begin = disk_now();
+    if (fdatasync(job->result->fd) != 0 && errno != EINVAL) job->writeError = POLYNOMIAL_CALC_ERROR;
+    job->writeSeconds += disk_now() - begin;
+    return NULL;
+}
+
+// Runs on the calling thread: multiplies the pairs as they arrive and
+// hands each finished output block to the writer
+static PolynomialError disk_compute(DiskMultiply* job, void* product, void* acc, void* carry, DiskIoStats* stats) {
+    const TypeInfo* typeInfo = job->typeInfo;
+    size_t size = typeInfo->size;
+    int block = job->block;
+    int64_t total = job->result->degree + 1;
+    memset(carry, 0, (size_t)block * size);
+
+    for (int64_t k = 0; k < job->blocksOut; k++) {
+        if (poly_job_checkpoint(k, job->blocksOut)) return POLYNOMIAL_CANCELLED;
+        // the high halves of the last block's products start this one
+        memcpy(acc, carry, (size_t)block * size);
+        memset(carry, 0, (size_t)block * size);
+
+        int64_t first = k - job->blocksB + 1 > 0 ? k - job->blocksB + 1 : 0;
+        int64_t last = k < job->blocksA - 1 ? k : job->blocksA - 1;
+        for (int64_t i = first; i <= last; i++) {
+            int slot = disk_queue_take(&job->pairs, &stats->stallSeconds);
+            if (slot < 0) return job->readError != POLYNOMIAL_OK ? job->readError : POLYNOMIAL_CALC_ERROR;
+            DiskPair* pair = &job->pairSlots[slot];
+            int n = pair->na + pair->nb - 1;
+            double begin = disk_now();
+            PolynomialError err = poly_mullow_raw(typeInfo, pair->a, pair->na, pair->b, pair->nb, product, n);
+            disk_queue_release(&job->pairs);
+            if (err != POLYNOMIAL_OK) return err;
+            int low = n < block ? n : block;
+            poly_add_raw(typeInfo, acc, product, low);
+            if (n > low) poly_add_raw(typeInfo, carry, (char*)product + (size_t)low * size, n - low);
+            stats->computeSeconds += disk_now() - begin;
+        }
+
+        int slot = disk_queue_reserve(&job->blocks, &stats->stallSeconds);
+        if (slot < 0) return job->writeError;
+        DiskBlock* out = &job->blockSlots[slot];
+        out->offset = k * block;
+        out->count = (int)(total - out->offset < block ? total - out->offset : block);
+        memcpy(out->data, acc, (size_t)out->count * size);
+        disk_queue_publish(&job->blocks);
+    }
+    return POLYNOMIAL_OK;
+}
+
+static int disk_block_size(const DiskMultiplyOptions* options, size_t size) {
+    if (options->blockSize > 0) return options->blockSize;
+    size_t fit = options->memoryBudget / (DISK_BLOCKS_PER_BUDGET * size);
+    if (fit > (size_t)1 << 28) fit = (size_t)1 << 28;
+    // a power of two keeps each pair product a single FFT/NTT size
+    int block = POLY_DISK_MIN_BLOCK;
+    while ((size_t)block * 2 <= fit) block *= 2;
+    return block;
+}
+
+static int disk_types_compatible(const TypeInfo* input, const TypeInfo* result) {
+    if (input == result) return 1;
+    int width = int_type_width(input);
+    return width && int_type_width(result) > width;
+}
+
+static PolynomialError disk_poly_multiply_unscoped(const DiskPolynomial* a, const DiskPolynomial* b,
+                                                   DiskPolynomial* result, const DiskMultiplyOptions* options, DiskIoStats* stats) {
+    if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
+    if (!disk_types_compatible(a->typeInfo, result->typeInfo) || !disk_types_compatible(b->typeInfo, result->typeInfo)) {
+        return POLYNOMIAL_TYPE_MISMATCH;
+    }
+    if (result->degree != a->degree + b->degree) return POLYNOMIAL_INVALID_DEGREE;
+    if (result == a || result == b || result->fd == a->fd || result->fd == b->fd) return POLYNOMIAL_INVALID_INPUT;
+
+    DiskMultiplyOptions defaults = POLY_DISK_DEFAULTS;
+    if (!options) options = &defaults;
+    DiskIoStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(DiskIoStats));
+    double start = disk_now();
+
+    DiskMultiply job;
+    memset(&job, 0, sizeof(job));
+    job.a = a;
+    job.b = b;
+    job.result = result;
+    job.typeInfo = result->typeInfo;
+    job.block = disk_block_size(options, job.typeInfo->size);
+    job.blocksA = disk_block_count(a->degree + 1, job.block);
+    job.blocksB = disk_block_count(b->degree + 1, job.block);
+    job.blocksOut = disk_block_count(result->degree + 1, job.block);
+    stats->blockSize = job.block;
+
+    // every buffer in one allocation: read-ahead pairs, write-behind
+    // blocks, staging, product (2 blocks), accumulator and carry
+    size_t size = job.typeInfo->size;
+    size_t blockBytes = (size_t)job.block * size;
+    size_t blocks = 2 * DISK_READ_AHEAD + DISK_WRITE_BEHIND + 1 + 2 + 2;
+    char* buffers = poly_mem_alloc(blocks * blockBytes);
+    if (!buffers) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* next = buffers;
+    for (int i = 0; i < DISK_READ_AHEAD; i++) {
+        job.pairSlots[i].a = next;
+        job.pairSlots[i].b = next + blockBytes;
+        next += 2 * blockBytes;
+    }
+    for (int i = 0; i < DISK_WRITE_BEHIND; i++, next += blockBytes) job.blockSlots[i].data = next;
+    job.staging = next;
+    void* product = next + blockBytes;
+    void* acc = next + 3 * blockBytes;
+    void* carry = next + 4 * blockBytes;
+
+    disk_queue_init(&job.pairs, DISK_READ_AHEAD);
+    disk_queue_init(&job.blocks, DISK_WRITE_BEHIND);
+    pthread_t reader, writer;
+    PolynomialError err = int_type_width(job.typeInfo) ? disk_check_bound(&job) : POLYNOMIAL_OK;
+    int readerStarted = err == POLYNOMIAL_OK && pthread_create(&reader, NULL, disk_reader_run, &job) == 0;
+    int writerStarted = readerStarted && pthread_create(&writer, NULL, disk_writer_run, &job) == 0;
+    if (err == POLYNOMIAL_OK && !writerStarted) err = POLYNOMIAL_MEM_ALLOC_FAIL;
+
+    if (err == POLYNOMIAL_OK) err = disk_compute(&job, product, acc, carry, stats);
+    if (err != POLYNOMIAL_OK) {
+        disk_queue_abort(&job.pairs);
+        disk_queue_abort(&job.blocks);
+    } else {
+        disk_queue_close(&job.blocks);
+    }
+    if (readerStarted) pthread_join(reader, NULL);
+    if (writerStarted) pthread_join(writer, NULL);
+    if (err == POLYNOMIAL_OK) err = job.writeError;
+
+    disk_queue_destroy(&job.pairs);
+    disk_queue_destroy(&job.blocks);
+    poly_mem_free(buffers);
+
+    stats->bytesRead = job.bytesRead;
+    stats->bytesWritten = job.bytesWritten;
+    stats->readSeconds = job.readSeconds;
+    stats->writeSeconds = job.writeSeconds;
+    stats->wallSeconds = disk_now() - start;
+    return err;
+}
+
+PolynomialError disk_poly_multiply(const DiskPolynomial* a, const DiskPolynomial* b, DiskPolynomial* result,
+                                   const DiskMultiplyOptions* options, DiskIoStats* stats) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_DISK, result ? result->typeInfo : NULL);
+    PolynomialError status = disk_poly_multiply_unscoped(a, b, result, options, stats);
+    poly_mem_leave(&scope);
+    return status;
+}
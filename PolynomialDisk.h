@@ -0,0 +1,70 @@
+#ifndef POLYNOMIAL_DISK_H
+#define POLYNOMIAL_DISK_H
+
+#include "Polynomial.h"
+#include <stdint.h>
+
+// A polynomial kept in a file rather than in memory: the coefficients, in
+// ascending order, as a flat array of typeInfo->size bytes each, with
+// nothing else in the file. Degrees are 64-bit so the file can be larger
+// than RAM; only the blocks being worked on are ever held in memory.
+typedef struct {
+    int fd;
+    int64_t degree;
+    const TypeInfo* typeInfo;
+} DiskPolynomial;
+
+// Bounds on the out-of-core multiplication. blockSize is in coefficients;
+// 0 derives it from memoryBudget, which covers every buffer the
+// multiplication and its I/O threads allocate.
+typedef struct {
+    size_t memoryBudget;
+    int blockSize;
+} DiskMultiplyOptions;
+
+#define POLY_DISK_DEFAULT_BUDGET ((size_t)256 << 20)
+#define POLY_DISK_MIN_BLOCK 64
+#define POLY_DISK_DEFAULTS {POLY_DISK_DEFAULT_BUDGET, 0}
+
+// What the multiplication did, for reporting bandwidth: read and write
+// times are those the I/O threads spent in the system calls (writes
+// include the final fdatasync), stall time is how long the computation
+// waited on them.
+typedef struct {
+    long long bytesRead;
+    long long bytesWritten;
+    double readSeconds;
+    double writeSeconds;
+    double computeSeconds;
+    double stallSeconds;
+    double wallSeconds;
+    int blockSize;
+} DiskIoStats;
+
+// Creates (or truncates) path to hold degree + 1 coefficients, all bytes
+// zero until written, which is the zero of every built-in type
+DiskPolynomial* disk_poly_create(const char* path, const TypeInfo* typeInfo, int64_t degree, PolynomialError* err);
+// Opens an existing coefficient file read-write; its size gives the degree
+DiskPolynomial* disk_poly_open(const char* path, const TypeInfo* typeInfo, PolynomialError* err);
+// Closes the file, which stays on disk
+void disk_poly_free(DiskPolynomial* poly);
+
+// Copies count coefficients starting at x^offset between the file and memory
+PolynomialError disk_poly_write(DiskPolynomial* poly, int64_t offset, const void* coeffs, int64_t count);
+PolynomialError disk_poly_read(const DiskPolynomial* poly, int64_t offset, void* coeffs, int64_t count);
+
+// result = a * b by blocked convolution: the product of each pair of input
+// blocks is formed with poly_mullow_raw and accumulated into the output
+// block it belongs to, which is written once, in order. A reader thread
+// prefetches the next pairs and a writer thread drains finished blocks
+// while the current pair is multiplied. result needs degree
+// a->degree + b->degree and the type of both inputs, except that integer
+// inputs may be narrower than an integer result; coefficients are
+// widened as they are read and products are not promoted further. Integer
+// inputs are scanned first, and when min(na, nb) max|a| max|b| does not fit
+// the result's type the product fails with POLYNOMIAL_CALC_ERROR rather
+// than wrap; a wider result holds it. stats and options may be NULL.
+PolynomialError disk_poly_multiply(const DiskPolynomial* a, const DiskPolynomial* b, DiskPolynomial* result,
+                                   const DiskMultiplyOptions* options, DiskIoStats* stats);
+
+#endif
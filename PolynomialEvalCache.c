@@ -0,0 +1,267 @@
+#include "PolynomialEvalCache.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "ThreadPool.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Points handled together: the slice's values stay in L1 while every term
+// of a pass is added into them, and each slice is one parallel index
+#define CACHE_SLICE 256
+// Updates of at most this many coefficients keep their deltas on the stack
+#define CACHE_STACK_TERMS 64
+
+typedef enum { CACHE_POWERS, CACHE_APPLY } CacheOp;
+
+// A pass over the points: either filling the power rows, or adding
+// scales[t] * row rows[t] into the values (rows NULL for 0, 1, 2, ...),
+// first zeroing them if reset is set
+typedef struct {
+    CacheOp op;
+    PolyKernelType type;
+    const PolyEvalCache* cache;
+    const int* rows;
+    const void* scales;
+    int terms;
+    int reset;
+} CacheJob;
+
+// Full slices are instantiated with the constant CACHE_SLICE as their
+// length, which lets the loops vectorize without a remainder
+#define CACHE_DEFINE_OPS(NAME, T, SUFFIX, LEN) \
+static void NAME##_cache_axpy##SUFFIX(T* restrict v, const T* restrict row, T d, int n) { \
+    (void)n; \
+    for (int k = 0; k < LEN; k++) v[k] = NAME##_k_add(v[k], NAME##_k_mul(d, row[k])); \
+} \
+\
+static void NAME##_cache_next_power##SUFFIX(T* restrict next, const T* restrict prev, const T* restrict x, int n) { \
+    (void)n; \
+    for (int k = 0; k < LEN; k++) next[k] = NAME##_k_mul(prev[k], x[k]); \
+}
+
+#define CACHE_DEFINE_KERNELS(NAME, T, GETTER) \
+    CACHE_DEFINE_OPS(NAME, T, _slice, CACHE_SLICE) \
+    CACHE_DEFINE_OPS(NAME, T, _tail, n)
+
+POLY_BUILTIN_TYPES(CACHE_DEFINE_KERNELS)
+#undef CACHE_DEFINE_KERNELS
+#undef CACHE_DEFINE_OPS
+
+#define CACHE_RUN(NAME, T, SUFFIX) \
+    if (job->op == CACHE_POWERS) { \
+        T* pw = (T*)c->powers + begin; \
+        for (int k = 0; k < n; k++) pw[k] = NAME##_k_one(); \
+        for (int i = 1; i <= c->degree; i++) \
+            NAME##_cache_next_power##SUFFIX(pw + i * stride, pw + (i - 1) * stride, (const T*)c->points + begin, n); \
+    } else { \
+        T* v = (T*)c->values + begin; \
+        if (job->reset) \
+            for (int k = 0; k < n; k++) v[k] = NAME##_k_zero(); \
+        for (int t = 0; t < job->terms; t++) { \
+            int row = job->rows ? job->rows[t] : t; \
+            NAME##_cache_axpy##SUFFIX(v, (const T*)c->powers + row * stride + begin, ((const T*)job->scales)[t], n); \
+        } \
+    }
+
+static void cache_body(void* ctx, int first, int last) {
+    const CacheJob* job = ctx;
+    const PolyEvalCache* c = job->cache;
+    size_t stride = c->count;
+    for (int slice = first; slice < last; slice++) {
+        int begin = slice * CACHE_SLICE;
+        int n = c->count - begin < CACHE_SLICE ? c->count - begin : CACHE_SLICE;
+        switch (job->type) {
+#define CACHE_CASE(NAME, T, GETTER) \
+        case POLY_KERNEL_##NAME: \
+            if (n == CACHE_SLICE) { \
+                CACHE_RUN(NAME, T, _slice) \
+            } else { \
+                CACHE_RUN(NAME, T, _tail) \
+            } \
+            break;
+        POLY_BUILTIN_TYPES(CACHE_CASE)
+#undef CACHE_CASE
+        default:
+            break;
+        }
+    }
+}
+
+#undef CACHE_RUN
+
+// Runs the slices inline, or on the shared pool when there is enough work
+static PolynomialError cache_run(CacheJob* job, int terms) {
+    int count = job->cache->count;
+    int slices = (count + CACHE_SLICE - 1) / CACHE_SLICE;
+    long long work = (long long)count * terms;
+    if (work < POLY_EVAL_CACHE_PARALLEL_WORK || slices == 1) {
+        cache_body(job, 0, slices);
+        return POLYNOMIAL_OK;
+    }
+    long long perSlice = work / slices + 1;
+    int grain = (int)(POLY_EVAL_CACHE_PARALLEL_WORK / 4 / perSlice) + 1;
+    return thread_pool_parallel_for(thread_pool_shared(), slices, grain, cache_body, job);
+}
+
+// The polynomial must still be the one the powers were built for
+static PolynomialError cache_check(const PolyEvalCache* cache) {
+    if (!cache || !cache->poly) return POLYNOMIAL_NULL_PTR;
+    if (cache->poly->typeInfo != cache->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (cache->poly->degree != cache->degree) return POLYNOMIAL_INVALID_DEGREE;
+    return POLYNOMIAL_OK;
+}
+
+static PolyEvalCache* poly_eval_cache_create_unscoped(Polynomial* poly, const void* points, int count, PolynomialError* err) {
+    if (!poly || !points) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    if (poly_kernel_type(poly->typeInfo) == POLY_KERNEL_GENERIC) {
+        if (err) *err = POLYNOMIAL_TYPE_MISMATCH;
+        return NULL;
+    }
+    size_t size = poly->typeInfo->size;
+    if (count <= 0 || (size_t)count > SIZE_MAX / size / ((size_t)poly->degree + 1)) {
+        if (err) *err = POLYNOMIAL_INVALID_INPUT;
+        return NULL;
+    }
+
+    PolyEvalCache* cache = poly_mem_calloc(1, sizeof(PolyEvalCache));
+    if (cache) {
+        cache->points = poly_mem_alloc(count * size);
+        cache->powers = poly_mem_alloc((size_t)(poly->degree + 1) * count * size);
+        cache->values = poly_mem_alloc(count * size);
+    }
+    if (!cache || !cache->points || !cache->powers || !cache->values) {
+        poly_eval_cache_free(cache);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    cache->poly = poly;
+    cache->typeInfo = poly->typeInfo;
+    cache->degree = poly->degree;
+    cache->count = count;
+    memcpy(cache->points, points, count * size);
+
+    CacheJob job = {CACHE_POWERS, poly_kernel_type(poly->typeInfo), cache, NULL, NULL, 0, 0};
+    PolynomialError status = cache_run(&job, poly->degree + 1);
+    if (status == POLYNOMIAL_OK) status = poly_eval_cache_refresh(cache);
+    if (status != POLYNOMIAL_OK) {
+        poly_eval_cache_free(cache);
+        cache = NULL;
+    }
+    if (err) *err = status;
+    return cache;
+}
+
+PolyEvalCache* poly_eval_cache_create(Polynomial* poly, const void* points, int count, PolynomialError* err) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_EVALUATE, poly ? poly->typeInfo : NULL);
+    PolyEvalCache* created = poly_eval_cache_create_unscoped(poly, points, count, err);
+    poly_mem_leave(&scope);
+    return created;
+}
+
+void poly_eval_cache_free(PolyEvalCache* cache) {
+    if (!cache) return;
+    poly_mem_free(cache->points);
+    poly_mem_free(cache->powers);
+    poly_mem_free(cache->values);
+    poly_mem_free(cache);
+}
+
+PolynomialError poly_eval_cache_refresh(PolyEvalCache* cache) {
+    PolynomialError err = cache_check(cache);
+    if (err != POLYNOMIAL_OK) return err;
+    CacheJob job = {CACHE_APPLY, poly_kernel_type(cache->typeInfo), cache, NULL, cache->poly->coefficients[0],
+                    cache->degree + 1, 1};
+    return cache_run(&job, cache->degree + 1);
+}
+
+static PolynomialError poly_eval_cache_update_unscoped(PolyEvalCache* cache, const int* indices, const void* coeffs, int count) {
+    PolynomialError err = cache_check(cache);
+    if (err != POLYNOMIAL_OK) return err;
+    if (count < 0) return POLYNOMIAL_INVALID_INPUT;
+    if (count == 0) return POLYNOMIAL_OK;
+    if (!indices || !coeffs) return POLYNOMIAL_NULL_PTR;
+    for (int t = 0; t < count; t++) {
+        if (indices[t] < 0 || indices[t] > cache->degree) return POLYNOMIAL_INVALID_INPUT;
+    }
+    err = poly_make_unique(cache->poly);
+    if (err != POLYNOMIAL_OK) return err;
+
+    size_t size = cache->typeInfo->size;
+    // a batch touching as many terms as the polynomial has is cheaper to
+    // re-evaluate than to apply
+    if (count > cache->degree) {
+        for (int t = 0; t < count; t++) {
+            memcpy(cache->poly->coefficients[indices[t]], (const char*)coeffs + t * size, size);
+        }
+        return poly_eval_cache_refresh(cache);
+    }
+
+    // every built-in type fits an Int128 slot
+    Int128 stackDeltas[CACHE_STACK_TERMS];
+    int stackRows[CACHE_STACK_TERMS];
+    void* deltas = count <= CACHE_STACK_TERMS ? (void*)stackDeltas : poly_mem_alloc(count * size);
+    int* rows = count <= CACHE_STACK_TERMS ? stackRows : poly_mem_alloc(count * sizeof(int));
+    if (!deltas || !rows) {
+        if (deltas != stackDeltas) poly_mem_free(deltas);
+        if (rows != stackRows) poly_mem_free(rows);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    // the deltas are taken in order against the coefficients as they are
+    // written, so repeated indices add up to the last value; unchanged
+    // coefficients are dropped
+    int terms = 0;
+    switch (poly_kernel_type(cache->typeInfo)) {
+#define CACHE_DELTA_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: { \
+        T* c = POLY_COEFFS(cache->poly, T); \
+        T zero = NAME##_k_zero(); \
+        for (int t = 0; t < count; t++) { \
+            T value = ((const T*)coeffs)[t]; \
+            T d = NAME##_k_sub(value, c[indices[t]]); \
+            c[indices[t]] = value; \
+            if (memcmp(&d, &zero, sizeof(T)) == 0) continue; \
+            ((T*)deltas)[terms] = d; \
+            rows[terms++] = indices[t]; \
+        } \
+        break; \
+    }
+    POLY_BUILTIN_TYPES(CACHE_DELTA_CASE)
+#undef CACHE_DELTA_CASE
+    default:
+        break;
+    }
+
+    CacheJob job = {CACHE_APPLY, poly_kernel_type(cache->typeInfo), cache, rows, deltas, terms, 0};
+    err = terms > 0 ? cache_run(&job, terms) : POLYNOMIAL_OK;
+    if (deltas != stackDeltas) poly_mem_free(deltas);
+    if (rows != stackRows) poly_mem_free(rows);
+    return err;
+}
+
+PolynomialError poly_eval_cache_update(PolyEvalCache* cache, const int* indices, const void* coeffs, int count) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_EVALUATE, cache ? cache->typeInfo : NULL);
+    PolynomialError status = poly_eval_cache_update_unscoped(cache, indices, coeffs, count);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+PolynomialError poly_eval_cache_set(PolyEvalCache* cache, int index, const void* coeff) {
+    return poly_eval_cache_update(cache, &index, coeff, 1);
+}
+
+PolynomialError poly_eval_cache_value(const PolyEvalCache* cache, int point, void* result) {
+    if (!cache || !result) return POLYNOMIAL_NULL_PTR;
+    if (point < 0 || point >= cache->count) return POLYNOMIAL_INVALID_INPUT;
+    size_t size = cache->typeInfo->size;
+    memcpy(result, (const char*)cache->values + (size_t)point * size, size);
+    return POLYNOMIAL_OK;
+}
+
+const void* poly_eval_cache_values(const PolyEvalCache* cache) {
+    return cache ? cache->values : NULL;
+}
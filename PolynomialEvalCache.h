@@ -0,0 +1,53 @@
+#ifndef POLYNOMIAL_EVAL_CACHE_H
+#define POLYNOMIAL_EVAL_CACHE_H
+
+#include "Polynomial.h"
+
+// The values of a polynomial at a fixed set of points, kept current as its
+// coefficients change. The cache holds every power x_j^i up to the degree,
+// stored row by row (power i of every point is contiguous), so changing
+// coefficient i by d adds d * x_j^i to each value: one pass over the
+// points that the compiler vectorizes, instead of a full evaluation per
+// point. Batched updates are applied together, one slice of points at a
+// time, with the slice's values kept in L1 across the whole batch.
+//
+// Only built-in types are supported, and their arithmetic is that of the
+// kernels: integer values wrap exactly as poly_evaluate's do, so they stay
+// equal to it. Complex values collect rounding error over many updates;
+// poly_eval_cache_refresh recomputes them. Memory is
+// (degree + 3) * count values.
+typedef struct {
+    Polynomial* poly;      // followed, not owned
+    const TypeInfo* typeInfo;
+    int degree;
+    int count;
+    void* points;          // count values
+    void* powers;          // (degree + 1) rows of count values, x_j^i at row i
+    void* values;          // count values, p(x_j)
+} PolyEvalCache;
+
+// Passes over the points spread over the shared thread pool above this
+// many coefficient operations
+#define POLY_EVAL_CACHE_PARALLEL_WORK (1 << 18)
+
+// Attaches a cache for the count points to poly and evaluates it there.
+// poly must keep its type and degree while the cache is attached.
+PolyEvalCache* poly_eval_cache_create(Polynomial* poly, const void* points, int count, PolynomialError* err);
+void poly_eval_cache_free(PolyEvalCache* cache);
+
+// Sets coefficients[indices[t]] = coeffs[t] for t in order (a repeated
+// index ends with its last value) and updates every cached value. Nothing
+// changes if an index is out of range. Large batches re-evaluate from the
+// cached powers instead, whichever is less work.
+PolynomialError poly_eval_cache_update(PolyEvalCache* cache, const int* indices, const void* coeffs, int count);
+PolynomialError poly_eval_cache_set(PolyEvalCache* cache, int index, const void* coeff);
+
+// Recomputes every value from the coefficients, after poly has been
+// changed other than through the cache
+PolynomialError poly_eval_cache_refresh(PolyEvalCache* cache);
+
+// p(x_point), or all count values, from the cache
+PolynomialError poly_eval_cache_value(const PolyEvalCache* cache, int point, void* result);
+const void* poly_eval_cache_values(const PolyEvalCache* cache);
+
+#endif
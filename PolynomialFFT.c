@@ -0,0 +1,191 @@
+#include "PolynomialFFT.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void bit_reverse_permute(void* data, int n, size_t size) {
+    char tmp[sizeof(Complex)];
+    char* base = data;
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            memcpy(tmp, base + i * size, size);
+            memcpy(base + i * size, base + j * size, size);
+            memcpy(base + j * size, tmp, size);
+        }
+    }
+}
+
+static int transform_length(int len) {
+    int n = 1;
+    while (n < len) n <<= 1;
+    return n;
+}
+
+static int transform_log(int n) {
+    int log = 0;
+    while ((1 << log) < n) log++;
+    return log;
+}
+
+PolynomialError poly_fft(Complex* a, int n, int invert) {
+    // twiddles e^(-2 pi i k / n) for k < n/2, computed directly for accuracy
+    Complex* roots = poly_mem_alloc((n / 2 + 1) * sizeof(Complex));
+    if (!roots) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    double angle = (invert ? 2.0 : -2.0) * acos(-1.0) / n;
+    for (int k = 0; k < n / 2; k++) {
+        roots[k].real = cos(angle * k);
+        roots[k].imag = sin(angle * k);
+    }
+
+    bit_reverse_permute(a, n, sizeof(Complex));
+    for (int len = 2, stage = 0; len <= n; len <<= 1, stage++) {
+        if (poly_job_checkpoint(stage, transform_log(n))) {
+            poly_mem_free(roots);
+            return POLYNOMIAL_CANCELLED;
+        }
+        int half = len >> 1;
+        int step = n / len;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half; k++) {
+                Complex w = roots[k * step];
+                Complex u = a[start + k];
+                Complex v = complex_k_mul(a[start + k + half], w);
+                a[start + k].real = u.real + v.real;
+                a[start + k].imag = u.imag + v.imag;
+                a[start + k + half].real = u.real - v.real;
+                a[start + k + half].imag = u.imag - v.imag;
+            }
+        }
+    }
+
+    if (invert) {
+        for (int i = 0; i < n; i++) {
+            a[i].real /= n;
+            a[i].imag /= n;
+        }
+    }
+    poly_mem_free(roots);
+    return POLYNOMIAL_OK;
+}
+
+void poly_ntt(ModInt* a, int n, int invert) {
+    bit_reverse_permute(a, n, sizeof(ModInt));
+    for (int len = 2, stage = 0; len <= n; len <<= 1, stage++) {
+        // a cancelled transform is left unfinished; callers check poly_job_cancelled
+        if (poly_job_checkpoint(stage, transform_log(n))) return;
+        int half = len >> 1;
+        ModInt wlen = modint_pow(MODINT_ROOT, (MODINT_MODULUS - 1) / len);
+        if (invert) wlen = modint_inverse(wlen);
+        for (int start = 0; start < n; start += len) {
+            ModInt w = 1;
+            for (int k = 0; k < half; k++) {
+                ModInt u = a[start + k];
+                ModInt v = modint_k_mul(a[start + k + half], w);
+                a[start + k] = modint_k_add(u, v);
+                a[start + k + half] = u >= v ? u - v : u + MODINT_MODULUS - v;
+                w = modint_k_mul(w, wlen);
+            }
+        }
+    }
+
+    if (invert) {
+        ModInt scale = modint_inverse((ModInt)n);
+        for (int i = 0; i < n; i++) a[i] = modint_k_mul(a[i], scale);
+    }
+}
+
+PolynomialError poly_fft_mullow_complex(const Complex* a, int na, const Complex* b, int nb, Complex* out, int nout) {
+    if (na > nout) na = nout;
+    if (nb > nout) nb = nout;
+    int n = transform_length(na + nb - 1);
+    int square = a == b && na == nb;
+
+    Complex* fa = poly_mem_calloc(square ? n : 2 * n, sizeof(Complex));
+    if (!fa) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    Complex* fb = square ? fa : fa + n;
+    memcpy(fa, a, na * sizeof(Complex));
+    if (!square) memcpy(fb, b, nb * sizeof(Complex));
+
+    // one progress phase per transform
+    int phases = square ? 2 : 3;
+    PolyJobPhase saved = poly_job_enter(0, phases);
+    PolynomialError err = poly_fft(fa, n, 0);
+    poly_job_leave(saved);
+    if (err == POLYNOMIAL_OK && !square) {
+        saved = poly_job_enter(1, phases);
+        err = poly_fft(fb, n, 0);
+        poly_job_leave(saved);
+    }
+    if (err == POLYNOMIAL_OK) {
+        for (int i = 0; i < n; i++) fa[i] = complex_k_mul(fa[i], fb[i]);
+        saved = poly_job_enter(phases - 1, phases);
+        err = poly_fft(fa, n, 1);
+        poly_job_leave(saved);
+    }
+    if (err == POLYNOMIAL_OK) {
+        int len = na + nb - 1 < nout ? na + nb - 1 : nout;
+        memcpy(out, fa, len * sizeof(Complex));
+        memset(out + len, 0, (nout - len) * sizeof(Complex));
+    }
+
+    poly_mem_free(fa);
+    return err;
+}
+
+PolynomialError poly_ntt_mullow_modint(const ModInt* a, int na, const ModInt* b, int nb, ModInt* out, int nout) {
+    if (na > nout) na = nout;
+    if (nb > nout) nb = nout;
+    int n = transform_length(na + nb - 1);
+    if (n > (1 << POLY_NTT_MAX_LOG)) return POLYNOMIAL_INVALID_DEGREE;
+    int square = a == b && na == nb;
+
+    ModInt* fa = poly_mem_calloc(square ? n : 2 * n, sizeof(ModInt));
+    if (!fa) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    ModInt* fb = square ? fa : fa + n;
+    memcpy(fa, a, na * sizeof(ModInt));
+    if (!square) memcpy(fb, b, nb * sizeof(ModInt));
+
+    int phases = square ? 2 : 3;
+    PolyJobPhase saved = poly_job_enter(0, phases);
+    poly_ntt(fa, n, 0);
+    poly_job_leave(saved);
+    if (!square) {
+        saved = poly_job_enter(1, phases);
+        poly_ntt(fb, n, 0);
+        poly_job_leave(saved);
+    }
+    for (int i = 0; i < n; i++) fa[i] = modint_k_mul(fa[i], fb[i]);
+    saved = poly_job_enter(phases - 1, phases);
+    poly_ntt(fa, n, 1);
+    poly_job_leave(saved);
+    if (poly_job_cancelled()) {
+        poly_mem_free(fa);
+        return POLYNOMIAL_CANCELLED;
+    }
+
+    int len = na + nb - 1 < nout ? na + nb - 1 : nout;
+    memcpy(out, fa, len * sizeof(ModInt));
+    memset(out + len, 0, (nout - len) * sizeof(ModInt));
+
+    poly_mem_free(fa);
+    return POLYNOMIAL_OK;
+}
+
+// Both operands' transforms, and for the FFT its table of roots
+size_t poly_fft_mullow_bytes(int na, int nb, int nout) {
+    if (na > nout) na = nout;
+    if (nb > nout) nb = nout;
+    size_t n = (size_t)transform_length(na + nb - 1);
+    return (2 * n + n / 2 + 1) * sizeof(Complex);
+}
+
+size_t poly_ntt_mullow_bytes(int na, int nb, int nout) {
+    if (na > nout) na = nout;
+    if (nb > nout) nb = nout;
+    return 2 * (size_t)transform_length(na + nb - 1) * sizeof(ModInt);
+}
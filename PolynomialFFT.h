@@ -0,0 +1,25 @@
+#ifndef POLYNOMIAL_FFT_H
+#define POLYNOMIAL_FFT_H
+
+#include "PolynomialDefines.h"
+#include "Complex.h"
+#include "ModInt.h"
+#include <stddef.h>
+
+// Below this many coefficients in the shorter operand the direct kernels win
+#define POLY_FFT_THRESHOLD 64
+// Largest transform the modulus supports: 2^23 divides MODINT_MODULUS - 1
+#define POLY_NTT_MAX_LOG 23
+
+// In-place transforms of power-of-two length n; the inverse includes the 1/n scaling
+PolynomialError poly_fft(Complex* a, int n, int invert);
+void poly_ntt(ModInt* a, int n, int invert);
+
+// out[0..nout) = (a * b) mod x^nout by transform, out must not alias the inputs
+PolynomialError poly_fft_mullow_complex(const Complex* a, int na, const Complex* b, int nb, Complex* out, int nout);
+PolynomialError poly_ntt_mullow_modint(const ModInt* a, int na, const ModInt* b, int nb, ModInt* out, int nout);
+// Bytes the two allocate at most for these lengths
+size_t poly_fft_mullow_bytes(int na, int nb, int nout);
+size_t poly_ntt_mullow_bytes(int na, int nb, int nout);
+
+#endif
@@ -0,0 +1,362 @@
+#define _POSIX_C_SOURCE 200809L
+#include "PolynomialFormat.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Where formatted bytes go: a caller buffer (poly_format) or a staging
+// buffer drained into a stream or descriptor in large writes
+typedef struct {
+    char* buf;
+    size_t cap;        // usable bytes in buf
+    size_t len;        // bytes in buf
+    size_t total;      // bytes produced, including any that did not fit
+    FILE* stream;
+    int fd;            // -1 unless writing to a descriptor
+    int draining;      // buf is staging rather than the final output
+    PolynomialError err;
+    char scratch[POLY_FORMAT_TERM_MAX];
+} FormatSink;
+
+static void sink_flush(FormatSink* sink) {
+    if (!sink->draining || sink->len == 0) return;
+    if (sink->err == POLYNOMIAL_OK) {
+        if (sink->stream) {
+            if (fwrite(sink->buf, 1, sink->len, sink->stream) != sink->len) sink->err = POLYNOMIAL_CALC_ERROR;
+        } else {
+            const char* p = sink->buf;
+            size_t left = sink->len;
+            while (left > 0) {
+                ssize_t n = write(sink->fd, p, left);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    sink->err = POLYNOMIAL_CALC_ERROR;
+                    break;
+                }
+                p += n;
+                left -= (size_t)n;
+            }
+        }
+    }
+    sink->len = 0;
+}
+
+// Room for one term: the buffer tail when it has POLY_FORMAT_TERM_MAX bytes
+// free, otherwise the scratch area that sink_commit copies from
+static char* sink_reserve(FormatSink* sink) {
+    if (sink->draining && sink->cap - sink->len < POLY_FORMAT_TERM_MAX) sink_flush(sink);
+    if (sink->cap - sink->len >= POLY_FORMAT_TERM_MAX) return sink->buf + sink->len;
+    return sink->scratch;
+}
+
+static void sink_commit(FormatSink* sink, const char* start, const char* end) {
+    size_t n = (size_t)(end - start);
+    sink->total += n;
+    if (start != sink->scratch) {
+        sink->len += n;
+        return;
+    }
+    size_t room = sink->cap - sink->len;
+    size_t copy = n < room ? n : room;
+    if (copy > 0) memcpy(sink->buf + sink->len, start, copy);
+    sink->len += copy;
+}
+
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static char* put_str(char* p, const char* s) {
+    size_t n = strlen(s);
+    memcpy(p, s, n);
+    return p + n;
+}
+
+static char* put_u64(char* p, uint64_t v) {
+    char tmp[20];
+    char* t = tmp + sizeof(tmp);
+    while (v >= 100) {
+        const char* pair = DIGIT_PAIRS + (v % 100) * 2;
+        v /= 100;
+        *--t = pair[1];
+        *--t = pair[0];
+    }
+    if (v >= 10) {
+        *--t = DIGIT_PAIRS[v * 2 + 1];
+        *--t = DIGIT_PAIRS[v * 2];
+    } else {
+        *--t = (char)('0' + v);
+    }
+    size_t n = (size_t)(tmp + sizeof(tmp) - t);
+    memcpy(p, t, n);
+    return p + n;
+}
+
+static char* put_int(char* p, int v) {
+    if (v < 0) {
+        *p++ = '-';
+        return put_u64(p, (uint64_t)0 - (uint64_t)(int64_t)v);
+    }
+    return put_u64(p, (uint64_t)v);
+}
+
+static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+// printf("%.*f") (with '+' when forceSign) for finite values small enough to
+// scale exactly into an integer. A scaled fraction near one half could round
+// either way, so those and everything else go through snprintf.
+static char* put_fixed(char* p, double v, int precision, int forceSign) {
+    if (precision < (int)(sizeof(POW10) / sizeof(POW10[0])) && isfinite(v)) {
+        double scaled = fabs(v) * POW10[precision];
+        if (scaled < 1e12) {
+            double whole = floor(scaled);
+            if (fabs(scaled - whole - 0.5) > 1e-3) {
+                uint64_t digits = (uint64_t)nearbyint(scaled);
+                if (signbit(v)) *p++ = '-';
+                else if (forceSign) *p++ = '+';
+                uint64_t scale = (uint64_t)POW10[precision];
+                p = put_u64(p, digits / scale);
+                if (precision > 0) {
+                    *p++ = '.';
+                    uint64_t frac = digits % scale;
+                    for (int i = precision - 1; i >= 0; i--) {
+                        p[i] = (char)('0' + frac % 10);
+                        frac /= 10;
+                    }
+                    p += precision;
+                }
+                return p;
+            }
+        }
+    }
+    // at most 309 integer digits, so two parts and the decorations fit a term
+    return p + snprintf(p, 360, forceSign ? "%+.*f" : "%.*f", precision, v);
+}
+
+// Shortest of %.15g..%.17g that reads back exactly; JSON gets null for
+// values it cannot represent
+static char* put_exact(char* p, double v, int json) {
+    if (!isfinite(v)) return put_str(p, json ? "null" : isnan(v) ? "nan" : v < 0 ? "-inf" : "inf");
+    int n = 0;
+    for (int digits = 15; digits <= 17; digits++) {
+        n = snprintf(p, 32, "%.*g", digits, v);
+        if (strtod(p, NULL) == v) break;
+    }
+    return p + n;
+}
+
+static char* put_double(char* p, double v, const PolyFormatOptions* options, int forceSign) {
+    if (options->precision >= 0) return put_fixed(p, v, options->precision, forceSign);
+    if (forceSign && !signbit(v)) *p++ = '+';
+    return put_exact(p, v, options->style == POLY_FORMAT_JSON);
+}
+
+// Coefficient as complex_print and friends write it
+static char* put_human_coeff(char* p, PolyKernelType type, const void* coeffs, int i,
+                             const PolyFormatOptions* options) {
+    switch (type) {
+    case POLY_KERNEL_int:
+        return put_int(p, ((const int*)coeffs)[i]);
+    case POLY_KERNEL_modint:
+        return put_u64(p, ((const ModInt*)coeffs)[i]);
+    case POLY_KERNEL_int64: {
+        int64_t v = ((const int64_t*)coeffs)[i];
+        if (v < 0) *p++ = '-';
+        return put_u64(p, v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v);
+    }
+    case POLY_KERNEL_int128:
+        return p + int128_to_chars(((const Int128*)coeffs)[i], p);
+    case POLY_KERNEL_complex: {
+        Complex c = ((const Complex*)coeffs)[i];
+        if (c.imag == 0.0) return put_double(p, c.real, options, 0);
+        if (c.real == 0.0) {
+            p = put_double(p, c.imag, options, 0);
+            *p++ = 'i';
+            return p;
+        }
+        *p++ = '(';
+        p = put_double(p, c.real, options, 0);
+        *p++ = ' ';
+        p = put_double(p, c.imag, options, 1);
+        *p++ = 'i';
+        *p++ = ')';
+        return p;
+    }
+    default:
+        return p;
+    }
+}
+
+// Plain number for CSV (a real and an imaginary column) and JSON ([re,im])
+static char* put_data_coeff(char* p, PolyKernelType type, const void* coeffs, int i,
+                            const PolyFormatOptions* options) {
+    if (type != POLY_KERNEL_complex) return put_human_coeff(p, type, coeffs, i, options);
+    Complex c = ((const Complex*)coeffs)[i];
+    int json = options->style == POLY_FORMAT_JSON;
+    if (json) *p++ = '[';
+    p = put_double(p, c.real, options, 0);
+    *p++ = ',';
+    p = put_double(p, c.imag, options, 0);
+    if (json) *p++ = ']';
+    return p;
+}
+
+static int coeff_is_zero(PolyKernelType type, const void* coeffs, int i) {
+    switch (type) {
+    case POLY_KERNEL_int: return ((const int*)coeffs)[i] == 0;
+    case POLY_KERNEL_modint: return ((const ModInt*)coeffs)[i] == 0;
+    case POLY_KERNEL_int64: return ((const int64_t*)coeffs)[i] == 0;
+    case POLY_KERNEL_int128: return ((const Int128*)coeffs)[i] == 0;
+    case POLY_KERNEL_complex: {
+        Complex c = ((const Complex*)coeffs)[i];
+        return c.real == 0.0 && c.imag == 0.0;
+    }
+    default: return 0;
+    }
+}
+
+#define POLY_FORMAT_TYPE_NAME(NAME, T, GETTER) #NAME,
+static const char* TYPE_NAMES[POLY_KERNEL_COUNT] = {NULL, POLY_BUILTIN_TYPES(POLY_FORMAT_TYPE_NAME)};
+#undef POLY_FORMAT_TYPE_NAME
+
+static void format_human(FormatSink* sink, PolyKernelType type, const void* coeffs, int degree,
+                         const PolyFormatOptions* options) {
+    int first = 1;
+    for (int i = degree; i >= 0; i--) {
+        // skipping zeros still leaves the constant term of the zero polynomial
+        if (options->skipZeros && coeff_is_zero(type, coeffs, i) && !(i == 0 && first)) continue;
+        char* start = sink_reserve(sink);
+        char* p = start;
+        if (!first) p = put_str(p, " + ");
+        p = put_human_coeff(p, type, coeffs, i, options);
+        if (i > 0) *p++ = 'x';
+        if (i > 1) {
+            *p++ = '^';
+            p = put_int(p, i);
+        }
+        sink_commit(sink, start, p);
+        first = 0;
+    }
+    char* start = sink_reserve(sink);
+    *start = '\n';
+    sink_commit(sink, start, start + 1);
+}
+
+static void format_csv(FormatSink* sink, PolyKernelType type, const void* coeffs, int degree,
+                       const PolyFormatOptions* options) {
+    char* start = sink_reserve(sink);
+    char* p = put_str(start, type == POLY_KERNEL_complex ? "degree,real,imag\n" : "degree,coefficient\n");
+    sink_commit(sink, start, p);
+    for (int i = 0; i <= degree; i++) {
+        if (options->skipZeros && coeff_is_zero(type, coeffs, i)) continue;
+        start = sink_reserve(sink);
+        p = put_int(start, i);
+        *p++ = ',';
+        p = put_data_coeff(p, type, coeffs, i, options);
+        *p++ = '\n';
+        sink_commit(sink, start, p);
+    }
+}
+
+static void format_json(FormatSink* sink, PolyKernelType type, const void* coeffs, int degree,
+                        const PolyFormatOptions* options) {
+    char* start = sink_reserve(sink);
+    char* p = put_str(start, "{\"type\":\"");
+    p = put_str(p, TYPE_NAMES[type]);
+    p = put_str(p, "\",\"degree\":");
+    p = put_int(p, degree);
+    p = put_str(p, options->skipZeros ? ",\"terms\":[" : ",\"coeffs\":[");
+    sink_commit(sink, start, p);
+    int first = 1;
+    for (int i = 0; i <= degree; i++) {
+        if (options->skipZeros && coeff_is_zero(type, coeffs, i)) continue;
+        start = sink_reserve(sink);
+        p = start;
+        if (!first) *p++ = ',';
+        if (options->skipZeros) {
+            *p++ = '[';
+            p = put_int(p, i);
+            *p++ = ',';
+        }
+        p = put_data_coeff(p, type, coeffs, i, options);
+        if (options->skipZeros) *p++ = ']';
+        sink_commit(sink, start, p);
+        first = 0;
+    }
+    start = sink_reserve(sink);
+    p = put_str(start, "]}\n");
+    sink_commit(sink, start, p);
+}
+
+static PolynomialError format_into(const Polynomial* poly, FormatSink* sink, const PolyFormatOptions* options) {
+    static const PolyFormatOptions defaults = POLY_FORMAT_DEFAULTS;
+    if (!options) options = &defaults;
+    PolyKernelType type = poly_kernel_type(poly->typeInfo);
+    if (type == POLY_KERNEL_GENERIC) return POLYNOMIAL_TYPE_MISMATCH;
+    if (options->precision > POLY_FORMAT_MAX_PRECISION) return POLYNOMIAL_INVALID_INPUT;
+
+    const void* coeffs = poly->coefficients[0];
+    switch (options->style) {
+    case POLY_FORMAT_HUMAN: format_human(sink, type, coeffs, poly->degree, options); break;
+    case POLY_FORMAT_CSV: format_csv(sink, type, coeffs, poly->degree, options); break;
+    case POLY_FORMAT_JSON: format_json(sink, type, coeffs, poly->degree, options); break;
+    default: return POLYNOMIAL_INVALID_INPUT;
+    }
+    sink_flush(sink);
+    return sink->err;
+}
+
+PolynomialError poly_format(const Polynomial* poly, char* buf, size_t cap, const PolyFormatOptions* options,
+                            size_t* length) {
+    if (!poly || (!buf && cap > 0)) return POLYNOMIAL_NULL_PTR;
+    FormatSink sink = {0};
+    sink.buf = buf;
+    sink.cap = cap > 0 ? cap - 1 : 0;
+    sink.fd = -1;
+    PolynomialError err = format_into(poly, &sink, options);
+    if (cap > 0) buf[sink.len] = '\0';
+    if (length) *length = sink.total;
+    if (err == POLYNOMIAL_OK && sink.total > sink.len) err = POLYNOMIAL_INVALID_INPUT;
+    return err;
+}
+
+static PolynomialError write_to(const Polynomial* poly, FILE* stream, int fd, const PolyFormatOptions* options) {
+    if (!poly) return POLYNOMIAL_NULL_PTR;
+    // a short polynomial needs no more than room for each of its terms
+    size_t cap = poly->degree < POLY_WRITE_BUFFER / POLY_FORMAT_TERM_MAX
+                     ? (size_t)(poly->degree + 1) * POLY_FORMAT_TERM_MAX
+                     : POLY_WRITE_BUFFER;
+    FormatSink* sink = poly_mem_alloc(sizeof(FormatSink));
+    char* buf = poly_mem_alloc(cap);
+    if (!sink || !buf) {
+        poly_mem_free(sink);
+        poly_mem_free(buf);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+    memset(sink, 0, sizeof(*sink));
+    sink->buf = buf;
+    sink->cap = cap;
+    sink->stream = stream;
+    sink->fd = fd;
+    sink->draining = 1;
+    PolynomialError err = format_into(poly, sink, options);
+    poly_mem_free(buf);
+    poly_mem_free(sink);
+    return err;
+}
+
+PolynomialError poly_write(const Polynomial* poly, FILE* stream, const PolyFormatOptions* options) {
+    if (!stream) return POLYNOMIAL_NULL_PTR;
+    return write_to(poly, stream, -1, options);
+}
+
+PolynomialError poly_write_fd(const Polynomial* poly, int fd, const PolyFormatOptions* options) {
+    if (fd < 0) return POLYNOMIAL_INVALID_INPUT;
+    return write_to(poly, NULL, fd, options);
+}
@@ -0,0 +1,42 @@
+#ifndef POLYNOMIAL_FORMAT_H
+#define POLYNOMIAL_FORMAT_H
+
+#include "Polynomial.h"
+#include <stdio.h>
+
+typedef enum {
+    POLY_FORMAT_HUMAN,  // as poly_print: 3x^2 + 0x + -1, highest degree first
+    POLY_FORMAT_CSV,    // header, then degree,coefficient (degree,real,imag) rows from degree 0
+    POLY_FORMAT_JSON    // {"type":..,"degree":..,"coeffs":[..]}, or "terms":[[degree,c],..] when skipping zeros
+} PolyFormatStyle;
+
+typedef struct {
+    PolyFormatStyle style;
+    int skipZeros;
+    // digits after the point for Complex parts; negative prints the shortest
+    // text that reads back to the same double
+    int precision;
+} PolyFormatOptions;
+
+// poly_print's layout; CSV and JSON usually want precision -1
+#define POLY_FORMAT_DEFAULTS {POLY_FORMAT_HUMAN, 0, 2}
+
+// Largest precision accepted
+#define POLY_FORMAT_MAX_PRECISION 32
+// Bytes the text of one coefficient can take, decorations included
+#define POLY_FORMAT_TERM_MAX 768
+// Most poly_write and poly_write_fd buffer before each write
+#define POLY_WRITE_BUFFER (1 << 18)
+
+// Formats the built-in coefficient types; every style ends with a newline.
+// options may be NULL for the defaults. buf receives at most cap - 1 bytes
+// and a terminating NUL, *length (optional) the full size of the text. When
+// the text does not fit the result is POLYNOMIAL_INVALID_INPUT and buf holds
+// a prefix, so the caller can retry with *length + 1 bytes. The writers
+// report a failed write as POLYNOMIAL_CALC_ERROR.
+PolynomialError poly_format(const Polynomial* poly, char* buf, size_t cap, const PolyFormatOptions* options,
+                            size_t* length);
+PolynomialError poly_write(const Polynomial* poly, FILE* stream, const PolyFormatOptions* options);
+PolynomialError poly_write_fd(const Polynomial* poly, int fd, const PolyFormatOptions* options);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef POLYNOMIAL_JOB_H
+#define POLYNOMIAL_JOB_H
+
+// Cooperative cancellation and progress for the asynchronous job running on
+// the current thread. Long kernels poll at block boundaries; with no job
+// attached a poll is one thread-local load and a branch.
+// Coefficient operations the direct kernels do between two polls
+#define POLY_JOB_CHECK_WORK (1 << 16)
+
+typedef struct {
+    int cancelled;
+    int progress;   // parts per million, never decreases
+    double base;    // the current phase covers [base, base + span) of the job
+    double span;
+} PolyJob;
+
+typedef struct {
+    double base;
+    double span;
+} PolyJobPhase;
+
+extern __thread PolyJob* POLY_CURRENT_JOB;
+
+// Records that done of total units of the current phase are finished and
+// returns nonzero if the job has been cancelled
+int poly_job_update(PolyJob* job, long long done, long long total);
+
+static inline int poly_job_cancelled(void) {
+    PolyJob* job = POLY_CURRENT_JOB;
+    return job && __atomic_load_n(&job->cancelled, __ATOMIC_RELAXED);
+}
+
+static inline int poly_job_checkpoint(long long done, long long total) {
+    PolyJob* job = POLY_CURRENT_JOB;
+    return job ? poly_job_update(job, done, total) : 0;
+}
+
+// Narrows the current phase to part index of count, until poly_job_leave
+PolyJobPhase poly_job_enter(int index, int count);
+void poly_job_leave(PolyJobPhase saved);
+
+#endif
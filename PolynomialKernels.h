@@ -0,0 +1,299 @@
+#ifndef POLYNOMIAL_KERNELS_H
+#define POLYNOMIAL_KERNELS_H
+
+#include "Polynomial.h"
+#include "Integer.h"
+#include "Complex.h"
+#include "ModInt.h"
+#include "PolynomialJob.h"
+#include <math.h>
+#include <string.h>
+
+// Built-in coefficient types that get specialized kernels.
+// X(name, C type, TypeInfo getter)
+#define POLY_BUILTIN_TYPES(X) \
+    X(int, int, GetIntTypeInfo) \
+    X(complex, Complex, GetComplexTypeInfo) \
+    X(modint, ModInt, GetModIntTypeInfo) \
+    X(int64, int64_t, GetInt64TypeInfo) \
+    X(int128, Int128, GetInt128TypeInfo)
+
+// Coefficients of a polynomial as a flat array (see poly_create)
+#define POLY_COEFFS(poly, T) ((T*)(poly)->coefficients[0])
+
+#define POLY_KERNEL_ENUM(NAME, T, GETTER) POLY_KERNEL_##NAME,
+typedef enum {
+    POLY_KERNEL_GENERIC = 0,
+    POLY_BUILTIN_TYPES(POLY_KERNEL_ENUM)
+    POLY_KERNEL_COUNT
+} PolyKernelType;
+#undef POLY_KERNEL_ENUM
+
+static inline PolyKernelType poly_kernel_type(const TypeInfo* typeInfo) {
+#define POLY_KERNEL_MATCH(NAME, T, GETTER) \
+    if (typeInfo == GETTER()) return POLY_KERNEL_##NAME;
+    POLY_BUILTIN_TYPES(POLY_KERNEL_MATCH)
+#undef POLY_KERNEL_MATCH
+    return POLY_KERNEL_GENERIC;
+}
+
+// Element operations by value. Integers wrap like int_add/int_multiply,
+// but through unsigned arithmetic so the wrap is well defined.
+static inline int int_k_zero(void) { return 0; }
+static inline int int_k_one(void) { return 1; }
+static inline int int_k_from_int(int v) { return v; }
+static inline int int_k_add(int a, int b) { return (int)((unsigned)a + (unsigned)b); }
+static inline int int_k_sub(int a, int b) { return (int)((unsigned)a - (unsigned)b); }
+static inline int int_k_mul(int a, int b) { return (int)((unsigned)a * (unsigned)b); }
+static inline int int_k_eq(int a, int b) { return a == b; }
+enum { int_k_exact = 1 };
+
+static inline Complex complex_k_zero(void) {
+    Complex z = {0.0, 0.0};
+    return z;
+}
+
+static inline Complex complex_k_one(void) {
+    Complex one = {1.0, 0.0};
+    return one;
+}
+
+static inline Complex complex_k_from_int(int v) {
+    Complex c = {(double)v, 0.0};
+    return c;
+}
+
+static inline Complex complex_k_add(Complex a, Complex b) {
+    Complex r = {a.real + b.real, a.imag + b.imag};
+    return r;
+}
+
+static inline Complex complex_k_sub(Complex a, Complex b) {
+    Complex r = {a.real - b.real, a.imag - b.imag};
+    return r;
+}
+
+static inline Complex complex_k_mul(Complex a, Complex b) {
+    Complex r = {a.real * b.real - a.imag * b.imag, a.real * b.imag + a.imag * b.real};
+    return r;
+}
+
+static inline int complex_k_eq(Complex a, Complex b) {
+    return fabs(a.real - b.real) <= 1e-6 && fabs(a.imag - b.imag) <= 1e-6;
+}
+enum { complex_k_exact = 0 };
+
+static inline ModInt modint_k_zero(void) { return 0; }
+static inline ModInt modint_k_one(void) { return 1; }
+static inline ModInt modint_k_from_int(int v) { return modint_from_int(v); }
+static inline ModInt modint_k_add(ModInt a, ModInt b) {
+    uint32_t sum = a + b;
+    return sum >= MODINT_MODULUS ? sum - MODINT_MODULUS : sum;
+}
+static inline ModInt modint_k_sub(ModInt a, ModInt b) {
+    return a >= b ? a - b : a + (MODINT_MODULUS - b);
+}
+static inline ModInt modint_k_mul(ModInt a, ModInt b) {
+    return (ModInt)((uint64_t)a * b % MODINT_MODULUS);
+}
+static inline int modint_k_eq(ModInt a, ModInt b) { return a == b; }
+enum { modint_k_exact = 1 };
+
+// The wider integer types wrap the same way; callers that promote check
+// magnitudes before choosing one (see poly_multiply)
+static inline int64_t int64_k_zero(void) { return 0; }
+static inline int64_t int64_k_one(void) { return 1; }
+static inline int64_t int64_k_from_int(int v) { return v; }
+static inline int64_t int64_k_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+static inline int64_t int64_k_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+static inline int64_t int64_k_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+static inline int int64_k_eq(int64_t a, int64_t b) { return a == b; }
+enum { int64_k_exact = 1 };
+
+__extension__ typedef unsigned __int128 PolyUInt128;
+static inline Int128 int128_k_zero(void) { return 0; }
+static inline Int128 int128_k_one(void) { return 1; }
+static inline Int128 int128_k_from_int(int v) { return v; }
+static inline Int128 int128_k_add(Int128 a, Int128 b) { return (Int128)((PolyUInt128)a + (PolyUInt128)b); }
+static inline Int128 int128_k_sub(Int128 a, Int128 b) { return (Int128)((PolyUInt128)a - (PolyUInt128)b); }
+static inline Int128 int128_k_mul(Int128 a, Int128 b) { return (Int128)((PolyUInt128)a * (PolyUInt128)b); }
+static inline int int128_k_eq(Int128 a, Int128 b) { return a == b; }
+enum { int128_k_exact = 1 };
+
+// Independent Horner chains in the split evaluator
+#define POLY_SPLIT_WAYS 4
+
+// Kernels over flat coefficient arrays; n* are coefficient counts (degree + 1).
+// add/scale/horner/equal tolerate r aliasing an input, fma does not.
+#define POLY_DEFINE_KERNELS(NAME, T, GETTER) \
+static inline void NAME##_kernel_add(const T* a, int na, const T* b, int nb, T* r) { \
+    int common = na < nb ? na : nb; \
+    for (int i = 0; i < common; i++) r[i] = NAME##_k_add(a[i], b[i]); \
+    for (int i = common; i < na; i++) r[i] = a[i]; \
+    for (int i = common; i < nb; i++) r[i] = b[i]; \
+} \
+\
+static inline void NAME##_kernel_scale(const T* a, int n, T s, T* r) { \
+    for (int i = 0; i < n; i++) r[i] = NAME##_k_mul(a[i], s); \
+} \
+\
+static inline void NAME##_kernel_fma(T* restrict acc, const T* restrict a, int na, \
+                                     const T* restrict b, int nb) { \
+    for (int i = 0; i < na; i++) { \
+        T ai = a[i]; \
+        T* row = acc + i; \
+        for (int j = 0; j < nb; j++) row[j] = NAME##_k_add(row[j], NAME##_k_mul(ai, b[j])); \
+    } \
+} \
+\
+static inline void NAME##_kernel_mullow(T* restrict out, int nout, const T* restrict a, int na, \
+                                        const T* restrict b, int nb) { \
+    for (int i = 0; i < nout; i++) out[i] = NAME##_k_zero(); \
+    if (na > nout) na = nout; \
+    int rowsPerCheck = 1 + POLY_JOB_CHECK_WORK / (nb > 0 ? nb : 1); \
+    for (int i = 0; i < na; i++) { \
+        if (i % rowsPerCheck == 0 && poly_job_checkpoint(i, na)) return; \
+        T ai = a[i]; \
+        T* row = out + i; \
+        int m = nout - i < nb ? nout - i : nb; \
+        for (int j = 0; j < m; j++) row[j] = NAME##_k_add(row[j], NAME##_k_mul(ai, b[j])); \
+    } \
+} \
+\
+static inline void NAME##_kernel_axpy(T* restrict r, const T* restrict x, int n, T s) { \
+    for (int i = 0; i < n; i++) r[i] = NAME##_k_add(r[i], NAME##_k_mul(s, x[i])); \
+} \
+\
+static inline void NAME##_kernel_derivative(const T* c, int n, T* r) { \
+    for (int i = 1; i < n; i++) r[i - 1] = NAME##_k_mul(c[i], NAME##_k_from_int(i)); \
+} \
+\
+/* q = c / (x - root), returns the remainder; q may alias c */ \
+static inline T NAME##_kernel_deflate(const T* c, int n, T root, T* q) { \
+    T acc = c[n - 1]; \
+    for (int i = n - 2; i >= 0; i--) { \
+        T ci = c[i]; \
+        q[i] = acc; \
+        acc = NAME##_k_add(ci, NAME##_k_mul(root, acc)); \
+    } \
+    return acc; \
+} \
+\
+/* c(x) <- c(x + a) in place, O(n^2) Horner-style shift */ \
+static inline void NAME##_kernel_taylor_shift(T* c, int n, T a) { \
+    for (int k = 0; k < n - 1; k++) \
+        for (int j = n - 2; j >= k; j--) c[j] = NAME##_k_add(c[j], NAME##_k_mul(a, c[j + 1])); \
+} \
+\
+/* r(x) = c(s x) in one streaming pass, r may alias c */ \
+static inline void NAME##_kernel_scale_var(const T* c, int n, T s, T* r) { \
+    T power = NAME##_k_one(); \
+    for (int i = 0; i < n; i++) { \
+        r[i] = NAME##_k_mul(c[i], power); \
+        power = NAME##_k_mul(power, s); \
+    } \
+} \
+\
+static inline T NAME##_kernel_horner(const T* c, int n, T x) { \
+    T r = c[n - 1]; \
+    for (int i = n - 2; i >= 0; i--) r = NAME##_k_add(NAME##_k_mul(r, x), c[i]); \
+    return r; \
+} \
+\
+/* Estrin's scheme evaluated as a stream: pairs c[2i] + c[2i+1] x are merged \
+ * like a binary counter, so level l combines blocks with x^(2^(l+1)). Only a \
+ * stack of log2(n) partial sums is kept. */ \
+static inline T NAME##_kernel_estrin(const T* c, int n, T x) { \
+    T powers[32]; \
+    T stack[32]; \
+    int levels[32]; \
+    int top = 0; \
+    powers[0] = x; \
+    for (int l = 1; l < 32 && (1 << l) < n; l++) powers[l] = NAME##_k_mul(powers[l - 1], powers[l - 1]); \
+    for (int i = 0; i + 1 < n; i += 2) { \
+        T v = NAME##_k_add(c[i], NAME##_k_mul(c[i + 1], x)); \
+        int level = 0; \
+        while (top > 0 && levels[top - 1] == level) { \
+            v = NAME##_k_add(stack[--top], NAME##_k_mul(v, powers[level + 1])); \
+            level++; \
+        } \
+        stack[top] = v; \
+        levels[top++] = level; \
+    } \
+    /* leftover blocks, highest coefficients last: r = s_j + x^len(s_j) r */ \
+    T r = (n & 1) ? c[n - 1] : NAME##_k_zero(); \
+    int haveR = n & 1; \
+    while (top > 0) { \
+        top--; \
+        r = haveR ? NAME##_k_add(stack[top], NAME##_k_mul(r, powers[levels[top] + 1])) : stack[top]; \
+        haveR = 1; \
+    } \
+    return r; \
+} \
+\
+/* p(x) = sum_r x^r P_r(x^K): K independent Horner chains in y = x^K, \
+ * combined by a short Horner pass in x at the end */ \
+static inline T NAME##_kernel_split_horner(const T* c, int n, T x) { \
+    T acc[POLY_SPLIT_WAYS]; \
+    T y = x; \
+    for (int r = 1; r < POLY_SPLIT_WAYS; r++) y = NAME##_k_mul(y, x); \
+    int rows = n / POLY_SPLIT_WAYS; \
+    int rem = n % POLY_SPLIT_WAYS; \
+    for (int r = 0; r < POLY_SPLIT_WAYS; r++) \
+        acc[r] = r < rem ? c[rows * POLY_SPLIT_WAYS + r] : NAME##_k_zero(); \
+    int first = rem ? rows - 1 : rows - 2; \
+    if (!rem) \
+        for (int r = 0; r < POLY_SPLIT_WAYS; r++) acc[r] = c[(rows - 1) * POLY_SPLIT_WAYS + r]; \
+    for (int i = first; i >= 0; i--) { \
+        const T* row = c + i * POLY_SPLIT_WAYS; \
+        for (int r = 0; r < POLY_SPLIT_WAYS; r++) acc[r] = NAME##_k_add(NAME##_k_mul(acc[r], y), row[r]); \
+    } \
+    T result = acc[POLY_SPLIT_WAYS - 1]; \
+    for (int r = POLY_SPLIT_WAYS - 2; r >= 0; r--) result = NAME##_k_add(acc[r], NAME##_k_mul(x, result)); \
+    return result; \
+} \
+\
+static inline int NAME##_kernel_equal(const T* a, const T* b, int n) { \
+    if (NAME##_k_exact) return memcmp(a, b, n * sizeof(T)) == 0; \
+    /* branch-free blocks so the comparison vectorizes, early exit per block */ \
+    for (int base = 0; base < n; base += 256) { \
+        int end = base + 256 < n ? base + 256 : n; \
+        int same = 1; \
+        for (int i = base; i < end; i++) same &= NAME##_k_eq(a[i], b[i]); \
+        if (!same) return 0; \
+    } \
+    return 1; \
+} \
+\
+static inline void NAME##_kernel_lincomb(T* out, int nout, const Polynomial* const* polys, const T* scalars, int k) { \
+    for (int i = 0; i < nout; i++) { \
+        T acc = NAME##_k_zero(); \
+        for (int p = 0; p < k; p++) { \
+            if (i > polys[p]->degree) continue; \
+            acc = NAME##_k_add(acc, NAME##_k_mul(POLY_COEFFS(polys[p], const T)[i], scalars[p])); \
+        } \
+        out[i] = acc; \
+    } \
+}
+
+POLY_BUILTIN_TYPES(POLY_DEFINE_KERNELS)
+#undef POLY_DEFINE_KERNELS
+
+// Flat-array primitives shared by the higher-level algorithms. Arrays hold
+// n coefficients of typeInfo->size bytes each; outputs must not alias inputs.
+
+// out[0..nout) = (a * b) mod x^nout, using the fastest available multiplication
+PolynomialError poly_mullow_raw(const TypeInfo* typeInfo, const void* a, int na,
+                                const void* b, int nb, void* out, int nout);
+// Bytes poly_mullow_raw allocates at most for these lengths. It takes the
+// FFT or NTT only when their scratch fits the memory budgets; transform 0
+// leaves them out, giving what the direct kernels need.
+size_t poly_mullow_raw_bytes(const TypeInfo* typeInfo, int na, int nb, int nout, int transform);
+// r[i] += s * x[i]
+PolynomialError poly_axpy_raw(const TypeInfo* typeInfo, void* r, const void* x, int n, const void* s);
+// r[i] += x[i]
+void poly_add_raw(const TypeInfo* typeInfo, void* r, const void* x, int n);
+// out = 1, fails for types without a known multiplicative identity
+PolynomialError poly_one_raw(const TypeInfo* typeInfo, void* out);
+
+#endif
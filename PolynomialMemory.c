@@ -0,0 +1,323 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "PolynomialMemory.h"
+#include "PolynomialKernels.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// One per thread that has allocated. A record lives while its thread runs
+// or any block it allocated does: refs counts both, and whoever drops the
+// last reference frees it.
+typedef struct {
+    size_t live;
+    size_t peak;
+    size_t budget;
+    long long allocations;
+    long long refused;
+    int refs;
+} MemThread;
+
+// In front of every block; the header's size keeps blocks aligned for any
+// coefficient type
+typedef struct {
+    size_t bytes;
+    MemThread* owner;
+    unsigned char type;
+    unsigned char op;
+} MemHeader;
+
+#define MEM_HEADER 32
+typedef char mem_header_fits[sizeof(MemHeader) <= MEM_HEADER ? 1 : -1];
+typedef char mem_type_slots[POLY_MEM_TYPE_COUNT == POLY_KERNEL_COUNT ? 1 : -1];
+
+static PolyMemCounter TOTAL;
+static PolyMemCounter BY_TYPE[POLY_MEM_TYPE_COUNT];
+static PolyMemCounter BY_OP[POLY_MEM_OP_COUNT];
+static size_t BUDGET;
+
+static __thread PolyMemScope SCOPE;
+static __thread MemThread* THREAD;
+static pthread_key_t THREAD_KEY;
+static pthread_once_t THREAD_KEY_ONCE = PTHREAD_ONCE_INIT;
+
+static const char* const OP_NAMES[POLY_MEM_OP_COUNT] = {
+    "other", "create", "add", "multiply", "scalar_multiply", "evaluate", "derivative",
+    "compose", "pow", "series", "roots", "batch", "disk", "multivariate",
+};
+
+static const char* const TYPE_NAMES[POLY_MEM_TYPE_COUNT] = {
+    "other", "int", "complex", "modint", "int64", "int128",
+};
+
+static void mem_thread_release(MemThread* thread) {
+    if (__atomic_sub_fetch(&thread->refs, 1, __ATOMIC_ACQ_REL) == 0) free(thread);
+}
+
+static void mem_thread_exit(void* thread) {
+    THREAD = NULL;
+    mem_thread_release(thread);
+}
+
+static void mem_thread_key_create(void) {
+    pthread_key_create(&THREAD_KEY, mem_thread_exit);
+}
+
+static MemThread* mem_thread(void) {
+    if (THREAD) return THREAD;
+    pthread_once(&THREAD_KEY_ONCE, mem_thread_key_create);
+    MemThread* thread = calloc(1, sizeof(MemThread));
+    if (!thread) return NULL;
+    thread->refs = 1;
+    if (pthread_setspecific(THREAD_KEY, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+    THREAD = thread;
+    return thread;
+}
+
+// Adds bytes to *live unless the sum passes budget (0 for none)
+static int mem_reserve(size_t* live, size_t bytes, size_t budget, size_t* now) {
+    size_t current = __atomic_load_n(live, __ATOMIC_RELAXED);
+    do {
+        if (budget && (bytes > budget || current > budget - bytes)) return 0;
+    } while (!__atomic_compare_exchange_n(live, &current, current + bytes, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    *now = current + bytes;
+    return 1;
+}
+
+static void mem_raise_peak(size_t* peak, size_t live) {
+    size_t current = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while (live > current &&
+           !__atomic_compare_exchange_n(peak, &current, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void mem_refuse(MemThread* thread) {
+    __atomic_add_fetch(&TOTAL.refused, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&BY_TYPE[SCOPE.type].refused, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&BY_OP[SCOPE.op].refused, 1, __ATOMIC_RELAXED);
+    if (thread) __atomic_add_fetch(&thread->refused, 1, __ATOMIC_RELAXED);
+}
+
+// Takes bytes out of both budgets, or neither
+static int mem_admit(MemThread* thread, size_t bytes) {
+    size_t total, own;
+    if (!mem_reserve(&TOTAL.live, bytes, __atomic_load_n(&BUDGET, __ATOMIC_RELAXED), &total)) {
+        mem_refuse(thread);
+        return 0;
+    }
+    if (!mem_reserve(&thread->live, bytes, thread->budget, &own)) {
+        __atomic_sub_fetch(&TOTAL.live, bytes, __ATOMIC_RELAXED);
+        mem_refuse(thread);
+        return 0;
+    }
+    mem_raise_peak(&TOTAL.peak, total);
+    mem_raise_peak(&thread->peak, own);
+    return 1;
+}
+
+static void mem_unadmit(MemThread* thread, size_t bytes) {
+    __atomic_sub_fetch(&TOTAL.live, bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&thread->live, bytes, __ATOMIC_RELAXED);
+}
+
+static void mem_charge(PolyMemCounter* counter, size_t bytes) {
+    mem_raise_peak(&counter->peak, __atomic_add_fetch(&counter->live, bytes, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&counter->allocations, 1, __ATOMIC_RELAXED);
+}
+
+// Books an admitted block to the calling thread's scope
+static void* mem_record(MemHeader* header, MemThread* thread, size_t bytes) {
+    header->bytes = bytes;
+    header->owner = thread;
+    header->type = SCOPE.type;
+    header->op = SCOPE.op;
+    __atomic_add_fetch(&thread->refs, 1, __ATOMIC_RELAXED);
+    // only the owner counts its allocations, so no locked add is needed
+    __atomic_store_n(&thread->allocations, thread->allocations + 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&TOTAL.allocations, 1, __ATOMIC_RELAXED);
+    mem_charge(&BY_TYPE[header->type], bytes);
+    mem_charge(&BY_OP[header->op], bytes);
+    return (char*)header + MEM_HEADER;
+}
+
+static void mem_uncharge(const MemHeader* header) {
+    size_t bytes = header->bytes;
+    __atomic_sub_fetch(&TOTAL.live, bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&BY_TYPE[header->type].live, bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&BY_OP[header->op].live, bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&header->owner->live, bytes, __ATOMIC_RELAXED);
+    mem_thread_release(header->owner);
+}
+
+static MemHeader* mem_header(void* block) {
+    return (MemHeader*)((char*)block - MEM_HEADER);
+}
+
+static void* mem_allocate(size_t bytes, int zero) {
+    if (bytes > SIZE_MAX - MEM_HEADER) return NULL;
+    MemThread* thread = mem_thread();
+    if (!thread || !mem_admit(thread, bytes)) return NULL;
+    MemHeader* header = zero ? calloc(1, MEM_HEADER + bytes) : malloc(MEM_HEADER + bytes);
+    if (!header) {
+        mem_unadmit(thread, bytes);
+        return NULL;
+    }
+    return mem_record(header, thread, bytes);
+}
+
+void* poly_mem_alloc(size_t bytes) {
+    return mem_allocate(bytes, 0);
+}
+
+void* poly_mem_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    return mem_allocate(count * size, 1);
+}
+
+// The new size is admitted in full before the old is released, which is
+// the peak when realloc has to move the block
+void* poly_mem_realloc(void* block, size_t bytes) {
+    if (!block) return poly_mem_alloc(bytes);
+    if (bytes > SIZE_MAX - MEM_HEADER) return NULL;
+    MemThread* thread = mem_thread();
+    if (!thread || !mem_admit(thread, bytes)) return NULL;
+    MemHeader old = *mem_header(block);
+    MemHeader* header = realloc(mem_header(block), MEM_HEADER + bytes);
+    if (!header) {
+        mem_unadmit(thread, bytes);
+        return NULL;
+    }
+    mem_uncharge(&old);
+    return mem_record(header, thread, bytes);
+}
+
+void poly_mem_free(void* block) {
+    if (!block) return;
+    MemHeader* header = mem_header(block);
+    mem_uncharge(header);
+    free(header);
+}
+
+void poly_mem_set_budget(size_t bytes) {
+    __atomic_store_n(&BUDGET, bytes, __ATOMIC_RELAXED);
+}
+
+void poly_mem_set_thread_budget(size_t bytes) {
+    MemThread* thread = mem_thread();
+    if (thread) thread->budget = bytes;
+}
+
+int poly_mem_fits(size_t bytes) {
+    size_t budget = __atomic_load_n(&BUDGET, __ATOMIC_RELAXED);
+    size_t live = __atomic_load_n(&TOTAL.live, __ATOMIC_RELAXED);
+    if (budget && (bytes > budget || live > budget - bytes)) return 0;
+    MemThread* thread = THREAD;
+    if (thread && thread->budget) {
+        live = __atomic_load_n(&thread->live, __ATOMIC_RELAXED);
+        if (bytes > thread->budget || live > thread->budget - bytes) return 0;
+    }
+    return 1;
+}
+
+PolynomialError poly_mem_check(size_t bytes) {
+    if (poly_mem_fits(bytes)) return POLYNOMIAL_OK;
+    mem_refuse(THREAD);
+    return POLYNOMIAL_MEM_ALLOC_FAIL;
+}
+
+static void mem_load(const PolyMemCounter* from, PolyMemCounter* to) {
+    to->live = __atomic_load_n(&from->live, __ATOMIC_RELAXED);
+    to->peak = __atomic_load_n(&from->peak, __ATOMIC_RELAXED);
+    to->allocations = __atomic_load_n(&from->allocations, __ATOMIC_RELAXED);
+    to->refused = __atomic_load_n(&from->refused, __ATOMIC_RELAXED);
+}
+
+void poly_mem_stats(PolyMemStats* stats) {
+    if (!stats) return;
+    mem_load(&TOTAL, &stats->total);
+    for (int t = 0; t < POLY_MEM_TYPE_COUNT; t++) mem_load(&BY_TYPE[t], &stats->byType[t]);
+    for (int op = 0; op < POLY_MEM_OP_COUNT; op++) mem_load(&BY_OP[op], &stats->byOp[op]);
+    stats->budget = __atomic_load_n(&BUDGET, __ATOMIC_RELAXED);
+}
+
+void poly_mem_thread_stats(PolyMemCounter* counter, size_t* budget) {
+    MemThread* thread = mem_thread();
+    if (counter) {
+        PolyMemCounter none = {0, 0, 0, 0};
+        *counter = none;
+        if (thread) {
+            counter->live = __atomic_load_n(&thread->live, __ATOMIC_RELAXED);
+            counter->peak = __atomic_load_n(&thread->peak, __ATOMIC_RELAXED);
+            counter->allocations = __atomic_load_n(&thread->allocations, __ATOMIC_RELAXED);
+            counter->refused = __atomic_load_n(&thread->refused, __ATOMIC_RELAXED);
+        }
+    }
+    if (budget) *budget = thread ? thread->budget : 0;
+}
+
+static void mem_reset_peak(PolyMemCounter* counter) {
+    __atomic_store_n(&counter->peak, __atomic_load_n(&counter->live, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+void poly_mem_reset_peaks(void) {
+    mem_reset_peak(&TOTAL);
+    for (int t = 0; t < POLY_MEM_TYPE_COUNT; t++) mem_reset_peak(&BY_TYPE[t]);
+    for (int op = 0; op < POLY_MEM_OP_COUNT; op++) mem_reset_peak(&BY_OP[op]);
+    MemThread* thread = THREAD;
+    if (thread) __atomic_store_n(&thread->peak, __atomic_load_n(&thread->live, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+const char* poly_mem_op_name(PolyMemOp op) {
+    return op >= 0 && op < POLY_MEM_OP_COUNT ? OP_NAMES[op] : "unknown";
+}
+
+const char* poly_mem_type_name(int type) {
+    return type >= 0 && type < POLY_MEM_TYPE_COUNT ? TYPE_NAMES[type] : "unknown";
+}
+
+static void mem_print_row(const char* name, const PolyMemCounter* counter) {
+    printf("  %-16s %14zu %14zu %12lld %8lld\n", name, counter->live, counter->peak, counter->allocations,
+           counter->refused);
+}
+
+void poly_mem_print(const PolyMemStats* stats) {
+    if (!stats) return;
+    printf("  %-16s %14s %14s %12s %8s\n", "", "live bytes", "peak bytes", "allocations", "refused");
+    mem_print_row("total", &stats->total);
+    printf("By type:\n");
+    for (int t = 0; t < POLY_MEM_TYPE_COUNT; t++) {
+        if (stats->byType[t].allocations || stats->byType[t].refused) mem_print_row(TYPE_NAMES[t], &stats->byType[t]);
+    }
+    printf("By operation:\n");
+    for (int op = 0; op < POLY_MEM_OP_COUNT; op++) {
+        if (stats->byOp[op].allocations || stats->byOp[op].refused) mem_print_row(OP_NAMES[op], &stats->byOp[op]);
+    }
+    if (stats->budget) printf("Budget: %zu bytes\n", stats->budget);
+    else printf("Budget: none\n");
+}
+
+PolyMemScope poly_mem_enter(PolyMemOp op, const TypeInfo* typeInfo) {
+    PolyMemScope saved = SCOPE;
+    if (SCOPE.depth == 0) SCOPE.op = (unsigned char)op;
+    if (typeInfo) SCOPE.type = (unsigned char)poly_kernel_type(typeInfo);
+    SCOPE.depth++;
+    return saved;
+}
+
+void poly_mem_leave(const PolyMemScope* saved) {
+    SCOPE = *saved;
+}
+
+PolyMemScope poly_mem_current(void) {
+    return SCOPE;
+}
+
+PolyMemScope poly_mem_resume(const PolyMemScope* scope) {
+    PolyMemScope saved = SCOPE;
+    SCOPE = *scope;
+    return saved;
+}
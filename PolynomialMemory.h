@@ -0,0 +1,98 @@
+#ifndef POLYNOMIAL_MEMORY_H
+#define POLYNOMIAL_MEMORY_H
+
+#include "PolynomialDefines.h"
+#include "TypeInfo.h"
+#include <stddef.h>
+
+// Memory accounting. The library allocates through poly_mem_alloc and
+// friends, which count live and peak bytes overall, per coefficient type
+// and per operation. Each allocation is charged to the outermost operation
+// the calling thread is inside and to the type of the innermost one that
+// names a type. Work the shared thread pool does for an operation is
+// charged the same way.
+//
+// A global budget and a per-thread budget cap live bytes. An allocation
+// that would pass either one is refused before anything is allocated, and
+// the operation fails with POLYNOMIAL_MEM_ALLOC_FAIL as on any failed
+// allocation. The larger operations check their estimated peak up front
+// (see poly_multiply_peak_bytes), so they fail before doing any work, and
+// pick a variant that needs less scratch when the faster one would not fit.
+
+typedef enum {
+    POLY_MEM_OP_OTHER,
+    POLY_MEM_OP_CREATE,          // poly_create, clone, view, copy-on-write, promote
+    POLY_MEM_OP_ADD,
+    POLY_MEM_OP_MULTIPLY,        // poly_multiply, poly_mullow
+    POLY_MEM_OP_SCALAR_MULTIPLY,
+    POLY_MEM_OP_EVALUATE,        // poly_evaluate and evaluation caches
+    POLY_MEM_OP_DERIVATIVE,
+    POLY_MEM_OP_COMPOSE,         // poly_compose, taylor shift, variable scaling
+    POLY_MEM_OP_POW,
+    POLY_MEM_OP_SERIES,
+    POLY_MEM_OP_ROOTS,
+    POLY_MEM_OP_BATCH,
+    POLY_MEM_OP_DISK,
+    POLY_MEM_OP_MULTIVARIATE,
+    POLY_MEM_OP_COUNT
+} PolyMemOp;
+
+// Types are PolyKernelType values, 0 for allocations of no built-in type
+#define POLY_MEM_TYPE_COUNT 6
+
+typedef struct {
+    size_t live;
+    size_t peak;
+    long long allocations;
+    long long refused;           // allocations and up-front checks over a budget
+} PolyMemCounter;
+
+typedef struct {
+    PolyMemCounter total;
+    PolyMemCounter byType[POLY_MEM_TYPE_COUNT];
+    PolyMemCounter byOp[POLY_MEM_OP_COUNT];
+    size_t budget;               // 0 when there is none
+} PolyMemStats;
+
+// Budgets in bytes of live allocations, 0 for none. The thread budget is
+// the calling thread's and counts what that thread allocated.
+void poly_mem_set_budget(size_t bytes);
+void poly_mem_set_thread_budget(size_t bytes);
+
+// Whether bytes more could be allocated now without passing a budget;
+// poly_mem_check also counts a refusal and reports it as
+// POLYNOMIAL_MEM_ALLOC_FAIL
+int poly_mem_fits(size_t bytes);
+PolynomialError poly_mem_check(size_t bytes);
+
+void poly_mem_stats(PolyMemStats* stats);
+// The calling thread's live and peak bytes, and its budget if budget is set
+void poly_mem_thread_stats(PolyMemCounter* counter, size_t* budget);
+// Peaks restart from the current live bytes
+void poly_mem_reset_peaks(void);
+void poly_mem_print(const PolyMemStats* stats);
+const char* poly_mem_op_name(PolyMemOp op);
+const char* poly_mem_type_name(int type);
+
+// The allocator. Blocks carry a small header and must be released with
+// poly_mem_free or resized with poly_mem_realloc.
+void* poly_mem_alloc(size_t bytes);
+void* poly_mem_calloc(size_t count, size_t size);
+void* poly_mem_realloc(void* block, size_t bytes);
+void poly_mem_free(void* block);
+
+// Marks the calling thread as inside an operation until poly_mem_leave,
+// which takes what poly_mem_enter returned. typeInfo may be NULL.
+typedef struct {
+    unsigned char op;
+    unsigned char type;
+    int depth;
+} PolyMemScope;
+
+PolyMemScope poly_mem_enter(PolyMemOp op, const TypeInfo* typeInfo);
+void poly_mem_leave(const PolyMemScope* saved);
+// The calling thread's scope, and a way to take it over on another thread
+PolyMemScope poly_mem_current(void);
+PolyMemScope poly_mem_resume(const PolyMemScope* scope);
+
+#endif
@@ -0,0 +1,929 @@
+#include "PolynomialRealRoots.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "ThreadPool.h"
+#include "Integer.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Gives up below intervals this many halvings deep
+#define ISO_MAX_DEPTH 65536
+
+/* ---- Multi-word integers: two's complement, little-endian 64-bit limbs ---- */
+
+static int big_sign(const uint64_t* v, int limbs) {
+    if (v[limbs - 1] >> 63) return -1;
+    for (int i = 0; i < limbs; i++) {
+        if (v[i]) return 1;
+    }
+    return 0;
+}
+
+static void big_add(uint64_t* restrict dst, const uint64_t* restrict src, int limbs) {
+    uint64_t carry = 0;
+    for (int i = 0; i < limbs; i++) {
+        PolyUInt128 sum = (PolyUInt128)dst[i] + src[i] + carry;
+        dst[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+}
+
+static void big_negate(uint64_t* v, int limbs) {
+    uint64_t carry = 1;
+    for (int i = 0; i < limbs; i++) {
+        uint64_t x = ~v[i] + carry;
+        carry = carry && x == 0;
+        v[i] = x;
+    }
+}
+
+// Bits of the magnitude, at most one more than needed for negative values
+static int big_bits(const uint64_t* v, int limbs) {
+    uint64_t fill = v[limbs - 1] >> 63 ? ~(uint64_t)0 : 0;
+    for (int i = limbs - 1; i >= 0; i--) {
+        uint64_t x = v[i] ^ fill;
+        if (x) return i * 64 + 64 - __builtin_clzll(x) + (fill ? 1 : 0);
+    }
+    return fill ? 1 : 0;
+}
+
+static void big_shl(uint64_t* v, int limbs, int shift) {
+    int words = shift / 64;
+    int bits = shift % 64;
+    for (int i = limbs - 1; i >= 0; i--) {
+        int src = i - words;
+        uint64_t x = src >= 0 ? v[src] << bits : 0;
+        if (bits && src >= 1) x |= v[src - 1] >> (64 - bits);
+        v[i] = x;
+    }
+}
+
+static void big_resize(uint64_t* dst, int dstLimbs, const uint64_t* src, int srcLimbs) {
+    int common = dstLimbs < srcLimbs ? dstLimbs : srcLimbs;
+    memcpy(dst, src, common * sizeof(uint64_t));
+    uint64_t fill = src[srcLimbs - 1] >> 63 ? ~(uint64_t)0 : 0;
+    for (int i = common; i < dstLimbs; i++) dst[i] = fill;
+}
+
+// r = v * a truncated to limbs words, for a of aLimbs words; as a sum of
+// limb products it is right for signed v and a whenever the product fits
+static void big_mul(uint64_t* restrict r, const uint64_t* restrict v, const uint64_t* restrict a, int aLimbs,
+                    int limbs) {
+    memset(r, 0, limbs * sizeof(uint64_t));
+    for (int i = 0; i < aLimbs; i++) {
+        if (!a[i]) continue;
+        uint64_t carry = 0;
+        for (int j = 0; i + j < limbs; j++) {
+            PolyUInt128 t = (PolyUInt128)v[j] * a[i] + r[i + j] + carry;
+            r[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+    }
+}
+
+// v * 2^exp for v >= 0, rounded toward zero or, with up, away from it
+static double big_to_double(const uint64_t* v, int limbs, int exp, int up) {
+    int bits = big_bits(v, limbs);
+    if (bits == 0) return 0.0;
+    int drop = bits > 53 ? bits - 53 : 0;
+    uint64_t top = 0;
+    int inexact = 0;
+    for (int b = 0; b < bits; b++) {
+        int bit = (v[b / 64] >> (b % 64)) & 1;
+        if (b < drop) inexact |= bit;
+        else top |= (uint64_t)bit << (b - drop);
+    }
+    double d = ldexp((double)top, drop + exp);
+    return up && inexact ? nextafter(d, INFINITY) : d;
+}
+
+/* ---- Polynomials with multi-word coefficients ---- */
+
+typedef struct {
+    int degree;
+    int limbs;
+    uint64_t* c;    // coefficient i at c + i * limbs
+} IsoPoly;
+
+#define ISO_COEFF(p, i) ((p)->c + (size_t)(i) * (p)->limbs)
+
+static PolynomialError iso_alloc(IsoPoly* p, int degree, int limbs) {
+    p->degree = degree;
+    p->limbs = limbs;
+    p->c = poly_mem_calloc((size_t)(degree + 1) * limbs, sizeof(uint64_t));
+    return p->c ? POLYNOMIAL_OK : POLYNOMIAL_MEM_ALLOC_FAIL;
+}
+
+static int iso_max_bits(const IsoPoly* p) {
+    int bits = 0;
+    for (int i = 0; i <= p->degree; i++) {
+        int b = big_bits(ISO_COEFF(p, i), p->limbs);
+        if (b > bits) bits = b;
+    }
+    return bits;
+}
+
+static PolynomialError iso_resize(IsoPoly* p, int limbs) {
+    if (limbs == p->limbs) return POLYNOMIAL_OK;
+    uint64_t* c = poly_mem_alloc((size_t)(p->degree + 1) * limbs * sizeof(uint64_t));
+    if (!c) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    for (int i = 0; i <= p->degree; i++) big_resize(c + (size_t)i * limbs, limbs, ISO_COEFF(p, i), p->limbs);
+    poly_mem_free(p->c);
+    p->c = c;
+    p->limbs = limbs;
+    return POLYNOMIAL_OK;
+}
+
+// Resizes the coefficients to hold their current values plus extra bits
+static PolynomialError iso_fit(IsoPoly* p, int extra) {
+    return iso_resize(p, (iso_max_bits(p) + extra + 1 + 63) / 64);
+}
+
+static PolynomialError iso_copy(IsoPoly* dst, const IsoPoly* src) {
+    PolynomialError err = iso_alloc(dst, src->degree, src->limbs);
+    if (err == POLYNOMIAL_OK) memcpy(dst->c, src->c, (size_t)(src->degree + 1) * src->limbs * sizeof(uint64_t));
+    return err;
+}
+
+static int iso_variations(const IsoPoly* p) {
+    int variations = 0, last = 0;
+    for (int i = 0; i <= p->degree; i++) {
+        int s = big_sign(ISO_COEFF(p, i), p->limbs);
+        if (s && last && s != last) variations++;
+        if (s) last = s;
+    }
+    return variations;
+}
+
+// p(x) <- p(x + 1) in place by repeated additions; needs degree bits of
+// headroom (iso_fit). After pass i coefficient i is final, so sign
+// variations are counted as they appear and the shift stops at limit.
+static int iso_taylor_shift(IsoPoly* p, int limit) {
+    int n = p->degree;
+    int limbs = p->limbs;
+    int variations = 0, last = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = n - 1; j >= i; j--) big_add(ISO_COEFF(p, j), ISO_COEFF(p, j + 1), limbs);
+        int s = big_sign(ISO_COEFF(p, i), limbs);
+        if (s && last && s != last) variations++;
+        if (s) last = s;
+        if (variations >= limit) return variations;
+    }
+    int s = big_sign(ISO_COEFF(p, n), limbs);
+    if (s && last && s != last) variations++;
+    return variations;
+}
+
+// Descartes' bound on the roots of p in (0, 1): the sign variations of
+// (x + 1)^n p(1 / (x + 1)), capped at 2
+static PolynomialError iso_descartes(const IsoPoly* p, int* variations) {
+    // no variations in p itself: no positive roots at all
+    if (iso_variations(p) == 0) {
+        *variations = 0;
+        return POLYNOMIAL_OK;
+    }
+    IsoPoly r;
+    PolynomialError err = iso_alloc(&r, p->degree, p->limbs);
+    if (err != POLYNOMIAL_OK) return err;
+    for (int i = 0; i <= p->degree; i++) {
+        memcpy(ISO_COEFF(&r, i), ISO_COEFF(p, p->degree - i), p->limbs * sizeof(uint64_t));
+    }
+    err = iso_fit(&r, p->degree + 1);
+    if (err == POLYNOMIAL_OK) *variations = iso_taylor_shift(&r, 2);
+    poly_mem_free(r.c);
+    return err;
+}
+
+static int big_trailing_zeros(const uint64_t* v, int limbs) {
+    for (int i = 0; i < limbs; i++) {
+        if (v[i]) return i * 64 + __builtin_ctzll(v[i]);
+    }
+    return INT_MAX;
+}
+
+// Arithmetic shift right, for shift < 64 * limbs
+static void big_shr(uint64_t* v, int limbs, int shift) {
+    int words = shift / 64;
+    int bits = shift % 64;
+    uint64_t fill = v[limbs - 1] >> 63 ? ~(uint64_t)0 : 0;
+    for (int i = 0; i < limbs; i++) {
+        int src = i + words;
+        uint64_t lo = src < limbs ? v[src] : fill;
+        uint64_t hi = src + 1 < limbs ? v[src + 1] : fill;
+        v[i] = bits ? lo >> bits | hi << (64 - bits) : lo;
+    }
+}
+
+// Divides out the largest power of two common to all coefficients, which
+// leaves the roots alone and keeps the coefficients from growing by n bits
+// at every halving
+static void iso_remove_twos(IsoPoly* p) {
+    int shift = INT_MAX;
+    for (int i = 0; i <= p->degree && shift > 0; i++) {
+        int zeros = big_trailing_zeros(ISO_COEFF(p, i), p->limbs);
+        if (zeros < shift) shift = zeros;
+    }
+    if (shift == 0 || shift == INT_MAX) return;
+    for (int i = 0; i <= p->degree; i++) big_shr(ISO_COEFF(p, i), p->limbs, shift);
+}
+
+// p(x) <- 2^n p(x / 2)
+static PolynomialError iso_halve(IsoPoly* p) {
+    PolynomialError err = iso_fit(p, p->degree);
+    if (err != POLYNOMIAL_OK) return err;
+    for (int i = 0; i < p->degree; i++) big_shl(ISO_COEFF(p, i), p->limbs, p->degree - i);
+    iso_remove_twos(p);
+    return POLYNOMIAL_OK;
+}
+
+/* ---- The bisection tree ---- */
+
+// The roots of poly in (0, 1) correspond to those of p in
+// sign * 2^K (c, c + 1) / 2^depth
+typedef struct {
+    IsoPoly poly;
+    uint64_t* c;     // depth / 64 + 1 limbs
+    int depth;
+    int negative;
+    int rootAtLower;   // an exact root sits at the end nearer 0
+    int rootAtUpper;
+} IsoNode;
+
+enum { ISO_DISCARD, ISO_ISOLATED, ISO_SPLIT };
+
+typedef struct {
+    IsoNode* nodes;
+    IsoNode* children;       // two per node
+    signed char* outcome;
+    signed char* midpointRoot;
+    PolynomialError* errors;
+} IsoLevel;
+
+static int iso_c_limbs(int depth) {
+    return depth / 64 + 1;
+}
+
+static PolynomialError iso_split(IsoNode* node, IsoNode* left, IsoNode* right, signed char* midpointRoot) {
+    int n = node->poly.degree;
+    int limbs = iso_c_limbs(node->depth + 1);
+    left->c = poly_mem_calloc(limbs, sizeof(uint64_t));
+    right->c = poly_mem_calloc(limbs, sizeof(uint64_t));
+    if (!left->c || !right->c) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    memcpy(left->c, node->c, iso_c_limbs(node->depth) * sizeof(uint64_t));
+    big_shl(left->c, limbs, 1);
+    memcpy(right->c, left->c, limbs * sizeof(uint64_t));
+    right->c[0] |= 1;
+    left->depth = right->depth = node->depth + 1;
+    left->negative = right->negative = node->negative;
+    left->rootAtLower = node->rootAtLower;
+    right->rootAtUpper = node->rootAtUpper;
+
+    // left(x) = 2^n p(x / 2), right(x) = left(x + 1)
+    left->poly = node->poly;
+    node->poly.c = NULL;
+    PolynomialError err = iso_halve(&left->poly);
+    if (err == POLYNOMIAL_OK) err = iso_copy(&right->poly, &left->poly);
+    if (err == POLYNOMIAL_OK) err = iso_fit(&right->poly, n + 1);
+    if (err != POLYNOMIAL_OK) return err;
+    iso_taylor_shift(&right->poly, INT_MAX);
+
+    // a root at the midpoint is reported on its own and divided out
+    *midpointRoot = big_sign(ISO_COEFF(&right->poly, 0), right->poly.limbs) == 0;
+    if (*midpointRoot) {
+        memmove(right->poly.c, ISO_COEFF(&right->poly, 1), (size_t)n * right->poly.limbs * sizeof(uint64_t));
+        right->poly.degree--;
+    }
+    left->rootAtUpper = right->rootAtLower = *midpointRoot;
+    return POLYNOMIAL_OK;
+}
+
+static void iso_level_body(void* ctx, int begin, int end) {
+    IsoLevel* level = ctx;
+    for (int i = begin; i < end; i++) {
+        IsoNode* node = &level->nodes[i];
+        int variations = 0;
+        level->midpointRoot[i] = 0;
+        level->errors[i] = iso_descartes(&node->poly, &variations);
+        if (level->errors[i] != POLYNOMIAL_OK) continue;
+        if (variations == 0) {
+            level->outcome[i] = ISO_DISCARD;
+        } else if (variations == 1) {
+            level->outcome[i] = ISO_ISOLATED;
+        } else {
+            level->outcome[i] = ISO_SPLIT;
+            level->errors[i] = iso_split(node, &level->children[2 * i], &level->children[2 * i + 1],
+                                         &level->midpointRoot[i]);
+        }
+    }
+}
+
+static void iso_node_free(IsoNode* node) {
+    poly_mem_free(node->poly.c);
+    poly_mem_free(node->c);
+    node->poly.c = NULL;
+    node->c = NULL;
+}
+
+/* ---- Refinement and output ---- */
+
+typedef struct {
+    IsoNode* nodes;
+    int exponent;        // K
+    int lowExponent;     // every nonzero root is above 2^-lowExponent
+    double precision;
+    PolyRealRoot* out;
+    PolynomialError* errors;
+} IsoRefine;
+
+// Sign of p(a / 2^j) for 0 < a < 2^j, from the exact integer
+// sum c_i a^i 2^(j (n - i)) by Horner's rule; work holds 3 * limbs words
+static int iso_sign_at(const IsoPoly* p, const uint64_t* a, int aLimbs, int j, uint64_t* work, int limbs) {
+    int n = p->degree;
+    uint64_t* acc = work;
+    uint64_t* product = work + limbs;
+    uint64_t* term = work + 2 * limbs;
+    big_resize(acc, limbs, ISO_COEFF(p, n), p->limbs);
+    for (int i = n - 1; i >= 0; i--) {
+        int negative = big_sign(acc, limbs) < 0;
+        if (negative) big_negate(acc, limbs);
+        big_mul(product, acc, a, aLimbs, limbs);
+        memcpy(acc, product, limbs * sizeof(uint64_t));
+        if (negative) big_negate(acc, limbs);
+        big_resize(term, limbs, ISO_COEFF(p, i), p->limbs);
+        big_shl(term, limbs, j * (n - i));
+        big_add(acc, term, limbs);
+    }
+    return big_sign(acc, limbs);
+}
+
+// Writes the root between num and num + 1 (or at num when exact) times
+// 2^exp, mirrored for negative roots
+static void iso_store_root(const uint64_t* num, int limbs, int exp, int exact, int negative, PolyRealRoot* out) {
+    double lower = big_to_double(num, limbs, exp, 0);
+    double upper;
+    if (exact) {
+        upper = big_to_double(num, limbs, exp, 1);
+    } else {
+        uint64_t* next = poly_mem_alloc((limbs + 1) * sizeof(uint64_t));
+        if (next) {
+            uint64_t one = 1;
+            memcpy(next, num, limbs * sizeof(uint64_t));
+            next[limbs] = 0;
+            for (int i = 0; i <= limbs && one; i++) {
+                next[i] += one;
+                one = next[i] == 0;
+            }
+            upper = big_to_double(next, limbs + 1, exp, 1);
+            poly_mem_free(next);
+        } else {
+            upper = nextafter(lower + ldexp(1.0, exp), INFINITY);
+        }
+    }
+    out->lower = negative ? -upper : lower;
+    out->upper = negative ? -lower : upper;
+}
+
+// Bisections after which an interval ending at an exact root stops short
+// of it by a double: steps of at most half an ulp of the root land on the
+// double next to it, which the root inside is beyond unless the two are
+// closer than that. 0 itself is kept apart by 2^-lowExponent
+static int iso_separating_steps(const IsoNode* node, int exponent, int lowExponent) {
+    int cLimbs = iso_c_limbs(node->depth);
+    int shift = exponent - node->depth;
+    double lower = big_to_double(node->c, cLimbs, shift, 0);
+    int steps = 0;
+    if (node->rootAtLower) {
+        int unit = lower == 0.0 ? -lowExponent : ilogb(lower) - DBL_MANT_DIG;
+        steps = shift - unit;
+    }
+    if (node->rootAtUpper) {
+        int unit = ilogb(lower + ldexp(1.0, shift)) - DBL_MANT_DIG;
+        if (shift - unit > steps) steps = shift - unit;
+    }
+    return steps;
+}
+
+static PolynomialError iso_refine(const IsoNode* node, int exponent, int lowExponent, double precision,
+                                  PolyRealRoot* out) {
+    const IsoPoly* p = &node->poly;
+    int n = p->degree;
+    // bisect t in (a, a + 1) / 2^j until 2^(K - depth - j) <= precision
+    int j = 0;
+    if (precision > 0.0) {
+        int scale;
+        frexp(precision, &scale);
+        j = exponent - node->depth - scale + 1;
+    }
+    int separating = iso_separating_steps(node, exponent, lowExponent);
+    if (separating > j) j = separating;
+    if (j < 0) j = 0;
+    if (j > ISO_MAX_DEPTH) j = ISO_MAX_DEPTH;
+    int steps = j;
+    int aLimbs = steps / 64 + 1;
+    int cLimbs = iso_c_limbs(node->depth);
+    int numLimbs = (node->depth + steps) / 64 + 2;
+    int limbs = (iso_max_bits(p) + steps * n + 64 - __builtin_clzll((uint64_t)n + 1) + 2 + 63) / 64 + 1;
+    uint64_t* a = poly_mem_calloc(aLimbs + 1, sizeof(uint64_t));
+    uint64_t* mid = poly_mem_calloc(aLimbs + 1, sizeof(uint64_t));
+    uint64_t* num = poly_mem_calloc(numLimbs, sizeof(uint64_t));
+    uint64_t* work = poly_mem_alloc((size_t)3 * limbs * sizeof(uint64_t));
+    if (!a || !mid || !num || !work) {
+        poly_mem_free(a);
+        poly_mem_free(mid);
+        poly_mem_free(num);
+        poly_mem_free(work);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    int lowSign = big_sign(ISO_COEFF(p, 0), p->limbs);
+    int exact = 0;
+    for (j = 0; j < steps && !exact; j++) {
+        memcpy(mid, a, (aLimbs + 1) * sizeof(uint64_t));
+        big_shl(mid, aLimbs + 1, 1);
+        mid[0] |= 1;
+        int s = iso_sign_at(p, mid, aLimbs + 1, j + 1, work, limbs);
+        big_shl(a, aLimbs + 1, 1);
+        if (s == 0) exact = 1;
+        if (s == 0 || s == lowSign) a[0] |= 1;
+    }
+
+    // numerator c 2^j + a over 2^(depth + j), scaled by 2^K
+    memcpy(num, node->c, cLimbs * sizeof(uint64_t));
+    big_shl(num, numLimbs, j);
+    big_add(num, a, aLimbs + 1 < numLimbs ? aLimbs + 1 : numLimbs);
+    iso_store_root(num, numLimbs, exponent - node->depth - j, exact, node->negative, out);
+
+    poly_mem_free(a);
+    poly_mem_free(mid);
+    poly_mem_free(num);
+    poly_mem_free(work);
+    return POLYNOMIAL_OK;
+}
+
+static void iso_refine_body(void* ctx, int begin, int end) {
+    IsoRefine* job = ctx;
+    for (int i = begin; i < end; i++) {
+        job->errors[i] = iso_refine(&job->nodes[i], job->exponent, job->lowExponent, job->precision, &job->out[i]);
+    }
+}
+
+/* ---- Square-freeness modulo primes ---- */
+
+static uint32_t mod_pow(uint64_t base, uint64_t e, uint32_t p) {
+    uint64_t r = 1;
+    base %= p;
+    while (e) {
+        if (e & 1) r = r * base % p;
+        base = base * base % p;
+        e >>= 1;
+    }
+    return (uint32_t)r;
+}
+
+// Degree of gcd(a, b) over Z/p, destroying both; a and b are trimmed
+static int mod_gcd_degree(uint32_t* a, int da, uint32_t* b, int db, uint32_t p) {
+    while (db >= 0) {
+        // a <- a mod b
+        uint32_t inv = mod_pow(b[db], p - 2, p);
+        while (da >= db) {
+            uint64_t q = (uint64_t)a[da] * inv % p;
+            for (int i = 0; i <= db; i++) {
+                a[da - db + i] = (uint32_t)((a[da - db + i] + (uint64_t)(p - q) * b[i]) % p);
+            }
+            while (da >= 0 && a[da] == 0) da--;
+        }
+        uint32_t* t = a;
+        a = b;
+        b = t;
+        int dt = da;
+        da = db;
+        db = dt;
+    }
+    return da;
+}
+
+// A fast path for iso_square_free_part: p is square-free over the rationals
+// if, reduced modulo a prime that keeps its degree, it is coprime to its
+// derivative. Failing that proves nothing.
+static int iso_square_free_modular(const Int128* c, int n) {
+    static const uint32_t primes[] = {998244353u, 1000000007u, 1000000009u};
+    uint32_t* a = poly_mem_alloc((size_t)(2 * n + 1) * sizeof(uint32_t));
+    if (!a) return 0;
+    uint32_t* b = a + n + 1;
+    int squareFree = 0;
+    for (size_t k = 0; k < sizeof(primes) / sizeof(primes[0]) && !squareFree; k++) {
+        uint32_t p = primes[k];
+        for (int i = 0; i <= n; i++) {
+            Int128 r = c[i] % p;
+            a[i] = (uint32_t)(r < 0 ? r + p : r);
+        }
+        if (a[n] == 0) continue;
+        int db = n - 1;
+        for (int i = 1; i <= n; i++) b[i - 1] = (uint32_t)((uint64_t)a[i] * i % p);
+        while (db >= 0 && b[db] == 0) db--;
+        if (db < 0) continue;
+        squareFree = mod_gcd_degree(a, n, b, db, p) == 0;
+    }
+    poly_mem_free(a);
+    return squareFree;
+}
+
+static int iso_compare_roots(const void* x, const void* y) {
+    const PolyRealRoot* a = x;
+    const PolyRealRoot* b = y;
+    if (a->lower != b->lower) return a->lower > b->lower ? 1 : -1;
+    return (a->upper > b->upper) - (a->upper < b->upper);
+}
+
+/* ---- Exact square-free part ---- */
+
+// dst -= src
+static void big_sub(uint64_t* restrict dst, const uint64_t* restrict src, int limbs) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < limbs; i++) {
+        uint64_t s = src[i] + borrow;
+        uint64_t wrapped = s < borrow;
+        borrow = wrapped | (dst[i] < s);
+        dst[i] -= s;
+    }
+}
+
+// Orders a, b >= 0
+static int big_compare(const uint64_t* a, const uint64_t* b, int limbs) {
+    for (int i = limbs - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] > b[i] ? 1 : -1;
+    }
+    return 0;
+}
+
+// Bits of |v| rounded down, for the bounds that divide by v
+static int big_bits_floor(const uint64_t* v, int limbs) {
+    int bits = big_bits(v, limbs);
+    return big_sign(v, limbs) < 0 ? bits - 1 : bits;
+}
+
+// a <- gcd(a, b) for a, b >= 0 by the binary algorithm, destroying b
+static void big_gcd(uint64_t* restrict a, uint64_t* restrict b, int limbs) {
+    if (big_sign(b, limbs) == 0) return;
+    if (big_sign(a, limbs) == 0) {
+        memcpy(a, b, limbs * sizeof(uint64_t));
+        return;
+    }
+    int za = big_trailing_zeros(a, limbs);
+    int zb = big_trailing_zeros(b, limbs);
+    big_shr(a, limbs, za);
+    do {
+        big_shr(b, limbs, big_trailing_zeros(b, limbs));
+        if (big_compare(a, b, limbs) > 0) {
+            for (int i = 0; i < limbs; i++) {
+                uint64_t t = a[i];
+                a[i] = b[i];
+                b[i] = t;
+            }
+        }
+        big_sub(b, a, limbs);
+    } while (big_sign(b, limbs) != 0);
+    big_shl(a, limbs, za < zb ? za : zb);
+}
+
+// v <- v / d for d > 0 dividing v. Products truncated to limbs words are
+// right for either sign, so after the twos the quotient is v times the
+// inverse of odd d modulo 2^(64 limbs), which Newton's iteration reaches by
+// doubling the correct bits per step. work holds 4 * limbs words.
+static void big_divexact(uint64_t* v, const uint64_t* d, int limbs, uint64_t* work) {
+    uint64_t* odd = work;
+    uint64_t* inv = work + limbs;
+    uint64_t* t = work + 2 * limbs;
+    uint64_t* u = work + 3 * limbs;
+    memcpy(odd, d, limbs * sizeof(uint64_t));
+    int zeros = big_trailing_zeros(odd, limbs);
+    big_shr(odd, limbs, zeros);
+    big_shr(v, limbs, zeros);
+    // odd[0] is its own inverse to 3 bits
+    uint64_t x = odd[0];
+    for (int i = 0; i < 5; i++) x *= 2 - odd[0] * x;
+    memset(inv, 0, limbs * sizeof(uint64_t));
+    inv[0] = x;
+    for (int words = 1; words < limbs; words *= 2) {
+        // inv <- inv (2 - odd inv)
+        big_mul(t, odd, inv, limbs, limbs);
+        big_negate(t, limbs);
+        memset(u, 0, limbs * sizeof(uint64_t));
+        u[0] = 2;
+        big_add(t, u, limbs);
+        big_mul(u, inv, t, limbs, limbs);
+        memcpy(inv, u, limbs * sizeof(uint64_t));
+    }
+    big_mul(t, v, inv, limbs, limbs);
+    memcpy(v, t, limbs * sizeof(uint64_t));
+}
+
+static int iso_is_zero(const IsoPoly* p) {
+    return p->degree == 0 && big_sign(p->c, p->limbs) == 0;
+}
+
+static void iso_trim(IsoPoly* p) {
+    while (p->degree > 0 && big_sign(ISO_COEFF(p, p->degree), p->limbs) == 0) p->degree--;
+}
+
+// Divides p by the gcd of its coefficients, and by -1 if it leads negative
+static PolynomialError iso_primitive(IsoPoly* p) {
+    int limbs = p->limbs;
+    uint64_t* work = poly_mem_alloc((size_t)6 * limbs * sizeof(uint64_t));
+    if (!work) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    uint64_t* g = work;
+    uint64_t* m = work + limbs;
+    memset(g, 0, limbs * sizeof(uint64_t));
+    for (int i = 0; i <= p->degree; i++) {
+        memcpy(m, ISO_COEFF(p, i), limbs * sizeof(uint64_t));
+        if (big_sign(m, limbs) < 0) big_negate(m, limbs);
+        big_gcd(g, m, limbs);
+    }
+    int flip = big_sign(ISO_COEFF(p, p->degree), limbs) < 0;
+    int divide = big_bits(g, limbs) > 1;
+    for (int i = 0; i <= p->degree && (flip || divide); i++) {
+        if (divide) big_divexact(ISO_COEFF(p, i), g, limbs, work + 2 * limbs);
+        if (flip) big_negate(ISO_COEFF(p, i), limbs);
+    }
+    poly_mem_free(work);
+    return POLYNOMIAL_OK;
+}
+
+// Widens a and b to common limbs that hold every step of pseudo-dividing a
+// by b: each step multiplies a by lc(b) and subtracts lc(a) x^k b, adding at
+// most bits(b) + 1 bits
+static PolynomialError iso_pseudo_prepare(IsoPoly* a, IsoPoly* b) {
+    int steps = a->degree - b->degree + 1;
+    int limbs = (iso_max_bits(a) + steps * (iso_max_bits(b) + 1) + 1 + 63) / 64;
+    PolynomialError err = iso_resize(a, limbs);
+    return err == POLYNOMIAL_OK ? iso_resize(b, limbs) : err;
+}
+
+// a <- lc(b)^m a - q b, the pseudo-remainder of a by b, and the quotient in
+// q (if given, zeroed, of degree deg a - deg b). All share a's limbs, set
+// by iso_pseudo_prepare.
+static PolynomialError iso_pseudo_divide(IsoPoly* a, const IsoPoly* b, IsoPoly* q) {
+    int limbs = a->limbs;
+    uint64_t* work = poly_mem_alloc((size_t)2 * limbs * sizeof(uint64_t));
+    if (!work) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    uint64_t* lead = work;
+    uint64_t* t = work + limbs;
+    const uint64_t* divisorLead = ISO_COEFF(b, b->degree);
+    while (a->degree >= b->degree && !iso_is_zero(a)) {
+        int shift = a->degree - b->degree;
+        memcpy(lead, ISO_COEFF(a, a->degree), limbs * sizeof(uint64_t));
+        for (int i = 0; q && i <= q->degree; i++) {
+            big_mul(t, ISO_COEFF(q, i), divisorLead, limbs, limbs);
+            memcpy(ISO_COEFF(q, i), t, limbs * sizeof(uint64_t));
+        }
+        if (q) big_add(ISO_COEFF(q, shift), lead, limbs);
+        for (int i = 0; i <= a->degree; i++) {
+            big_mul(t, ISO_COEFF(a, i), divisorLead, limbs, limbs);
+            memcpy(ISO_COEFF(a, i), t, limbs * sizeof(uint64_t));
+            if (i < shift) continue;
+            big_mul(t, lead, ISO_COEFF(b, i - shift), limbs, limbs);
+            big_sub(ISO_COEFF(a, i), t, limbs);
+        }
+        // the leading term cancelled
+        if (a->degree > 0) a->degree--;
+        iso_trim(a);
+    }
+    poly_mem_free(work);
+    return POLYNOMIAL_OK;
+}
+
+// The square-free part of p, with each of its roots once: p / gcd(p, p'),
+// the gcd by the primitive remainder sequence over the integers. Its
+// coefficients may outgrow 128 bits. out->c is always the caller's to free.
+static PolynomialError iso_square_free_part(const Int128* c, int n, IsoPoly* out) {
+    PolynomialError err = iso_alloc(out, n, 2);
+    for (int i = 0; err == POLYNOMIAL_OK && i <= n; i++) {
+        ISO_COEFF(out, i)[0] = (uint64_t)c[i];
+        ISO_COEFF(out, i)[1] = (uint64_t)((PolyUInt128)c[i] >> 64);
+    }
+    if (err != POLYNOMIAL_OK || n < 2 || iso_square_free_modular(c, n)) return err;
+
+    IsoPoly a = {0}, b = {0}, q = {0}, r = {0};
+    err = iso_copy(&a, out);
+    if (err == POLYNOMIAL_OK) err = iso_alloc(&b, n - 1, 3);
+    for (int i = 1; err == POLYNOMIAL_OK && i <= n; i++) {
+        uint64_t value[3], factor[3] = {(uint64_t)i, 0, 0};
+        big_resize(value, 3, ISO_COEFF(out, i), 2);
+        big_mul(ISO_COEFF(&b, i - 1), value, factor, 3, 3);
+    }
+    if (err == POLYNOMIAL_OK) err = iso_primitive(&a);
+    if (err == POLYNOMIAL_OK) err = iso_primitive(&b);
+    // gcd(a, b) = gcd(b, prem(a, b)) up to a constant
+    while (err == POLYNOMIAL_OK && b.degree > 0) {
+        err = iso_pseudo_prepare(&a, &b);
+        if (err == POLYNOMIAL_OK) err = iso_pseudo_divide(&a, &b, NULL);
+        if (err == POLYNOMIAL_OK && !iso_is_zero(&a)) err = iso_primitive(&a);
+        if (err == POLYNOMIAL_OK) err = iso_fit(&a, 0);
+        IsoPoly t = a;
+        a = b;
+        b = t;
+    }
+    // b is zero when a is the gcd, a nonzero constant when p is square-free
+    if (err == POLYNOMIAL_OK && iso_is_zero(&b) && a.degree > 0) {
+        // g divides p, so the pseudo-quotient is a multiple of p / g
+        err = iso_copy(&r, out);
+        if (err == POLYNOMIAL_OK) err = iso_pseudo_prepare(&r, &a);
+        if (err == POLYNOMIAL_OK) err = iso_alloc(&q, r.degree - a.degree, r.limbs);
+        if (err == POLYNOMIAL_OK) err = iso_pseudo_divide(&r, &a, &q);
+        if (err == POLYNOMIAL_OK) err = iso_primitive(&q);
+        if (err == POLYNOMIAL_OK) err = iso_fit(&q, 0);
+        if (err == POLYNOMIAL_OK) {
+            poly_mem_free(out->c);
+            *out = q;
+            q.c = NULL;
+        }
+    }
+    poly_mem_free(a.c);
+    poly_mem_free(b.c);
+    poly_mem_free(q.c);
+    poly_mem_free(r.c);
+    return err;
+}
+
+// q(x) = p(sign 2^K x), whose roots in (0, 1) are those of p in sign (0, 2^K)
+static PolynomialError iso_root_node(const IsoPoly* p, int exponent, int negative, int zeroRoot, IsoNode* node) {
+    int n = p->degree;
+    node->depth = 0;
+    node->negative = negative;
+    node->rootAtLower = zeroRoot;
+    node->rootAtUpper = 0;
+    node->c = poly_mem_calloc(1, sizeof(uint64_t));
+    PolynomialError err = node->c ? iso_alloc(&node->poly, n, (iso_max_bits(p) + exponent * n + 1 + 63) / 64)
+                                  : POLYNOMIAL_MEM_ALLOC_FAIL;
+    if (err != POLYNOMIAL_OK) return err;
+    for (int i = 0; i <= n; i++) {
+        uint64_t* coeff = ISO_COEFF(&node->poly, i);
+        big_resize(coeff, node->poly.limbs, ISO_COEFF(p, i), p->limbs);
+        if (negative && (i & 1)) big_negate(coeff, node->poly.limbs);
+        big_shl(coeff, node->poly.limbs, exponent * i);
+    }
+    return iso_fit(&node->poly, 0);
+}
+
+static PolynomialError poly_isolate_real_roots_unscoped(const Polynomial* poly, double precision, PolyRealRoot* roots, int* count) {
+    if (!poly || !roots || !count) return POLYNOMIAL_NULL_PTR;
+    int width = int_type_width(poly->typeInfo);
+    if (!width) return POLYNOMIAL_TYPE_MISMATCH;
+    *count = 0;
+
+    int n = poly->degree;
+    Int128* c = poly_mem_alloc((size_t)(n + 1) * sizeof(Int128));
+    if (!c) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    for (int i = 0; i <= n; i++) {
+        if (width == 32) c[i] = POLY_COEFFS(poly, const int)[i];
+        else if (width == 64) c[i] = POLY_COEFFS(poly, const int64_t)[i];
+        else c[i] = POLY_COEFFS(poly, const Int128)[i];
+    }
+    while (n >= 0 && c[n] == 0) n--;
+    int low = 0;
+    while (low <= n && c[low] == 0) low++;
+    if (n < 0) {
+        poly_mem_free(c);
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+    // x = 0 is a root of multiplicity low; the rest come from p / x^low
+    int zeroRoot = low > 0;
+    n -= low;
+    memmove(c, c + low, (size_t)(n + 1) * sizeof(Int128));
+    // repeated roots would stall the bisection, so isolate those of the
+    // square-free part, which are the same roots once each
+    IsoPoly p;
+    PolynomialError err = iso_square_free_part(c, n, &p);
+    poly_mem_free(c);
+    if (err != POLYNOMIAL_OK) {
+        poly_mem_free(p.c);
+        return err;
+    }
+    n = p.degree;
+
+    // Cauchy: every root is below 1 + max |c_i / c_n| <= 2^K
+    int maxBits = 0;
+    for (int i = 0; i < n; i++) {
+        int bits = big_bits(ISO_COEFF(&p, i), p.limbs);
+        if (bits > maxBits) maxBits = bits;
+    }
+    int exponent = maxBits - big_bits_floor(ISO_COEFF(&p, n), p.limbs) + 2;
+    if (exponent < 1) exponent = 1;
+    // and, on the reversed polynomial, every root is above 2^-lowExponent
+    maxBits = 0;
+    for (int i = 1; i <= n; i++) {
+        int bits = big_bits(ISO_COEFF(&p, i), p.limbs);
+        if (bits > maxBits) maxBits = bits;
+    }
+    int lowExponent = maxBits - big_bits_floor(ISO_COEFF(&p, 0), p.limbs) + 2;
+    if (lowExponent < 1) lowExponent = 1;
+
+    IsoNode* frontier = poly_mem_calloc(2, sizeof(IsoNode));
+    IsoNode* isolated = NULL;
+    int frontierCount = 0, isolatedCount = 0, isolatedCap = 0;
+    if (!frontier) err = POLYNOMIAL_MEM_ALLOC_FAIL;
+    for (int negative = 0; negative <= 1 && err == POLYNOMIAL_OK && n > 0; negative++) {
+        err = iso_root_node(&p, exponent, negative, zeroRoot, &frontier[frontierCount++]);
+    }
+
+    // breadth first, each level's intervals in parallel
+    while (err == POLYNOMIAL_OK && frontierCount > 0) {
+        if (frontier[0].depth > ISO_MAX_DEPTH) {
+            err = POLYNOMIAL_CALC_ERROR;
+            break;
+        }
+        IsoLevel level;
+        level.nodes = frontier;
+        level.children = poly_mem_calloc((size_t)2 * frontierCount, sizeof(IsoNode));
+        level.outcome = poly_mem_calloc(frontierCount, 1);
+        level.midpointRoot = poly_mem_calloc(frontierCount, 1);
+        level.errors = poly_mem_calloc(frontierCount, sizeof(PolynomialError));
+        if (!level.children || !level.outcome || !level.midpointRoot || !level.errors) err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        if (err == POLYNOMIAL_OK) err = thread_pool_parallel_for(thread_pool_shared(), frontierCount, 1, iso_level_body, &level);
+
+        int nextCount = 0;
+        for (int i = 0; err == POLYNOMIAL_OK && i < frontierCount; i++) {
+            if (level.errors[i] != POLYNOMIAL_OK) err = level.errors[i];
+        }
+        for (int i = 0; err == POLYNOMIAL_OK && i < frontierCount; i++) {
+            IsoNode* node = &frontier[i];
+            if (level.midpointRoot[i]) {
+                // (2c + 1) / 2^(depth + 1) exactly
+                int limbs = iso_c_limbs(node->depth + 1);
+                if (*count >= poly->degree) {
+                    err = POLYNOMIAL_CALC_ERROR;
+                    break;
+                }
+                iso_store_root(level.children[2 * i + 1].c, limbs, exponent - node->depth - 1, 1, node->negative,
+                               &roots[(*count)++]);
+            }
+            if (level.outcome[i] == ISO_ISOLATED) {
+                if (isolatedCount == isolatedCap) {
+                    isolatedCap = isolatedCap ? 2 * isolatedCap : 16;
+                    IsoNode* grown = poly_mem_realloc(isolated, isolatedCap * sizeof(IsoNode));
+                    if (!grown) {
+                        err = POLYNOMIAL_MEM_ALLOC_FAIL;
+                        break;
+                    }
+                    isolated = grown;
+                }
+                isolated[isolatedCount++] = *node;
+                node->poly.c = NULL;
+                node->c = NULL;
+            }
+        }
+        if (err == POLYNOMIAL_OK) {
+            for (int i = 0; i < frontierCount; i++) {
+                if (level.outcome[i] != ISO_SPLIT) continue;
+                level.children[nextCount++] = level.children[2 * i];
+                level.children[nextCount++] = level.children[2 * i + 1];
+            }
+        } else {
+            for (int i = 0; level.children && i < 2 * frontierCount; i++) iso_node_free(&level.children[i]);
+        }
+        for (int i = 0; i < frontierCount; i++) iso_node_free(&frontier[i]);
+        poly_mem_free(frontier);
+        poly_mem_free(level.outcome);
+        poly_mem_free(level.midpointRoot);
+        poly_mem_free(level.errors);
+        frontier = level.children;
+        frontierCount = nextCount;
+    }
+    for (int i = 0; i < frontierCount; i++) iso_node_free(&frontier[i]);
+    poly_mem_free(frontier);
+
+    if (err == POLYNOMIAL_OK && *count + isolatedCount + zeroRoot > poly->degree) err = POLYNOMIAL_CALC_ERROR;
+    if (err == POLYNOMIAL_OK && isolatedCount > 0) {
+        PolynomialError* errors = poly_mem_calloc(isolatedCount, sizeof(PolynomialError));
+        IsoRefine job = {isolated, exponent, lowExponent, precision, roots + *count, errors};
+        err = errors ? thread_pool_parallel_for(thread_pool_shared(), isolatedCount, 1, iso_refine_body, &job)
+                     : POLYNOMIAL_MEM_ALLOC_FAIL;
+        for (int i = 0; err == POLYNOMIAL_OK && i < isolatedCount; i++) err = errors[i];
+        poly_mem_free(errors);
+        *count += isolatedCount;
+    }
+    for (int i = 0; i < isolatedCount; i++) iso_node_free(&isolated[i]);
+    poly_mem_free(isolated);
+    poly_mem_free(p.c);
+
+    if (err != POLYNOMIAL_OK) {
+        *count = 0;
+        return err;
+    }
+    if (zeroRoot) {
+        roots[*count].lower = roots[*count].upper = 0.0;
+        (*count)++;
+    }
+    qsort(roots, *count, sizeof(PolyRealRoot), iso_compare_roots);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_isolate_real_roots(const Polynomial* poly, double precision, PolyRealRoot* roots, int* count) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_ROOTS, poly ? poly->typeInfo : NULL);
+    PolynomialError status = poly_isolate_real_roots_unscoped(poly, precision, roots, count);
+    poly_mem_leave(&scope);
+    return status;
+}
@@ -0,0 +1,30 @@
+#ifndef POLYNOMIAL_REAL_ROOTS_H
+#define POLYNOMIAL_REAL_ROOTS_H
+
+#include "Polynomial.h"
+
+// A real root lies in [lower, upper]; lower == upper when the root is that
+// double exactly. The intervals of different roots do not overlap: two can
+// share an endpoint, but never one that is a root, except where two roots
+// are closer than the doubles around them can tell apart.
+typedef struct {
+    double lower;
+    double upper;
+} PolyRealRoot;
+
+// Isolates the distinct real roots of an integer polynomial (any width)
+// with the Vincent-Collins-Akritas bisection: Descartes' rule of signs,
+// applied after a Taylor shift, bounds the roots in each dyadic interval,
+// and intervals with two or more sign variations are halved. Arithmetic
+// is exact on multi-word integers, and each level of the search is spread
+// over the shared thread pool. Isolating intervals are then bisected until
+// they are at most precision wide (precision <= 0 skips this), and those
+// ending at an exact root until they stop a double short of it.
+//
+// roots must hold poly->degree entries; *count receives how many were found,
+// sorted ascending, each root once whatever its multiplicity: the search
+// runs on the square-free part p / gcd(p, p'). The zero polynomial gives
+// POLYNOMIAL_INVALID_INPUT.
+PolynomialError poly_isolate_real_roots(const Polynomial* poly, double precision, PolyRealRoot* roots, int* count);
+
+#endif
@@ -0,0 +1,240 @@
+#include "PolynomialRoots.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "ThreadPool.h"
+#include "Integer.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POLY_ROOTS_PI 3.14159265358979323846
+
+static inline Complex c_make(double real, double imag) {
+    Complex c = {real, imag};
+    return c;
+}
+
+static inline Complex c_sub(Complex a, Complex b) {
+    return c_make(a.real - b.real, a.imag - b.imag);
+}
+
+static inline double c_abs(Complex a) {
+    return hypot(a.real, a.imag);
+}
+
+// Smith's division, avoids overflow in |b|^2
+static inline Complex c_div(Complex a, Complex b) {
+    if (fabs(b.real) >= fabs(b.imag)) {
+        double r = b.imag / b.real;
+        double d = b.real + b.imag * r;
+        return c_make((a.real + a.imag * r) / d, (a.imag - a.real * r) / d);
+    }
+    double r = b.real / b.imag;
+    double d = b.real * r + b.imag;
+    return c_make((a.real * r + a.imag) / d, (a.imag * r - a.real) / d);
+}
+
+// Starting points from the Newton polygon: the upper convex hull of
+// (i, log|c_i|). An edge from i to j contributes j - i points spread on a
+// circle whose radius is the geometric slope of that edge.
+static PolynomialError aberth_initial(const double* absc, int n, Complex* z) {
+    int* hull = poly_mem_alloc((n + 1) * sizeof(int));
+    double* lg = poly_mem_alloc((n + 1) * sizeof(double));
+    if (!hull || !lg) {
+        poly_mem_free(hull);
+        poly_mem_free(lg);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    int h = 0;
+    for (int i = 0; i <= n; i++) {
+        if (absc[i] == 0.0) continue;
+        lg[i] = log(absc[i]);
+        while (h >= 2) {
+            int a = hull[h - 2];
+            int b = hull[h - 1];
+            if ((lg[b] - lg[a]) * (i - a) > (lg[i] - lg[a]) * (b - a)) break;
+            h--;
+        }
+        hull[h++] = i;
+    }
+
+    for (int e = 0; e + 1 < h; e++) {
+        int a = hull[e];
+        int b = hull[e + 1];
+        int k = b - a;
+        double radius = exp((lg[a] - lg[b]) / k);
+        for (int l = 0; l < k; l++) {
+            double angle = 2.0 * POLY_ROOTS_PI * l / k + 2.0 * POLY_ROOTS_PI * a / n + 0.7;
+            z[a + l] = c_make(radius * cos(angle), radius * sin(angle));
+        }
+    }
+
+    poly_mem_free(hull);
+    poly_mem_free(lg);
+    return POLYNOMIAL_OK;
+}
+
+// Evaluates p and p' together in one Horner pass, along with the running
+// bound sum |c_i||z|^i used for the backward-error stopping test. Returns 1
+// when |p(z)| is at rounding level, otherwise stores the Newton correction
+// p(z)/p'(z) in ratio. For |z| > 1 the reversed polynomial is evaluated at
+// 1/z so that z^n cannot overflow.
+static int aberth_newton(const Complex* c, const double* absc, int n, Complex z, Complex* ratio) {
+    double tol = (4.0 * n + 1.0) * DBL_EPSILON;
+    double az = c_abs(z);
+
+    if (az <= 1.0) {
+        Complex p = c[n];
+        Complex dp = c_make(0.0, 0.0);
+        double bound = absc[n];
+        for (int i = n - 1; i >= 0; i--) {
+            dp = complex_k_add(complex_k_mul(dp, z), p);
+            p = complex_k_add(complex_k_mul(p, z), c[i]);
+            bound = bound * az + absc[i];
+        }
+        if (c_abs(p) <= tol * bound) return 1;
+        *ratio = c_abs(dp) > 0.0 ? c_div(p, dp) : c_make(DBL_EPSILON * (1.0 + az), 0.0);
+        return 0;
+    }
+
+    // p(z) = z^n R(y), y = 1/z, R(y) = sum c_(n-i) y^i, and p/p' = z R / (n R - y R')
+    Complex y = c_div(c_make(1.0, 0.0), z);
+    double ay = 1.0 / az;
+    Complex r = c[0];
+    Complex dr = c_make(0.0, 0.0);
+    double bound = absc[0];
+    for (int i = 1; i <= n; i++) {
+        dr = complex_k_add(complex_k_mul(dr, y), r);
+        r = complex_k_add(complex_k_mul(r, y), c[i]);
+        bound = bound * ay + absc[i];
+    }
+    if (c_abs(r) <= tol * bound) return 1;
+
+    Complex denom = c_sub(complex_k_mul(c_make(n, 0.0), r), complex_k_mul(y, dr));
+    *ratio = c_abs(denom) > 0.0 ? c_div(complex_k_mul(z, r), denom) : c_make(DBL_EPSILON * az, 0.0);
+    return 0;
+}
+
+// Simultaneous Aberth-Ehrlich iteration on c[0..n] with c[0] and c[n] nonzero.
+// Each root stops on its own once it converges and is then only read.
+static PolynomialError aberth_solve(const Complex* c, int n, Complex* z) {
+    char* scratch = poly_mem_alloc((n + 1) * sizeof(double) + n);
+    if (!scratch) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    double* absc = (double*)scratch;
+    char* done = scratch + (n + 1) * sizeof(double);
+
+    for (int i = 0; i <= n; i++) absc[i] = c_abs(c[i]);
+    memset(done, 0, n);
+
+    PolynomialError err = aberth_initial(absc, n, z);
+    int active = n;
+    for (int iter = 0; err == POLYNOMIAL_OK && active > 0 && iter < POLY_ROOTS_MAX_ITERATIONS; iter++) {
+        if (poly_job_checkpoint(n - active, n)) {
+            err = POLYNOMIAL_CANCELLED;
+            break;
+        }
+        for (int k = 0; k < n; k++) {
+            if (done[k]) continue;
+
+            Complex ratio;
+            if (aberth_newton(c, absc, n, z[k], &ratio)) {
+                done[k] = 1;
+                active--;
+                continue;
+            }
+
+            Complex sum = c_make(0.0, 0.0);
+            for (int j = 0; j < n; j++) {
+                if (j == k) continue;
+                sum = complex_k_add(sum, c_div(c_make(1.0, 0.0), c_sub(z[k], z[j])));
+            }
+            Complex w = c_div(ratio, c_sub(c_make(1.0, 0.0), complex_k_mul(ratio, sum)));
+            z[k] = c_sub(z[k], w);
+
+            if (c_abs(w) <= 2.0 * DBL_EPSILON * c_abs(z[k])) {
+                done[k] = 1;
+                active--;
+            }
+        }
+    }
+
+    poly_mem_free(scratch);
+    if (err != POLYNOMIAL_OK) return err;
+    return active == 0 ? POLYNOMIAL_OK : POLYNOMIAL_CALC_ERROR;
+}
+
+static PolynomialError poly_roots_unscoped(const Polynomial* poly, Complex* roots_out) {
+    if (!poly || !roots_out) return POLYNOMIAL_NULL_PTR;
+
+    PolyKernelType type = poly_kernel_type(poly->typeInfo);
+    if (!int_type_width(poly->typeInfo) && type != POLY_KERNEL_complex) return POLYNOMIAL_TYPE_MISMATCH;
+
+    int n = poly->degree;
+    if (n == 0) return POLYNOMIAL_OK;
+
+    Complex* c = poly_mem_alloc((n + 1) * sizeof(Complex));
+    if (!c) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    for (int i = 0; i <= n; i++) {
+        if (type == POLY_KERNEL_int) c[i] = c_make(POLY_COEFFS(poly, const int)[i], 0.0);
+        else if (type == POLY_KERNEL_int64) c[i] = c_make((double)POLY_COEFFS(poly, const int64_t)[i], 0.0);
+        else if (type == POLY_KERNEL_int128) c[i] = c_make((double)POLY_COEFFS(poly, const Int128)[i], 0.0);
+        else c[i] = POLY_COEFFS(poly, const Complex)[i];
+    }
+
+    if (c[n].real == 0.0 && c[n].imag == 0.0) {
+        poly_mem_free(c);
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+
+    // deflate exact zero roots before iterating
+    int zeros = 0;
+    while (c[zeros].real == 0.0 && c[zeros].imag == 0.0) {
+        roots_out[zeros++] = c_make(0.0, 0.0);
+    }
+
+    PolynomialError err = POLYNOMIAL_OK;
+    int m = n - zeros;
+    if (m == 1) {
+        roots_out[zeros] = c_div(c_make(-c[zeros].real, -c[zeros].imag), c[n]);
+    } else if (m > 1) {
+        err = aberth_solve(c + zeros, m, roots_out + zeros);
+    }
+
+    poly_mem_free(c);
+    return err;
+}
+
+PolynomialError poly_roots(const Polynomial* poly, Complex* roots_out) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_ROOTS, poly ? poly->typeInfo : NULL);
+    PolynomialError status = poly_roots_unscoped(poly, roots_out);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+typedef struct {
+    const Polynomial* const* polys;
+    Complex* const* roots;
+    PolynomialError* errors;
+    PolynomialError status;
+} RootsBatch;
+
+static void poly_roots_batch_body(void* ctx, int begin, int end) {
+    RootsBatch* batch = ctx;
+    for (int i = begin; i < end; i++) {
+        PolynomialError err = poly_roots(batch->polys[i], batch->roots[i]);
+        if (batch->errors) batch->errors[i] = err;
+        if (err != POLYNOMIAL_OK) __atomic_store_n(&batch->status, err, __ATOMIC_RELAXED);
+    }
+}
+
+PolynomialError poly_roots_batch(const Polynomial* const* polys, Complex* const* roots_out,
+                                 PolynomialError* errors, int count) {
+    if (count > 0 && (!polys || !roots_out)) return POLYNOMIAL_NULL_PTR;
+    if (count < 0) return POLYNOMIAL_INVALID_INPUT;
+
+    RootsBatch batch = {polys, roots_out, errors, POLYNOMIAL_OK};
+    PolynomialError err = thread_pool_parallel_for(thread_pool_shared(), count, 4, poly_roots_batch_body, &batch);
+    return err != POLYNOMIAL_OK ? err : batch.status;
+}
@@ -0,0 +1,20 @@
+#ifndef POLYNOMIAL_ROOTS_H
+#define POLYNOMIAL_ROOTS_H
+
+#include "Polynomial.h"
+#include "Complex.h"
+
+// Give up after this many Aberth sweeps; poly_roots then reports POLYNOMIAL_CALC_ERROR
+#define POLY_ROOTS_MAX_ITERATIONS 500
+
+// All complex roots of an integer or Complex polynomial by simultaneous
+// Aberth-Ehrlich iteration. roots_out must hold poly->degree values.
+PolynomialError poly_roots(const Polynomial* poly, Complex* roots_out);
+
+// Runs poly_roots for count independent polynomials on the shared thread pool.
+// errors (optional) receives the status of each polynomial; the return value
+// is POLYNOMIAL_OK only if every polynomial succeeded.
+PolynomialError poly_roots_batch(const Polynomial* const* polys, Complex* const* roots_out,
+                                 PolynomialError* errors, int count);
+
+#endif
@@ -0,0 +1,376 @@
+#include "PolynomialSeries.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "PolynomialTrace.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CELL(buf, i, size) ((char*)(buf) + (size_t)(i) * (size))
+
+// What the Newton iterations need beyond products, per coefficient type.
+// Array arguments hold n coefficients; r may alias a.
+typedef struct {
+    void (*negate)(void* r, const void* a, int n);
+    void (*average)(void* r, const void* a, const void* b, int n);   // (a + b) / 2
+    void (*integral)(void* r, const void* a, int n);                 // r[0] = 0, r[i] = a[i - 1] / i
+    int (*inverse)(const void* a, void* r);                          // 0 if a has none
+    int (*sqrt)(const void* a, void* r);                             // 0 if a has none
+    int (*is_zero)(const void* a);
+    int (*is_one)(const void* a);
+} SeriesOps;
+
+static void complex_series_negate(void* r, const void* a, int n) {
+    const Complex* x = a;
+    Complex* out = r;
+    for (int i = 0; i < n; i++) {
+        out[i].real = -x[i].real;
+        out[i].imag = -x[i].imag;
+    }
+}
+
+static void complex_series_average(void* r, const void* a, const void* b, int n) {
+    const Complex* x = a;
+    const Complex* y = b;
+    Complex* out = r;
+    for (int i = 0; i < n; i++) {
+        out[i].real = 0.5 * (x[i].real + y[i].real);
+        out[i].imag = 0.5 * (x[i].imag + y[i].imag);
+    }
+}
+
+static void complex_series_integral(void* r, const void* a, int n) {
+    const Complex* x = a;
+    Complex* out = r;
+    // from the top, so r may alias a
+    for (int i = n - 1; i > 0; i--) {
+        out[i].real = x[i - 1].real / i;
+        out[i].imag = x[i - 1].imag / i;
+    }
+    out[0] = complex_k_zero();
+}
+
+static int complex_series_inverse(const void* a, void* r) {
+    const Complex* z = a;
+    double norm = z->real * z->real + z->imag * z->imag;
+    if (norm == 0.0) return 0;
+    Complex inv = {z->real / norm, -z->imag / norm};
+    *(Complex*)r = inv;
+    return 1;
+}
+
+static int complex_series_sqrt(const void* a, void* r) {
+    const Complex* z = a;
+    double modulus = hypot(z->real, z->imag);
+    if (modulus == 0.0) return 0;
+    Complex root = {sqrt(0.5 * (modulus + z->real)), copysign(sqrt(0.5 * (modulus - z->real)), z->imag)};
+    *(Complex*)r = root;
+    return 1;
+}
+
+static int complex_series_is_zero(const void* a) {
+    const Complex* z = a;
+    return z->real == 0.0 && z->imag == 0.0;
+}
+
+static int complex_series_is_one(const void* a) {
+    const Complex* z = a;
+    return z->real == 1.0 && z->imag == 0.0;
+}
+
+static const SeriesOps COMPLEX_SERIES_OPS = {
+    complex_series_negate,
+    complex_series_average,
+    complex_series_integral,
+    complex_series_inverse,
+    complex_series_sqrt,
+    complex_series_is_zero,
+    complex_series_is_one
+};
+
+static void modint_series_negate(void* r, const void* a, int n) {
+    const ModInt* x = a;
+    ModInt* out = r;
+    for (int i = 0; i < n; i++) out[i] = x[i] ? MODINT_MODULUS - x[i] : 0;
+}
+
+static void modint_series_average(void* r, const void* a, const void* b, int n) {
+    const ModInt* x = a;
+    const ModInt* y = b;
+    ModInt* out = r;
+    for (int i = 0; i < n; i++) {
+        ModInt sum = modint_k_add(x[i], y[i]);
+        // halving an odd residue: (s + p) / 2
+        out[i] = sum & 1 ? (ModInt)(((uint64_t)sum + MODINT_MODULUS) >> 1) : sum >> 1;
+    }
+}
+
+static void modint_series_integral(void* r, const void* a, int n) {
+    const ModInt* x = a;
+    ModInt* out = r;
+    if (n <= 1) {
+        if (n == 1) out[0] = 0;
+        return;
+    }
+    // 1/i for all i < n in linear time: 1/i = -(p / i) / (p mod i)
+    ModInt* inv = poly_mem_alloc(n * sizeof(ModInt));
+    if (inv) {
+        inv[1] = 1;
+        for (int i = 2; i < n; i++) {
+            inv[i] = modint_k_mul(MODINT_MODULUS - MODINT_MODULUS / i, inv[MODINT_MODULUS % i]);
+        }
+    }
+    for (int i = n - 1; i > 0; i--) out[i] = modint_k_mul(x[i - 1], inv ? inv[i] : modint_inverse((ModInt)i));
+    out[0] = 0;
+    poly_mem_free(inv);
+}
+
+static int modint_series_inverse(const void* a, void* r) {
+    ModInt v = *(const ModInt*)a;
+    if (v == 0) return 0;
+    *(ModInt*)r = modint_inverse(v);
+    return 1;
+}
+
+// Tonelli-Shanks; p - 1 = 119 * 2^23
+static int modint_series_sqrt(const void* a, void* r) {
+    ModInt v = *(const ModInt*)a;
+    if (v == 0 || modint_pow(v, (MODINT_MODULUS - 1) / 2) != 1) return 0;
+    const int twos = 23;
+    const uint64_t odd = (MODINT_MODULUS - 1) >> twos;
+    ModInt c = modint_pow(MODINT_ROOT, odd);   // 3 is a non-residue
+    ModInt x = modint_pow(v, (odd + 1) / 2);
+    ModInt t = modint_pow(v, odd);
+    int m = twos;
+    while (t != 1) {
+        int i = 0;
+        for (ModInt s = t; s != 1; s = modint_k_mul(s, s)) i++;
+        ModInt b = c;
+        for (int j = 0; j < m - i - 1; j++) b = modint_k_mul(b, b);
+        x = modint_k_mul(x, b);
+        c = modint_k_mul(b, b);
+        t = modint_k_mul(t, c);
+        m = i;
+    }
+    *(ModInt*)r = x <= MODINT_MODULUS - x ? x : MODINT_MODULUS - x;
+    return 1;
+}
+
+static int modint_series_is_zero(const void* a) {
+    return *(const ModInt*)a == 0;
+}
+
+static int modint_series_is_one(const void* a) {
+    return *(const ModInt*)a == 1;
+}
+
+static const SeriesOps MODINT_SERIES_OPS = {
+    modint_series_negate,
+    modint_series_average,
+    modint_series_integral,
+    modint_series_inverse,
+    modint_series_sqrt,
+    modint_series_is_zero,
+    modint_series_is_one
+};
+
+static const SeriesOps* series_ops(const TypeInfo* typeInfo) {
+    switch (poly_kernel_type(typeInfo)) {
+    case POLY_KERNEL_complex: return &COMPLEX_SERIES_OPS;
+    case POLY_KERNEL_modint: return &MODINT_SERIES_OPS;
+    default: return NULL;
+    }
+}
+
+static void series_derivative(const TypeInfo* typeInfo, const void* a, int n, void* r) {
+    if (poly_kernel_type(typeInfo) == POLY_KERNEL_complex) complex_kernel_derivative(a, n, r);
+    else modint_kernel_derivative(a, n, r);
+}
+
+/* ---- Newton iterations on flat arrays of n coefficients ---- */
+
+// g = 1 / f mod x^n. Each step doubles the known prefix g[0..m): with
+// e = f g mod x^2m, whose first m terms are 1, 0, ..., the next m terms are
+// g[m..2m) = -(g e[m..2m)) mod x^m.
+static PolynomialError series_inv_raw(const TypeInfo* ti, const SeriesOps* ops, const void* f, int nf,
+                                      void* g, int n) {
+    size_t size = ti->size;
+    if (!ops->inverse(f, g)) return POLYNOMIAL_INVALID_INPUT;
+    if (n == 1) return POLYNOMIAL_OK;
+
+    char* e = poly_mem_alloc((size_t)2 * n * size);
+    if (!e) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* t = CELL(e, n, size);
+    PolynomialError err = POLYNOMIAL_OK;
+    for (int m = 1; m < n && err == POLYNOMIAL_OK; m *= 2) {
+        int m2 = 2 * m < n ? 2 * m : n;
+        err = poly_mullow_raw(ti, f, nf < m2 ? nf : m2, g, m, e, m2);
+        if (err == POLYNOMIAL_OK) err = poly_mullow_raw(ti, g, m2 - m, CELL(e, m, size), m2 - m, t, m2 - m);
+        if (err == POLYNOMIAL_OK) ops->negate(CELL(g, m, size), t, m2 - m);
+    }
+    poly_mem_free(e);
+    return err;
+}
+
+// log f = integral(f' / f), f[0] == 1
+static PolynomialError series_log_raw(const TypeInfo* ti, const SeriesOps* ops, const void* f, int nf,
+                                      void* r, int n) {
+    size_t size = ti->size;
+    if (nf < 1 || !ops->is_one(f)) return POLYNOMIAL_INVALID_INPUT;
+    memset(r, 0, n * size);
+    if (n == 1 || nf == 1) return POLYNOMIAL_OK;
+
+    int len = n - 1;
+    char* buf = poly_mem_alloc((size_t)3 * len * size);
+    if (!buf) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* derivative = buf;
+    char* inverse = CELL(buf, len, size);
+    char* quotient = CELL(buf, 2 * len, size);
+    int nd = (nf < n ? nf : n) - 1;
+    series_derivative(ti, f, nd + 1, derivative);
+
+    PolynomialError err = series_inv_raw(ti, ops, f, nf, inverse, len);
+    if (err == POLYNOMIAL_OK) err = poly_mullow_raw(ti, derivative, nd, inverse, len, quotient, len);
+    if (err == POLYNOMIAL_OK) ops->integral(r, quotient, n);
+    poly_mem_free(buf);
+    return err;
+}
+
+// exp f, f[0] == 0: g <- g (1 + f - log g), doubling the precision each step
+static PolynomialError series_exp_raw(const TypeInfo* ti, const SeriesOps* ops, const void* f, void* g, int n) {
+    size_t size = ti->size;
+    if (!ops->is_zero(f)) return POLYNOMIAL_INVALID_INPUT;
+    memset(g, 0, n * size);
+    PolynomialError err = poly_one_raw(ti, g);
+    if (err != POLYNOMIAL_OK || n == 1) return err;
+
+    char* buf = poly_mem_alloc((size_t)2 * n * size);
+    if (!buf) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* d = buf;
+    char* product = CELL(buf, n, size);
+    for (int m = 1; m < n && err == POLYNOMIAL_OK; m *= 2) {
+        int m2 = 2 * m < n ? 2 * m : n;
+        // log g agrees with f below x^m, so d = 1 + f - log g starts 1, 0, ..., 0
+        err = series_log_raw(ti, ops, g, m, d, m2);
+        if (err != POLYNOMIAL_OK) break;
+        ops->negate(d, d, m2);
+        poly_add_raw(ti, d, f, m2);
+        poly_one_raw(ti, d);
+        err = poly_mullow_raw(ti, g, m, d, m2, product, m2);
+        if (err == POLYNOMIAL_OK) memcpy(g, product, m2 * size);
+    }
+    poly_mem_free(buf);
+    return err;
+}
+
+// sqrt f by Heron's step g <- (g + f / g) / 2
+static PolynomialError series_sqrt_raw(const TypeInfo* ti, const SeriesOps* ops, const void* f, void* g, int n) {
+    size_t size = ti->size;
+    memset(g, 0, n * size);
+    if (!ops->sqrt(f, g)) return POLYNOMIAL_INVALID_INPUT;
+    if (n == 1) return POLYNOMIAL_OK;
+
+    char* buf = poly_mem_alloc((size_t)2 * n * size);
+    if (!buf) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* inverse = buf;
+    char* quotient = CELL(buf, n, size);
+    PolynomialError err = POLYNOMIAL_OK;
+    for (int m = 1; m < n && err == POLYNOMIAL_OK; m *= 2) {
+        int m2 = 2 * m < n ? 2 * m : n;
+        err = series_inv_raw(ti, ops, g, m, inverse, m2);
+        if (err == POLYNOMIAL_OK) err = poly_mullow_raw(ti, f, m2, inverse, m2, quotient, m2);
+        if (err == POLYNOMIAL_OK) ops->average(g, g, quotient, m2);
+    }
+    poly_mem_free(buf);
+    return err;
+}
+
+/* ---- Polynomial entry points ---- */
+
+static PolynomialError series_store(const void* src, int n, Polynomial* result) {
+    PolynomialError err = poly_make_unique(result);
+    if (err != POLYNOMIAL_OK) return err;
+    size_t size = result->typeInfo->size;
+    memcpy(result->coefficients[0], src, n * size);
+    memset(CELL(result->coefficients[0], n, size), 0, (result->degree + 1 - n) * size);
+    return POLYNOMIAL_OK;
+}
+
+static PolynomialError poly_mullow_unscoped(const Polynomial* a, const Polynomial* b, int n, Polynomial* result) {
+    if (!a || !b || !result) return POLYNOMIAL_NULL_PTR;
+    if (a->typeInfo != b->typeInfo || a->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    if (n < 1 || result->degree < n - 1) return POLYNOMIAL_INVALID_DEGREE;
+
+    size_t size = a->typeInfo->size;
+    void* out = poly_mem_alloc(n * size);
+    if (!out) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    int na = a->degree + 1 < n ? a->degree + 1 : n;
+    int nb = b->degree + 1 < n ? b->degree + 1 : n;
+    PolynomialError err = poly_mullow_raw(a->typeInfo, a->coefficients[0], na, b->coefficients[0], nb, out, n);
+    if (err == POLYNOMIAL_OK) err = series_store(out, n, result);
+    poly_mem_free(out);
+    return err;
+}
+
+PolynomialError poly_mullow(const Polynomial* a, const Polynomial* b, int n, Polynomial* result) {
+    PolyTraceSpan span = poly_trace_begin();
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_MULTIPLY, a ? a->typeInfo : NULL);
+    PolynomialError status = poly_mullow_unscoped(a, b, n, result);
+    poly_trace_end(&span, POLY_TRACE_MULLOW, a, b, b ? b->degree : -1, n, status);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+typedef enum { SERIES_INV, SERIES_LOG, SERIES_EXP, SERIES_SQRT } SeriesFunction;
+
+// Works on a copy of f padded with zeros to n terms, so result may alias f
+static PolynomialError series_apply_unscoped(SeriesFunction function, const Polynomial* f, int n, Polynomial* result) {
+    if (!f || !result) return POLYNOMIAL_NULL_PTR;
+    if (f->typeInfo != result->typeInfo) return POLYNOMIAL_TYPE_MISMATCH;
+    const SeriesOps* ops = series_ops(f->typeInfo);
+    if (!ops) return POLYNOMIAL_TYPE_MISMATCH;
+    if (n < 1 || result->degree < n - 1) return POLYNOMIAL_INVALID_DEGREE;
+
+    const TypeInfo* ti = f->typeInfo;
+    size_t size = ti->size;
+    char* buf = poly_mem_calloc((size_t)2 * n, size);
+    if (!buf) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    char* input = buf;
+    char* out = CELL(buf, n, size);
+    int nf = f->degree + 1 < n ? f->degree + 1 : n;
+    memcpy(input, f->coefficients[0], nf * size);
+
+    PolynomialError err = POLYNOMIAL_INVALID_INPUT;
+    switch (function) {
+    case SERIES_INV: err = series_inv_raw(ti, ops, input, nf, out, n); break;
+    case SERIES_LOG: err = series_log_raw(ti, ops, input, nf, out, n); break;
+    case SERIES_EXP: err = series_exp_raw(ti, ops, input, out, n); break;
+    case SERIES_SQRT: err = series_sqrt_raw(ti, ops, input, out, n); break;
+    }
+    if (err == POLYNOMIAL_OK) err = series_store(out, n, result);
+    poly_mem_free(buf);
+    return err;
+}
+
+static PolynomialError series_apply(SeriesFunction function, const Polynomial* f, int n, Polynomial* result) {
+    PolyMemScope scope = poly_mem_enter(POLY_MEM_OP_SERIES, f ? f->typeInfo : NULL);
+    PolynomialError status = series_apply_unscoped(function, f, n, result);
+    poly_mem_leave(&scope);
+    return status;
+}
+
+PolynomialError series_inv(const Polynomial* f, int n, Polynomial* result) {
+    return series_apply(SERIES_INV, f, n, result);
+}
+
+PolynomialError series_log(const Polynomial* f, int n, Polynomial* result) {
+    return series_apply(SERIES_LOG, f, n, result);
+}
+
+PolynomialError series_exp(const Polynomial* f, int n, Polynomial* result) {
+    return series_apply(SERIES_EXP, f, n, result);
+}
+
+PolynomialError series_sqrt(const Polynomial* f, int n, Polynomial* result) {
+    return series_apply(SERIES_SQRT, f, n, result);
+}
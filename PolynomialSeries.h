@@ -0,0 +1,28 @@
+#ifndef POLYNOMIAL_SERIES_H
+#define POLYNOMIAL_SERIES_H
+
+#include "Polynomial.h"
+
+// Polynomials as power series truncated to n terms (everything from x^n on
+// is dropped). result needs degree >= n - 1, gets zeros above x^(n-1), and
+// may alias the inputs.
+
+// (a * b) mod x^n; only the first n coefficients of the product are formed
+PolynomialError poly_mullow(const Polynomial* a, const Polynomial* b, int n, Polynomial* result);
+
+// Newton iterations doubling the precision each step, O(M(n)) for the
+// cost M(n) of one n-term product. These need division, so they take
+// Complex and ModInt coefficients and fail with POLYNOMIAL_TYPE_MISMATCH
+// otherwise; inputs outside their domain give POLYNOMIAL_INVALID_INPUT.
+
+// 1 / f, f[0] != 0
+PolynomialError series_inv(const Polynomial* f, int n, Polynomial* result);
+// log f, f[0] == 1
+PolynomialError series_log(const Polynomial* f, int n, Polynomial* result);
+// exp f, f[0] == 0
+PolynomialError series_exp(const Polynomial* f, int n, Polynomial* result);
+// sqrt f with result[0] the principal (Complex) or smaller (ModInt) root of
+// f[0], which must be nonzero and, for ModInt, a quadratic residue
+PolynomialError series_sqrt(const Polynomial* f, int n, Polynomial* result);
+
+#endif
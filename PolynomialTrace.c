@@ -0,0 +1,443 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "PolynomialTrace.h"
+#include "PolynomialKernels.h"
+#include "PolynomialMemory.h"
+#include "PolynomialSeries.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TRACE_MAGIC "PTRC"
+#define TRACE_VERSION 1u
+#define TRACE_HEADER_SIZE 8
+#define TRACE_BUFFER_SIZE (1 << 16)
+
+int POLY_TRACE_ACTIVE = 0;
+static __thread int TRACE_DEPTH = 0;
+
+// The open trace; the lock orders records from concurrent threads
+static pthread_mutex_t TRACE_LOCK = PTHREAD_MUTEX_INITIALIZER;
+static FILE* TRACE_FILE = NULL;
+static uint64_t TRACE_EPOCH = 0;
+
+static uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+PolynomialError poly_trace_start(const char* path) {
+    if (!path) return POLYNOMIAL_NULL_PTR;
+    pthread_mutex_lock(&TRACE_LOCK);
+    if (TRACE_FILE) {
+        pthread_mutex_unlock(&TRACE_LOCK);
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+    FILE* file = fopen(path, "wb");
+    uint32_t version = TRACE_VERSION;
+    if (!file || fwrite(TRACE_MAGIC, 4, 1, file) != 1 || fwrite(&version, 4, 1, file) != 1) {
+        if (file) fclose(file);
+        pthread_mutex_unlock(&TRACE_LOCK);
+        return POLYNOMIAL_CALC_ERROR;
+    }
+    setvbuf(file, NULL, _IOFBF, TRACE_BUFFER_SIZE);
+    TRACE_FILE = file;
+    TRACE_EPOCH = trace_now();
+    __atomic_store_n(&POLY_TRACE_ACTIVE, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&TRACE_LOCK);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_trace_stop(void) {
+    pthread_mutex_lock(&TRACE_LOCK);
+    __atomic_store_n(&POLY_TRACE_ACTIVE, 0, __ATOMIC_RELAXED);
+    FILE* file = TRACE_FILE;
+    TRACE_FILE = NULL;
+    pthread_mutex_unlock(&TRACE_LOCK);
+    if (!file) return POLYNOMIAL_INVALID_INPUT;
+    return fclose(file) == 0 ? POLYNOMIAL_OK : POLYNOMIAL_CALC_ERROR;
+}
+
+PolyTraceSpan poly_trace_enter(void) {
+    PolyTraceSpan span;
+    span.counted = 1;
+    span.outermost = TRACE_DEPTH++ == 0;
+    span.startNs = span.outermost ? trace_now() : 0;
+    return span;
+}
+
+void poly_trace_leave(const PolyTraceSpan* span, PolyTraceOp op, const Polynomial* a, const Polynomial* b,
+                      int degreeB, int parameter, PolynomialError status) {
+    TRACE_DEPTH--;
+    if (!span->outermost) return;
+
+    PolyTraceRecord record;
+    memset(&record, 0, sizeof(record));
+    record.durationNs = trace_now() - span->startNs;
+    record.degreeA = a ? a->degree : -1;
+    record.degreeB = degreeB;
+    record.parameter = parameter;
+    record.op = (uint8_t)op;
+    record.typeA = a ? (uint8_t)poly_kernel_type(a->typeInfo) : 0;
+    record.typeB = b ? (uint8_t)poly_kernel_type(b->typeInfo) : record.typeA;
+    record.status = status;
+
+    pthread_mutex_lock(&TRACE_LOCK);
+    // the trace may have been stopped while the operation ran
+    if (TRACE_FILE) {
+        record.startNs = span->startNs > TRACE_EPOCH ? span->startNs - TRACE_EPOCH : 0;
+        fwrite(&record, sizeof(record), 1, TRACE_FILE);
+    }
+    pthread_mutex_unlock(&TRACE_LOCK);
+}
+
+static int trace_compare_start(const void* x, const void* y) {
+    const PolyTraceRecord* a = x;
+    const PolyTraceRecord* b = y;
+    return (a->startNs > b->startNs) - (a->startNs < b->startNs);
+}
+
+PolyTraceRecord* poly_trace_load(const char* path, long long* count, PolynomialError* err) {
+    if (!path || !count) {
+        if (err) *err = POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        if (err) *err = POLYNOMIAL_CALC_ERROR;
+        return NULL;
+    }
+    char header[TRACE_HEADER_SIZE];
+    uint32_t version;
+    long size = -1;
+    if (fread(header, TRACE_HEADER_SIZE, 1, file) == 1 && fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    memcpy(&version, header + 4, 4);
+    if (size < TRACE_HEADER_SIZE || memcmp(header, TRACE_MAGIC, 4) != 0 || version != TRACE_VERSION ||
+        (size - TRACE_HEADER_SIZE) % sizeof(PolyTraceRecord) != 0) {
+        fclose(file);
+        if (err) *err = POLYNOMIAL_INVALID_INPUT;
+        return NULL;
+    }
+
+    long long n = (size - TRACE_HEADER_SIZE) / (long)sizeof(PolyTraceRecord);
+    PolyTraceRecord* records = malloc((n > 0 ? n : 1) * sizeof(PolyTraceRecord));
+    if (!records) {
+        fclose(file);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    if (fseek(file, TRACE_HEADER_SIZE, SEEK_SET) != 0 ||
+        (long long)fread(records, sizeof(PolyTraceRecord), n, file) != n) {
+        fclose(file);
+        free(records);
+        if (err) *err = POLYNOMIAL_CALC_ERROR;
+        return NULL;
+    }
+    fclose(file);
+    // records are written as operations finish
+    qsort(records, n, sizeof(PolyTraceRecord), trace_compare_start);
+    *count = n;
+    if (err) *err = POLYNOMIAL_OK;
+    return records;
+}
+
+const char* poly_trace_op_name(PolyTraceOp op) {
+    static const char* const NAMES[POLY_TRACE_OP_COUNT] = {
+        "add", "multiply", "scalar_multiply", "evaluate", "derivative", "compose", "pow",
+        "fma", "taylor_shift", "scale_var", "mullow",
+    };
+    return op >= 0 && op < POLY_TRACE_OP_COUNT ? NAMES[op] : "unknown";
+}
+
+// Replay
+
+typedef struct {
+    const PolyTraceRecord* records;
+    long long count;
+    int thread;
+    int threads;
+    double rate;
+    uint64_t startNs;
+    uint64_t* latencies;     // per record, written by the thread that ran it
+    PolynomialError* statuses;
+    unsigned seed;
+} ReplayWorker;
+
+static const TypeInfo* replay_type(int code) {
+    switch (code) {
+#define REPLAY_TYPE_CASE(NAME, T, GETTER) \
+    case POLY_KERNEL_##NAME: \
+        return GETTER();
+    POLY_BUILTIN_TYPES(REPLAY_TYPE_CASE)
+#undef REPLAY_TYPE_CASE
+    default:
+        return NULL;
+    }
+}
+
+static int replay_small(unsigned* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (int)(*seed >> 16) % 201 - 100;
+}
+
+// Small values keep integer operations from promoting more than the
+// recorded ones are likely to have
+static void replay_fill(const TypeInfo* typeInfo, void* out, int n, unsigned* seed) {
+    switch (poly_kernel_type(typeInfo)) {
+    case POLY_KERNEL_int:
+        for (int i = 0; i < n; i++) ((int*)out)[i] = replay_small(seed);
+        break;
+    case POLY_KERNEL_int64:
+        for (int i = 0; i < n; i++) ((int64_t*)out)[i] = replay_small(seed);
+        break;
+    case POLY_KERNEL_int128:
+        for (int i = 0; i < n; i++) ((Int128*)out)[i] = replay_small(seed);
+        break;
+    case POLY_KERNEL_modint:
+        for (int i = 0; i < n; i++) ((ModInt*)out)[i] = modint_from_int((long long)replay_small(seed) * 9973);
+        break;
+    case POLY_KERNEL_complex:
+        for (int i = 0; i < n; i++) {
+            ((Complex*)out)[i].real = replay_small(seed) / 128.0;
+            ((Complex*)out)[i].imag = replay_small(seed) / 128.0;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static Polynomial* replay_poly(int code, int degree, unsigned* seed) {
+    Polynomial* poly = poly_create(replay_type(code), degree, NULL);
+    if (poly) replay_fill(poly->typeInfo, poly->coefficients[0], degree + 1, seed);
+    return poly;
+}
+
+static int replay_needs_b(PolyTraceOp op) {
+    return op == POLY_TRACE_ADD || op == POLY_TRACE_MULTIPLY || op == POLY_TRACE_COMPOSE || op == POLY_TRACE_FMA ||
+           op == POLY_TRACE_MULLOW;
+}
+
+// The degree the operation's result needs, or -1 if the record cannot be
+// reissued
+static long long replay_result_degree(const PolyTraceRecord* r) {
+    long long a = r->degreeA;
+    long long b = r->degreeB;
+    switch ((PolyTraceOp)r->op) {
+    case POLY_TRACE_ADD:
+        return a > b ? a : b;
+    case POLY_TRACE_MULTIPLY:
+    case POLY_TRACE_FMA:
+        return a + b;
+    case POLY_TRACE_SCALAR_MULTIPLY:
+    case POLY_TRACE_DERIVATIVE:
+    case POLY_TRACE_TAYLOR_SHIFT:
+    case POLY_TRACE_SCALE_VAR:
+        return a;
+    case POLY_TRACE_MULLOW:
+        return r->parameter >= 1 ? r->parameter - 1 : -1;
+    case POLY_TRACE_EVALUATE:
+        return 0;
+    case POLY_TRACE_COMPOSE:
+        return a * b;
+    case POLY_TRACE_POW: {
+        if (r->parameter < 0) return -1;
+        long long full = a * r->parameter;
+        return b >= 0 && b < full ? b : full;
+    }
+    default:
+        return -1;
+    }
+}
+
+static int replay_valid(const PolyTraceRecord* r) {
+    if (r->op >= POLY_TRACE_OP_COUNT || !replay_type(r->typeA) || !replay_type(r->typeB)) return 0;
+    if (r->degreeA < 0 || (replay_needs_b((PolyTraceOp)r->op) && r->degreeB < 0)) return 0;
+    long long degree = replay_result_degree(r);
+    return degree >= 0 && degree <= 0x7ffffffe;
+}
+
+static PolynomialError replay_run(const PolyTraceRecord* r, Polynomial* a, Polynomial* b, Polynomial* result,
+                                  const void* scalar) {
+    switch ((PolyTraceOp)r->op) {
+    case POLY_TRACE_ADD:
+        return poly_add(a, b, result);
+    case POLY_TRACE_MULTIPLY:
+        return poly_multiply(a, b, result);
+    case POLY_TRACE_SCALAR_MULTIPLY:
+        return poly_scalar_multiply(a, scalar, result);
+    case POLY_TRACE_EVALUATE:
+        return poly_evaluate_scheme(a, scalar, result->coefficients[0], (PolyEvalScheme)r->parameter);
+    case POLY_TRACE_DERIVATIVE:
+        return poly_derivative(a, result);
+    case POLY_TRACE_COMPOSE:
+        return poly_compose(a, b, result);
+    case POLY_TRACE_POW:
+        return poly_pow(a, r->parameter, r->degreeB, result);
+    case POLY_TRACE_FMA:
+        return poly_fma(result, a, b);
+    case POLY_TRACE_TAYLOR_SHIFT:
+        return poly_taylor_shift(a, scalar, result);
+    case POLY_TRACE_SCALE_VAR:
+        return poly_scale_var(a, scalar, result);
+    case POLY_TRACE_MULLOW:
+        return poly_mullow(a, b, r->parameter, result);
+    default:
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+}
+
+// Issues one record: operands first, then waits until it is due
+static void replay_one(ReplayWorker* w, long long i) {
+    const PolyTraceRecord* r = &w->records[i];
+    PolynomialError err = POLYNOMIAL_MEM_ALLOC_FAIL;
+    int typeResult = r->typeA > r->typeB ? r->typeA : r->typeB;
+    Polynomial* a = replay_poly(r->typeA, r->degreeA, &w->seed);
+    Polynomial* b = replay_needs_b((PolyTraceOp)r->op) ? replay_poly(r->typeB, r->degreeB, &w->seed) : NULL;
+    Polynomial* result = poly_create(replay_type(typeResult), (int)replay_result_degree(r), NULL);
+    // the scalar or point, of the second operand's type
+    Polynomial* scalar = replay_poly(r->typeB, 0, &w->seed);
+
+    uint64_t due = w->startNs;
+    if (w->rate > 0) {
+        due += (uint64_t)(i / w->rate * 1e9);
+        struct timespec ts = {(time_t)(due / 1000000000u), (long)(due % 1000000000u)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+        }
+    }
+    uint64_t begin = trace_now();
+    if (a && result && scalar && (b || !replay_needs_b((PolyTraceOp)r->op)))
+        err = replay_run(r, a, b, result, scalar->coefficients[0]);
+    uint64_t end = trace_now();
+
+    w->latencies[i] = end - (w->rate > 0 && due < begin ? due : begin);
+    w->statuses[i] = err;
+    poly_free(a);
+    poly_free(b);
+    poly_free(result);
+    poly_free(scalar);
+}
+
+static void* replay_worker(void* arg) {
+    ReplayWorker* w = arg;
+    for (long long i = w->thread; i < w->count; i += w->threads) replay_one(w, i);
+    return NULL;
+}
+
+static int replay_compare_latency(const void* x, const void* y) {
+    uint64_t a = *(const uint64_t*)x;
+    uint64_t b = *(const uint64_t*)y;
+    return (a > b) - (a < b);
+}
+
+static double replay_percentile(const uint64_t* sorted, long long n, double p) {
+    long long rank = (long long)(p * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1] / 1000.0;
+}
+
+static PolynomialError replay_summarize(const PolyTraceRecord* records, long long count,
+                                        const uint64_t* latencies, const PolynomialError* statuses,
+                                        PolyReplayReport* report) {
+    uint64_t* sorted = poly_mem_alloc((count > 0 ? count : 1) * sizeof(uint64_t));
+    if (!sorted) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    for (int op = 0; op < POLY_TRACE_OP_COUNT; op++) {
+        PolyLatencyStats* stats = &report->ops[op];
+        long long n = 0;
+        for (long long i = 0; i < count; i++) {
+            if (records[i].op != op) continue;
+            sorted[n++] = latencies[i];
+            if (statuses[i] != POLYNOMIAL_OK) stats->errors++;
+        }
+        stats->count = n;
+        if (n == 0) continue;
+        qsort(sorted, n, sizeof(uint64_t), replay_compare_latency);
+        stats->p50 = replay_percentile(sorted, n, 0.50);
+        stats->p90 = replay_percentile(sorted, n, 0.90);
+        stats->p99 = replay_percentile(sorted, n, 0.99);
+        stats->p999 = replay_percentile(sorted, n, 0.999);
+        stats->max = sorted[n - 1] / 1000.0;
+    }
+    poly_mem_free(sorted);
+    return POLYNOMIAL_OK;
+}
+
+PolynomialError poly_trace_replay(const char* path, const PolyReplayOptions* options, PolyReplayReport* report) {
+    if (!path || !report) return POLYNOMIAL_NULL_PTR;
+    PolyReplayOptions defaults = POLY_REPLAY_DEFAULTS;
+    if (!options) options = &defaults;
+    if (options->threads < 1 || options->rate < 0) return POLYNOMIAL_INVALID_INPUT;
+    memset(report, 0, sizeof(*report));
+
+    long long total;
+    PolynomialError err;
+    PolyTraceRecord* records = poly_trace_load(path, &total, &err);
+    if (!records) return err;
+
+    // keep only what can be reissued, in start order
+    long long count = 0;
+    for (long long i = 0; i < total; i++) {
+        if (replay_valid(&records[i])) records[count++] = records[i];
+    }
+    report->skipped = total - count;
+
+    int threads = options->threads;
+    uint64_t* latencies = poly_mem_alloc((count > 0 ? count : 1) * sizeof(uint64_t));
+    PolynomialError* statuses = poly_mem_alloc((count > 0 ? count : 1) * sizeof(PolynomialError));
+    ReplayWorker* workers = poly_mem_alloc(threads * sizeof(ReplayWorker));
+    pthread_t* ids = poly_mem_alloc(threads * sizeof(pthread_t));
+    if (!latencies || !statuses || !workers || !ids) {
+        err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        goto done;
+    }
+
+    uint64_t start = trace_now();
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t] = (ReplayWorker){records, count, t, threads, options->rate, start, latencies, statuses,
+                                    0x9e3779b9u * (t + 1)};
+    }
+    // the calling thread is worker 0
+    for (int t = 1; t < threads; t++, started++) {
+        if (pthread_create(&ids[t], NULL, replay_worker, &workers[t]) != 0) break;
+    }
+    if (started < threads - 1) {
+        // the threads that did start still replay their share; the rest is
+        // picked up here so every record runs exactly once
+        for (int t = started + 1; t < threads; t++) replay_worker(&workers[t]);
+    }
+    replay_worker(&workers[0]);
+    for (int t = 1; t <= started; t++) pthread_join(ids[t], NULL);
+    uint64_t end = trace_now();
+
+    report->operations = count;
+    report->wallSeconds = (end - start) / 1e9;
+    report->throughput = report->wallSeconds > 0 ? count / report->wallSeconds : 0;
+    err = replay_summarize(records, count, latencies, statuses, report);
+
+done:
+    free(records);
+    poly_mem_free(latencies);
+    poly_mem_free(statuses);
+    poly_mem_free(workers);
+    poly_mem_free(ids);
+    return err;
+}
+
+void poly_replay_print(const PolyReplayReport* report) {
+    if (!report) return;
+    printf("Replayed %lld operations (%lld skipped) in %.3f s: %.0f ops/s\n", report->operations,
+           report->skipped, report->wallSeconds, report->throughput);
+    printf("%-16s %9s %7s %10s %10s %10s %10s %10s\n", "operation", "count", "errors", "p50 us", "p90 us",
+           "p99 us", "p999 us", "max us");
+    for (int op = 0; op < POLY_TRACE_OP_COUNT; op++) {
+        const PolyLatencyStats* s = &report->ops[op];
+        if (s->count == 0) continue;
+        printf("%-16s %9lld %7lld %10.2f %10.2f %10.2f %10.2f %10.2f\n", poly_trace_op_name((PolyTraceOp)op),
+               s->count, s->errors, s->p50, s->p90, s->p99, s->p999, s->max);
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef POLYNOMIAL_TRACE_H
+#define POLYNOMIAL_TRACE_H
+
+#include "Polynomial.h"
+#include <stdint.h>
+
+// Workload capture and replay. While a trace is open, every outermost call
+// of the operations below, on any thread, appends one fixed-size record to
+// the trace file; calls an operation makes internally (poly_multiply from
+// inside poly_pow) are part of their caller's record. poly_add_inplace and
+// poly_scale_inplace are recorded as the add and scalar multiply they are.
+// The series functions, root finding, poly_linear_combination and the
+// batch API are not recorded. With no trace open an operation pays one
+// relaxed load and a branch.
+
+typedef enum {
+    POLY_TRACE_ADD,
+    POLY_TRACE_MULTIPLY,
+    POLY_TRACE_SCALAR_MULTIPLY,
+    POLY_TRACE_EVALUATE,
+    POLY_TRACE_DERIVATIVE,
+    POLY_TRACE_COMPOSE,
+    POLY_TRACE_POW,
+    POLY_TRACE_FMA,
+    POLY_TRACE_TAYLOR_SHIFT,
+    POLY_TRACE_SCALE_VAR,
+    POLY_TRACE_MULLOW,
+    POLY_TRACE_OP_COUNT
+} PolyTraceOp;
+
+// One operation as stored, 40 bytes in host byte order after an 8-byte
+// header. Types are PolyKernelType values (0 for types without kernels);
+// degrees are -1 for a missing operand.
+typedef struct {
+    uint64_t startNs;      // since the trace was opened
+    uint64_t durationNs;
+    int32_t degreeA;
+    int32_t degreeB;       // second operand, or pow's truncation degree
+    int32_t parameter;     // pow's exponent, evaluate's scheme, mullow's n, else 0
+    int32_t status;        // PolynomialError
+    uint8_t op;            // PolyTraceOp
+    uint8_t typeA;
+    uint8_t typeB;
+    uint8_t reserved[5];
+} PolyTraceRecord;
+
+// Opens path (truncating it) and starts recording; fails with
+// POLYNOMIAL_INVALID_INPUT if a trace is already open
+PolynomialError poly_trace_start(const char* path);
+// Stops recording and closes the file; records of operations still
+// running are dropped
+PolynomialError poly_trace_stop(void);
+
+// The whole trace at path, sorted by start time; free() the array
+PolyTraceRecord* poly_trace_load(const char* path, long long* count, PolynomialError* err);
+const char* poly_trace_op_name(PolyTraceOp op);
+
+// Replay options: threads issue the records round-robin; with a rate, in
+// operations per second over all threads, record i is due i / rate
+// seconds after the start and its latency runs from then, so a replay
+// that falls behind shows it in the tail. rate 0 issues back to back.
+typedef struct {
+    int threads;
+    double rate;
+} PolyReplayOptions;
+
+#define POLY_REPLAY_DEFAULTS {1, 0.0}
+
+// Latencies in microseconds, nearest-rank percentiles
+typedef struct {
+    long long count;
+    long long errors;      // calls that did not return POLYNOMIAL_OK
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+} PolyLatencyStats;
+
+typedef struct {
+    long long operations;
+    long long skipped;     // records whose operands cannot be rebuilt
+    double wallSeconds;
+    double throughput;     // operations per second
+    PolyLatencyStats ops[POLY_TRACE_OP_COUNT];
+} PolyReplayReport;
+
+// Reissues every record of the trace at path against the library with
+// fresh operands of the recorded types and degrees. Operands are built
+// before an operation is due and are not part of its latency.
+PolynomialError poly_trace_replay(const char* path, const PolyReplayOptions* options, PolyReplayReport* report);
+void poly_replay_print(const PolyReplayReport* report);
+
+// Hooks for the traced operations
+typedef struct {
+    uint64_t startNs;
+    int counted;
+    int outermost;
+} PolyTraceSpan;
+
+extern int POLY_TRACE_ACTIVE;
+
+PolyTraceSpan poly_trace_enter(void);
+void poly_trace_leave(const PolyTraceSpan* span, PolyTraceOp op, const Polynomial* a, const Polynomial* b,
+                      int degreeB, int parameter, PolynomialError status);
+
+static inline PolyTraceSpan poly_trace_begin(void) {
+    PolyTraceSpan span = {0, 0, 0};
+    if (__atomic_load_n(&POLY_TRACE_ACTIVE, __ATOMIC_RELAXED)) span = poly_trace_enter();
+    return span;
+}
+
+// typeB is taken from b, or from a when b is NULL
+static inline void poly_trace_end(const PolyTraceSpan* span, PolyTraceOp op, const Polynomial* a,
+                                  const Polynomial* b, int degreeB, int parameter, PolynomialError status) {
+    if (span->counted) poly_trace_leave(span, op, a, b, degreeB, parameter, status);
+}
+
+#endif
@@ -0,0 +1,1286 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "Server.h"
+#include "Polynomial.h"
+#include "PolynomialMemory.h"
+#include "Integer.h"
+#include "Complex.h"
+#include "ModInt.h"
+#include "ThreadPool.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_EPOLL_EVENTS 64
+#define SERVER_READ_CHUNK 65536
+
+static const char* SERVER_TYPE_NAMES[] = {"int", "complex", "modint", "int64", "int128"};
+static const char* SERVER_OP_NAMES[] = {NULL, "create", "add", "multiply", "evaluate", "fetch", "free"};
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} ServerBuffer;
+
+static int buffer_reserve(ServerBuffer* buf, size_t extra) {
+    if (buf->length + extra <= buf->capacity) return 1;
+    size_t capacity = buf->capacity ? buf->capacity : 256;
+    while (capacity < buf->length + extra) capacity *= 2;
+    char* data = poly_mem_realloc(buf->data, capacity);
+    if (!data) return 0;
+    buf->data = data;
+    buf->capacity = capacity;
+    return 1;
+}
+
+static int buffer_append(ServerBuffer* buf, const void* bytes, size_t n) {
+    if (!buffer_reserve(buf, n)) return 0;
+    memcpy(buf->data + buf->length, bytes, n);
+    buf->length += n;
+    return 1;
+}
+
+static int buffer_printf(ServerBuffer* buf, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (n < 0 || !buffer_reserve(buf, (size_t)n + 1)) return 0;
+    va_start(args, fmt);
+    vsnprintf(buf->data + buf->length, (size_t)n + 1, fmt, args);
+    va_end(args);
+    buf->length += n;
+    return 1;
+}
+
+static void buffer_consume(ServerBuffer* buf, size_t n) {
+    memmove(buf->data, buf->data + n, buf->length - n);
+    buf->length -= n;
+}
+
+static void buffer_free(ServerBuffer* buf) {
+    poly_mem_free(buf->data);
+    buf->data = NULL;
+    buf->length = buf->capacity = 0;
+}
+
+static uint32_t read_u32(const void* p) {
+    const unsigned char* b = p;
+    return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+}
+
+static void write_u32(void* p, uint32_t v) {
+    unsigned char* b = p;
+    b[0] = v >> 24;
+    b[1] = v >> 16;
+    b[2] = v >> 8;
+    b[3] = v;
+}
+
+static int append_u32(ServerBuffer* buf, uint32_t v) {
+    unsigned char bytes[4];
+    write_u32(bytes, v);
+    return buffer_append(buf, bytes, 4);
+}
+
+static double server_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const TypeInfo* server_type_info(int type) {
+    switch (type) {
+    case SERVER_TYPE_INT: return GetIntTypeInfo();
+    case SERVER_TYPE_COMPLEX: return GetComplexTypeInfo();
+    case SERVER_TYPE_MODINT: return GetModIntTypeInfo();
+    case SERVER_TYPE_INT64: return GetInt64TypeInfo();
+    case SERVER_TYPE_INT128: return GetInt128TypeInfo();
+    default: return NULL;
+    }
+}
+
+static int server_type_of(const TypeInfo* typeInfo) {
+    if (typeInfo == GetComplexTypeInfo()) return SERVER_TYPE_COMPLEX;
+    if (typeInfo == GetModIntTypeInfo()) return SERVER_TYPE_MODINT;
+    if (typeInfo == GetInt64TypeInfo()) return SERVER_TYPE_INT64;
+    if (typeInfo == GetInt128TypeInfo()) return SERVER_TYPE_INT128;
+    return SERVER_TYPE_INT;
+}
+
+// Size of the first complete request in data: 0 while more bytes are needed, -1 if malformed
+static long server_request_length(const char* data, size_t length) {
+    if (length == 0) return 0;
+    // no valid frame length starts with these bytes, so they mark a text line
+    if (data[0] == '{' || data[0] == '\n' || data[0] == '\r' || data[0] == ' ') {
+        const char* newline = memchr(data, '\n', length);
+        if (!newline) return length > SERVER_MAX_FRAME ? -1 : 0;
+        return newline - data + 1;
+    }
+    if (length < 4) return 0;
+    uint32_t body = read_u32(data);
+    if (body == 0 || body > SERVER_MAX_FRAME) return -1;
+    return length - 4 >= body ? (long)body + 4 : 0;
+}
+
+/* ---- Resident polynomials ---- */
+
+// Ids index slots directly; a freed id reads as NULL until the next insert
+// takes it back from the free list, so a long-running server holds as many
+// slots as it ever had polynomials at once. Readers hold the lock while
+// they compute on the polynomials they looked up, which is safe because
+// stored polynomials are never modified.
+typedef struct {
+    pthread_rwlock_t lock;
+    Polynomial** slots;
+    uint32_t* freeIds;     // a stack of freed ids, at most count of them
+    uint32_t count;
+    uint32_t freeCount;
+    uint32_t capacity;
+} ServerStore;
+
+static Polynomial* store_lookup(ServerStore* store, uint32_t id) {
+    return id >= 1 && id <= store->count ? store->slots[id - 1] : NULL;
+}
+
+static PolynomialError store_insert(ServerStore* store, Polynomial* poly, uint32_t* id) {
+    pthread_rwlock_wrlock(&store->lock);
+    if (store->freeCount > 0) {
+        *id = store->freeIds[--store->freeCount];
+        store->slots[*id - 1] = poly;
+        pthread_rwlock_unlock(&store->lock);
+        return POLYNOMIAL_OK;
+    }
+    if (store->count == store->capacity) {
+        uint32_t capacity = store->capacity ? 2 * store->capacity : 64;
+        Polynomial** slots = poly_mem_realloc(store->slots, capacity * sizeof(Polynomial*));
+        if (slots) store->slots = slots;
+        uint32_t* freeIds = slots ? poly_mem_realloc(store->freeIds, capacity * sizeof(uint32_t)) : NULL;
+        if (!freeIds) {
+            pthread_rwlock_unlock(&store->lock);
+            return POLYNOMIAL_MEM_ALLOC_FAIL;
+        }
+        store->freeIds = freeIds;
+        store->capacity = capacity;
+    }
+    store->slots[store->count++] = poly;
+    *id = store->count;
+    pthread_rwlock_unlock(&store->lock);
+    return POLYNOMIAL_OK;
+}
+
+// Empties the slot of id and returns what it held, NULL if nothing
+static Polynomial* store_remove(ServerStore* store, uint32_t id) {
+    pthread_rwlock_wrlock(&store->lock);
+    Polynomial* poly = store_lookup(store, id);
+    if (poly) {
+        store->slots[id - 1] = NULL;
+        store->freeIds[store->freeCount++] = id;
+    }
+    pthread_rwlock_unlock(&store->lock);
+    return poly;
+}
+
+/* ---- Requests ---- */
+
+typedef struct {
+    int op;
+    int type;
+    uint32_t a;             // operand, or the id for evaluate/fetch/free
+    uint32_t b;
+    int degree;
+    const void* coeffs;     // points into the frame or into ownedCoeffs
+    void* ownedCoeffs;
+    const char* jsonValue;  // text of "x", parsed once the type is known
+    char value[sizeof(Complex)] __attribute__((aligned(sizeof(Int128))));
+    size_t valueLength;
+} ServerRequest;
+
+typedef struct {
+    PolynomialError status;
+    uint32_t id;
+    char value[sizeof(Complex)] __attribute__((aligned(sizeof(Int128))));
+    const TypeInfo* valueType;
+    Polynomial* fetched;
+} ServerReply;
+
+static PolynomialError server_parse_binary(const unsigned char* body, size_t length, ServerRequest* req) {
+    req->op = body[0];
+    body++;
+    length--;
+
+    switch (req->op) {
+    case SERVER_OP_CREATE: {
+        if (length < 5) return POLYNOMIAL_INVALID_INPUT;
+        req->type = body[0];
+        uint32_t degree = read_u32(body + 1);
+        const TypeInfo* typeInfo = server_type_info(req->type);
+        if (!typeInfo) return POLYNOMIAL_INVALID_INPUT;
+        if (degree >= (length - 5) / typeInfo->size || (degree + 1) * typeInfo->size != length - 5) {
+            return POLYNOMIAL_INVALID_DEGREE;
+        }
+        req->degree = (int)degree;
+        req->coeffs = body + 5;
+        return POLYNOMIAL_OK;
+    }
+    case SERVER_OP_ADD:
+    case SERVER_OP_MULTIPLY:
+        if (length != 8) return POLYNOMIAL_INVALID_INPUT;
+        req->a = read_u32(body);
+        req->b = read_u32(body + 4);
+        return POLYNOMIAL_OK;
+    case SERVER_OP_EVALUATE:
+        if (length < 4 || length - 4 > sizeof(req->value)) return POLYNOMIAL_INVALID_INPUT;
+        req->a = read_u32(body);
+        req->valueLength = length - 4;
+        memcpy(req->value, body + 4, req->valueLength);
+        return POLYNOMIAL_OK;
+    case SERVER_OP_FETCH:
+    case SERVER_OP_FREE:
+        if (length != 4) return POLYNOMIAL_INVALID_INPUT;
+        req->a = read_u32(body);
+        return POLYNOMIAL_OK;
+    default:
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+}
+
+// Start of the value of "key" in a JSON object, or NULL. Only the object's
+// own keys match, the strings after its '{' and each top-level ','; string
+// values and nested arrays and objects are stepped over
+static const char* json_value(const char* text, const char* key) {
+    size_t n = strlen(key);
+    int depth = 0;
+    int atKey = 0;
+    for (const char* p = text; *p; p++) {
+        if (*p == '"') {
+            const char* start = ++p;
+            while (*p && *p != '"') {
+                if (*p == '\\' && p[1]) p++;
+                p++;
+            }
+            if (!*p) return NULL;
+            if (depth == 1 && atKey && (size_t)(p - start) == n && strncmp(start, key, n) == 0) {
+                const char* v = p + 1;
+                while (*v == ' ') v++;
+                if (*v != ':') return NULL;
+                v++;
+                while (*v == ' ') v++;
+                return v;
+            }
+            atKey = 0;
+        } else if (*p == '{' || *p == '[') {
+            atKey = ++depth == 1 && *p == '{';
+        } else if (*p == '}' || *p == ']') {
+            if (--depth <= 0) return NULL;
+        } else if (*p == ',') {
+            atKey = depth == 1;
+        } else if (*p != ' ' && *p != '\t') {
+            atKey = 0;
+        }
+    }
+    return NULL;
+}
+
+static int json_string_equals(const char* value, const char* expected) {
+    size_t n = strlen(expected);
+    return value && value[0] == '"' && strncmp(value + 1, expected, n) == 0 && value[n + 1] == '"';
+}
+
+static int json_u32(const char* value, uint32_t* out) {
+    if (!value) return 0;
+    char* end;
+    errno = 0;
+    long long v = strtoll(value, &end, 10);
+    if (end == value || errno || v < 0 || v > UINT32_MAX) return 0;
+    *out = (uint32_t)v;
+    return 1;
+}
+
+// Parses one coefficient of the given type; complex values are [re, im] or a bare real
+static int json_element(const char** text, const TypeInfo* typeInfo, void* out) {
+    const char* p = *text;
+    char* end;
+    while (*p == ' ') p++;
+
+    if (typeInfo == GetComplexTypeInfo()) {
+        Complex c = {0.0, 0.0};
+        if (*p == '[') {
+            c.real = strtod(p + 1, &end);
+            if (end == p + 1) return 0;
+            p = end;
+            while (*p == ' ') p++;
+            if (*p++ != ',') return 0;
+            c.imag = strtod(p, &end);
+            if (end == p) return 0;
+            p = end;
+            while (*p == ' ') p++;
+            if (*p++ != ']') return 0;
+        } else {
+            c.real = strtod(p, &end);
+            if (end == p) return 0;
+            p = end;
+        }
+        memcpy(out, &c, sizeof(c));
+        *text = p;
+        return 1;
+    }
+
+    errno = 0;
+    long long v = strtoll(p, &end, 10);
+    if (end == p || errno || *end == '.' || *end == 'e' || *end == 'E') return 0;
+    if (typeInfo == GetModIntTypeInfo()) {
+        *(ModInt*)out = modint_from_int(v);
+    } else if (typeInfo == GetInt64TypeInfo()) {
+        int64_t wide = v;
+        memcpy(out, &wide, sizeof(wide));
+    } else if (typeInfo == GetInt128TypeInfo()) {
+        Int128 wide = v;
+        memcpy(out, &wide, sizeof(wide));
+    } else {
+        if (v < INT_MIN || v > INT_MAX) return 0;
+        *(int*)out = (int)v;
+    }
+    *text = end;
+    return 1;
+}
+
+static PolynomialError json_coefficients(const char* value, const TypeInfo* typeInfo, ServerRequest* req) {
+    if (!value || *value != '[') return POLYNOMIAL_INVALID_INPUT;
+    ServerBuffer coeffs = {NULL, 0, 0};
+    const char* p = value + 1;
+    char element[sizeof(Complex)] __attribute__((aligned(sizeof(Int128))));
+
+    while (*p == ' ') p++;
+    while (*p != ']') {
+        if (!json_element(&p, typeInfo, element) || !buffer_append(&coeffs, element, typeInfo->size)) {
+            buffer_free(&coeffs);
+            return POLYNOMIAL_INVALID_INPUT;
+        }
+        while (*p == ' ') p++;
+        if (*p == ',') p++;
+        else if (*p != ']') {
+            buffer_free(&coeffs);
+            return POLYNOMIAL_INVALID_INPUT;
+        }
+    }
+
+    if (coeffs.length == 0) return POLYNOMIAL_INVALID_DEGREE;
+    req->degree = (int)(coeffs.length / typeInfo->size) - 1;
+    req->coeffs = req->ownedCoeffs = coeffs.data;
+    return POLYNOMIAL_OK;
+}
+
+static PolynomialError server_parse_json(const char* text, ServerRequest* req) {
+    const char* op = json_value(text, "op");
+    req->op = 0;
+    for (int i = SERVER_OP_CREATE; i <= SERVER_OP_FREE; i++) {
+        if (json_string_equals(op, SERVER_OP_NAMES[i])) req->op = i;
+    }
+
+    switch (req->op) {
+    case SERVER_OP_CREATE: {
+        const char* type = json_value(text, "type");
+        req->type = -1;
+        for (int i = SERVER_TYPE_INT; i <= SERVER_TYPE_INT128; i++) {
+            if (json_string_equals(type, SERVER_TYPE_NAMES[i])) req->type = i;
+        }
+        // the type defaults to int
+        if (!type) req->type = SERVER_TYPE_INT;
+        const TypeInfo* typeInfo = server_type_info(req->type);
+        if (!typeInfo) return POLYNOMIAL_INVALID_INPUT;
+        return json_coefficients(json_value(text, "coeffs"), typeInfo, req);
+    }
+    case SERVER_OP_ADD:
+    case SERVER_OP_MULTIPLY:
+        if (!json_u32(json_value(text, "a"), &req->a) || !json_u32(json_value(text, "b"), &req->b)) {
+            return POLYNOMIAL_INVALID_INPUT;
+        }
+        return POLYNOMIAL_OK;
+    case SERVER_OP_EVALUATE:
+        req->jsonValue = json_value(text, "x");
+        if (!req->jsonValue) return POLYNOMIAL_INVALID_INPUT;
+        // fall through
+    case SERVER_OP_FETCH:
+    case SERVER_OP_FREE:
+        return json_u32(json_value(text, "id"), &req->a) ? POLYNOMIAL_OK : POLYNOMIAL_INVALID_INPUT;
+    default:
+        return POLYNOMIAL_INVALID_INPUT;
+    }
+}
+
+static void server_binary_op(ServerStore* store, const ServerRequest* req, ServerReply* reply) {
+    pthread_rwlock_rdlock(&store->lock);
+    const Polynomial* a = store_lookup(store, req->a);
+    const Polynomial* b = store_lookup(store, req->b);
+    Polynomial* result = NULL;
+    if (!a || !b) {
+        reply->status = POLYNOMIAL_INVALID_INPUT;
+    } else if (a->typeInfo != b->typeInfo && !(int_type_width(a->typeInfo) && int_type_width(b->typeInfo))) {
+        reply->status = POLYNOMIAL_TYPE_MISMATCH;
+    } else if (req->op == SERVER_OP_ADD) {
+        // integers of different widths combine at the wider one, which may grow further
+        const TypeInfo* typeInfo = int_type_width(b->typeInfo) > int_type_width(a->typeInfo) ? b->typeInfo : a->typeInfo;
+        result = poly_create(typeInfo, a->degree > b->degree ? a->degree : b->degree, &reply->status);
+        if (result) reply->status = poly_add(a, b, result);
+    } else {
+        const TypeInfo* typeInfo = int_type_width(b->typeInfo) > int_type_width(a->typeInfo) ? b->typeInfo : a->typeInfo;
+        result = poly_create(typeInfo, a->degree + b->degree, &reply->status);
+        if (result) reply->status = poly_multiply(a, b, result);
+    }
+    pthread_rwlock_unlock(&store->lock);
+
+    if (result && reply->status == POLYNOMIAL_OK) reply->status = store_insert(store, result, &reply->id);
+    if (reply->status != POLYNOMIAL_OK) poly_free(result);
+}
+
+static void server_execute(ServerStore* store, ServerRequest* req, ServerReply* reply) {
+    reply->status = POLYNOMIAL_OK;
+
+    switch (req->op) {
+    case SERVER_OP_CREATE: {
+        Polynomial* poly = poly_create_with_coeffs(server_type_info(req->type), req->degree, req->coeffs, &reply->status);
+        if (!poly) return;
+        if (req->type == SERVER_TYPE_MODINT) {
+            ModInt* c = poly->coefficients[0];
+            for (int i = 0; i <= poly->degree; i++) c[i] %= MODINT_MODULUS;
+        }
+        reply->status = store_insert(store, poly, &reply->id);
+        if (reply->status != POLYNOMIAL_OK) poly_free(poly);
+        return;
+    }
+    case SERVER_OP_ADD:
+    case SERVER_OP_MULTIPLY:
+        server_binary_op(store, req, reply);
+        return;
+    case SERVER_OP_EVALUATE: {
+        pthread_rwlock_rdlock(&store->lock);
+        const Polynomial* poly = store_lookup(store, req->a);
+        if (!poly) {
+            reply->status = POLYNOMIAL_INVALID_INPUT;
+        } else if (req->jsonValue) {
+            const char* p = req->jsonValue;
+            if (!json_element(&p, poly->typeInfo, req->value)) reply->status = POLYNOMIAL_INVALID_INPUT;
+        } else if (req->valueLength != poly->typeInfo->size) {
+            reply->status = POLYNOMIAL_TYPE_MISMATCH;
+        }
+        if (reply->status == POLYNOMIAL_OK) {
+            if (poly->typeInfo == GetModIntTypeInfo()) *(ModInt*)req->value %= MODINT_MODULUS;
+            reply->status = poly_evaluate(poly, req->value, reply->value);
+            reply->valueType = poly->typeInfo;
+        }
+        pthread_rwlock_unlock(&store->lock);
+        return;
+    }
+    case SERVER_OP_FETCH:
+        pthread_rwlock_rdlock(&store->lock);
+        reply->fetched = poly_clone(store_lookup(store, req->a), &reply->status);
+        if (reply->status == POLYNOMIAL_NULL_PTR) reply->status = POLYNOMIAL_INVALID_INPUT;
+        pthread_rwlock_unlock(&store->lock);
+        return;
+    case SERVER_OP_FREE: {
+        Polynomial* poly = store_remove(store, req->a);
+        if (!poly) reply->status = POLYNOMIAL_INVALID_INPUT;
+        poly_free(poly);
+        return;
+    }
+    default:
+        reply->status = POLYNOMIAL_INVALID_INPUT;
+        return;
+    }
+}
+
+static int json_append_element(ServerBuffer* out, const TypeInfo* typeInfo, const void* value) {
+    if (typeInfo == GetComplexTypeInfo()) {
+        const Complex* c = value;
+        return buffer_printf(out, "[%.17g,%.17g]", c->real, c->imag);
+    }
+    if (typeInfo == GetModIntTypeInfo()) return buffer_printf(out, "%u", *(const ModInt*)value);
+    if (typeInfo == GetInt64TypeInfo()) return buffer_printf(out, "%lld", (long long)*(const int64_t*)value);
+    if (typeInfo == GetInt128TypeInfo()) {
+        char digits[40];
+        return buffer_append(out, digits, int128_to_chars(*(const Int128*)value, digits));
+    }
+    return buffer_printf(out, "%d", *(const int*)value);
+}
+
+static int server_reply_json(const ServerRequest* req, const ServerReply* reply, ServerBuffer* out) {
+    if (reply->status != POLYNOMIAL_OK) {
+        return buffer_printf(out, "{\"ok\":false,\"error\":\"%s\"}\n", polynomial_error_msg(reply->status));
+    }
+
+    switch (req->op) {
+    case SERVER_OP_CREATE:
+    case SERVER_OP_ADD:
+    case SERVER_OP_MULTIPLY:
+        return buffer_printf(out, "{\"ok\":true,\"id\":%u}\n", reply->id);
+    case SERVER_OP_EVALUATE:
+        return buffer_printf(out, "{\"ok\":true,\"value\":") && json_append_element(out, reply->valueType, reply->value) &&
+               buffer_append(out, "}\n", 2);
+    case SERVER_OP_FETCH: {
+        const Polynomial* poly = reply->fetched;
+        int ok = buffer_printf(out, "{\"ok\":true,\"type\":\"%s\",\"degree\":%d,\"coeffs\":[",
+                               SERVER_TYPE_NAMES[server_type_of(poly->typeInfo)], poly->degree);
+        for (int i = 0; ok && i <= poly->degree; i++) {
+            if (i > 0) ok = buffer_append(out, ",", 1);
+            if (ok) ok = json_append_element(out, poly->typeInfo, poly->coefficients[i]);
+        }
+        return ok && buffer_append(out, "]}\n", 3);
+    }
+    default:
+        return buffer_printf(out, "{\"ok\":true}\n");
+    }
+}
+
+static int server_reply_binary(const ServerRequest* req, const ServerReply* reply, ServerBuffer* out) {
+    size_t start = out->length;
+    unsigned char status = (unsigned char)(reply->status / 100);
+    if (!append_u32(out, 0) || !buffer_append(out, &status, 1)) return 0;
+
+    int ok = 1;
+    if (reply->status == POLYNOMIAL_OK) {
+        switch (req->op) {
+        case SERVER_OP_CREATE:
+        case SERVER_OP_ADD:
+        case SERVER_OP_MULTIPLY:
+            ok = append_u32(out, reply->id);
+            break;
+        case SERVER_OP_EVALUATE:
+            ok = buffer_append(out, reply->value, reply->valueType->size);
+            break;
+        case SERVER_OP_FETCH: {
+            const Polynomial* poly = reply->fetched;
+            unsigned char type = (unsigned char)server_type_of(poly->typeInfo);
+            ok = buffer_append(out, &type, 1) && append_u32(out, (uint32_t)poly->degree) &&
+                 buffer_append(out, poly->coefficients[0], (poly->degree + 1) * poly->typeInfo->size);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    if (ok) write_u32(out->data + start, (uint32_t)(out->length - start - 4));
+    return ok;
+}
+
+// Handles one complete request and appends its reply; returns 0 only when out of memory
+static int server_handle_request(ServerStore* store, const char* data, size_t length, ServerBuffer* out) {
+    ServerRequest req;
+    ServerReply reply;
+    memset(&req, 0, sizeof(req));
+    memset(&reply, 0, sizeof(reply));
+    int ok;
+
+    // blank lines between JSON requests get no reply
+    if (data[0] == '\n' || data[0] == '\r' || data[0] == ' ') return 1;
+
+    if (data[0] == '{') {
+        char* text = poly_mem_alloc(length + 1);
+        if (!text) return 0;
+        memcpy(text, data, length);
+        text[length] = '\0';
+        reply.status = server_parse_json(text, &req);
+        if (reply.status == POLYNOMIAL_OK) server_execute(store, &req, &reply);
+        ok = server_reply_json(&req, &reply, out);
+        poly_mem_free(text);
+    } else {
+        reply.status = server_parse_binary((const unsigned char*)data + 4, length - 4, &req);
+        if (reply.status == POLYNOMIAL_OK) server_execute(store, &req, &reply);
+        ok = server_reply_binary(&req, &reply, out);
+    }
+
+    poly_mem_free(req.ownedCoeffs);
+    poly_free(reply.fetched);
+    return ok;
+}
+
+/* ---- Event loop ---- */
+
+typedef struct ServerConn ServerConn;
+
+// Requests of one connection handed to a worker; replies come back in order
+typedef struct ServerBatch {
+    Server* server;
+    ServerConn* conn;
+    ServerBuffer requests;
+    ServerBuffer replies;
+    int failed;
+    struct ServerBatch* next;
+} ServerBatch;
+
+// Owned by the event loop thread. A connection has at most one batch in
+// flight, which keeps its replies in request order while other connections
+// run on the other workers.
+struct ServerConn {
+    int fd;
+    int index;
+    uint32_t events;
+    int readClosed;
+    ServerBuffer in;
+    ServerBuffer out;
+    size_t outSent;
+    ServerBatch* batch;
+    ServerConn* nextClosed;
+};
+
+struct Server {
+    int listenFd;
+    int bound;          // the socket file at path is ours to remove
+    int epollFd;
+    int wakePipe[2];
+    char* path;
+    int stopRequested;  // set by server_stop from any thread
+    int stopping;       // the loop's copy, no new work once set
+    int inFlight;
+    ThreadPool* workers;
+    ServerStore store;
+    pthread_mutex_t doneLock;
+    ServerBatch* done;
+    ServerConn** conns;
+    int connCount;
+    int connCapacity;
+    ServerConn* closed;
+    // only the addresses are used, to tag epoll events
+    ServerConn listener;
+    ServerConn waker;
+};
+
+// Clears path for bind: nothing there, or a socket no server listens on,
+// which is removed. Anything else is left alone and refused
+static PolynomialError server_clear_path(const struct sockaddr_un* addr) {
+    struct stat st;
+    if (lstat(addr->sun_path, &st) != 0) return errno == ENOENT ? POLYNOMIAL_OK : POLYNOMIAL_INVALID_INPUT;
+    if (!S_ISSOCK(st.st_mode)) return POLYNOMIAL_INVALID_INPUT;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return POLYNOMIAL_CALC_ERROR;
+    int live = connect(fd, (const struct sockaddr*)addr, sizeof(*addr)) == 0 || errno != ECONNREFUSED;
+    close(fd);
+    if (live || unlink(addr->sun_path) != 0) return POLYNOMIAL_INVALID_INPUT;
+    return POLYNOMIAL_OK;
+}
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void server_process_batch(void* arg) {
+    ServerBatch* batch = arg;
+    Server* server = batch->server;
+
+    size_t offset = 0;
+    while (offset < batch->requests.length && !batch->failed) {
+        long n = server_request_length(batch->requests.data + offset, batch->requests.length - offset);
+        if (!server_handle_request(&server->store, batch->requests.data + offset, n, &batch->replies)) batch->failed = 1;
+        offset += n;
+    }
+
+    pthread_mutex_lock(&server->doneLock);
+    batch->next = server->done;
+    server->done = batch;
+    pthread_mutex_unlock(&server->doneLock);
+    // a full pipe already holds a pending wakeup
+    char byte = 0;
+    if (write(server->wakePipe[1], &byte, 1) < 0) return;
+}
+
+static void server_conn_free(ServerConn* conn) {
+    buffer_free(&conn->in);
+    buffer_free(&conn->out);
+    poly_mem_free(conn);
+}
+
+// Stops watching the socket; the memory goes once no batch refers to it
+static void server_conn_close(Server* server, ServerConn* conn) {
+    if (conn->fd < 0) return;
+    epoll_ctl(server->epollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+
+    server->conns[conn->index] = server->conns[--server->connCount];
+    server->conns[conn->index]->index = conn->index;
+    if (!conn->batch) {
+        conn->nextClosed = server->closed;
+        server->closed = conn;
+    }
+}
+
+static void server_conn_watch(Server* server, ServerConn* conn) {
+    uint32_t events = 0;
+    // the largest incomplete request fits in SERVER_MAX_FRAME + 4 bytes
+    if (!conn->readClosed && conn->in.length <= SERVER_MAX_FRAME + 4) events |= EPOLLIN;
+    if (conn->outSent < conn->out.length) events |= EPOLLOUT;
+    if (events == conn->events) return;
+
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->events = events;
+}
+
+static int server_conn_flush(ServerConn* conn) {
+    while (conn->outSent < conn->out.length) {
+        ssize_t n = send(conn->fd, conn->out.data + conn->outSent, conn->out.length - conn->outSent, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->outSent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+    conn->out.length = 0;
+    conn->outSent = 0;
+    return 1;
+}
+
+// Moves every complete request to a new batch for the workers
+static int server_conn_dispatch(Server* server, ServerConn* conn) {
+    if (conn->batch || server->stopping || conn->out.length - conn->outSent > SERVER_MAX_PENDING_OUTPUT) return 1;
+
+    size_t taken = 0;
+    for (;;) {
+        long n = server_request_length(conn->in.data + taken, conn->in.length - taken);
+        if (n == 0) break;
+        if (n < 0) {
+            // the stream cannot be resynchronized: answer what came before, then close
+            conn->in.length = taken;
+            conn->readClosed = 1;
+            break;
+        }
+        taken += n;
+    }
+    if (taken == 0) return 1;
+
+    ServerBatch* batch = poly_mem_calloc(1, sizeof(ServerBatch));
+    if (!batch) return 0;
+    batch->server = server;
+    batch->conn = conn;
+    if (taken == conn->in.length) {
+        batch->requests = conn->in;
+        memset(&conn->in, 0, sizeof(conn->in));
+    } else if (buffer_append(&batch->requests, conn->in.data, taken)) {
+        buffer_consume(&conn->in, taken);
+    } else {
+        poly_mem_free(batch);
+        return 0;
+    }
+
+    if (thread_pool_submit(server->workers, server_process_batch, batch) != POLYNOMIAL_OK) {
+        buffer_free(&batch->requests);
+        poly_mem_free(batch);
+        return 0;
+    }
+    conn->batch = batch;
+    server->inFlight++;
+    return 1;
+}
+
+static void server_conn_progress(Server* server, ServerConn* conn) {
+    if (!server_conn_flush(conn) || !server_conn_dispatch(server, conn)) {
+        server_conn_close(server, conn);
+        return;
+    }
+    if (conn->readClosed && !conn->batch && conn->outSent == conn->out.length) {
+        server_conn_close(server, conn);
+        return;
+    }
+    server_conn_watch(server, conn);
+}
+
+static void server_conn_read(Server* server, ServerConn* conn) {
+    while (!conn->readClosed && conn->in.length <= SERVER_MAX_FRAME + 4) {
+        if (!buffer_reserve(&conn->in, SERVER_READ_CHUNK)) {
+            server_conn_close(server, conn);
+            return;
+        }
+        ssize_t n = read(conn->fd, conn->in.data + conn->in.length, SERVER_READ_CHUNK);
+        if (n > 0) {
+            conn->in.length += n;
+        } else if (n == 0) {
+            conn->readClosed = 1;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            server_conn_close(server, conn);
+            return;
+        }
+    }
+    server_conn_progress(server, conn);
+}
+
+static void server_accept(Server* server) {
+    for (;;) {
+        int fd = accept(server->listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        ServerConn* conn = poly_mem_calloc(1, sizeof(ServerConn));
+        if (server->connCount == server->connCapacity) {
+            int capacity = server->connCapacity ? 2 * server->connCapacity : 16;
+            ServerConn** conns = poly_mem_realloc(server->conns, capacity * sizeof(ServerConn*));
+            if (conns) {
+                server->conns = conns;
+                server->connCapacity = capacity;
+            }
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (!conn || server->connCount == server->connCapacity || !set_nonblocking(fd) ||
+            epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            poly_mem_free(conn);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        conn->index = server->connCount;
+        server->conns[server->connCount++] = conn;
+    }
+}
+
+// Takes finished batches from the workers and queues their replies
+static void server_collect(Server* server) {
+    char drain[64];
+    while (read(server->wakePipe[0], drain, sizeof(drain)) > 0) {}
+
+    pthread_mutex_lock(&server->doneLock);
+    ServerBatch* batch = server->done;
+    server->done = NULL;
+    pthread_mutex_unlock(&server->doneLock);
+
+    while (batch) {
+        ServerBatch* next = batch->next;
+        ServerConn* conn = batch->conn;
+        conn->batch = NULL;
+        server->inFlight--;
+
+        if (conn->fd < 0) {
+            server_conn_free(conn);
+        } else if (batch->failed) {
+            server_conn_close(server, conn);
+        } else {
+            if (conn->out.length == 0) {
+                buffer_free(&conn->out);
+                conn->out = batch->replies;
+                memset(&batch->replies, 0, sizeof(batch->replies));
+            } else if (!buffer_append(&conn->out, batch->replies.data, batch->replies.length)) {
+                conn->readClosed = 1;
+            }
+            server_conn_progress(server, conn);
+        }
+
+        buffer_free(&batch->requests);
+        buffer_free(&batch->replies);
+        poly_mem_free(batch);
+        batch = next;
+    }
+}
+
+Server* server_create(const char* path, int workers, PolynomialError* err) {
+    struct sockaddr_un addr;
+    if (!path || strlen(path) >= sizeof(addr.sun_path)) {
+        if (err) *err = path ? POLYNOMIAL_INVALID_INPUT : POLYNOMIAL_NULL_PTR;
+        return NULL;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    PolynomialError cleared = server_clear_path(&addr);
+    if (cleared != POLYNOMIAL_OK) {
+        if (err) *err = cleared;
+        return NULL;
+    }
+
+    Server* server = poly_mem_calloc(1, sizeof(Server));
+    if (!server) {
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    server->listenFd = server->epollFd = server->wakePipe[0] = server->wakePipe[1] = -1;
+    pthread_rwlock_init(&server->store.lock, NULL);
+    pthread_mutex_init(&server->doneLock, NULL);
+
+    if (workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (int)cpus : 1;
+    }
+    PolynomialError status = POLYNOMIAL_OK;
+    server->workers = thread_pool_create(workers, &status);
+    server->path = poly_mem_alloc(strlen(path) + 1);
+    if (!server->workers || !server->path) {
+        server_destroy(server);
+        if (err) *err = status != POLYNOMIAL_OK ? status : POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    strcpy(server->path, path);
+
+    struct epoll_event listenEv, wakeEv;
+    listenEv.events = EPOLLIN;
+    listenEv.data.ptr = &server->listener;
+    wakeEv.events = EPOLLIN;
+    wakeEv.data.ptr = &server->waker;
+
+    server->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    server->epollFd = epoll_create1(0);
+    int ready = server->listenFd >= 0 && server->epollFd >= 0 && pipe(server->wakePipe) == 0 &&
+                set_nonblocking(server->listenFd) && set_nonblocking(server->wakePipe[0]) &&
+                set_nonblocking(server->wakePipe[1]);
+    server->bound = ready && bind(server->listenFd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    if (!server->bound ||
+        listen(server->listenFd, SOMAXCONN) != 0 ||
+        epoll_ctl(server->epollFd, EPOLL_CTL_ADD, server->listenFd, &listenEv) != 0 ||
+        epoll_ctl(server->epollFd, EPOLL_CTL_ADD, server->wakePipe[0], &wakeEv) != 0) {
+        server_destroy(server);
+        if (err) *err = POLYNOMIAL_CALC_ERROR;
+        return NULL;
+    }
+
+    if (err) *err = POLYNOMIAL_OK;
+    return server;
+}
+
+PolynomialError server_run(Server* server) {
+    if (!server) return POLYNOMIAL_NULL_PTR;
+
+    struct epoll_event events[SERVER_EPOLL_EVENTS];
+    PolynomialError status = POLYNOMIAL_OK;
+    for (;;) {
+        if (__atomic_load_n(&server->stopRequested, __ATOMIC_ACQUIRE)) server->stopping = 1;
+        if (server->stopping && server->inFlight == 0) break;
+
+        int n = epoll_wait(server->epollFd, events, SERVER_EPOLL_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            status = POLYNOMIAL_CALC_ERROR;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            ServerConn* conn = events[i].data.ptr;
+            if (conn == &server->listener) {
+                if (!server->stopping) server_accept(server);
+            } else if (conn == &server->waker) {
+                server_collect(server);
+            } else if (conn->fd >= 0) {
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) server_conn_read(server, conn);
+                else server_conn_progress(server, conn);
+            }
+        }
+
+        // freed only now, since later events of the same round may name them
+        while (server->closed) {
+            ServerConn* conn = server->closed;
+            server->closed = conn->nextClosed;
+            server_conn_free(conn);
+        }
+    }
+
+    // a failed epoll_wait can leave batches running; they still hold their connections
+    struct timespec pause = {0, 1000000};
+    while (server->inFlight > 0) {
+        nanosleep(&pause, NULL);
+        server_collect(server);
+    }
+    while (server->connCount > 0) server_conn_close(server, server->conns[0]);
+    while (server->closed) {
+        ServerConn* conn = server->closed;
+        server->closed = conn->nextClosed;
+        server_conn_free(conn);
+    }
+    return status;
+}
+
+void server_stop(Server* server) {
+    if (!server) return;
+    __atomic_store_n(&server->stopRequested, 1, __ATOMIC_RELEASE);
+    char byte = 0;
+    if (write(server->wakePipe[1], &byte, 1) < 0) return;
+}
+
+void server_destroy(Server* server) {
+    if (!server) return;
+    thread_pool_destroy(server->workers);
+    if (server->listenFd >= 0) {
+        close(server->listenFd);
+        if (server->bound) unlink(server->path);
+    }
+    if (server->epollFd >= 0) close(server->epollFd);
+    if (server->wakePipe[0] >= 0) close(server->wakePipe[0]);
+    if (server->wakePipe[1] >= 0) close(server->wakePipe[1]);
+
+    for (uint32_t i = 0; i < server->store.count; i++) poly_free(server->store.slots[i]);
+    poly_mem_free(server->store.slots);
+    poly_mem_free(server->store.freeIds);
+    pthread_rwlock_destroy(&server->store.lock);
+    pthread_mutex_destroy(&server->doneLock);
+    poly_mem_free(server->conns);
+    poly_mem_free(server->path);
+    poly_mem_free(server);
+}
+
+/* ---- Load generator ---- */
+
+#define LOAD_POLY_DEGREE 63
+
+typedef struct {
+    const char* path;
+    int requests;
+    int depth;
+    int json;
+    double* latencies;
+    PolynomialError status;
+} LoadClient;
+
+typedef struct {
+    int fd;
+    int json;
+    ServerBuffer in;
+} LoadConn;
+
+static int load_write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        data += n;
+        length -= n;
+    }
+    return 1;
+}
+
+static size_t load_reply_length(const LoadConn* conn) {
+    if (conn->in.length == 0) return 0;
+    if (conn->json) {
+        const char* newline = memchr(conn->in.data, '\n', conn->in.length);
+        return newline ? (size_t)(newline - conn->in.data) + 1 : 0;
+    }
+    if (conn->in.length < 4 || conn->in.length - 4 < read_u32(conn->in.data)) return 0;
+    return 4 + read_u32(conn->in.data);
+}
+
+// Blocks for the next reply and extracts its status and the id it carries, if any
+static int load_read_reply(LoadConn* conn, PolynomialError* status, uint32_t* id) {
+    size_t length;
+    while ((length = load_reply_length(conn)) == 0) {
+        if (!buffer_reserve(&conn->in, SERVER_READ_CHUNK)) return 0;
+        ssize_t n = read(conn->fd, conn->in.data + conn->in.length, SERVER_READ_CHUNK);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        conn->in.length += n;
+    }
+
+    *id = 0;
+    if (conn->json) {
+        conn->in.data[length - 1] = '\0';
+        *status = strstr(conn->in.data, "\"ok\":true") ? POLYNOMIAL_OK : POLYNOMIAL_CALC_ERROR;
+        json_u32(json_value(conn->in.data, "id"), id);
+    } else {
+        *status = (PolynomialError)(conn->in.data[4] * 100);
+        if (length >= 9) *id = read_u32(conn->in.data + 5);
+    }
+    buffer_consume(&conn->in, length);
+    return 1;
+}
+
+static int load_request(ServerBuffer* out, int json, int op, uint32_t a, uint32_t b, int x) {
+    if (json) {
+        switch (op) {
+        case SERVER_OP_MULTIPLY: return buffer_printf(out, "{\"op\":\"multiply\",\"a\":%u,\"b\":%u}\n", a, b);
+        case SERVER_OP_EVALUATE: return buffer_printf(out, "{\"op\":\"evaluate\",\"id\":%u,\"x\":%d}\n", a, x);
+        default: return buffer_printf(out, "{\"op\":\"free\",\"id\":%u}\n", a);
+        }
+    }
+
+    unsigned char opcode = (unsigned char)op;
+    switch (op) {
+    case SERVER_OP_MULTIPLY:
+        return append_u32(out, 9) && buffer_append(out, &opcode, 1) && append_u32(out, a) && append_u32(out, b);
+    case SERVER_OP_EVALUATE:
+        return append_u32(out, 5 + sizeof(int)) && buffer_append(out, &opcode, 1) && append_u32(out, a) &&
+               buffer_append(out, &x, sizeof(int));
+    default:
+        return append_u32(out, 5) && buffer_append(out, &opcode, 1) && append_u32(out, a);
+    }
+}
+
+static int load_create(LoadConn* conn, int seed, uint32_t* id) {
+    ServerBuffer out = {NULL, 0, 0};
+    int coeffs[LOAD_POLY_DEGREE + 1];
+    for (int i = 0; i <= LOAD_POLY_DEGREE; i++) coeffs[i] = (i * 7 + seed) % 9 - 4;
+
+    int ok;
+    if (conn->json) {
+        ok = buffer_printf(&out, "{\"op\":\"create\",\"type\":\"int\",\"coeffs\":[");
+        for (int i = 0; ok && i <= LOAD_POLY_DEGREE; i++) ok = buffer_printf(&out, i ? ",%d" : "%d", coeffs[i]);
+        ok = ok && buffer_printf(&out, "]}\n");
+    } else {
+        unsigned char header[2] = {SERVER_OP_CREATE, SERVER_TYPE_INT};
+        ok = append_u32(&out, 6 + sizeof(coeffs)) && buffer_append(&out, header, 2) &&
+             append_u32(&out, LOAD_POLY_DEGREE) && buffer_append(&out, coeffs, sizeof(coeffs));
+    }
+
+    PolynomialError status = POLYNOMIAL_CALC_ERROR;
+    ok = ok && load_write_all(conn->fd, out.data, out.length) && load_read_reply(conn, &status, id);
+    buffer_free(&out);
+    return ok && status == POLYNOMIAL_OK;
+}
+
+// Keeps depth requests in flight: evaluations, with every fourth a multiply
+// whose product is freed by a later request
+static void* load_client_run(void* arg) {
+    LoadClient* client = arg;
+    LoadConn conn = {-1, client->json, {NULL, 0, 0}};
+    ServerBuffer out = {NULL, 0, 0};
+    double* sentAt = poly_mem_alloc(client->depth * sizeof(double));
+    char* kinds = poly_mem_alloc(client->depth);
+    uint32_t* pendingFree = poly_mem_alloc((client->requests + 2) * sizeof(uint32_t));
+    int freeCount = 0;
+    uint32_t a = 0, b = 0;
+    client->status = POLYNOMIAL_CALC_ERROR;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, client->path, sizeof(addr.sun_path) - 1);
+    conn.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (!sentAt || !kinds || !pendingFree || conn.fd < 0 ||
+        connect(conn.fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        !load_create(&conn, 0, &a) || !load_create(&conn, 1, &b)) {
+        goto done;
+    }
+
+    int sent = 0, received = 0;
+    while (received < client->requests) {
+        out.length = 0;
+        while (sent < client->requests && sent - received < client->depth) {
+            int slot = sent % client->depth;
+            int ok;
+            if (freeCount > 0) {
+                kinds[slot] = SERVER_OP_FREE;
+                ok = load_request(&out, client->json, SERVER_OP_FREE, pendingFree[--freeCount], 0, 0);
+            } else if (sent % 4 == 3) {
+                kinds[slot] = SERVER_OP_MULTIPLY;
+                ok = load_request(&out, client->json, SERVER_OP_MULTIPLY, a, b, 0);
+            } else {
+                kinds[slot] = SERVER_OP_EVALUATE;
+                ok = load_request(&out, client->json, SERVER_OP_EVALUATE, a, 0, sent % 7 - 3);
+            }
+            if (!ok) goto done;
+            sentAt[slot] = server_now();
+            sent++;
+        }
+        if (out.length > 0 && !load_write_all(conn.fd, out.data, out.length)) goto done;
+
+        // one reply, then whatever else has already arrived
+        do {
+            PolynomialError status;
+            uint32_t id;
+            if (!load_read_reply(&conn, &status, &id) || status != POLYNOMIAL_OK) goto done;
+            int slot = received % client->depth;
+            client->latencies[received] = server_now() - sentAt[slot];
+            if (kinds[slot] == SERVER_OP_MULTIPLY) pendingFree[freeCount++] = id;
+            received++;
+        } while (received < sent && load_reply_length(&conn) > 0);
+    }
+
+    // products still resident and the two operands, outside the measurement
+    pendingFree[freeCount++] = a;
+    pendingFree[freeCount++] = b;
+    out.length = 0;
+    for (int i = 0; i < freeCount; i++) {
+        if (!load_request(&out, client->json, SERVER_OP_FREE, pendingFree[i], 0, 0)) goto done;
+    }
+    if (!load_write_all(conn.fd, out.data, out.length)) goto done;
+    for (int i = 0; i < freeCount; i++) {
+        PolynomialError status;
+        uint32_t id;
+        if (!load_read_reply(&conn, &status, &id)) goto done;
+    }
+    client->status = POLYNOMIAL_OK;
+
+done:
+    if (conn.fd >= 0) close(conn.fd);
+    buffer_free(&conn.in);
+    buffer_free(&out);
+    poly_mem_free(sentAt);
+    poly_mem_free(kinds);
+    poly_mem_free(pendingFree);
+    return NULL;
+}
+
+static int load_compare(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile of sorted samples
+static double load_percentile(const double* sorted, int n, double q) {
+    int rank = (int)(q * n + 0.999999);
+    return sorted[rank < 1 ? 0 : rank > n ? n - 1 : rank - 1];
+}
+
+PolynomialError server_load_test(const char* path, int connections, int requests, int depth, int json) {
+    if (!path) return POLYNOMIAL_NULL_PTR;
+    if (connections < 1 || requests < 1 || depth < 1) return POLYNOMIAL_INVALID_INPUT;
+    if ((long long)connections * requests > INT_MAX) return POLYNOMIAL_INVALID_INPUT;
+
+    int total = connections * requests;
+    LoadClient* clients = poly_mem_calloc(connections, sizeof(LoadClient));
+    pthread_t* threads = poly_mem_alloc(connections * sizeof(pthread_t));
+    double* latencies = poly_mem_alloc(total * sizeof(double));
+    if (!clients || !threads || !latencies) {
+        poly_mem_free(clients);
+        poly_mem_free(threads);
+        poly_mem_free(latencies);
+        return POLYNOMIAL_MEM_ALLOC_FAIL;
+    }
+
+    double start = server_now();
+    int started = 0;
+    for (; started < connections; started++) {
+        LoadClient* client = &clients[started];
+        client->path = path;
+        client->requests = requests;
+        client->depth = depth;
+        client->json = json;
+        client->latencies = latencies + (size_t)started * requests;
+        if (pthread_create(&threads[started], NULL, load_client_run, client) != 0) break;
+    }
+    PolynomialError status = started == connections ? POLYNOMIAL_OK : POLYNOMIAL_CALC_ERROR;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        if (clients[i].status != POLYNOMIAL_OK) status = clients[i].status;
+    }
+    double elapsed = server_now() - start;
+
+    if (status == POLYNOMIAL_OK) {
+        qsort(latencies, total, sizeof(double), load_compare);
+        printf("=== Load test: %d connections x %d requests, depth %d, %s ===\n",
+               connections, requests, depth, json ? "JSON lines" : "binary frames");
+        printf("%d requests in %.3f s: %.0f requests/s\n", total, elapsed, total / elapsed);
+        printf("latency p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               load_percentile(latencies, total, 0.50) * 1e6, load_percentile(latencies, total, 0.99) * 1e6,
+               latencies[total - 1] * 1e6);
+    }
+
+    poly_mem_free(clients);
+    poly_mem_free(threads);
+    poly_mem_free(latencies);
+    return status;
+}
@@ -0,0 +1,54 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "PolynomialDefines.h"
+#include <stdint.h>
+
+// Requests whose body is longer than this are rejected and the connection closed
+#define SERVER_MAX_FRAME (16u << 20)
+// A connection stops getting new batches while this much output is unsent
+#define SERVER_MAX_PENDING_OUTPUT (4u << 20)
+
+// Wire protocol. A request starting with '{' is one JSON line, for example
+//   {"op":"create","type":"int","coeffs":[1,2,3]}
+//   {"op":"multiply","a":1,"b":2}   {"op":"evaluate","id":3,"x":2}
+// and is answered with one JSON line. Anything else is a binary frame: a
+// big-endian u32 body length, then the body. Request bodies start with an
+// opcode byte, response bodies with a status byte (PolynomialError / 100)
+// and the payload. Ids are big-endian u32; coefficients and values travel
+// in the host's native layout, since the socket is local.
+typedef enum {
+    SERVER_OP_CREATE = 1,   // u8 type, u32 degree, coefficients -> u32 id
+    SERVER_OP_ADD,          // u32 a, u32 b -> u32 id
+    SERVER_OP_MULTIPLY,     // u32 a, u32 b -> u32 id
+    SERVER_OP_EVALUATE,     // u32 id, value -> value
+    SERVER_OP_FETCH,        // u32 id -> u8 type, u32 degree, coefficients
+    SERVER_OP_FREE          // u32 id -> nothing
+} ServerOp;
+
+typedef enum {
+    SERVER_TYPE_INT,
+    SERVER_TYPE_COMPLEX,
+    SERVER_TYPE_MODINT,
+    SERVER_TYPE_INT64,      // int results that outgrew 32 bits are fetched as these
+    SERVER_TYPE_INT128
+} ServerType;
+
+typedef struct Server Server;
+
+// Binds the socket at path; workers <= 0 uses one per CPU. A stale socket
+// left there, one that refuses connections, is replaced; a live socket or
+// any other file gives POLYNOMIAL_INVALID_INPUT and is left in place
+Server* server_create(const char* path, int workers, PolynomialError* err);
+// Runs the event loop until server_stop; resident polynomials live until server_destroy
+PolynomialError server_run(Server* server);
+// Async-signal-safe, may be called from any thread
+void server_stop(Server* server);
+void server_destroy(Server* server);
+
+// Load generator: connections client threads each keep depth requests in
+// flight until they have sent requests of them, then reports throughput and
+// latency percentiles. json selects the JSON-lines encoding over binary.
+PolynomialError server_load_test(const char* path, int connections, int requests, int depth, int json);
+
+#endif
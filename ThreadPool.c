@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ThreadPool.h"
+#include "PolynomialMemory.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct TaskNode {
+    ThreadTask task;
+    void* arg;
+    struct TaskNode* next;
+} TaskNode;
+
+struct ThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+    TaskNode* head;
+    TaskNode* tail;
+    int stopping;
+    int threadCount;
+    pthread_t* threads;
+};
+
+static void* thread_pool_worker(void* arg) {
+    ThreadPool* pool = arg;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->head && !pool->stopping) {
+            pthread_cond_wait(&pool->available, &pool->lock);
+        }
+        if (!pool->head) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        TaskNode* node = pool->head;
+        pool->head = node->next;
+        if (!pool->head) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+        node->task(node->arg);
+        poly_mem_free(node);
+    }
+}
+
+ThreadPool* thread_pool_create(int threads, PolynomialError* err) {
+    if (threads < 1) {
+        if (err) *err = POLYNOMIAL_INVALID_INPUT;
+        return NULL;
+    }
+
+    ThreadPool* pool = poly_mem_calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+    pool->threads = poly_mem_alloc(threads * sizeof(pthread_t));
+    if (!pool->threads) {
+        poly_mem_free(pool);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->available, NULL);
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, thread_pool_worker, pool) != 0) break;
+        pool->threadCount++;
+    }
+    if (pool->threadCount == 0) {
+        thread_pool_destroy(pool);
+        if (err) *err = POLYNOMIAL_MEM_ALLOC_FAIL;
+        return NULL;
+    }
+
+    if (err) *err = POLYNOMIAL_OK;
+    return pool;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    // queued tasks still run before the workers exit
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->available);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->available);
+    poly_mem_free(pool->threads);
+    poly_mem_free(pool);
+}
+
+PolynomialError thread_pool_submit(ThreadPool* pool, ThreadTask task, void* arg) {
+    if (!pool || !task) return POLYNOMIAL_NULL_PTR;
+
+    TaskNode* node = poly_mem_alloc(sizeof(TaskNode));
+    if (!node) return POLYNOMIAL_MEM_ALLOC_FAIL;
+    node->task = task;
+    node->arg = arg;
+    node->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail) pool->tail->next = node;
+    else pool->head = node;
+    pool->tail = node;
+    pthread_cond_signal(&pool->available);
+    pthread_mutex_unlock(&pool->lock);
+    return POLYNOMIAL_OK;
+}
+
+int thread_pool_size(const ThreadPool* pool) {
+    return pool ? pool->threadCount : 0;
+}
+
+static ThreadPool* SHARED_POOL = NULL;
+static pthread_once_t SHARED_POOL_ONCE = PTHREAD_ONCE_INIT;
+
+static void thread_pool_shared_init(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    SHARED_POOL = thread_pool_create(cpus > 0 ? (int)cpus : 1, NULL);
+}
+
+ThreadPool* thread_pool_shared(void) {
+    pthread_once(&SHARED_POOL_ONCE, thread_pool_shared_init);
+    return SHARED_POOL;
+}
+
+// Shared between the caller and its helper tasks. Helpers that start after all
+// chunks are taken just drop their reference; the last reference frees it.
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    ParallelBody body;
+    void* ctx;
+    int count;
+    int grain;
+    int chunks;
+    int nextChunk;
+    int finishedChunks;
+    int refs;
+    PolyMemScope memory;   // the caller's, so helpers' allocations are charged to its operation
+} ParallelJob;
+
+static void parallel_job_release(ParallelJob* job) {
+    pthread_mutex_lock(&job->lock);
+    int last = --job->refs == 0;
+    pthread_mutex_unlock(&job->lock);
+    if (last) {
+        pthread_mutex_destroy(&job->lock);
+        pthread_cond_destroy(&job->done);
+        poly_mem_free(job);
+    }
+}
+
+static void parallel_job_run(ParallelJob* job) {
+    for (;;) {
+        int chunk = __atomic_fetch_add(&job->nextChunk, 1, __ATOMIC_RELAXED);
+        if (chunk >= job->chunks) return;
+
+        int begin = chunk * job->grain;
+        int end = begin + job->grain < job->count ? begin + job->grain : job->count;
+        job->body(job->ctx, begin, end);
+
+        pthread_mutex_lock(&job->lock);
+        if (++job->finishedChunks == job->chunks) pthread_cond_broadcast(&job->done);
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+static void parallel_job_helper(void* arg) {
+    ParallelJob* job = arg;
+    PolyMemScope saved = poly_mem_resume(&job->memory);
+    parallel_job_run(job);
+    poly_mem_leave(&saved);
+    parallel_job_release(job);
+}
+
+PolynomialError thread_pool_parallel_for(ThreadPool* pool, int count, int grain, ParallelBody body, void* ctx) {
+    if (!body) return POLYNOMIAL_NULL_PTR;
+    if (count <= 0) return POLYNOMIAL_OK;
+    if (grain < 1) grain = 1;
+
+    int chunks = (int)(((long long)count + grain - 1) / grain);
+    int helpers = pool ? thread_pool_size(pool) : 0;
+    if (helpers > chunks - 1) helpers = chunks - 1;
+    if (helpers <= 0) {
+        body(ctx, 0, count);
+        return POLYNOMIAL_OK;
+    }
+
+    ParallelJob* job = poly_mem_alloc(sizeof(ParallelJob));
+    if (!job) {
+        body(ctx, 0, count);
+        return POLYNOMIAL_OK;
+    }
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->done, NULL);
+    job->body = body;
+    job->ctx = ctx;
+    job->count = count;
+    job->grain = grain;
+    job->chunks = chunks;
+    job->nextChunk = 0;
+    job->finishedChunks = 0;
+    job->refs = 1;
+    job->memory = poly_mem_current();
+
+    for (int i = 0; i < helpers; i++) {
+        pthread_mutex_lock(&job->lock);
+        job->refs++;
+        pthread_mutex_unlock(&job->lock);
+        if (thread_pool_submit(pool, parallel_job_helper, job) != POLYNOMIAL_OK) {
+            parallel_job_release(job);
+            break;
+        }
+    }
+
+    parallel_job_run(job);
+
+    pthread_mutex_lock(&job->lock);
+    while (job->finishedChunks < job->chunks) {
+        pthread_cond_wait(&job->done, &job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+    parallel_job_release(job);
+    return POLYNOMIAL_OK;
+}
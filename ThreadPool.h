@@ -0,0 +1,25 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "PolynomialDefines.h"
+
+typedef void (*ThreadTask)(void* arg);
+// Processes the index range [begin, end) of a parallel loop
+typedef void (*ParallelBody)(void* ctx, int begin, int end);
+
+typedef struct ThreadPool ThreadPool;
+
+ThreadPool* thread_pool_create(int threads, PolynomialError* err);
+void thread_pool_destroy(ThreadPool* pool);
+PolynomialError thread_pool_submit(ThreadPool* pool, ThreadTask task, void* arg);
+int thread_pool_size(const ThreadPool* pool);
+
+// Process-wide pool sized to the online CPUs, created on first use
+ThreadPool* thread_pool_shared(void);
+
+// Splits [0, count) into chunks of at most grain indices and runs them on the
+// pool; the calling thread takes part and returns once every chunk is done.
+// Safe to call from inside a pool task.
+PolynomialError thread_pool_parallel_for(ThreadPool* pool, int count, int grain, ParallelBody body, void* ctx);
+
+#endif
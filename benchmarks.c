@@ -0,0 +1,854 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "benchmarks.h"
+#include "Polynomial.h"
+#include "Integer.h"
+#include "Complex.h"
+#include "PolynomialFormat.h"
+#include "PolynomialSeries.h"
+#include "PolynomialRealRoots.h"
+#include "PolynomialDisk.h"
+#include "PolynomialBatch.h"
+#include "PolynomialConvolve.h"
+#include "PolynomialTrace.h"
+#include "PolynomialEvalCache.h"
+#include "PolynomialCompile.h"
+#include "PolynomialKernels.h"
+#include "PolynomialFFT.h"
+#include "PolynomialMemory.h"
+#include "ModInt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static double bench_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static Polynomial* bench_random_poly(const TypeInfo* typeInfo, int degree) {
+    PolynomialError err;
+    Polynomial* poly = poly_create(typeInfo, degree, &err);
+    if (!poly) return NULL;
+
+    for (int i = 0; i <= degree; i++) {
+        if (typeInfo->size == sizeof(Complex)) {
+            Complex* c = poly->coefficients[i];
+            c->real = (double)rand() / RAND_MAX - 0.5;
+            c->imag = (double)rand() / RAND_MAX - 0.5;
+        } else {
+            *(int*)poly->coefficients[i] = rand() % 201 - 100;
+        }
+    }
+    return poly;
+}
+
+// Runs one operation on polynomials of the given type, returns seconds per repetition
+static double bench_operation(const TypeInfo* typeInfo, const char* op, int degree, int reps) {
+    Polynomial* a = bench_random_poly(typeInfo, degree);
+    Polynomial* b = strcmp(op, "is_equal") == 0 ? poly_clone(a, NULL) : bench_random_poly(typeInfo, degree);
+    Polynomial* r = poly_create(typeInfo, 2 * degree, NULL);
+    char x[sizeof(Complex)];
+    char value[sizeof(Complex)];
+    memcpy(x, a->coefficients[1], typeInfo->size);
+
+    volatile int sink = 0;
+    double start = bench_now();
+    for (int rep = 0; rep < reps; rep++) {
+        if (strcmp(op, "add") == 0) {
+            poly_add(a, b, r);
+        } else if (strcmp(op, "multiply") == 0) {
+            poly_multiply(a, b, r);
+        } else if (strcmp(op, "scale") == 0) {
+            poly_scalar_multiply(a, x, r);
+        } else if (strcmp(op, "evaluate") == 0) {
+            poly_evaluate(a, x, value);
+        } else if (strcmp(op, "is_equal") == 0) {
+            sink += poly_is_equal(a, b);
+        }
+    }
+    double elapsed = (bench_now() - start) / reps;
+    (void)sink;
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(r);
+    return elapsed;
+}
+
+void bench_dispatch_overhead() {
+    printf("=== Benchmark: specialized kernels vs TypeInfo dispatch ===\n");
+
+    // Copies of the built-in descriptors carry the same callbacks but are not
+    // recognized by the dispatcher, so they exercise the generic void* path.
+    TypeInfo genericInt = *GetIntTypeInfo();
+    TypeInfo genericComplex = *GetComplexTypeInfo();
+
+    struct {
+        const char* op;
+        int degree;
+        int reps;
+    } cases[] = {
+        {"add", 100000, 50},
+        {"scale", 100000, 50},
+        {"evaluate", 100000, 50},
+        {"is_equal", 100000, 50},
+        {"multiply", 512, 5},
+    };
+
+    printf("%-8s %-9s %8s %14s %14s %9s\n", "type", "op", "degree", "specialized", "generic", "speedup");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (int t = 0; t < 2; t++) {
+            const TypeInfo* builtin = t == 0 ? GetIntTypeInfo() : GetComplexTypeInfo();
+            const TypeInfo* generic = t == 0 ? &genericInt : &genericComplex;
+            double fast = bench_operation(builtin, cases[c].op, cases[c].degree, cases[c].reps);
+            double slow = bench_operation(generic, cases[c].op, cases[c].degree, cases[c].reps);
+            printf("%-8s %-9s %8d %11.3f ms %11.3f ms %8.2fx\n",
+                   t == 0 ? "int" : "complex", cases[c].op, cases[c].degree,
+                   fast * 1e3, slow * 1e3, slow / fast);
+        }
+    }
+    printf("\n");
+}
+
+static const char* SCHEME_NAMES[] = {"auto", "horner", "estrin", "split"};
+
+// Latency of one evaluation: each call's x depends on the previous result, so
+// consecutive calls cannot overlap and only the dependency chain is measured.
+static double bench_eval_latency(const Polynomial* poly, PolyEvalScheme scheme, int reps) {
+    static volatile int zero = 0;
+    int z = zero;
+    double start = bench_now();
+    if (poly->typeInfo == GetComplexTypeInfo()) {
+        Complex x = {0.999, 0.01}, r;
+        for (int rep = 0; rep < reps; rep++) {
+            poly_evaluate_scheme(poly, &x, &r, scheme);
+            x.real += r.real * z;
+        }
+    } else {
+        int x = 3, r;
+        for (int rep = 0; rep < reps; rep++) {
+            poly_evaluate_scheme(poly, &x, &r, scheme);
+            x += r * z;
+        }
+    }
+    return (bench_now() - start) / reps;
+}
+
+// Relative error of each scheme against a long double Horner reference
+static double bench_eval_error(const Polynomial* poly, PolyEvalScheme scheme, Complex x) {
+    long double re = 0.0L, im = 0.0L;
+    for (int i = poly->degree; i >= 0; i--) {
+        const Complex* c = poly->coefficients[i];
+        long double t = re * x.real - im * x.imag + c->real;
+        im = re * x.imag + im * x.real + c->imag;
+        re = t;
+    }
+    Complex r;
+    poly_evaluate_scheme(poly, &x, &r, scheme);
+    long double norm = sqrtl(re * re + im * im);
+    long double diff = sqrtl((r.real - re) * (r.real - re) + (r.imag - im) * (r.imag - im));
+    return norm > 0 ? (double)(diff / norm) : (double)diff;
+}
+
+void bench_evaluation_schemes() {
+    printf("=== Benchmark: single-point evaluation latency (ns) ===\n");
+    int degrees[] = {8, 16, 32, 48, 64, 256, 1024, 16384, 131072, 1000000};
+    int count = sizeof(degrees) / sizeof(degrees[0]);
+
+    for (int t = 0; t < 2; t++) {
+        const TypeInfo* typeInfo = t == 0 ? GetIntTypeInfo() : GetComplexTypeInfo();
+        printf("%-8s %8s %10s %10s %10s %10s\n", t == 0 ? "int" : "complex", "degree",
+               SCHEME_NAMES[POLY_EVAL_HORNER], SCHEME_NAMES[POLY_EVAL_ESTRIN],
+               SCHEME_NAMES[POLY_EVAL_SPLIT_HORNER], SCHEME_NAMES[POLY_EVAL_AUTO]);
+        for (int d = 0; d < count; d++) {
+            Polynomial* poly = bench_random_poly(typeInfo, degrees[d]);
+            int reps = 20000000 / (degrees[d] + 1);
+            if (reps < 5) reps = 5;
+            printf("%-8s %8d", "", degrees[d]);
+            PolyEvalScheme order[] = {POLY_EVAL_HORNER, POLY_EVAL_ESTRIN, POLY_EVAL_SPLIT_HORNER, POLY_EVAL_AUTO};
+            for (int k = 0; k < 4; k++) {
+                printf(" %10.1f", bench_eval_latency(poly, order[k], reps) * 1e9);
+            }
+            printf("\n");
+            poly_free(poly);
+        }
+    }
+
+    printf("\ncomplex: max relative error against a long double reference\n");
+    printf("%8s %12s %12s %12s\n", "degree", "horner", "estrin", "split");
+    for (int d = 0; d < count; d++) {
+        Polynomial* poly = bench_random_poly(GetComplexTypeInfo(), degrees[d]);
+        double worst[4] = {0, 0, 0, 0};
+        for (int k = 0; k < 16; k++) {
+            double angle = 2.0 * acos(-1.0) * k / 16;
+            Complex x = {cos(angle) * 0.999, sin(angle) * 0.999};
+            for (int s = POLY_EVAL_HORNER; s <= POLY_EVAL_SPLIT_HORNER; s++) {
+                double e = bench_eval_error(poly, (PolyEvalScheme)s, x);
+                if (e > worst[s]) worst[s] = e;
+            }
+        }
+        printf("%8d %12.2e %12.2e %12.2e\n", degrees[d], worst[POLY_EVAL_HORNER],
+               worst[POLY_EVAL_ESTRIN], worst[POLY_EVAL_SPLIT_HORNER]);
+        poly_free(poly);
+    }
+    printf("\n");
+}
+
+#define SCALING_OPS_PER_THREAD 4000
+
+// Each thread owns its polynomials and repeats multiply, evaluate and add, so
+// the only sharing is the type descriptors and the allocator.
+static void* bench_scaling_worker(void* arg) {
+    const TypeInfo* typeInfo = arg;
+    PolynomialError err;
+    Polynomial* a = poly_create(typeInfo, 48, &err);
+    Polynomial* b = poly_create(typeInfo, 48, &err);
+    Polynomial* r = poly_create(typeInfo, 96, &err);
+    for (int i = 0; i <= 48; i++) {
+        *(int*)a->coefficients[i] = i % 13 - 6;
+        *(int*)b->coefficients[i] = i % 7 - 3;
+    }
+
+    int x = 3, value;
+    for (int op = 0; op < SCALING_OPS_PER_THREAD; op++) {
+        poly_multiply(a, b, r);
+        poly_evaluate(r, &x, &value);
+        poly_add(a, b, a);
+    }
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(r);
+    return NULL;
+}
+
+void bench_thread_scaling() {
+    printf("=== Benchmark: throughput from concurrent caller threads ===\n");
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    int maxThreads = cpus < 4 ? 8 : 2 * (int)cpus;
+    printf("%d CPUs online, %d ops per thread\n", (int)cpus, SCALING_OPS_PER_THREAD);
+    printf("%8s %14s %9s %11s\n", "threads", "ops/s", "speedup", "efficiency");
+
+    pthread_t* threads = malloc(maxThreads * sizeof(pthread_t));
+    if (!threads) return;
+    bench_scaling_worker((void*)GetIntTypeInfo());
+    double base = 0.0;
+    for (int count = 1; count <= maxThreads; count *= 2) {
+        double start = bench_now();
+        int started = 0;
+        for (; started < count; started++) {
+            if (pthread_create(&threads[started], NULL, bench_scaling_worker, (void*)GetIntTypeInfo()) != 0) break;
+        }
+        for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+        double rate = (double)started * SCALING_OPS_PER_THREAD / (bench_now() - start);
+
+        if (count == 1) base = rate;
+        // efficiency is relative to the ideal speedup the hardware allows
+        int ideal = count < cpus ? count : (int)cpus;
+        printf("%8d %14.0f %8.2fx %10.0f%%\n", count, rate, rate / base, 100.0 * rate / (base * ideal));
+    }
+    free(threads);
+    printf("\n");
+}
+
+#define FORMAT_BENCH_DEGREE 1000000
+
+// Old printf-per-coefficient path, kept here as the baseline
+static void bench_print_with_printf(const Polynomial* poly, FILE* out) {
+    for (int i = poly->degree; i >= 0; i--) {
+        if (i < poly->degree) fprintf(out, " + ");
+        if (poly->typeInfo == GetIntTypeInfo()) {
+            fprintf(out, "%d", *(int*)poly->coefficients[i]);
+        } else {
+            const Complex* c = poly->coefficients[i];
+            if (c->imag == 0.0) fprintf(out, "%.2f", c->real);
+            else if (c->real == 0.0) fprintf(out, "%.2fi", c->imag);
+            else fprintf(out, "(%.2f %+.2fi)", c->real, c->imag);
+        }
+        if (i > 0) fprintf(out, "x");
+        if (i > 1) fprintf(out, "^%d", i);
+    }
+    fprintf(out, "\n");
+}
+
+void bench_format_throughput() {
+    printf("=== Benchmark: formatting throughput, degree %d ===\n", FORMAT_BENCH_DEGREE);
+    FILE* out = fopen("/dev/null", "w");
+    if (!out) return;
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetComplexTypeInfo()};
+    const char* names[] = {"int", "complex"};
+    printf("%-8s %-10s %12s %12s\n", "type", "path", "MB", "MB/s");
+
+    for (int t = 0; t < 2; t++) {
+        Polynomial* poly = bench_random_poly(types[t], FORMAT_BENCH_DEGREE);
+        size_t bytes = 0;
+        poly_format(poly, NULL, 0, NULL, &bytes);
+
+        double start = bench_now();
+        bench_print_with_printf(poly, out);
+        fflush(out);
+        double printfTime = bench_now() - start;
+
+        start = bench_now();
+        poly_write(poly, out, NULL);
+        fflush(out);
+        double writeTime = bench_now() - start;
+
+        double mb = bytes / 1e6;
+        printf("%-8s %-10s %12.1f %12.1f\n", names[t], "printf", mb, mb / printfTime);
+        printf("%-8s %-10s %12.1f %12.1f\n", names[t], "poly_write", mb, mb / writeTime);
+        poly_free(poly);
+    }
+    fclose(out);
+    printf("\n");
+}
+
+// 1 / f by the term-by-term recurrence the Newton iteration replaces, O(n^2)
+static void bench_naive_inverse(const ModInt* f, ModInt* g, int n) {
+    ModInt inv0 = modint_inverse(f[0]);
+    g[0] = inv0;
+    for (int k = 1; k < n; k++) {
+        uint64_t sum = 0;
+        for (int i = 1; i <= k; i++) sum = (sum + (uint64_t)f[i] * g[k - i]) % MODINT_MODULUS;
+        g[k] = (ModInt)((MODINT_MODULUS - sum) % MODINT_MODULUS * inv0 % MODINT_MODULUS);
+    }
+}
+
+void bench_power_series() {
+    printf("=== Benchmark: ModInt power series, Newton iteration vs O(n^2) ===\n");
+    printf("%8s %12s %12s %12s %12s %12s\n", "terms", "naive inv", "inv", "log", "exp", "sqrt");
+    for (int n = 1 << 10; n <= 1 << 16; n <<= 2) {
+        PolynomialError err;
+        Polynomial* f = poly_create(GetModIntTypeInfo(), n - 1, &err);
+        Polynomial* r = poly_create(GetModIntTypeInfo(), n - 1, &err);
+        ModInt* c = f->coefficients[0];
+        c[0] = 1;
+        for (int i = 1; i < n; i++) c[i] = (ModInt)(rand() % MODINT_MODULUS);
+
+        double naive = -1.0;
+        if (n <= 1 << 14) {
+            double start = bench_now();
+            bench_naive_inverse(c, r->coefficients[0], n);
+            naive = bench_now() - start;
+        }
+        double times[4];
+        for (int op = 0; op < 4; op++) {
+            // exp needs a zero constant term, the others a unit
+            c[0] = op == 2 ? 0 : 1;
+            double start = bench_now();
+            if (op == 0) series_inv(f, n, r);
+            else if (op == 1) series_log(f, n, r);
+            else if (op == 2) series_exp(f, n, r);
+            else series_sqrt(f, n, r);
+            times[op] = bench_now() - start;
+        }
+
+        if (naive >= 0.0) printf("%8d %10.2fms", n, naive * 1e3);
+        else printf("%8d %12s", n, "-");
+        printf(" %10.2fms %10.2fms %10.2fms %10.2fms\n", times[0] * 1e3, times[1] * 1e3, times[2] * 1e3, times[3] * 1e3);
+        poly_free(f);
+        poly_free(r);
+    }
+    printf("\n");
+}
+
+void bench_real_roots() {
+    printf("=== Benchmark: real root isolation ===\n");
+    printf("%-28s %8s %8s %12s %12s\n", "polynomial", "degree", "roots", "isolate", "to 1e-12");
+    PolyRealRoot* roots = malloc(1024 * sizeof(PolyRealRoot));
+    for (int family = 0; family < 2; family++) {
+        static const int mignotte[] = {32, 64, 128};
+        static const int dense[] = {100, 200, 400};
+        for (int k = 0; k < 3; k++) {
+            // Mignotte x^n - 2 (10x - 1)^2 has two roots about 10^-n/2 apart
+            int n = family == 0 ? mignotte[k] : dense[k];
+            PolynomialError err;
+            Polynomial* p = poly_create(GetIntTypeInfo(), n, &err);
+            int* c = p->coefficients[0];
+            if (family == 0) {
+                c[0] = -2;
+                c[1] = 40;
+                c[2] = -200;
+                c[n] = 1;
+            } else {
+                for (int i = 0; i <= n; i++) c[i] = rand() % 2001 - 1000;
+                if (c[n] == 0) c[n] = 1;
+            }
+
+            int count = 0;
+            double start = bench_now();
+            PolynomialError isolate = poly_isolate_real_roots(p, 0.0, roots, &count);
+            double isolated = bench_now() - start;
+            start = bench_now();
+            poly_isolate_real_roots(p, 1e-12, roots, &count);
+            double refined = bench_now() - start;
+            if (isolate == POLYNOMIAL_OK) {
+                printf("%-28s %8d %8d %10.2fms %10.2fms\n", family == 0 ? "Mignotte, a = 10" : "random dense, |c| <= 1000",
+                       n, count, isolated * 1e3, refined * 1e3);
+            } else {
+                printf("%-28s %8d %8s\n", family == 0 ? "Mignotte, a = 10" : "random dense, |c| <= 1000", n,
+                       "not square-free");
+            }
+            poly_free(p);
+        }
+    }
+    free(roots);
+    printf("\n");
+}
+
+void bench_disk_multiply() {
+    printf("=== Benchmark: out-of-core ModInt multiplication, 2^20 x 2^20 coefficients ===\n");
+    const int n = 1 << 20;
+    PolynomialError err;
+    Polynomial* a = poly_create(GetModIntTypeInfo(), n - 1, &err);
+    Polynomial* b = poly_create(GetModIntTypeInfo(), n - 1, &err);
+    Polynomial* r = poly_create(GetModIntTypeInfo(), 2 * n - 2, &err);
+    for (int i = 0; i < n; i++) {
+        *(ModInt*)a->coefficients[i] = (ModInt)(rand() % MODINT_MODULUS);
+        *(ModInt*)b->coefficients[i] = (ModInt)(rand() % MODINT_MODULUS);
+    }
+    double start = bench_now();
+    poly_multiply(a, b, r);
+    printf("in memory: %.2fms\n", (bench_now() - start) * 1e3);
+
+    char pathA[64], pathB[64], pathR[64];
+    snprintf(pathA, sizeof(pathA), "/tmp/polycalc-bench-%d-a.bin", (int)getpid());
+    snprintf(pathB, sizeof(pathB), "/tmp/polycalc-bench-%d-b.bin", (int)getpid());
+    snprintf(pathR, sizeof(pathR), "/tmp/polycalc-bench-%d-r.bin", (int)getpid());
+    DiskPolynomial* da = disk_poly_create(pathA, GetModIntTypeInfo(), n - 1, &err);
+    DiskPolynomial* db = disk_poly_create(pathB, GetModIntTypeInfo(), n - 1, &err);
+    DiskPolynomial* dr = disk_poly_create(pathR, GetModIntTypeInfo(), 2 * n - 2, &err);
+    if (da && db && dr) {
+        disk_poly_write(da, 0, a->coefficients[0], n);
+        disk_poly_write(db, 0, b->coefficients[0], n);
+        printf("%10s %8s %10s %10s %10s %10s %12s %12s\n", "budget", "block", "total", "compute", "stalled",
+               "read", "read MB/s", "write MB/s");
+        for (size_t budget = (size_t)4 << 20; budget <= (size_t)64 << 20; budget <<= 2) {
+            DiskMultiplyOptions options = {budget, 0};
+            DiskIoStats stats;
+            if (disk_poly_multiply(da, db, dr, &options, &stats) != POLYNOMIAL_OK) continue;
+            printf("%8zuMB %8d %8.2fms %8.2fms %8.2fms %8.1fMB %12.1f %12.1f\n", budget >> 20, stats.blockSize,
+                   stats.wallSeconds * 1e3, stats.computeSeconds * 1e3, stats.stallSeconds * 1e3,
+                   stats.bytesRead / 1e6, stats.bytesRead / 1e6 / stats.readSeconds,
+                   stats.bytesWritten / 1e6 / stats.writeSeconds);
+        }
+    }
+    disk_poly_free(da);
+    disk_poly_free(db);
+    disk_poly_free(dr);
+    unlink(pathA);
+    unlink(pathB);
+    unlink(pathR);
+    poly_free(a);
+    poly_free(b);
+    poly_free(r);
+    printf("\n");
+}
+
+// Seconds per call of one of the direct or FFT convolutions, repeated for
+// at least 20ms
+static double bench_convolution_time(int kernel, void* out, const void* a, const void* b, int n) {
+    int reps = 0;
+    double start = bench_now(), elapsed;
+    do {
+        switch (kernel) {
+        case 0: int_kernel_mullow(out, 2 * n - 1, a, n, b, n); break;
+        case 1: poly_convolve_int(out, 2 * n - 1, a, n, b, n); break;
+        case 2: complex_kernel_mullow(out, 2 * n - 1, a, n, b, n); break;
+        case 3: poly_convolve_complex(out, 2 * n - 1, a, n, b, n); break;
+        default: poly_fft_mullow_complex(a, n, b, n, out, 2 * n - 1); break;
+        }
+        reps++;
+        elapsed = bench_now() - start;
+    } while (elapsed < 0.02);
+    return elapsed / reps;
+}
+
+void bench_convolution() {
+    printf("=== Benchmark: direct convolution, row kernel vs register-tiled (n x n coefficients) ===\n");
+    printf("%6s %12s %12s %8s %12s %12s %8s %12s\n", "n", "int row", "int tiled", "speedup", "cplx row",
+           "cplx tiled", "speedup", "cplx FFT");
+    for (int n = 16; n <= 4096; n *= 2) {
+        int* ia = malloc(n * sizeof(int));
+        int* ib = malloc(n * sizeof(int));
+        int* iout = malloc(2 * n * sizeof(int));
+        Complex* ca = malloc(n * sizeof(Complex));
+        Complex* cb = malloc(n * sizeof(Complex));
+        Complex* cout = malloc(2 * n * sizeof(Complex));
+        for (int i = 0; i < n; i++) {
+            ia[i] = rand() % 201 - 100;
+            ib[i] = rand() % 201 - 100;
+            ca[i].real = (double)rand() / RAND_MAX - 0.5;
+            ca[i].imag = (double)rand() / RAND_MAX - 0.5;
+            cb[i].real = (double)rand() / RAND_MAX - 0.5;
+            cb[i].imag = (double)rand() / RAND_MAX - 0.5;
+        }
+        double t[5];
+        for (int k = 0; k < 5; k++) {
+            t[k] = k < 2 ? bench_convolution_time(k, iout, ia, ib, n) : bench_convolution_time(k, cout, ca, cb, n);
+        }
+        printf("%6d %10.2fus %10.2fus %7.1fx %10.2fus %10.2fus %7.1fx %10.2fus\n", n, t[0] * 1e6, t[1] * 1e6,
+               t[0] / t[1], t[2] * 1e6, t[3] * 1e6, t[2] / t[3], t[4] * 1e6);
+        free(ia);
+        free(ib);
+        free(iout);
+        free(ca);
+        free(cb);
+        free(cout);
+    }
+    printf("\n");
+}
+
+void bench_batch_operations() {
+    const int count = 1 << 17, degree = 15;
+    printf("=== Benchmark: %d independent degree-%d operations, one call each vs batched (ns/item) ===\n", count,
+           degree);
+    printf("%-8s %-10s %12s %12s %8s\n", "type", "op", "per call", "batched", "speedup");
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetComplexTypeInfo()};
+    const char* names[] = {"int", "complex"};
+    for (int t = 0; t < 2; t++) {
+        const TypeInfo* type = types[t];
+        PolynomialError err;
+        Polynomial** as = malloc(count * sizeof(Polynomial*));
+        Polynomial** bs = malloc(count * sizeof(Polynomial*));
+        PolyBatch* a = poly_batch_create(type, count, degree, &err);
+        PolyBatch* b = poly_batch_create(type, count, degree, &err);
+        PolyBatch* sum = poly_batch_create(type, count, degree, &err);
+        PolyBatch* r = poly_batch_create(type, count, 2 * degree, &err);
+        char* points = malloc((size_t)count * type->size);
+        char* values = malloc((size_t)count * type->size);
+        for (int k = 0; k < count; k++) {
+            as[k] = bench_random_poly(type, degree);
+            bs[k] = bench_random_poly(type, degree);
+            poly_batch_set(a, k, as[k]);
+            poly_batch_set(b, k, bs[k]);
+            // points of magnitude at most 1 keep the values finite
+            memset(points + (size_t)k * type->size, 0, type->size);
+            if (t == 0) ((int*)points)[k] = k % 3 - 1;
+            else ((Complex*)points)[k].real = (k % 200) / 100.0 - 1.0;
+        }
+
+        for (int op = 0; op < 3; op++) {
+            // one call per item, each result allocated as the callers do today
+            double start = bench_now();
+            for (int k = 0; k < count; k++) {
+                if (op == 2) {
+                    poly_evaluate(as[k], points + (size_t)k * type->size, values + (size_t)k * type->size);
+                    continue;
+                }
+                Polynomial* result = poly_create(type, op == 0 ? degree : 2 * degree, &err);
+                if (op == 0) poly_add(as[k], bs[k], result);
+                else poly_multiply(as[k], bs[k], result);
+                poly_free(result);
+            }
+            double single = bench_now() - start;
+
+            // best of three, the first also faulting in the result block
+            double batched = 1e30;
+            for (int rep = 0; rep < 3; rep++) {
+                start = bench_now();
+                if (op == 0) poly_batch_add(a, b, sum);
+                else if (op == 1) poly_batch_multiply(a, b, r);
+                else poly_batch_evaluate(a, points, values);
+                if (bench_now() - start < batched) batched = bench_now() - start;
+            }
+            const char* opNames[] = {"add", "multiply", "evaluate"};
+            printf("%-8s %-10s %12.1f %12.1f %7.1fx\n", names[t], opNames[op], single / count * 1e9,
+                   batched / count * 1e9, single / batched);
+        }
+
+        for (int k = 0; k < count; k++) {
+            poly_free(as[k]);
+            poly_free(bs[k]);
+        }
+        free(as);
+        free(bs);
+        free(points);
+        free(values);
+        poly_batch_free(a);
+        poly_batch_free(b);
+        poly_batch_free(sum);
+        poly_batch_free(r);
+    }
+    printf("\n");
+}
+
+void bench_trace_replay() {
+    const int calls = 200000, degree = 8;
+    printf("=== Benchmark: tracing cost on %d degree-%d int adds, then replay of the trace ===\n", calls, degree);
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/polycalc-bench-%d.trace", (int)getpid());
+    PolynomialError err;
+    Polynomial* a = bench_random_poly(GetIntTypeInfo(), degree);
+    Polynomial* b = bench_random_poly(GetIntTypeInfo(), degree);
+    Polynomial* r = poly_create(GetIntTypeInfo(), degree, &err);
+
+    double times[2];
+    for (int traced = 0; traced < 2; traced++) {
+        if (traced) poly_trace_start(path);
+        double start = bench_now();
+        for (int i = 0; i < calls; i++) poly_add(a, b, r);
+        times[traced] = bench_now() - start;
+        if (traced) poly_trace_stop();
+    }
+    printf("%-12s %10.1f ns/op\n", "untraced", times[0] / calls * 1e9);
+    printf("%-12s %10.1f ns/op (%zu bytes per record)\n", "traced", times[1] / calls * 1e9, sizeof(PolyTraceRecord));
+
+    PolyReplayReport report;
+    PolyReplayOptions options = POLY_REPLAY_DEFAULTS;
+    if (poly_trace_replay(path, &options, &report) == POLYNOMIAL_OK) poly_replay_print(&report);
+    remove(path);
+    poly_free(a);
+    poly_free(b);
+    poly_free(r);
+}
+
+void bench_eval_cache() {
+    const int degree = 1023, count = 4096, updates = 256, batch = 16;
+    printf("=== Benchmark: degree-%d polynomial at %d points, coefficient updates (us/update) ===\n", degree, count);
+    printf("%-8s %14s %14s %14s %10s\n", "type", "re-evaluate", "cached", "cached x16", "speedup");
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetComplexTypeInfo()};
+    const char* names[] = {"int", "complex"};
+    for (int t = 0; t < 2; t++) {
+        const TypeInfo* type = types[t];
+        size_t size = type->size;
+        PolynomialError err;
+        Polynomial* poly = bench_random_poly(type, degree);
+        Polynomial* coeffs = bench_random_poly(type, updates - 1);
+        Polynomial* pointPoly = bench_random_poly(type, count - 1);
+        char* points = malloc(count * size);
+        char* values = malloc(count * size);
+        memcpy(points, pointPoly->coefficients[0], count * size);
+        // complex points on the unit circle keep high powers out of the denormals
+        for (int j = 0; t == 1 && j < count; j++) {
+            ((Complex*)points)[j].real = cos(j * 0.01);
+            ((Complex*)points)[j].imag = sin(j * 0.01);
+        }
+
+        // without a cache every update re-evaluates at every point
+        int reps = 4;
+        double start = bench_now();
+        for (int k = 0; k < reps; k++) {
+            memcpy(poly->coefficients[(k * 37) % (degree + 1)], coeffs->coefficients[k], size);
+            for (int j = 0; j < count; j++) poly_evaluate(poly, points + j * size, values + j * size);
+        }
+        double full = (bench_now() - start) / reps;
+
+        PolyEvalCache* cache = poly_eval_cache_create(poly, points, count, &err);
+        start = bench_now();
+        for (int k = 0; k < updates; k++) {
+            poly_eval_cache_set(cache, (k * 37) % (degree + 1), coeffs->coefficients[k]);
+        }
+        double single = (bench_now() - start) / updates;
+
+        int indices[16];
+        start = bench_now();
+        for (int k = 0; k < updates; k += batch) {
+            for (int i = 0; i < batch; i++) indices[i] = ((k + i) * 53) % (degree + 1);
+            poly_eval_cache_update(cache, indices, coeffs->coefficients[k], batch);
+        }
+        double batched = (bench_now() - start) / updates;
+
+        printf("%-8s %14.1f %14.2f %14.2f %9.0fx\n", names[t], full * 1e6, single * 1e6, batched * 1e6,
+               full / single);
+        poly_eval_cache_free(cache);
+        poly_free(poly);
+        poly_free(coeffs);
+        poly_free(pointPoly);
+        free(points);
+        free(values);
+    }
+}
+
+void bench_copy_on_write() {
+    const int copies = 1000;
+    printf("=== Benchmark: %d copies of an int polynomial (us/copy) ===\n", copies);
+    printf("%-8s %14s %14s %14s\n", "degree", "deep copy", "clone", "first write");
+    int degrees[] = {16, 1024, 65536};
+    Polynomial** held = malloc(copies * sizeof(Polynomial*));
+    for (int d = 0; d < 3; d++) {
+        PolynomialError err;
+        Polynomial* poly = bench_random_poly(GetIntTypeInfo(), degrees[d]);
+
+        double start = bench_now();
+        for (int k = 0; k < copies; k++) {
+            held[k] = poly_create_with_coeffs(GetIntTypeInfo(), poly->degree, poly->coefficients[0], &err);
+        }
+        double deep = (bench_now() - start) / copies;
+        for (int k = 0; k < copies; k++) poly_free(held[k]);
+
+        start = bench_now();
+        for (int k = 0; k < copies; k++) held[k] = poly_clone(poly, &err);
+        double clone = (bench_now() - start) / copies;
+
+        // the first write pays for the copy the clone deferred
+        start = bench_now();
+        for (int k = 0; k < copies; k++) poly_make_unique(held[k]);
+        double write = (bench_now() - start) / copies;
+        for (int k = 0; k < copies; k++) poly_free(held[k]);
+
+        printf("%-8d %14.3f %14.3f %14.3f\n", degrees[d], deep * 1e6, clone * 1e6, write * 1e6);
+        poly_free(poly);
+    }
+    free(held);
+}
+
+void bench_compiled_evaluate() {
+    const int count = 1 << 16;
+    printf("=== Benchmark: evaluation at %d points, compiled vs poly_evaluate (ns/point) ===\n", count);
+    printf("%-8s %6s %12s %12s %9s %12s %12s\n", "type", "degree", "generic", "compiled", "speedup", "build ms",
+           "cached ms");
+    char dir[] = "/tmp/polycalc-bench-compile-XXXXXX";
+    if (!mkdtemp(dir) || poly_compile_set_cache_dir(dir) != POLYNOMIAL_OK) {
+        printf("Cannot create a cache directory\n");
+        return;
+    }
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetComplexTypeInfo()};
+    const char* names[] = {"int", "complex"};
+    int degrees[] = {8, 32, 256};
+    for (int t = 0; t < 2; t++) {
+        const TypeInfo* type = types[t];
+        size_t size = type->size;
+        Polynomial* pointPoly = bench_random_poly(type, count - 1);
+        char* points = malloc(count * size);
+        char* values = malloc(count * size);
+        memcpy(points, pointPoly->coefficients[0], count * size);
+        for (int j = 0; t == 1 && j < count; j++) {
+            ((Complex*)points)[j].real = cos(j * 0.01);
+            ((Complex*)points)[j].imag = sin(j * 0.01);
+        }
+        for (int d = 0; d < 3; d++) {
+            PolynomialError err;
+            Polynomial* poly = bench_random_poly(type, degrees[d]);
+            double start = bench_now();
+            for (int j = 0; j < count; j++) poly_evaluate(poly, points + j * size, values + j * size);
+            double generic = (bench_now() - start) / count;
+
+            start = bench_now();
+            PolyCompiled* compiled = poly_compile(poly, &err);
+            double build = bench_now() - start;
+            if (!compiled) {
+                printf("%-8s %6d compile failed (%d)\n", names[t], degrees[d], err);
+                poly_free(poly);
+                continue;
+            }
+            start = bench_now();
+            PolyCompiled* again = poly_compile(poly, &err);
+            double cached = bench_now() - start;
+
+            int reps = 8;
+            start = bench_now();
+            for (int k = 0; k < reps; k++) poly_compiled_evaluate(compiled, points, values, count);
+            double native = (bench_now() - start) / reps / count;
+
+            printf("%-8s %6d %12.2f %12.2f %8.1fx %12.1f %12.2f\n", names[t], degrees[d], generic * 1e9,
+                   native * 1e9, generic / native, build * 1e3, cached * 1e3);
+            poly_compiled_free(again);
+            poly_compiled_free(compiled);
+            poly_free(poly);
+        }
+        poly_free(pointPoly);
+        free(points);
+        free(values);
+    }
+    poly_compile_clear_cache();
+    rmdir(dir);
+    poly_compile_set_cache_dir(NULL);
+}
+
+#define BENCH_MEM_THREADS 4
+
+typedef struct {
+    int accounted;
+    int count;
+} BenchMemWorker;
+
+static void* bench_mem_worker(void* arg) {
+    BenchMemWorker* worker = arg;
+    for (int k = 0; k < worker->count; k++) {
+        void* block = worker->accounted ? poly_mem_alloc(64) : malloc(64);
+        *(volatile char*)block = (char)k;
+        if (worker->accounted) poly_mem_free(block);
+        else free(block);
+    }
+    return NULL;
+}
+
+// Seconds per allocate-and-free pair on each of threads threads
+static double bench_mem_pairs(int accounted, int threads, int count) {
+    pthread_t ids[BENCH_MEM_THREADS];
+    BenchMemWorker workers[BENCH_MEM_THREADS];
+    double start = bench_now();
+    for (int t = 0; t < threads; t++) {
+        workers[t].accounted = accounted;
+        workers[t].count = count;
+        pthread_create(&ids[t], NULL, bench_mem_worker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) pthread_join(ids[t], NULL);
+    return (bench_now() - start) / count;
+}
+
+void bench_memory_accounting() {
+    const int count = 1000000;
+    printf("=== Benchmark: 64-byte allocate and free, malloc vs accounted (ns/pair) ===\n");
+    printf("%-8s %12s %12s %10s\n", "threads", "malloc", "accounted", "overhead");
+    int threads[] = {1, BENCH_MEM_THREADS};
+    for (int t = 0; t < 2; t++) {
+        double plain = bench_mem_pairs(0, threads[t], count);
+        double accounted = bench_mem_pairs(1, threads[t], count);
+        printf("%-8d %12.1f %12.1f %9.2fx\n", threads[t], plain * 1e9, accounted * 1e9, accounted / plain);
+    }
+
+    // a budget below the NTT's scratch trades its speed for the direct kernel
+    printf("=== Benchmark: modint product under a memory budget ===\n");
+    printf("%-8s %12s %14s %14s\n", "degree", "budget", "peak bytes", "ms");
+    int degrees[] = {1023, 4095};
+    for (int d = 0; d < 2; d++) {
+        PolynomialError err;
+        Polynomial* a = bench_random_poly(GetModIntTypeInfo(), degrees[d]);
+        Polynomial* b = bench_random_poly(GetModIntTypeInfo(), degrees[d]);
+        Polynomial* product = poly_create(GetModIntTypeInfo(), 2 * degrees[d], &err);
+        for (int budgeted = 0; budgeted < 2; budgeted++) {
+            PolyMemStats stats;
+            poly_mem_stats(&stats);
+            size_t base = stats.total.live;
+            if (budgeted) poly_mem_set_budget(base + 1024);
+            poly_mem_reset_peaks();
+            double start = bench_now();
+            poly_multiply(a, b, product);
+            double elapsed = bench_now() - start;
+            poly_mem_stats(&stats);
+            poly_mem_set_budget(0);
+            printf("%-8d %12s %14zu %14.3f\n", degrees[d], budgeted ? "1 KiB" : "none", stats.total.peak - base,
+                   elapsed * 1e3);
+        }
+        poly_free(a);
+        poly_free(b);
+        poly_free(product);
+    }
+}
+
+void run_all_benchmarks() {
+    srand(12345);
+    bench_dispatch_overhead();
+    bench_evaluation_schemes();
+    bench_thread_scaling();
+    bench_format_throughput();
+    bench_power_series();
+    bench_real_roots();
+    bench_disk_multiply();
+    bench_convolution();
+    bench_batch_operations();
+    bench_trace_replay();
+    bench_eval_cache();
+    bench_copy_on_write();
+    bench_compiled_evaluate();
+    bench_memory_accounting();
+    printf("All benchmarks completed.\n");
+}
@@ -0,0 +1,20 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+void run_all_benchmarks();
+void bench_dispatch_overhead();
+void bench_evaluation_schemes();
+void bench_thread_scaling();
+void bench_format_throughput();
+void bench_power_series();
+void bench_real_roots();
+void bench_disk_multiply();
+void bench_convolution();
+void bench_batch_operations();
+void bench_trace_replay();
+void bench_eval_cache();
+void bench_copy_on_write();
+void bench_compiled_evaluate();
+void bench_memory_accounting();
+
+#endif
@@ -1,7 +1,89 @@
 #include "ui.h"
+#include "benchmarks.h"
+#include "Server.h"
+#include "PolynomialTrace.h"
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-int main() {
+static Server* SERVING = NULL;
+
+static void stop_serving(int sig) {
+    (void)sig;
+    server_stop(SERVING);
+}
+
+static int serve(const char* path, int workers) {
+    PolynomialError err;
+    SERVING = server_create(path, workers, &err);
+    if (!SERVING) {
+        fprintf(stderr, "Cannot serve on %s: %s\n", path, polynomial_error_msg(err));
+        return 1;
+    }
+    signal(SIGINT, stop_serving);
+    signal(SIGTERM, stop_serving);
+    printf("Serving on %s\n", path);
+    fflush(stdout);
+
+    err = server_run(SERVING);
+    server_destroy(SERVING);
+    return err == POLYNOMIAL_OK ? 0 : 1;
+}
+
+static int run(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--test") == 0) {
+        run_all_tests();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        run_all_benchmarks();
+        return 0;
+    }
+    // --serve PATH [workers]
+    if (argc > 2 && strcmp(argv[1], "--serve") == 0) {
+        return serve(argv[2], argc > 3 ? atoi(argv[3]) : 0);
+    }
+    // --load PATH [connections] [requests] [depth] [json|binary]
+    if (argc > 2 && strcmp(argv[1], "--load") == 0) {
+        int connections = argc > 3 ? atoi(argv[3]) : 4;
+        int requests = argc > 4 ? atoi(argv[4]) : 20000;
+        int depth = argc > 5 ? atoi(argv[5]) : 16;
+        int json = argc > 6 && strcmp(argv[6], "json") == 0;
+        PolynomialError err = server_load_test(argv[2], connections, requests, depth, json);
+        if (err != POLYNOMIAL_OK) fprintf(stderr, "Load test failed: %s\n", polynomial_error_msg(err));
+        return err == POLYNOMIAL_OK ? 0 : 1;
+    }
+    // --replay TRACE [threads] [rate]
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        PolyReplayOptions options = POLY_REPLAY_DEFAULTS;
+        if (argc > 3) options.threads = atoi(argv[3]);
+        if (argc > 4) options.rate = atof(argv[4]);
+        PolyReplayReport report;
+        PolynomialError err = poly_trace_replay(argv[2], &options, &report);
+        if (err != POLYNOMIAL_OK) {
+            fprintf(stderr, "Replay failed: %s\n", polynomial_error_msg(err));
+            return 1;
+        }
+        poly_replay_print(&report);
+        return 0;
+    }
     run_main_menu();
     return 0;
-}
\ No newline at end of file
+}
+
+// --trace TRACE records every operation of whatever mode follows
+int main(int argc, char* argv[]) {
+    if (argc > 2 && strcmp(argv[1], "--trace") == 0) {
+        PolynomialError err = poly_trace_start(argv[2]);
+        if (err != POLYNOMIAL_OK) {
+            fprintf(stderr, "Cannot trace to %s: %s\n", argv[2], polynomial_error_msg(err));
+            return 1;
+        }
+        argv[2] = argv[0];
+        int status = run(argc - 2, argv + 2);
+        poly_trace_stop();
+        return status;
+    }
+    return run(argc, argv);
+}
@@ -1,10 +1,38 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "tests.h"
 #include "Polynomial.h"
 #include "Integer.h"
 #include "Complex.h"
+#include "ModInt.h"
+#include "PolynomialRoots.h"
+#include "Multivariate.h"
+#include "Server.h"
+#include "PolynomialAsync.h"
+#include "PolynomialFormat.h"
+#include "PolynomialSeries.h"
+#include "PolynomialRealRoots.h"
+#include "PolynomialDisk.h"
+#include "PolynomialConvolve.h"
+#include "PolynomialBatch.h"
+#include "PolynomialTrace.h"
+#include "PolynomialEvalCache.h"
+#include "PolynomialCompile.h"
+#include "PolynomialMemory.h"
+#include "ui.h"
+#include "PolynomialKernels.h"
 #include <assert.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <time.h>
 
 #define EPSILON 1e-6
 
@@ -283,6 +311,2178 @@ void test_diff_size_polynomials() {
     printf("\n");
 }
 
+void test_inplace_and_fma() {
+    printf("=== Testing in-place, fused multiply-add and linear combination ===\n");
+    PolynomialError err;
+
+    int aCoeffs[] = {1, 2};
+    int bCoeffs[] = {3, 4};
+    Polynomial* a = poly_create_with_coeffs(GetIntTypeInfo(), 1, aCoeffs, &err);
+    Polynomial* b = poly_create_with_coeffs(GetIntTypeInfo(), 1, bCoeffs, &err);
+
+    err = poly_add_inplace(a, b);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(int*)a->coefficients[0] == 4 && *(int*)a->coefficients[1] == 6);
+
+    int two = 2;
+    err = poly_scale_inplace(a, &two);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(int*)a->coefficients[0] == 8 && *(int*)a->coefficients[1] == 12);
+
+    // acc += acc * 3 and a * 3 with the result aliasing an input
+    int threeCoeffs[] = {3};
+    int accCoeffs[] = {1, 1};
+    int accExpected[] = {4, 4};
+    Polynomial* three = poly_create_with_coeffs(GetIntTypeInfo(), 0, threeCoeffs, &err);
+    Polynomial* acc = poly_create_with_coeffs(GetIntTypeInfo(), 1, accCoeffs, &err);
+    Polynomial* expectedAcc = poly_create_with_coeffs(GetIntTypeInfo(), 1, accExpected, &err);
+    err = poly_fma(acc, acc, three);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(acc, expectedAcc));
+
+    err = poly_multiply(three, acc, acc);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(int*)acc->coefficients[0] == 12 && *(int*)acc->coefficients[1] == 12);
+
+    // aliased fma matches the same fma on a separate copy
+    const TypeInfo* fmaTypes[] = {GetComplexTypeInfo(), GetInt64TypeInfo()};
+    for (int t = 0; t < 2; t++) {
+        const TypeInfo* ti = fmaTypes[t];
+        Polynomial* self = poly_create(ti, 40, &err);
+        Polynomial* scale = poly_create(ti, 0, &err);
+        for (int i = 0; i <= 40; i++) {
+            if (ti == GetComplexTypeInfo()) *(Complex*)self->coefficients[i] = (Complex){i % 7 - 3.5, i % 5 - 2.0};
+            else *(int64_t*)self->coefficients[i] = i % 7 - 3;
+        }
+        if (ti == GetComplexTypeInfo()) *(Complex*)scale->coefficients[0] = (Complex){1.5, -0.5};
+        else *(int64_t*)scale->coefficients[0] = 5;
+        Polynomial* input = poly_create(ti, 40, &err);
+        err = poly_copy_coeffs(self, input);
+        assert(err == POLYNOMIAL_OK);
+        Polynomial* separate = poly_create(ti, 40, &err);
+        err = poly_copy_coeffs(self, separate);
+        assert(err == POLYNOMIAL_OK);
+        err = poly_fma(separate, input, scale);
+        assert(err == POLYNOMIAL_OK);
+        err = poly_fma(self, self, scale);
+        assert(err == POLYNOMIAL_OK);
+        assert(poly_is_equal(self, separate));
+        poly_free(self);
+        poly_free(scale);
+        poly_free(input);
+        poly_free(separate);
+    }
+
+    // out = 2*c + i*d with out aliasing polys[0]
+    Complex cCoeffs[] = {{1,0}, {0,1}};
+    Complex dCoeffs[] = {{1,1}};
+    Complex scalars[] = {{2,0}, {0,1}};
+    Complex cExpected[] = {{1,1}, {0,2}};
+    Polynomial* c = poly_create_with_coeffs(GetComplexTypeInfo(), 1, cCoeffs, &err);
+    Polynomial* d = poly_create_with_coeffs(GetComplexTypeInfo(), 0, dCoeffs, &err);
+    Polynomial* expectedC = poly_create_with_coeffs(GetComplexTypeInfo(), 1, cExpected, &err);
+    const Polynomial* terms[] = {c, d};
+    err = poly_linear_combination(c, terms, scalars, 2);
+    assert(err == POLYNOMIAL_OK);
+
+    assert(poly_is_equal(expectedC, c));
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(three);
+    poly_free(acc);
+    poly_free(expectedAcc);
+    poly_free(c);
+    poly_free(d);
+    poly_free(expectedC);
+}
+
+void test_specialized_matches_generic() {
+    printf("=== Testing specialized kernels against the generic path ===\n");
+    PolynomialError err;
+
+    // A copy of the descriptor is not recognized by the dispatcher
+    TypeInfo genericComplex = *GetComplexTypeInfo();
+    Complex aCoeffs[] = {{1,2}, {-3,0.5}, {0,1}};
+    Complex bCoeffs[] = {{2,-1}, {4,4}};
+    Complex x = {0.5, -1.5};
+
+    Polynomial* a = poly_create_with_coeffs(GetComplexTypeInfo(), 2, aCoeffs, &err);
+    Polynomial* b = poly_create_with_coeffs(GetComplexTypeInfo(), 1, bCoeffs, &err);
+    Polynomial* prod = poly_create(GetComplexTypeInfo(), 3, &err);
+    Polynomial* ga = poly_create_with_coeffs(&genericComplex, 2, aCoeffs, &err);
+    Polynomial* gb = poly_create_with_coeffs(&genericComplex, 1, bCoeffs, &err);
+    Polynomial* gprod = poly_create(&genericComplex, 3, &err);
+
+    err = poly_multiply(a, b, prod);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_multiply(ga, gb, gprod);
+    assert(err == POLYNOMIAL_OK);
+    for (int i = 0; i <= 3; i++) {
+        assert(complex_equals(prod->coefficients[i], gprod->coefficients[i]));
+    }
+
+    Complex value, gvalue;
+    err = poly_evaluate(prod, &x, &value);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_evaluate(gprod, &x, &gvalue);
+    assert(err == POLYNOMIAL_OK);
+    assert(complex_equals(&value, &gvalue));
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(prod);
+    poly_free(ga);
+    poly_free(gb);
+    poly_free(gprod);
+}
+
+void test_pow_and_compose() {
+    printf("=== Testing polynomial power and composition ===\n");
+    PolynomialError err;
+
+    // (1 + x)^5 and its truncation to degree 2
+    int baseCoeffs[] = {1, 1};
+    int expectedPow[] = {1, 5, 10, 10, 5, 1};
+    Polynomial* base = poly_create_with_coeffs(GetIntTypeInfo(), 1, baseCoeffs, &err);
+    Polynomial* power = poly_create(GetIntTypeInfo(), 5, &err);
+    Polynomial* expectedPowPoly = poly_create_with_coeffs(GetIntTypeInfo(), 5, expectedPow, &err);
+    err = poly_pow(base, 5, -1, power);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(power, expectedPowPoly));
+
+    Polynomial* truncated = poly_create(GetIntTypeInfo(), 2, &err);
+    err = poly_pow(base, 5, 2, truncated);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(int*)truncated->coefficients[2] == 10);
+
+    // p(q) for both the Horner and the Brent-Kung sizes
+    int degrees[] = {5, 60};
+    for (int d = 0; d < 2; d++) {
+        int n = degrees[d];
+        Polynomial* p = poly_create(GetIntTypeInfo(), n, &err);
+        for (int i = 0; i <= n; i++) *(int*)p->coefficients[i] = (i * 7) % 11 - 5;
+        int qCoeffs[] = {2, -1, 3};
+        Polynomial* q = poly_create_with_coeffs(GetIntTypeInfo(), 2, qCoeffs, &err);
+
+        Polynomial* composed = poly_create(GetIntTypeInfo(), 2 * n, &err);
+        err = poly_compose(p, q, composed);
+        assert(err == POLYNOMIAL_OK);
+
+        // integer arithmetic wraps consistently, so p(q(x)) must match exactly
+        for (int x = -3; x <= 3; x++) {
+            int qx, pqx, composedx;
+            poly_evaluate(q, &x, &qx);
+            poly_evaluate(p, &qx, &pqx);
+            poly_evaluate(composed, &x, &composedx);
+            assert(pqx == composedx);
+        }
+
+        poly_free(p);
+        poly_free(q);
+        poly_free(composed);
+    }
+
+    assert(poly_is_equal(power, expectedPowPoly));
+
+    poly_free(base);
+    poly_free(power);
+    poly_free(expectedPowPoly);
+    poly_free(truncated);
+}
+
+static int root_is_listed(const Complex* roots, int n, Complex expected, double tol) {
+    for (int i = 0; i < n; i++) {
+        if (fabs(roots[i].real - expected.real) < tol && fabs(roots[i].imag - expected.imag) < tol) return 1;
+    }
+    return 0;
+}
+
+void test_derivative_and_roots() {
+    printf("=== Testing derivative, deflation and root finding ===\n");
+    PolynomialError err;
+
+    // (x - 1)(x - 2)(x - 3) = x^3 - 6x^2 + 11x - 6
+    int cubicCoeffs[] = {-6, 11, -6, 1};
+    int derivExpected[] = {11, -12, 3};
+    int quotientExpected[] = {6, -5, 1, 0};
+    Polynomial* cubic = poly_create_with_coeffs(GetIntTypeInfo(), 3, cubicCoeffs, &err);
+    Polynomial* deriv = poly_create(GetIntTypeInfo(), 2, &err);
+    Polynomial* expectedDeriv = poly_create_with_coeffs(GetIntTypeInfo(), 2, derivExpected, &err);
+    err = poly_derivative(cubic, deriv);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(deriv, expectedDeriv));
+
+    // deflating in place by the root x = 1 leaves x^2 - 5x + 6
+    Polynomial* quotient = poly_clone(cubic, &err);
+    Polynomial* expectedQuotient = poly_create_with_coeffs(GetIntTypeInfo(), 3, quotientExpected, &err);
+    int root = 1, remainder = -1;
+    err = poly_deflate(quotient, &root, quotient, &remainder);
+    assert(err == POLYNOMIAL_OK);
+    assert(remainder == 0);
+    assert(poly_is_equal(quotient, expectedQuotient));
+
+    Complex roots[20];
+    err = poly_roots(cubic, roots);
+    assert(err == POLYNOMIAL_OK);
+    for (int r = 1; r <= 3; r++) {
+        Complex expected = {r, 0};
+        assert(root_is_listed(roots, 3, expected, 1e-9));
+    }
+
+    // x^20 - 1 and x^3 (zero roots) through the batch interface
+    Polynomial* unity = poly_create(GetComplexTypeInfo(), 20, &err);
+    ((Complex*)unity->coefficients[0])->real = -1;
+    ((Complex*)unity->coefficients[20])->real = 1;
+    int cubeCoeffs[] = {0, 0, 0, 2};
+    Polynomial* cube = poly_create_with_coeffs(GetIntTypeInfo(), 3, cubeCoeffs, &err);
+
+    Complex unityRoots[20];
+    Complex cubeRoots[3];
+    const Polynomial* batch[] = {unity, cube, cubic};
+    Complex* batchRoots[] = {unityRoots, cubeRoots, roots};
+    PolynomialError errors[3];
+    err = poly_roots_batch(batch, batchRoots, errors, 3);
+    assert(err == POLYNOMIAL_OK);
+    for (int k = 0; k < 20; k++) {
+        Complex expected = {cos(2 * acos(-1.0) * k / 20), sin(2 * acos(-1.0) * k / 20)};
+        assert(root_is_listed(unityRoots, 20, expected, 1e-9));
+    }
+    for (int k = 0; k < 3; k++) {
+        assert(cubeRoots[k].real == 0.0 && cubeRoots[k].imag == 0.0);
+    }
+
+
+    poly_free(cubic);
+    poly_free(deriv);
+    poly_free(expectedDeriv);
+    poly_free(quotient);
+    poly_free(expectedQuotient);
+    poly_free(unity);
+    poly_free(cube);
+}
+
+void test_taylor_shift_and_scaling() {
+    printf("=== Testing Taylor shift, variable scaling and transform multiplication ===\n");
+    PolynomialError err;
+
+    // (x + 1)^2 shifted by -1 is x^2, scaled by 3 is 9x^2
+    int sqCoeffs[] = {1, 2, 1};
+    int shiftedExpected[] = {0, 0, 1};
+    int scaledExpected[] = {0, 0, 9};
+    Polynomial* sq = poly_create_with_coeffs(GetIntTypeInfo(), 2, sqCoeffs, &err);
+    Polynomial* expectedShift = poly_create_with_coeffs(GetIntTypeInfo(), 2, shiftedExpected, &err);
+    Polynomial* expectedScale = poly_create_with_coeffs(GetIntTypeInfo(), 2, scaledExpected, &err);
+    int minusOne = -1, three = 3;
+    err = poly_taylor_shift(sq, &minusOne, sq);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(sq, expectedShift));
+    err = poly_scale_var(sq, &three, sq);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(sq, expectedScale));
+
+    // convolution-based shifts: p(x + a) evaluated at x must equal p at x + a
+    int n = 300;
+    Polynomial* ip = poly_create(GetIntTypeInfo(), n, &err);
+    Polynomial* mp = poly_create(GetModIntTypeInfo(), n, &err);
+    Polynomial* cp = poly_create(GetComplexTypeInfo(), n, &err);
+    for (int i = 0; i <= n; i++) {
+        *(int*)ip->coefficients[i] = (i * 37) % 19 - 9;
+        *(ModInt*)mp->coefficients[i] = modint_from_int((long long)i * i * 7919 + 3);
+        Complex c = {cos(i * 0.7) / (i + 1), sin(i * 1.3) / (i + 1)};
+        *(Complex*)cp->coefficients[i] = c;
+    }
+    Polynomial* ishift = poly_create(GetIntTypeInfo(), n, &err);
+    Polynomial* mshift = poly_create(GetModIntTypeInfo(), n, &err);
+    Polynomial* cshift = poly_create(GetComplexTypeInfo(), n, &err);
+    int ia = 3;
+    ModInt ma = 12345;
+    Complex ca = {0.01, -0.02};
+    err = poly_taylor_shift(ip, &ia, ishift);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_taylor_shift(mp, &ma, mshift);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_taylor_shift(cp, &ca, cshift);
+    assert(err == POLYNOMIAL_OK);
+
+    for (int x = -2; x <= 2; x++) {
+        int ixa = x + ia, iv1, iv2;
+        poly_evaluate(ip, &ixa, &iv1);
+        poly_evaluate(ishift, &x, &iv2);
+        assert(iv1 == iv2);
+
+        ModInt mx = modint_from_int(x), mxa = modint_from_int(x + ma), mv1, mv2;
+        poly_evaluate(mp, &mxa, &mv1);
+        poly_evaluate(mshift, &mx, &mv2);
+        assert(mv1 == mv2);
+
+        Complex cx = {x * 0.4, 0.1}, cxa = {cx.real + ca.real, cx.imag + ca.imag}, cv1, cv2;
+        poly_evaluate(cp, &cxa, &cv1);
+        poly_evaluate(cshift, &cx, &cv2);
+        assert(complex_equals(&cv1, &cv2));
+    }
+
+    // the FFT/NTT products agree with the generic path
+    TypeInfo genericModInt = *GetModIntTypeInfo();
+    Polynomial* gmp = poly_create_with_coeffs(&genericModInt, n, mp->coefficients[0], &err);
+    Polynomial* msq = poly_create(GetModIntTypeInfo(), 2 * n, &err);
+    Polynomial* gmsq = poly_create(&genericModInt, 2 * n, &err);
+    err = poly_multiply(mp, mshift, msq);
+    assert(err == POLYNOMIAL_OK);
+    Polynomial* gmshift = poly_create_with_coeffs(&genericModInt, n, mshift->coefficients[0], &err);
+    err = poly_multiply(gmp, gmshift, gmsq);
+    assert(err == POLYNOMIAL_OK);
+    assert(memcmp(msq->coefficients[0], gmsq->coefficients[0], (2 * n + 1) * sizeof(ModInt)) == 0);
+
+    assert(poly_is_equal(sq, expectedScale));
+
+    poly_free(sq);
+    poly_free(expectedShift);
+    poly_free(expectedScale);
+    poly_free(ip);
+    poly_free(mp);
+    poly_free(cp);
+    poly_free(ishift);
+    poly_free(mshift);
+    poly_free(cshift);
+    poly_free(gmp);
+    poly_free(msq);
+    poly_free(gmsq);
+    poly_free(gmshift);
+}
+
+void test_evaluation_schemes() {
+    printf("=== Testing Estrin and split Horner evaluators ===\n");
+    PolynomialError err;
+
+    // every scheme must agree with Horner, across degrees that hit all the ragged ends
+    for (int degree = 0; degree <= 70; degree++) {
+        Polynomial* ip = poly_create(GetIntTypeInfo(), degree, &err);
+        Polynomial* cp = poly_create(GetComplexTypeInfo(), degree, &err);
+        for (int i = 0; i <= degree; i++) {
+            *(int*)ip->coefficients[i] = (i * 13) % 7 - 3;
+            Complex c = {((i * 5) % 9 - 4) * 0.25, ((i * 3) % 5 - 2) * 0.5};
+            *(Complex*)cp->coefficients[i] = c;
+        }
+
+        int ix = -2, ihorner, iother;
+        Complex cx = {0.3, -0.9}, chorner, cother;
+        poly_evaluate_scheme(ip, &ix, &ihorner, POLY_EVAL_HORNER);
+        poly_evaluate_scheme(cp, &cx, &chorner, POLY_EVAL_HORNER);
+        for (int s = POLY_EVAL_AUTO; s <= POLY_EVAL_SPLIT_HORNER; s++) {
+            err = poly_evaluate_scheme(ip, &ix, &iother, (PolyEvalScheme)s);
+            assert(err == POLYNOMIAL_OK);
+            assert(iother == ihorner);
+            err = poly_evaluate_scheme(cp, &cx, &cother, (PolyEvalScheme)s);
+            assert(err == POLYNOMIAL_OK);
+            assert(complex_equals(&cother, &chorner));
+        }
+
+        poly_free(ip);
+        poly_free(cp);
+    }
+}
+
+void test_multivariate() {
+    printf("=== Testing sparse multivariate polynomials ===\n");
+    PolynomialError err;
+
+    // s = x + y + 1 in three variables x, y, z
+    MPolynomial* s = mpoly_create(GetIntTypeInfo(), 3, 0, &err);
+    assert(err == POLYNOMIAL_OK && s->bits == 21);
+    int one = 1, minusOne = -1;
+    int ex[3] = {1, 0, 0}, ey[3] = {0, 1, 0}, e0[3] = {0, 0, 0};
+    mpoly_add_term(s, ex, &one);
+    mpoly_add_term(s, ey, &one);
+    mpoly_add_term(s, e0, &one);
+
+    // (x + y + 1)^2 has six terms, leading x^2 and a 2xy cross term
+    MPolynomial* sq = mpoly_create(GetIntTypeInfo(), 3, 0, &err);
+    err = mpoly_multiply(s, s, sq);
+    assert(err == POLYNOMIAL_OK && sq->length == 6);
+    int exps[3], coeff;
+    mpoly_get_term(sq, 0, exps, &coeff);
+    assert(exps[0] == 2 && exps[1] == 0 && coeff == 1);
+    mpoly_get_term(sq, 1, exps, &coeff);
+    assert(exps[0] == 1 && exps[1] == 1 && coeff == 2);
+
+    int values[3] = {2, -5, 7}, value;
+    mpoly_evaluate(sq, values, &value);
+    assert(value == 4);
+
+    // x = 2 leaves (y + 3)^2 = y^2 + 6y + 9
+    MPolynomial* partial = mpoly_create(GetIntTypeInfo(), 3, 0, &err);
+    err = mpoly_partial_evaluate(sq, 0, &values[0], partial);
+    assert(err == POLYNOMIAL_OK && partial->length == 3);
+    mpoly_get_term(partial, 1, exps, &coeff);
+    assert(exps[0] == 0 && exps[1] == 1 && coeff == 6);
+
+    // adding -x^2 cancels the leading term; adding the square to itself aliases
+    int ex2[3] = {2, 0, 0};
+    mpoly_add_term(sq, ex2, &minusOne);
+    assert(sq->length == 5);
+    mpoly_add(sq, sq, sq);
+    mpoly_get_term(sq, 0, exps, &coeff);
+    assert(exps[0] == 1 && exps[1] == 1 && coeff == 4);
+
+    // x^20 in a 4-bit field overflows its exponent
+    MPolynomial* narrow = mpoly_create(GetIntTypeInfo(), 2, 4, &err);
+    int big[2] = {5, 0};
+    err = mpoly_add_term(narrow, big, &one);
+    assert(err == POLYNOMIAL_OK);
+    err = mpoly_multiply(narrow, narrow, narrow);
+    assert(err == POLYNOMIAL_INVALID_DEGREE);
+
+    // a single variable defaults to the widest field rather than the whole word
+    MPolynomial* single = mpoly_create(GetIntTypeInfo(), 1, 0, &err);
+    assert(err == POLYNOMIAL_OK && single->bits == 32);
+    int e1[1] = {1000000};
+    err = mpoly_add_term(single, e1, &one);
+    assert(err == POLYNOMIAL_OK);
+    mpoly_free(single);
+
+    // parallel product matches serial on a larger ModInt input
+    MPolynomial* a = mpoly_create(GetModIntTypeInfo(), 3, 0, &err);
+    MPolynomial* b = mpoly_create(GetModIntTypeInfo(), 3, 0, &err);
+    for (int i = 0; i < 300; i++) {
+        int ea[3] = {i % 7, (i * 3) % 11, i % 5};
+        int eb[3] = {(i * 5) % 6, i % 9, (i * 7) % 4};
+        ModInt ca = modint_from_int(i * 31 + 1), cb = modint_from_int(i * 17 - 40);
+        mpoly_add_term(a, ea, &ca);
+        mpoly_add_term(b, eb, &cb);
+    }
+    MPolynomial* serial = mpoly_create(GetModIntTypeInfo(), 3, 0, &err);
+    MPolynomial* parallel = mpoly_create(GetModIntTypeInfo(), 3, 0, &err);
+    err = mpoly_multiply(a, b, serial);
+    assert(err == POLYNOMIAL_OK);
+    err = mpoly_multiply_parallel(a, b, parallel);
+    assert(err == POLYNOMIAL_OK);
+    assert(serial->length == parallel->length);
+    for (int i = 0; i < serial->length; i++) {
+        assert(serial->monomials[i] == parallel->monomials[i]);
+        assert(((ModInt*)serial->coeffs)[i] == ((ModInt*)parallel->coeffs)[i]);
+    }
+
+    mpoly_free(s);
+    mpoly_free(sq);
+    mpoly_free(partial);
+    mpoly_free(narrow);
+    mpoly_free(a);
+    mpoly_free(b);
+    mpoly_free(serial);
+    mpoly_free(parallel);
+}
+
+// Results of one pass over the library, compared field by field across threads
+typedef struct {
+    int intProduct;
+    int intPow;
+    int intCompose;
+    int intShift;
+    ModInt modProduct;
+    Complex complexProduct;
+    Complex rootSum;
+    int mpolyTerms;
+    int failed;
+} WorkloadSignature;
+
+static void concurrent_workload(int seed, WorkloadSignature* sig) {
+    PolynomialError err;
+    int n = 200;
+    memset(sig, 0, sizeof(*sig));
+
+    Polynomial* ia = poly_create(GetIntTypeInfo(), 30, &err);
+    Polynomial* ib = poly_create(GetIntTypeInfo(), 30, &err);
+    Polynomial* ma = poly_create(GetModIntTypeInfo(), n, &err);
+    Polynomial* mb = poly_create(GetModIntTypeInfo(), n, &err);
+    Polynomial* ca = poly_create(GetComplexTypeInfo(), n, &err);
+    Polynomial* cb = poly_create(GetComplexTypeInfo(), n, &err);
+    for (int i = 0; i <= n; i++) {
+        if (i <= 30) {
+            *(int*)ia->coefficients[i] = (i * 7 + seed) % 9 - 4;
+            *(int*)ib->coefficients[i] = (i * 5 + seed) % 7 - 3;
+        }
+        *(ModInt*)ma->coefficients[i] = modint_from_int(i * 1009 + seed);
+        *(ModInt*)mb->coefficients[i] = modint_from_int(i * 7919 - seed);
+        Complex c = {((i + seed) % 11 - 5) * 0.1, (i % 3 - 1) * 0.2};
+        Complex d = {(i % 5 - 2) * 0.3, ((i * seed) % 7 - 3) * 0.1};
+        *(Complex*)ca->coefficients[i] = c;
+        *(Complex*)cb->coefficients[i] = d;
+    }
+    *(int*)ia->coefficients[30] = 1;
+
+    Polynomial* iprod = poly_create(GetIntTypeInfo(), 60, &err);
+    Polynomial* ipow = poly_create(GetIntTypeInfo(), 90, &err);
+    Polynomial* icomp = poly_create(GetIntTypeInfo(), 900, &err);
+    Polynomial* ishift = poly_create(GetIntTypeInfo(), 30, &err);
+    Polynomial* mprod = poly_create(GetModIntTypeInfo(), 2 * n, &err);
+    Polynomial* cprod = poly_create(GetComplexTypeInfo(), 2 * n, &err);
+
+    int ix = 2, one = 1;
+    ModInt mx = 5;
+    Complex cx = {0.5, 0.1};
+    sig->failed |= poly_multiply(ia, ib, iprod) != POLYNOMIAL_OK;
+    sig->failed |= poly_pow(ia, 3, -1, ipow) != POLYNOMIAL_OK;
+    sig->failed |= poly_compose(ia, ib, icomp) != POLYNOMIAL_OK;
+    sig->failed |= poly_taylor_shift(ia, &one, ishift) != POLYNOMIAL_OK;
+    sig->failed |= poly_multiply(ma, mb, mprod) != POLYNOMIAL_OK;
+    sig->failed |= poly_multiply(ca, cb, cprod) != POLYNOMIAL_OK;
+    poly_evaluate(iprod, &ix, &sig->intProduct);
+    poly_evaluate(ipow, &ix, &sig->intPow);
+    poly_evaluate(icomp, &ix, &sig->intCompose);
+    poly_evaluate(ishift, &ix, &sig->intShift);
+    poly_evaluate(mprod, &mx, &sig->modProduct);
+    poly_evaluate(cprod, &cx, &sig->complexProduct);
+
+    Polynomial* small = poly_create(GetIntTypeInfo(), 8, &err);
+    for (int i = 0; i <= 8; i++) *(int*)small->coefficients[i] = (i * 3 + seed) % 5 - 2;
+    *(int*)small->coefficients[8] = 1;
+    Complex roots[8];
+    sig->failed |= poly_roots(small, roots) != POLYNOMIAL_OK;
+    for (int i = 0; i < 8; i++) {
+        sig->rootSum.real += roots[i].real;
+        sig->rootSum.imag += roots[i].imag;
+    }
+
+    MPolynomial* mp = mpoly_create(GetIntTypeInfo(), 2, 0, &err);
+    for (int i = 0; i < 20; i++) {
+        int exps[2] = {i % 5, (i * seed) % 6};
+        int coeff = i - seed;
+        mpoly_add_term(mp, exps, &coeff);
+    }
+    sig->failed |= mpoly_multiply(mp, mp, mp) != POLYNOMIAL_OK;
+    sig->mpolyTerms = mp->length;
+
+    mpoly_free(mp);
+    poly_free(small);
+    poly_free(ia);
+    poly_free(ib);
+    poly_free(ma);
+    poly_free(mb);
+    poly_free(ca);
+    poly_free(cb);
+    poly_free(iprod);
+    poly_free(ipow);
+    poly_free(icomp);
+    poly_free(ishift);
+    poly_free(mprod);
+    poly_free(cprod);
+}
+
+#define CONCURRENT_THREADS 8
+#define CONCURRENT_ROUNDS 3
+
+typedef struct {
+    const WorkloadSignature* expected;
+    int mismatches;
+} ConcurrentWorker;
+
+static void* concurrent_worker(void* arg) {
+    ConcurrentWorker* worker = arg;
+    for (int round = 0; round < CONCURRENT_ROUNDS; round++) {
+        for (int seed = 0; seed < CONCURRENT_THREADS; seed++) {
+            WorkloadSignature sig;
+            concurrent_workload(seed, &sig);
+            if (memcmp(&sig, &worker->expected[seed], sizeof(sig)) != 0) worker->mismatches++;
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_operations() {
+    printf("=== Testing library calls from concurrent threads ===\n");
+
+    // serial reference first, then every thread must reproduce it bit for bit
+    WorkloadSignature expected[CONCURRENT_THREADS];
+    for (int seed = 0; seed < CONCURRENT_THREADS; seed++) {
+        concurrent_workload(seed, &expected[seed]);
+        assert(!expected[seed].failed);
+    }
+
+    pthread_t threads[CONCURRENT_THREADS];
+    ConcurrentWorker workers[CONCURRENT_THREADS];
+    for (int t = 0; t < CONCURRENT_THREADS; t++) {
+        workers[t].expected = expected;
+        workers[t].mismatches = 0;
+        int started = pthread_create(&threads[t], NULL, concurrent_worker, &workers[t]);
+        assert(started == 0);
+    }
+    int mismatches = 0;
+    for (int t = 0; t < CONCURRENT_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        mismatches += workers[t].mismatches;
+    }
+
+    assert(mismatches == 0);
+}
+
+static void* server_thread(void* arg) {
+    server_run(arg);
+    return NULL;
+}
+
+void test_server_roundtrip() {
+    printf("=== Testing the polynomial server ===\n");
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/polycalc-test-%d.sock", (int)getpid());
+
+    PolynomialError err;
+    Server* server = server_create(path, 2, &err);
+    assert(server && err == POLYNOMIAL_OK);
+    pthread_t thread;
+    int started = pthread_create(&thread, NULL, server_thread, server);
+    assert(started == 0);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    int connected = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    assert(connected == 0);
+
+    // pipelined JSON requests followed by a binary evaluate of the product: 1 + 3x + 5x^2 + 3x^3 at 2;
+    // the id freed last is the next one handed out, and keys of nested objects are not the request's
+    const char* lines = "{\"op\":\"create\",\"type\":\"int\",\"coeffs\":[1,2,3]}\n"
+                        "{\"op\":\"create\",\"coeffs\":[1,1]}\n"
+                        "{\"op\":\"multiply\",\"a\":1,\"b\":2}\n"
+                        "{\"op\":\"fetch\",\"id\":3}\n"
+                        "{\"op\":\"evaluate\",\"id\":9,\"x\":1}\n"
+                        "{\"op\":\"free\",\"id\":1}\n"
+                        "{\"op\":\"free\",\"id\":2}\n"
+                        "{\"op\":\"create\",\"coeffs\":[7]}\n"
+                        "{\"meta\":{\"op\":\"free\"},\"op\":\"create\",\"coeffs\":[5]}\n";
+    unsigned char frame[13] = {0, 0, 0, 9, SERVER_OP_EVALUATE, 0, 0, 0, 3};
+    int x = 2;
+    memcpy(frame + 9, &x, sizeof(int));
+    ssize_t sent = write(fd, lines, strlen(lines));
+    assert(sent == (ssize_t)strlen(lines));
+    sent = write(fd, frame, sizeof(frame));
+    assert(sent == (ssize_t)sizeof(frame));
+
+    const char* expected = "{\"ok\":true,\"id\":1}\n{\"ok\":true,\"id\":2}\n{\"ok\":true,\"id\":3}\n"
+                           "{\"ok\":true,\"type\":\"int\",\"degree\":3,\"coeffs\":[1,3,5,3]}\n"
+                           "{\"ok\":false,\"error\":\"Invalid input\"}\n"
+                           "{\"ok\":true}\n{\"ok\":true}\n{\"ok\":true,\"id\":2}\n{\"ok\":true,\"id\":1}\n";
+    size_t expectedLength = strlen(expected) + 4 + 1 + sizeof(int);
+    char reply[512];
+    size_t got = 0;
+    while (got < expectedLength) {
+        ssize_t n = read(fd, reply + got, sizeof(reply) - got);
+        assert(n > 0);
+        got += n;
+    }
+    close(fd);
+    assert(got == expectedLength && memcmp(reply, expected, strlen(expected)) == 0);
+    const unsigned char* binary = (const unsigned char*)reply + strlen(expected);
+    int value;
+    memcpy(&value, binary + 5, sizeof(int));
+    assert(binary[3] == 5 && binary[4] == 0 && value == 51);
+
+    // a live server's socket is not taken over
+    Server* second = server_create(path, 1, &err);
+    assert(!second && err == POLYNOMIAL_INVALID_INPUT);
+
+    err = server_load_test(path, 2, 200, 8, 0);
+    assert(err == POLYNOMIAL_OK);
+    err = server_load_test(path, 2, 200, 8, 1);
+    assert(err == POLYNOMIAL_OK);
+
+    server_stop(server);
+    pthread_join(thread, NULL);
+    server_destroy(server);
+    assert(access(path, F_OK) != 0);
+
+    // a regular file is left alone; a socket no one listens on is replaced
+    FILE* file = fopen(path, "w");
+    assert(file);
+    fclose(file);
+    server = server_create(path, 1, &err);
+    assert(!server && err == POLYNOMIAL_INVALID_INPUT && access(path, F_OK) == 0);
+    unlink(path);
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    int bound = bind(stale, (struct sockaddr*)&addr, sizeof(addr));
+    assert(bound == 0);
+    close(stale);
+    server = server_create(path, 1, &err);
+    assert(server && err == POLYNOMIAL_OK);
+    server_destroy(server);
+    assert(access(path, F_OK) != 0);
+}
+
+void test_async_operations() {
+    printf("=== Testing asynchronous operations ===\n");
+    PolynomialError err;
+
+    // an FFT-sized product matches the synchronous one
+    Polynomial* ca = poly_create(GetComplexTypeInfo(), 4096, &err);
+    Polynomial* cb = poly_create(GetComplexTypeInfo(), 4096, &err);
+    for (int i = 0; i <= 4096; i++) {
+        Complex c = {(i % 11 - 5) * 0.1, (i % 3 - 1) * 0.2};
+        Complex d = {(i % 5 - 2) * 0.3, (i % 7 - 3) * 0.1};
+        *(Complex*)ca->coefficients[i] = c;
+        *(Complex*)cb->coefficients[i] = d;
+    }
+    Polynomial* expected = poly_create(GetComplexTypeInfo(), 8192, &err);
+    Polynomial* actual = poly_create(GetComplexTypeInfo(), 8192, &err);
+    poly_multiply(ca, cb, expected);
+    PolyFuture* future = poly_multiply_async(ca, cb, actual, &err);
+    assert(future && err == POLYNOMIAL_OK);
+    err = poly_future_wait(future);
+    assert(err == POLYNOMIAL_OK);
+    int done = poly_future_try_get(future, &err);
+    assert(done == 1 && err == POLYNOMIAL_OK);
+    assert(poly_future_progress(future) == 1.0);
+    assert(poly_is_equal(expected, actual));
+    poly_future_free(future);
+
+    // many evaluation points split across the pool
+    Polynomial* ip = poly_create(GetIntTypeInfo(), 50, &err);
+    for (int i = 0; i <= 50; i++) *(int*)ip->coefficients[i] = i % 5 - 2;
+    int points[1000], values[1000];
+    for (int i = 0; i < 1000; i++) points[i] = i % 9 - 4;
+    future = poly_evaluate_many_async(ip, points, 1000, values, &err);
+    err = poly_future_wait(future);
+    assert(err == POLYNOMIAL_OK);
+    poly_future_free(future);
+    for (int i = 0; i < 1000; i++) {
+        int value;
+        poly_evaluate(ip, &points[i], &value);
+        assert(values[i] == value);
+    }
+
+    Complex roots[50], asyncRoots[50];
+    poly_roots(ip, roots);
+    future = poly_roots_async(ip, asyncRoots, &err);
+    err = poly_future_wait(future);
+    assert(err == POLYNOMIAL_OK);
+    poly_future_free(future);
+    for (int i = 0; i < 50; i++) assert(complex_equals(&roots[i], &asyncRoots[i]));
+
+    // a direct int product of this size runs for minutes unless cancelled
+    Polynomial* big = poly_create(GetIntTypeInfo(), 200000, &err);
+    Polynomial* bigProduct = poly_create(GetIntTypeInfo(), 400000, &err);
+    for (int i = 0; i <= 200000; i++) *(int*)big->coefficients[i] = i % 3 - 1;
+    Polynomial* abandonedProduct = poly_create(GetIntTypeInfo(), 400000, &err);
+    future = poly_multiply_async(big, big, bigProduct, &err);
+    PolyFuture* abandoned = poly_multiply_async(big, big, abandonedProduct, &err);
+    struct timespec pause = {0, 1000000};
+    while (poly_future_progress(future) == 0.0) nanosleep(&pause, NULL);
+    done = poly_future_try_get(future, &err);
+    assert(done == 0);
+    poly_future_cancel(future);
+    PolynomialError status = poly_future_wait(future);
+    double progress = poly_future_progress(future);
+    assert(status == POLYNOMIAL_CANCELLED);
+    assert(progress > 0.0 && progress < 1.0);
+    poly_future_free(future);
+    poly_future_free(abandoned);
+
+    PolyFuture* refused = poly_multiply_async(ca, ip, actual, &err);
+    assert(refused == NULL && err == POLYNOMIAL_TYPE_MISMATCH);
+
+    poly_free(ca);
+    poly_free(cb);
+    poly_free(expected);
+    poly_free(actual);
+    poly_free(ip);
+    poly_free(big);
+    poly_free(bigProduct);
+    poly_free(abandonedProduct);
+}
+
+void test_poly_format() {
+    printf("=== Testing buffered polynomial formatting ===\n");
+    PolynomialError err;
+    char buf[512];
+    size_t length;
+
+    int ints[] = {-1, 0, 3, -2147483647 - 1};
+    Polynomial* ip = poly_create_with_coeffs(GetIntTypeInfo(), 3, ints, &err);
+    err = poly_format(ip, buf, sizeof(buf), NULL, &length);
+    assert(err == POLYNOMIAL_OK);
+    assert(strcmp(buf, "-2147483648x^3 + 3x^2 + 0x + -1\n") == 0 && length == strlen(buf));
+
+    PolyFormatOptions options = {POLY_FORMAT_HUMAN, 1, 2};
+    poly_format(ip, buf, sizeof(buf), &options, NULL);
+    assert(strcmp(buf, "-2147483648x^3 + 3x^2 + -1\n") == 0);
+    options.style = POLY_FORMAT_CSV;
+    poly_format(ip, buf, sizeof(buf), &options, NULL);
+    assert(strcmp(buf, "degree,coefficient\n0,-1\n2,3\n3,-2147483648\n") == 0);
+    options.style = POLY_FORMAT_JSON;
+    poly_format(ip, buf, sizeof(buf), &options, NULL);
+    assert(strcmp(buf, "{\"type\":\"int\",\"degree\":3,\"terms\":[[0,-1],[2,3],[3,-2147483648]]}\n") == 0);
+
+    // a short buffer keeps a prefix and reports the size needed
+    err = poly_format(ip, buf, 8, NULL, &length);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    assert(strcmp(buf, "-214748") == 0 && length == 32);
+
+    Complex cs[] = {{1.005, 0.0}, {0.0, -2.5}, {-0.125, 1.0 / 3.0}, {0.0, 0.0}};
+    Polynomial* cp = poly_create_with_coeffs(GetComplexTypeInfo(), 3, cs, &err);
+    poly_format(cp, buf, sizeof(buf), NULL, NULL);
+    assert(strcmp(buf, "0.00x^3 + (-0.12 +0.33i)x^2 + -2.50ix + 1.00\n") == 0);
+    options.style = POLY_FORMAT_JSON;
+    options.skipZeros = 0;
+    options.precision = -1;
+    poly_format(cp, buf, sizeof(buf), &options, NULL);
+    assert(strcmp(buf, "{\"type\":\"complex\",\"degree\":3,\"coeffs\":"
+                       "[[1.005,0],[0,-2.5],[-0.125,0.3333333333333333],[0,0]]}\n") == 0);
+
+    ModInt ms[] = {998244352, 7};
+    Polynomial* mp = poly_create_with_coeffs(GetModIntTypeInfo(), 1, ms, &err);
+    poly_format(mp, buf, sizeof(buf), NULL, NULL);
+    assert(strcmp(buf, "7x + 998244352\n") == 0);
+
+    // the fixed-point path agrees with printf, including values near a rounding tie
+    srand(7);
+    for (int i = 0; i < 10000; i++) {
+        Complex c = {((double)rand() / RAND_MAX - 0.5) * pow(10.0, rand() % 12 - 3), 0.0};
+        if (i % 2) c.real = (rand() % 20001 - 10000) / 1000.0 + 0.005;
+        char expected[64];
+        snprintf(expected, sizeof(expected), "%.2f\n", c.real);
+        *(Complex*)cp->coefficients[0] = c;
+        Polynomial constant = {cp->coefficients, 0, cp->typeInfo, NULL};
+        poly_format(&constant, buf, sizeof(buf), NULL, NULL);
+        assert(strcmp(buf, expected) == 0);
+    }
+
+    // the stream and descriptor writers produce the same bytes as poly_format
+    Polynomial* big = poly_create(GetIntTypeInfo(), 100000, &err);
+    for (int i = 0; i <= 100000; i++) *(int*)big->coefficients[i] = i * 7919 - 400000000;
+    poly_format(big, NULL, 0, NULL, &length);
+    char* expected = malloc(length + 1);
+    char* written = malloc(length + 1);
+    err = poly_format(big, expected, length + 1, NULL, NULL);
+    assert(err == POLYNOMIAL_OK);
+    FILE* stream = tmpfile();
+    err = poly_write(big, stream, NULL);
+    assert(err == POLYNOMIAL_OK);
+    rewind(stream);
+    size_t copied = fread(written, 1, length + 1, stream);
+    assert(copied == length);
+    assert(memcmp(expected, written, length) == 0);
+    fclose(stream);
+
+    int fds[2];
+    int piped = pipe(fds);
+    assert(piped == 0);
+    err = poly_write_fd(ip, fds[1], NULL);
+    assert(err == POLYNOMIAL_OK);
+    close(fds[1]);
+    ssize_t got = read(fds[0], written, length);
+    close(fds[0]);
+    assert(got == 32 && memcmp(written, "-2147483648x^3", 14) == 0);
+
+    // poly_print needs a buffer only as long as the polynomial, and falls
+    // back to the coefficient callbacks when even that is refused
+    int ss[] = {1, 2, 3};
+    Polynomial* small = poly_create_with_coeffs(GetIntTypeInfo(), 2, ss, &err);
+    PolyMemStats stats;
+    poly_mem_stats(&stats);
+    FILE* capture = tmpfile();
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+    poly_mem_set_budget(stats.total.live + 65536);
+    poly_print(small);
+    poly_mem_set_budget(stats.total.live + 16);
+    poly_print(small);
+    poly_mem_set_budget(0);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    rewind(capture);
+    copied = fread(written, 1, length, capture);
+    fclose(capture);
+    assert(copied == 28 && memcmp(written, "3x^2 + 2x + 1\n3x^2 + 2x + 1\n", 28) == 0);
+
+    free(expected);
+    free(written);
+    poly_free(ip);
+    poly_free(cp);
+    poly_free(mp);
+    poly_free(big);
+    poly_free(small);
+}
+
+void test_integer_promotion() {
+    printf("=== Testing integer overflow promotion ===\n");
+    PolynomialError err;
+
+    // small values keep the 32-bit type
+    int small[] = {1, 2, 3};
+    Polynomial* sp = poly_create_with_coeffs(GetIntTypeInfo(), 2, small, &err);
+    Polynomial* square = poly_create(GetIntTypeInfo(), 4, &err);
+    err = poly_multiply(sp, sp, square);
+    assert(err == POLYNOMIAL_OK);
+    assert(square->typeInfo == GetIntTypeInfo() && *(int*)square->coefficients[2] == 10);
+
+    // a sum past INT_MAX widens to int64, in place when result aliases an input
+    int edge[] = {INT_MAX, -5};
+    int one[] = {1, INT_MIN};
+    Polynomial* ep = poly_create_with_coeffs(GetIntTypeInfo(), 1, edge, &err);
+    Polynomial* op = poly_create_with_coeffs(GetIntTypeInfo(), 1, one, &err);
+    err = poly_add_inplace(ep, op);
+    assert(err == POLYNOMIAL_OK);
+    assert(ep->typeInfo == GetInt64TypeInfo());
+    assert(*(int64_t*)ep->coefficients[0] == (int64_t)INT_MAX + 1);
+    assert(*(int64_t*)ep->coefficients[1] == (int64_t)INT_MIN - 5);
+
+    // products are computed at the width their bound needs, then stored at the width they take
+    int wide[600];
+    for (int i = 0; i < 600; i++) wide[i] = (i % 2 ? 1 : -1) * (2000000000 - i);
+    Polynomial* wp = poly_create_with_coeffs(GetIntTypeInfo(), 599, wide, &err);
+    Polynomial* product = poly_create(GetIntTypeInfo(), 1198, &err);
+    err = poly_multiply(wp, wp, product);
+    assert(err == POLYNOMIAL_OK);
+    assert(product->typeInfo == GetInt128TypeInfo());
+    for (int k = 0; k <= 1198; k++) {
+        Int128 expected = 0;
+        for (int i = 0; i <= k && i < 600; i++) {
+            if (k - i < 600) expected += (Int128)wide[i] * wide[k - i];
+        }
+        assert(*(Int128*)product->coefficients[k] == expected);
+    }
+
+    // mixed widths combine, and a scalar multiple grows into int128
+    int64_t big = (int64_t)1 << 62;
+    Polynomial* bp = poly_create_with_coeffs(GetInt64TypeInfo(), 0, &big, &err);
+    Polynomial* mixed = poly_create(GetIntTypeInfo(), 2, &err);
+    err = poly_add(bp, sp, mixed);
+    assert(err == POLYNOMIAL_OK && mixed->typeInfo == GetInt64TypeInfo());
+    assert(*(int64_t*)mixed->coefficients[0] == big + 1);
+    int64_t eight = 8;
+    err = poly_scalar_multiply(bp, &eight, bp);
+    assert(err == POLYNOMIAL_OK);
+    assert(bp->typeInfo == GetInt128TypeInfo() && *(Int128*)bp->coefficients[0] == (Int128)big * 8);
+
+    char text[64];
+    poly_format(bp, text, sizeof(text), NULL, NULL);
+    assert(strcmp(text, "36893488147419103232\n") == 0);
+
+    // only values past int128 fail
+    Polynomial* huge = poly_create(GetInt128TypeInfo(), 0, &err);
+    *(Int128*)huge->coefficients[0] = (Int128)1 << 100;
+    Polynomial* hugeSquare = poly_create(GetInt128TypeInfo(), 0, &err);
+    err = poly_multiply(huge, huge, hugeSquare);
+    assert(err == POLYNOMIAL_CALC_ERROR);
+
+    poly_free(sp);
+    poly_free(square);
+    poly_free(ep);
+    poly_free(op);
+    poly_free(wp);
+    poly_free(product);
+    poly_free(bp);
+    poly_free(mixed);
+    poly_free(huge);
+    poly_free(hugeSquare);
+}
+
+void test_power_series() {
+    printf("=== Testing power series ===\n");
+    PolynomialError err;
+    const int n = 1000;
+
+    // exp(x) = sum x^k / k!
+    ModInt xs[] = {0, 1};
+    Polynomial* x = poly_create_with_coeffs(GetModIntTypeInfo(), 1, xs, &err);
+    Polynomial* e = poly_create(GetModIntTypeInfo(), n - 1, &err);
+    err = series_exp(x, n, e);
+    assert(err == POLYNOMIAL_OK);
+    ModInt factorial = 1;
+    for (int k = 0; k < n; k++) {
+        if (k > 0) factorial = (ModInt)((uint64_t)factorial * k % MODINT_MODULUS);
+        assert((uint64_t)*(ModInt*)e->coefficients[k] * factorial % MODINT_MODULUS == 1);
+    }
+
+    // for f with f(0) = 0: log(exp f) = f, (1 + f) / (1 + f) = 1, sqrt(1 + f)^2 = 1 + f
+    Polynomial* f = poly_create(GetModIntTypeInfo(), n - 1, &err);
+    for (int k = 1; k < n; k++) *(ModInt*)f->coefficients[k] = (ModInt)((k * 2654435761u) % MODINT_MODULUS);
+    Polynomial* g = poly_create(GetModIntTypeInfo(), n - 1, &err);
+    err = series_exp(f, n, g);
+    assert(err == POLYNOMIAL_OK);
+    err = series_log(g, n, g);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(f, g));
+
+    *(ModInt*)f->coefficients[0] = 1;
+    Polynomial* one = poly_create(GetModIntTypeInfo(), n - 1, &err);
+    err = series_inv(f, n, g);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_mullow(f, g, n, one);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(ModInt*)one->coefficients[0] == 1);
+    for (int k = 1; k < n; k++) assert(*(ModInt*)one->coefficients[k] == 0);
+
+    *(ModInt*)f->coefficients[0] = 4;
+    err = series_sqrt(f, n, g);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(ModInt*)g->coefficients[0] == 2);
+    err = poly_mullow(g, g, n, g);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(f, g));
+
+    // Complex: log(1 + x) = sum (-1)^(k+1) x^k / k and sqrt(1 + x) = sum binom(1/2, k) x^k
+    Complex cs[] = {{1.0, 0.0}, {1.0, 0.0}};
+    Polynomial* c = poly_create_with_coeffs(GetComplexTypeInfo(), 1, cs, &err);
+    Polynomial* cr = poly_create(GetComplexTypeInfo(), 299, &err);
+    err = series_log(c, 300, cr);
+    assert(err == POLYNOMIAL_OK);
+    for (int k = 1; k < 300; k++) {
+        Complex expected = {(k % 2 ? 1.0 : -1.0) / k, 0.0};
+        assert(complex_equals((Complex*)cr->coefficients[k], &expected));
+    }
+    err = series_sqrt(c, 300, cr);
+    assert(err == POLYNOMIAL_OK);
+    double binomial = 1.0;
+    for (int k = 0; k < 300; k++) {
+        Complex expected = {binomial, 0.0};
+        assert(complex_equals((Complex*)cr->coefficients[k], &expected));
+        binomial *= (0.5 - k) / (k + 1);
+    }
+
+    // domains
+    err = series_log(x, n, g);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    err = series_exp(f, n, g);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    err = series_inv(x, n, g);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    Polynomial* ip = poly_create(GetIntTypeInfo(), 3, &err);
+    err = series_inv(ip, 4, ip);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+
+    err = series_log(c, 300, cr);
+    assert(err == POLYNOMIAL_OK);
+
+    poly_free(x);
+    poly_free(e);
+    poly_free(f);
+    poly_free(g);
+    poly_free(one);
+    poly_free(c);
+    poly_free(cr);
+    poly_free(ip);
+}
+
+void test_real_root_isolation() {
+    printf("=== Testing real root isolation ===\n");
+    PolynomialError err;
+    PolyRealRoot roots[128];
+    int count;
+
+    // x (x - 1)(x - 2)(x + 3)(2x - 1): dyadic roots come back exactly
+    int cs[] = {0, -6, 19, -14, -1, 2};
+    Polynomial* p = poly_create_with_coeffs(GetIntTypeInfo(), 5, cs, &err);
+    err = poly_isolate_real_roots(p, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK);
+    double expected[] = {-3.0, 0.0, 0.5, 1.0, 2.0};
+    assert(count == 5);
+    for (int i = 0; i < count; i++) {
+        assert(roots[i].lower <= expected[i] && expected[i] <= roots[i].upper);
+        if (i > 0) assert(roots[i - 1].upper <= roots[i].lower);
+    }
+
+    // intervals ending at an exact root stop short of it: (x - 1)(x - 2)
+    // and x (3x - 1), whose isolating intervals end at 2 and at 0
+    int ts[] = {2, -3, 1};
+    Polynomial* t = poly_create_with_coeffs(GetIntTypeInfo(), 2, ts, &err);
+    err = poly_isolate_real_roots(t, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK && count == 2);
+    assert(roots[0].lower <= 1.0 && 1.0 <= roots[0].upper && roots[0].upper < 2.0);
+    assert(roots[1].lower == 2.0 && roots[1].upper == 2.0);
+    int zs[] = {0, -1, 3};
+    Polynomial* z = poly_create_with_coeffs(GetIntTypeInfo(), 2, zs, &err);
+    err = poly_isolate_real_roots(z, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK && count == 2);
+    assert(roots[0].lower == 0.0 && roots[0].upper == 0.0);
+    assert(0.0 < roots[1].lower && roots[1].lower <= 1.0 / 3 && 1.0 / 3 <= roots[1].upper);
+
+    // x^2 - 2 refined to 1e-12, in 64-bit coefficients
+    int64_t qs[] = {-2, 0, 1};
+    Polynomial* q = poly_create_with_coeffs(GetInt64TypeInfo(), 2, qs, &err);
+    err = poly_isolate_real_roots(q, 1e-12, roots, &count);
+    assert(err == POLYNOMIAL_OK);
+    assert(count == 2);
+    assert(roots[0].lower <= -sqrt(2.0) && -sqrt(2.0) <= roots[0].upper);
+    assert(roots[1].lower <= sqrt(2.0) && sqrt(2.0) <= roots[1].upper);
+    assert(roots[1].upper - roots[1].lower <= 1e-12);
+
+    // Mignotte x^32 - 2 (10x - 1)^2: two roots about 10^-17 apart near 0.1
+    int ms[33] = {0};
+    ms[0] = -2;
+    ms[1] = 40;
+    ms[2] = -200;
+    ms[32] = 1;
+    Polynomial* m = poly_create_with_coeffs(GetIntTypeInfo(), 32, ms, &err);
+    err = poly_isolate_real_roots(m, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK);
+    assert(count == 4);
+    for (int i = 1; i < count; i++) assert(roots[i - 1].upper <= roots[i].lower);
+    assert(roots[1].lower < 0.1 && roots[2].upper > 0.1 && roots[2].upper - roots[1].lower < 1e-3);
+
+    // repeated roots come back once: (x - 1)^2 and (x - 1)^2 (x - 2)
+    int rs[] = {1, -2, 1};
+    Polynomial* r = poly_create_with_coeffs(GetIntTypeInfo(), 2, rs, &err);
+    err = poly_isolate_real_roots(r, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK && count == 1);
+    assert(roots[0].lower <= 1.0 && 1.0 <= roots[0].upper);
+    int ds[] = {-2, 5, -4, 1};
+    Polynomial* d = poly_create_with_coeffs(GetIntTypeInfo(), 3, ds, &err);
+    err = poly_isolate_real_roots(d, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK && count == 2);
+    assert(roots[0].lower == 1.0 && roots[0].upper == 1.0);
+    assert(roots[1].lower == 2.0 && roots[1].upper == 2.0);
+    // and mixed multiplicities: x^2 (3x + 1)^3 (x - 5)^2 (7x^2 - 2)^2
+    int64_t hs[] = {0, 0, 100, 860, 1644, -4364, -16155, -949, 35518, 19530, -11907, 1323};
+    Polynomial* h = poly_create_with_coeffs(GetInt64TypeInfo(), 11, hs, &err);
+    err = poly_isolate_real_roots(h, 1e-9, roots, &count);
+    assert(err == POLYNOMIAL_OK && count == 5);
+    double repeated[] = {-sqrt(2.0 / 7), -1.0 / 3, 0.0, sqrt(2.0 / 7), 5.0};
+    for (int i = 0; i < count; i++) assert(roots[i].lower <= repeated[i] && repeated[i] <= roots[i].upper);
+    // N x - 1 with N the product of the primes the modular fast path uses
+    Polynomial* l = poly_create(GetInt128TypeInfo(), 1, &err);
+    *(Int128*)l->coefficients[0] = -1;
+    *(Int128*)l->coefficients[1] = (Int128)998244353 * 1000000007 * 1000000009;
+    err = poly_isolate_real_roots(l, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_OK && count == 1);
+    double reciprocal = 1.0 / ((double)998244353 * 1000000007 * 1000000009);
+    assert(roots[0].lower <= reciprocal * (1 + 1e-9) && reciprocal * (1 - 1e-9) <= roots[0].upper);
+
+    // the zero polynomial and non-integer types are rejected
+    Polynomial* zero = poly_create(GetIntTypeInfo(), 3, &err);
+    err = poly_isolate_real_roots(zero, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    Polynomial* c = poly_create(GetComplexTypeInfo(), 2, &err);
+    err = poly_isolate_real_roots(c, 0.0, roots, &count);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+
+    err = poly_isolate_real_roots(q, 1e-12, roots, &count);
+    assert(err == POLYNOMIAL_OK);
+
+    poly_free(p);
+    poly_free(q);
+    poly_free(t);
+    poly_free(z);
+    poly_free(m);
+    poly_free(r);
+    poly_free(d);
+    poly_free(h);
+    poly_free(l);
+    poly_free(zero);
+    poly_free(c);
+}
+
+void test_disk_multiply() {
+    printf("=== Testing out-of-core multiplication ===\n");
+    PolynomialError err;
+    char pathA[64], pathB[64], pathR[64];
+    snprintf(pathA, sizeof(pathA), "/tmp/polycalc-test-%d-a.bin", (int)getpid());
+    snprintf(pathB, sizeof(pathB), "/tmp/polycalc-test-%d-b.bin", (int)getpid());
+    snprintf(pathR, sizeof(pathR), "/tmp/polycalc-test-%d-r.bin", (int)getpid());
+    // small blocks force many block pairs, a ragged last block and carries
+    DiskMultiplyOptions options = {0, 64};
+    DiskIoStats stats;
+
+    // ModInt against the in-memory product, exactly
+    const int na = 1000, nb = 700;
+    Polynomial* a = poly_create(GetModIntTypeInfo(), na - 1, &err);
+    Polynomial* b = poly_create(GetModIntTypeInfo(), nb - 1, &err);
+    for (int i = 0; i < na; i++) *(ModInt*)a->coefficients[i] = (ModInt)((i * 2654435761u) % MODINT_MODULUS);
+    for (int i = 0; i < nb; i++) *(ModInt*)b->coefficients[i] = (ModInt)((i * 40503u + 7) % MODINT_MODULUS);
+    Polynomial* expected = poly_create(GetModIntTypeInfo(), na + nb - 2, &err);
+    err = poly_multiply(a, b, expected);
+    assert(err == POLYNOMIAL_OK);
+
+    DiskPolynomial* da = disk_poly_create(pathA, GetModIntTypeInfo(), na - 1, &err);
+    DiskPolynomial* db = disk_poly_create(pathB, GetModIntTypeInfo(), nb - 1, &err);
+    DiskPolynomial* dr = disk_poly_create(pathR, GetModIntTypeInfo(), na + nb - 2, &err);
+    assert(da && db && dr);
+    err = disk_poly_write(da, 0, a->coefficients[0], na);
+    assert(err == POLYNOMIAL_OK);
+    err = disk_poly_write(db, 0, b->coefficients[0], nb);
+    assert(err == POLYNOMIAL_OK);
+    err = disk_poly_multiply(da, db, dr, &options, &stats);
+    assert(err == POLYNOMIAL_OK);
+    Polynomial* actual = poly_create(GetModIntTypeInfo(), na + nb - 2, &err);
+    err = disk_poly_read(dr, 0, actual->coefficients[0], na + nb - 1);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_equal(expected, actual));
+    assert(stats.blockSize == 64 && stats.bytesWritten == (long long)(na + nb - 1) * sizeof(ModInt));
+    err = disk_poly_read(dr, 1, actual->coefficients[0], na + nb - 1);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    disk_poly_free(da);
+    disk_poly_free(db);
+    disk_poly_free(dr);
+
+    // int inputs widened into an int64 result, read back from a reopened file
+    int ones[300];
+    for (int i = 0; i < 300; i++) ones[i] = 100000;
+    da = disk_poly_create(pathA, GetIntTypeInfo(), 299, &err);
+    err = disk_poly_write(da, 0, ones, 300);
+    assert(err == POLYNOMIAL_OK);
+    disk_poly_free(da);
+    da = disk_poly_open(pathA, GetIntTypeInfo(), &err);
+    assert(da && da->degree == 299);
+    db = disk_poly_open(pathA, GetIntTypeInfo(), &err);
+    dr = disk_poly_create(pathR, GetInt64TypeInfo(), 598, &err);
+    err = disk_poly_multiply(da, db, dr, &options, NULL);
+    assert(err == POLYNOMIAL_OK);
+    int64_t wide[599];
+    err = disk_poly_read(dr, 0, wide, 599);
+    assert(err == POLYNOMIAL_OK);
+    for (int k = 0; k < 599; k++) assert(wide[k] == (int64_t)(k < 300 ? k + 1 : 599 - k) * 10000000000);
+
+    // the same product in an int result would wrap, so it is refused
+    DiskPolynomial* overflowing = disk_poly_create(pathB, GetIntTypeInfo(), 598, &err);
+    err = disk_poly_multiply(da, db, overflowing, &options, NULL);
+    assert(err == POLYNOMIAL_CALC_ERROR);
+    disk_poly_free(overflowing);
+    disk_poly_free(db);
+
+    // a narrower or non-integer result and a wrong degree are refused
+    DiskPolynomial* narrow = disk_poly_create(pathB, GetIntTypeInfo(), 1196, &err);
+    err = disk_poly_multiply(dr, dr, narrow, &options, NULL);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+    disk_poly_free(narrow);
+    DiskPolynomial* complexResult = disk_poly_create(pathB, GetComplexTypeInfo(), 598, &err);
+    err = disk_poly_multiply(da, da, complexResult, &options, NULL);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+    disk_poly_free(complexResult);
+    DiskPolynomial* shortResult = disk_poly_create(pathB, GetInt64TypeInfo(), 500, &err);
+    err = disk_poly_multiply(da, da, shortResult, &options, NULL);
+    assert(err == POLYNOMIAL_INVALID_DEGREE);
+    disk_poly_free(shortResult);
+
+    disk_poly_free(da);
+    disk_poly_free(dr);
+    unlink(pathA);
+    unlink(pathB);
+    unlink(pathR);
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(expected);
+    poly_free(actual);
+}
+
+void test_tiled_convolution() {
+    printf("=== Testing tiled convolution kernels ===\n");
+    enum { N = 150 };
+    static int ia[N], ib[N], iout[2 * N], iref[2 * N];
+    static int64_t wa[N], wb[N], wout[2 * N], wref[2 * N];
+    static Complex ca[N], cb[N], cout[2 * N], cref[2 * N];
+    for (int i = 0; i < N; i++) {
+        // large enough that int products wrap
+        ia[i] = (int)(i * 2654435761u);
+        ib[i] = (int)(i * 40503u + 12345u) - 70000;
+        wa[i] = ia[i];
+        wb[i] = ib[i];
+        ca[i].real = sin(i);
+        ca[i].imag = cos(3 * i);
+        cb[i].real = 1.0 / (i + 1);
+        cb[i].imag = -0.5 * i;
+    }
+
+    // every shape around the tile sizes, full and truncated products
+    for (int na = 1; na <= N; na += na < 40 ? 1 : 37) {
+        for (int nb = 1; nb <= N; nb += nb < 40 ? 3 : 41) {
+            int full = na + nb - 1;
+            int nouts[] = {full, full / 2 + 1, full + 5};
+            for (int k = 0; k < 3; k++) {
+                int nout = nouts[k] < 2 * N ? nouts[k] : 2 * N;
+                int_kernel_mullow(iref, nout, ia, na, ib, nb);
+                poly_convolve_int(iout, nout, ia, na, ib, nb);
+                assert(memcmp(iout, iref, nout * sizeof(int)) == 0);
+
+                int64_kernel_mullow(wref, nout, wa, na, wb, nb);
+                poly_convolve_int64(wout, nout, wa, na, wb, nb);
+                assert(memcmp(wout, wref, nout * sizeof(int64_t)) == 0);
+                poly_convolve_int_wide(wout, nout, ib, na, ib, nb);
+                for (int i = 0; i < nout; i++) {
+                    int64_t sum = 0;
+                    for (int j = 0; j <= i && j < na; j++) {
+                        if (i - j < nb) sum += (int64_t)ib[j] * ib[i - j];
+                    }
+                    assert(wout[i] == sum);
+                }
+
+                complex_kernel_mullow(cref, nout, ca, na, cb, nb);
+                poly_convolve_complex(cout, nout, ca, na, cb, nb);
+                for (int i = 0; i < nout; i++) {
+                    assert(fabs(cout[i].real - cref[i].real) < 1e-9 && fabs(cout[i].imag - cref[i].imag) < 1e-9);
+                }
+            }
+        }
+    }
+
+    // poly_multiply picks the 64-bit accumulators for int products past INT_MAX
+    PolynomialError err;
+    Polynomial* a = poly_create_with_coeffs(GetIntTypeInfo(), 63, ib, &err);
+    Polynomial* r = poly_create(GetIntTypeInfo(), 126, &err);
+    err = poly_multiply(a, a, r);
+    assert(err == POLYNOMIAL_OK);
+    assert(r->typeInfo == GetInt64TypeInfo());
+    poly_convolve_int_wide(wout, 127, ib, 64, ib, 64);
+    assert(memcmp(r->coefficients[0], wout, 127 * sizeof(int64_t)) == 0);
+
+    poly_free(a);
+    poly_free(r);
+}
+
+// Fills poly with small pseudo-random coefficients of its type
+static void fill_small_poly(Polynomial* poly, unsigned seed) {
+    for (int i = 0; i <= poly->degree; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int v = (int)(seed >> 16) % 201 - 100;
+        if (poly->typeInfo == GetComplexTypeInfo()) {
+            Complex* c = poly->coefficients[i];
+            c->real = v / 8.0;
+            c->imag = (v % 7) / 4.0;
+        } else if (poly->typeInfo == GetModIntTypeInfo()) {
+            *(ModInt*)poly->coefficients[i] = (ModInt)(v + 100) * 9973u;
+        } else {
+            *(int*)poly->coefficients[i] = v;
+        }
+    }
+}
+
+static int batch_polys_match(const Polynomial* expected, const Polynomial* actual) {
+    if (expected->typeInfo != GetComplexTypeInfo()) return poly_is_equal(expected, actual);
+    for (int i = 0; i <= expected->degree; i++) {
+        if (!complex_equals(expected->coefficients[i], actual->coefficients[i])) return 0;
+    }
+    return 1;
+}
+
+void test_batch_operations() {
+    printf("=== Testing batched operations ===\n");
+    PolynomialError err;
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetComplexTypeInfo(), GetModIntTypeInfo()};
+    // 1000 items end in a partial slice; 40000 multiplications run in parallel
+    const int counts[] = {1000, 40000};
+    const int da = 7, db = 12;
+
+    for (int t = 0; t < 3; t++) {
+        for (int c = 0; c < 2; c++) {
+            const TypeInfo* type = types[t];
+            int count = counts[c];
+            PolyBatch* a = poly_batch_create(type, count, da, &err);
+            PolyBatch* b = poly_batch_create(type, count, db, &err);
+            PolyBatch* sum = poly_batch_create(type, count, db, &err);
+            PolyBatch* product = poly_batch_create(type, count, da + db, &err);
+            Polynomial* pa = poly_create(type, da, &err);
+            Polynomial* pb = poly_create(type, db, &err);
+            Polynomial* expected = poly_create(type, da + db, &err);
+            Polynomial* actual = poly_create(type, da + db, &err);
+            char* points = malloc((size_t)count * type->size);
+            char* values = malloc((size_t)count * type->size);
+
+            for (int k = 0; k < count; k++) {
+                fill_small_poly(pa, 2 * k + 1);
+                fill_small_poly(pb, 2 * k + 2);
+                err = poly_batch_set(a, k, pa);
+                assert(err == POLYNOMIAL_OK);
+                err = poly_batch_set(b, k, pb);
+                assert(err == POLYNOMIAL_OK);
+                memcpy(points + (size_t)k * type->size, pa->coefficients[k % (da + 1)], type->size);
+            }
+            err = poly_batch_add(a, b, sum);
+            assert(err == POLYNOMIAL_OK);
+            err = poly_batch_multiply(a, b, product);
+            assert(err == POLYNOMIAL_OK);
+            err = poly_batch_evaluate(b, points, values);
+            assert(err == POLYNOMIAL_OK);
+
+            for (int k = 0; k < count; k += count / 100 + 1) {
+                fill_small_poly(pa, 2 * k + 1);
+                fill_small_poly(pb, 2 * k + 2);
+                Polynomial* s = poly_create(type, db, &err);
+                Polynomial* got = poly_create(type, db, &err);
+                err = poly_add(pa, pb, s);
+                assert(err == POLYNOMIAL_OK);
+                err = poly_batch_get(sum, k, got);
+                assert(err == POLYNOMIAL_OK);
+                assert(batch_polys_match(s, got));
+                err = poly_multiply(pa, pb, expected);
+                assert(err == POLYNOMIAL_OK);
+                err = poly_batch_get(product, k, actual);
+                assert(err == POLYNOMIAL_OK);
+                assert(batch_polys_match(expected, actual));
+                char value[sizeof(Complex)];
+                err = poly_evaluate(pb, points + (size_t)k * type->size, value);
+                assert(err == POLYNOMIAL_OK);
+                if (type == GetComplexTypeInfo()) {
+                    assert(complex_equals((Complex*)value, (Complex*)(values + (size_t)k * type->size)));
+                } else {
+                    assert(memcmp(value, values + (size_t)k * type->size, type->size) == 0);
+                }
+                poly_free(s);
+                poly_free(got);
+            }
+
+            // in place: b += a, then b += b
+            err = poly_batch_add(a, b, b);
+            assert(err == POLYNOMIAL_OK);
+            err = poly_batch_add(b, b, b);
+            assert(err == POLYNOMIAL_OK);
+            Polynomial* twice = poly_create(type, db, &err);
+            Polynomial* got = poly_create(type, db, &err);
+            err = poly_batch_get(sum, count - 1, twice);
+            assert(err == POLYNOMIAL_OK);
+            err = poly_add(twice, twice, twice);
+            assert(err == POLYNOMIAL_OK);
+            err = poly_batch_get(b, count - 1, got);
+            assert(err == POLYNOMIAL_OK);
+            assert(batch_polys_match(twice, got));
+
+            err = poly_batch_multiply(a, b, b);
+            assert(err == POLYNOMIAL_INVALID_DEGREE);
+            err = poly_batch_multiply(a, b, sum);
+            assert(err == POLYNOMIAL_INVALID_DEGREE);
+            err = poly_batch_set(a, count, pa);
+            assert(err == POLYNOMIAL_INVALID_INPUT);
+            err = poly_batch_set(a, 0, pb);
+            assert(err == POLYNOMIAL_INVALID_DEGREE);
+
+            poly_free(twice);
+            poly_free(got);
+            free(points);
+            free(values);
+            poly_free(pa);
+            poly_free(pb);
+            poly_free(expected);
+            poly_free(actual);
+            poly_batch_free(a);
+            poly_batch_free(b);
+            poly_batch_free(sum);
+            poly_batch_free(product);
+        }
+    }
+
+    PolyBatch* ints = poly_batch_create(GetIntTypeInfo(), 4, 2, &err);
+    PolyBatch* complexes = poly_batch_create(GetComplexTypeInfo(), 4, 2, &err);
+    err = poly_batch_add(ints, complexes, ints);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+    poly_batch_free(ints);
+    poly_batch_free(complexes);
+}
+
+static int replay_stats_ordered(const PolyLatencyStats* s) {
+    return s->p50 <= s->p90 && s->p90 <= s->p99 && s->p99 <= s->p999 && s->p999 <= s->max;
+}
+
+void test_trace_replay() {
+    printf("=== Testing workload trace and replay ===\n");
+    PolynomialError err;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/polycalc-test-%d.trace", (int)getpid());
+
+    Polynomial* a = poly_create(GetModIntTypeInfo(), 10, &err);
+    Polynomial* b = poly_create(GetModIntTypeInfo(), 5, &err);
+    Polynomial* r = poly_create(GetModIntTypeInfo(), 50, &err);
+    Polynomial* ints = poly_create(GetIntTypeInfo(), 3, &err);
+    Polynomial* complexes = poly_create(GetComplexTypeInfo(), 3, &err);
+    for (int i = 0; i <= 10; i++) *(ModInt*)a->coefficients[i] = (ModInt)(i + 1);
+    for (int i = 0; i <= 5; i++) *(ModInt*)b->coefficients[i] = (ModInt)(2 * i + 1);
+    ModInt x = 3, value;
+
+    err = poly_trace_start(path);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_trace_start(path);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    err = poly_add(a, b, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_multiply(a, b, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_scalar_multiply(a, &x, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_evaluate(a, &x, &value);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_derivative(a, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_compose(a, b, r);
+    assert(err == POLYNOMIAL_OK);
+    // the multiplications inside pow are part of its record
+    err = poly_pow(a, 3, 12, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_fma(r, a, b);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_taylor_shift(a, &x, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_scale_var(a, &x, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_mullow(a, b, 8, r);
+    assert(err == POLYNOMIAL_OK);
+    err = poly_add(ints, complexes, ints);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+    err = poly_trace_stop();
+    assert(err == POLYNOMIAL_OK);
+    err = poly_trace_stop();
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    err = poly_add(a, b, r);
+    assert(err == POLYNOMIAL_OK);
+
+    long long count;
+    PolyTraceRecord* records = poly_trace_load(path, &count, &err);
+    assert(records && count == 12);
+    const PolyTraceOp ops[12] = {POLY_TRACE_ADD, POLY_TRACE_MULTIPLY, POLY_TRACE_SCALAR_MULTIPLY, POLY_TRACE_EVALUATE,
+                                 POLY_TRACE_DERIVATIVE, POLY_TRACE_COMPOSE, POLY_TRACE_POW, POLY_TRACE_FMA,
+                                 POLY_TRACE_TAYLOR_SHIFT, POLY_TRACE_SCALE_VAR, POLY_TRACE_MULLOW, POLY_TRACE_ADD};
+    for (int i = 0; i < 12; i++) {
+        assert(records[i].op == ops[i]);
+        assert(i == 0 || records[i].startNs >= records[i - 1].startNs + records[i - 1].durationNs);
+    }
+    assert(records[1].degreeA == 10 && records[1].degreeB == 5 && records[1].typeA == POLY_KERNEL_modint);
+    assert(records[3].degreeB == -1 && records[3].parameter == POLY_EVAL_AUTO);
+    assert(records[6].parameter == 3 && records[6].degreeB == 12);
+    assert(records[7].degreeA == 10 && records[7].degreeB == 5);
+    assert(records[10].parameter == 8 && records[10].degreeB == 5);
+    assert(records[11].typeA == POLY_KERNEL_int && records[11].typeB == POLY_KERNEL_complex);
+    assert(records[11].status == POLYNOMIAL_TYPE_MISMATCH);
+    free(records);
+
+    // back to back on two threads, then paced on three
+    PolyReplayOptions options = {2, 0.0};
+    PolyReplayReport report;
+    err = poly_trace_replay(path, &options, &report);
+    assert(err == POLYNOMIAL_OK);
+    assert(report.operations == 12 && report.skipped == 0);
+    assert(report.ops[POLY_TRACE_ADD].count == 2 && report.ops[POLY_TRACE_ADD].errors == 1);
+    for (int op = 0; op < POLY_TRACE_OP_COUNT; op++) {
+        assert(report.ops[op].count == (op == POLY_TRACE_ADD ? 2 : 1));
+        assert(replay_stats_ordered(&report.ops[op]));
+        if (op != POLY_TRACE_ADD) assert(report.ops[op].errors == 0);
+    }
+
+    options = (PolyReplayOptions){3, 400.0};
+    err = poly_trace_replay(path, &options, &report);
+    assert(err == POLYNOMIAL_OK);
+    assert(report.operations == 12);
+    // the last record is due 11 / 400 s after the start
+    assert(report.wallSeconds >= 11 / 400.0);
+    for (int op = 0; op < POLY_TRACE_OP_COUNT; op++) assert(replay_stats_ordered(&report.ops[op]));
+
+    options.threads = 0;
+    err = poly_trace_replay(path, &options, &report);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    FILE* bad = fopen(path, "wb");
+    fputs("not a trace", bad);
+    fclose(bad);
+    err = poly_trace_replay(path, NULL, &report);
+    assert(err == POLYNOMIAL_INVALID_INPUT);
+    remove(path);
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(r);
+    poly_free(ints);
+    poly_free(complexes);
+}
+
+// Every cached value against poly_evaluate at its point
+static int eval_cache_matches(const PolyEvalCache* cache, const char* points) {
+    size_t size = cache->typeInfo->size;
+    Int128 expected, actual;
+    for (int j = 0; j < cache->count; j++) {
+        PolynomialError err = poly_evaluate(cache->poly, points + j * size, &expected);
+        assert(err == POLYNOMIAL_OK);
+        err = poly_eval_cache_value(cache, j, &actual);
+        assert(err == POLYNOMIAL_OK);
+        int same = cache->typeInfo == GetComplexTypeInfo()
+                       ? complex_equals((const Complex*)&expected, (const Complex*)&actual)
+                       : memcmp(&expected, &actual, size) == 0;
+        if (!same) return 0;
+    }
+    return 1;
+}
+
+void test_eval_cache() {
+    printf("=== Testing incrementally maintained evaluation cache ===\n");
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetModIntTypeInfo(), GetComplexTypeInfo(), GetInt64TypeInfo()};
+    // three full slices of points and a ragged one
+    const int degree = 40, count = 1000;
+    PolynomialError err;
+    for (int t = 0; t < 4; t++) {
+        const TypeInfo* type = types[t];
+        size_t size = type->size;
+        Polynomial* poly = poly_create(type, degree, &err);
+        Polynomial* scratch = poly_create(type, count - 1, &err);
+        fill_small_poly(poly, 7 * t + 1);
+        // points of magnitude at most 1 keep the complex values well scaled
+        fill_small_poly(scratch, 7 * t + 2);
+        char* points = malloc(count * size);
+        for (int j = 0; j < count; j++) {
+            memcpy(points + j * size, scratch->coefficients[j], size);
+            if (type == GetComplexTypeInfo()) {
+                ((Complex*)points)[j].real /= 16.0;
+                ((Complex*)points)[j].imag /= 2.0;
+            } else if (type != GetModIntTypeInfo()) {
+                memset(points + j * size, 0, size);
+                *(int*)(points + j * size) = j % 5 - 2;
+            }
+        }
+
+        PolyEvalCache* cache = poly_eval_cache_create(poly, points, count, &err);
+        assert(cache && err == POLYNOMIAL_OK);
+        assert(eval_cache_matches(cache, points));
+
+        // single updates, including one that leaves the coefficient as it is
+        Polynomial* coeffs = poly_create(type, 63, &err);
+        fill_small_poly(coeffs, 7 * t + 3);
+        for (int k = 0; k < 20; k++) {
+            err = poly_eval_cache_set(cache, (k * 17) % (degree + 1), coeffs->coefficients[k]);
+            assert(err == POLYNOMIAL_OK);
+        }
+        err = poly_eval_cache_set(cache, 3, poly->coefficients[3]);
+        assert(err == POLYNOMIAL_OK);
+        assert(eval_cache_matches(cache, points));
+
+        // a batch with a repeated index, which ends with its last value
+        int indices[64] = {5, 0, degree, 5, 12, 33, 5, 1};
+        err = poly_eval_cache_update(cache, indices, coeffs->coefficients[20], 8);
+        assert(err == POLYNOMIAL_OK);
+        assert(memcmp(poly->coefficients[5], coeffs->coefficients[26], size) == 0);
+        assert(eval_cache_matches(cache, points));
+
+        // more updates than terms re-evaluate
+        for (int k = 0; k < 64; k++) indices[k] = (k * 5) % (degree + 1);
+        err = poly_eval_cache_update(cache, indices, coeffs->coefficients[0], 64);
+        assert(err == POLYNOMIAL_OK);
+        assert(eval_cache_matches(cache, points));
+
+        // a bad index changes nothing
+        indices[1] = degree + 1;
+        err = poly_eval_cache_update(cache, indices, coeffs->coefficients[30], 2);
+        assert(err == POLYNOMIAL_INVALID_INPUT);
+        assert(eval_cache_matches(cache, points));
+        err = poly_eval_cache_value(cache, count, coeffs->coefficients[0]);
+        assert(err == POLYNOMIAL_INVALID_INPUT);
+
+        // changed behind the cache's back, then refreshed
+        memcpy(poly->coefficients[7], coeffs->coefficients[40], size);
+        err = poly_eval_cache_refresh(cache);
+        assert(err == POLYNOMIAL_OK);
+        assert(eval_cache_matches(cache, points));
+
+        poly_eval_cache_free(cache);
+        poly_free(coeffs);
+        poly_free(scratch);
+        poly_free(poly);
+        free(points);
+    }
+
+    // a promoted polynomial no longer matches its powers
+    Polynomial* ints = poly_create(GetIntTypeInfo(), 3, &err);
+    int x = 2, one = 1;
+    PolyEvalCache* cache = poly_eval_cache_create(ints, &x, 1, &err);
+    err = poly_promote(ints, GetInt64TypeInfo());
+    assert(err == POLYNOMIAL_OK);
+    err = poly_eval_cache_set(cache, 0, &one);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH);
+    poly_eval_cache_free(cache);
+    poly_free(ints);
+}
+
+#define COW_THREADS 4
+#define COW_ROUNDS 500
+
+typedef struct {
+    const Polynomial* shared;
+    int failures;
+} CowWorker;
+
+// Clones of one polynomial written from several threads at once: each
+// clone must see its own writes only
+static void* cow_worker(void* arg) {
+    CowWorker* worker = arg;
+    int three = 3;
+    for (int round = 0; round < COW_ROUNDS; round++) {
+        PolynomialError err;
+        Polynomial* copy = poly_clone(worker->shared, &err);
+        Polynomial* view = poly_view(worker->shared, 1, 2, &err);
+        if (!copy || !view || poly_scalar_multiply(copy, &three, copy) != POLYNOMIAL_OK) {
+            worker->failures++;
+        } else {
+            for (int i = 0; i <= copy->degree; i++) {
+                if (*(int*)copy->coefficients[i] != 3 * *(int*)worker->shared->coefficients[i]) worker->failures++;
+            }
+            if (*(int*)view->coefficients[0] != *(int*)worker->shared->coefficients[1]) worker->failures++;
+        }
+        poly_free(copy);
+        poly_free(view);
+    }
+    return NULL;
+}
+
+void test_copy_on_write() {
+    printf("=== Testing copy-on-write coefficient sharing ===\n");
+    PolynomialError err;
+    const int degree = 100;
+    Polynomial* a = poly_create(GetIntTypeInfo(), degree, &err);
+    for (int i = 0; i <= degree; i++) *(int*)a->coefficients[i] = i + 1;
+
+    // a clone shares until the first write, which copies
+    Polynomial* b = poly_clone(a, &err);
+    assert(b && poly_is_shared(a) && poly_is_shared(b));
+    assert(b->coefficients[0] == a->coefficients[0] && poly_is_equal(a, b));
+    int two = 2;
+    err = poly_scalar_multiply(b, &two, b);
+    assert(err == POLYNOMIAL_OK);
+    assert(!poly_is_shared(a) && !poly_is_shared(b));
+    assert(*(int*)a->coefficients[7] == 8 && *(int*)b->coefficients[7] == 16);
+
+    // slices and truncations outlive the polynomial they view
+    Polynomial* slice = poly_view(a, 10, 20, &err);
+    Polynomial* head = poly_view(a, 0, 5, &err);
+    assert(slice && slice->degree == 20 && *(int*)slice->coefficients[0] == 11);
+    assert(head && head->degree == 5 && head->coefficients[0] == a->coefficients[0]);
+    Polynomial* outside = poly_view(a, 90, 20, &err);
+    assert(outside == NULL && err == POLYNOMIAL_INVALID_DEGREE);
+
+    // three polynomials, two buffers: the views cost no coefficients
+    const Polynomial* registry[4] = {a, b, slice, head};
+    PolyMemoryReport report;
+    err = poly_memory_report(registry, 4, &report);
+    assert(err == POLYNOMIAL_OK);
+    assert(report.polynomials == 4 && report.buffers == 2);
+    // the 27 viewed coefficients and their pointers, plus two headers
+    size_t saved = report.logicalBytes - report.allocatedBytes;
+    assert(saved > 27 * (sizeof(int) + sizeof(void*)));
+
+    // a rejected write leaves the sharing alone
+    Polynomial* wrongType = poly_create(GetComplexTypeInfo(), degree, &err);
+    Polynomial* tooShort = poly_create(GetIntTypeInfo(), 3, &err);
+    err = poly_add(wrongType, wrongType, head);
+    assert(err == POLYNOMIAL_TYPE_MISMATCH && poly_is_shared(head));
+    err = poly_multiply(a, a, head);
+    assert(err == POLYNOMIAL_INVALID_DEGREE && poly_is_shared(head));
+    err = poly_scalar_multiply(a, &two, head);
+    assert(err == POLYNOMIAL_INVALID_DEGREE && poly_is_shared(head));
+    err = poly_fma(head, a, tooShort);
+    assert(err == POLYNOMIAL_INVALID_DEGREE && poly_is_shared(head));
+    poly_free(wrongType);
+    poly_free(tooShort);
+
+    poly_free(a);
+    err = poly_add(head, head, head);
+    assert(err == POLYNOMIAL_OK);
+    assert(*(int*)head->coefficients[5] == 12 && *(int*)slice->coefficients[0] == 11);
+
+    // scaling by one shares the input instead of copying it
+    int one = 1;
+    Polynomial* scaled = poly_create(GetIntTypeInfo(), 20, &err);
+    err = poly_scalar_multiply(slice, &one, scaled);
+    assert(err == POLYNOMIAL_OK);
+    assert(poly_is_shared(scaled) && scaled->coefficients[0] == slice->coefficients[0]);
+    assert(poly_is_equal(scaled, slice));
+
+    // widening a shared integer polynomial leaves the other users alone
+    err = poly_promote(scaled, GetInt64TypeInfo());
+    assert(err == POLYNOMIAL_OK);
+    assert(slice->typeInfo == GetIntTypeInfo() && *(int*)slice->coefficients[20] == 31);
+    assert(*(int64_t*)scaled->coefficients[20] == 31);
+
+    // copies made and written from several threads at once
+    pthread_t threads[COW_THREADS];
+    CowWorker workers[COW_THREADS];
+    for (int t = 0; t < COW_THREADS; t++) {
+        workers[t].shared = slice;
+        workers[t].failures = 0;
+        int started = pthread_create(&threads[t], NULL, cow_worker, &workers[t]);
+        assert(started == 0);
+    }
+    int failures = 0;
+    for (int t = 0; t < COW_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        failures += workers[t].failures;
+    }
+    assert(failures == 0);
+    assert(!poly_is_shared(slice) && *(int*)slice->coefficients[0] == 11);
+
+    poly_free(b);
+    poly_free(slice);
+    poly_free(head);
+    poly_free(scaled);
+}
+
+// Occurrences of word in the evaluator's body, past the type's prelude
+static int count_in_evaluator(const char* text, const char* word) {
+    int n = 0;
+    text = strstr(text, "U eval(");
+    for (const char* p = strstr(text, word); p; p = strstr(p + 1, word)) n++;
+    return n;
+}
+
+// Coefficient i set to 1 or -1 in poly's type
+static void set_unit_coeff(Polynomial* poly, int i, int sign) {
+    void* c = poly->coefficients[i];
+    memset(c, 0, poly->typeInfo->size);
+    if (poly->typeInfo == GetComplexTypeInfo()) {
+        ((Complex*)c)->real = sign;
+    } else if (poly->typeInfo == GetModIntTypeInfo()) {
+        *(ModInt*)c = sign > 0 ? 1 : MODINT_MODULUS - 1;
+    } else if (sign > 0) {
+        *(char*)c = 1;
+    } else {
+        memset(c, 0xff, poly->typeInfo->size);
+    }
+}
+
+void test_compiled_evaluate() {
+    printf("=== Testing polynomials compiled to native evaluators ===\n");
+    char dir[] = "/tmp/polycalc-test-compile-XXXXXX";
+    char* made = mkdtemp(dir);
+    assert(made);
+    PolynomialError err = poly_compile_set_cache_dir(dir);
+    assert(err == POLYNOMIAL_OK);
+
+    // zero and unit coefficients emit nothing: x^2 + 1 is one square and
+    // one add, and x^40 + 3 squares up to x^32 and multiplies in x^8
+    int sparse[41] = {1, 0, 1};
+    Polynomial* poly = poly_create_with_coeffs(GetIntTypeInfo(), 2, sparse, &err);
+    char* source = poly_compile_source(poly, &err);
+    assert(source && err == POLYNOMIAL_OK);
+    assert(count_in_evaluator(source, "MUL(") == 1 && count_in_evaluator(source, "ADD(") == 1);
+    free(source);
+    poly_free(poly);
+    sparse[0] = 3;
+    sparse[2] = 0;
+    sparse[40] = 1;
+    poly = poly_create_with_coeffs(GetIntTypeInfo(), 40, sparse, &err);
+    source = poly_compile_source(poly, &err);
+    assert(count_in_evaluator(source, "MUL(") == 6 && count_in_evaluator(source, "ADD(") == 1);
+    free(source);
+    poly_free(poly);
+
+    const TypeInfo* types[] = {GetIntTypeInfo(), GetModIntTypeInfo(), GetComplexTypeInfo(), GetInt64TypeInfo(),
+                               GetInt128TypeInfo()};
+    // Horner below the Estrin crossover, Estrin at and above it
+    const int degrees[] = {0, 7, 16, 45};
+    const int count = 1000;
+    for (int t = 0; t < 5; t++) {
+        const TypeInfo* type = types[t];
+        size_t size = type->size;
+        Polynomial* scratch = poly_create(type, count - 1, &err);
+        fill_small_poly(scratch, 11 * t + 1);
+        char* points = malloc(count * size);
+        char* values = malloc(count * size);
+        for (int j = 0; j < count; j++) {
+            memcpy(points + j * size, scratch->coefficients[j], size);
+            if (type == GetComplexTypeInfo()) {
+                ((Complex*)points)[j].real /= 16.0;
+                ((Complex*)points)[j].imag /= 2.0;
+            } else if (type != GetModIntTypeInfo()) {
+                memset(points + j * size, 0, size);
+                *(int*)(points + j * size) = j % 5 - 2;
+            }
+        }
+
+        for (int d = 0; d < 4; d++) {
+            poly = poly_create(type, degrees[d], &err);
+            fill_small_poly(poly, 11 * t + d + 2);
+            for (int i = 1; i <= poly->degree; i += 3) {
+                if (i % 2) set_unit_coeff(poly, i, i % 4 == 1 ? 1 : -1);
+                else memset(poly->coefficients[i], 0, size);
+            }
+            PolyCompiled* compiled = poly_compile(poly, &err);
+            assert(compiled && err == POLYNOMIAL_OK && !compiled->cached);
+            err = poly_compiled_evaluate(compiled, points, values, count);
+            assert(err == POLYNOMIAL_OK);
+            Int128 expected;
+            for (int j = 0; j < count; j++) {
+                err = poly_evaluate(poly, points + j * size, &expected);
+                assert(err == POLYNOMIAL_OK);
+                if (type == GetComplexTypeInfo()) {
+                    assert(complex_equals((const Complex*)&expected, (const Complex*)(values + j * size)));
+                } else {
+                    assert(memcmp(&expected, values + j * size, size) == 0);
+                }
+            }
+
+            // the same polynomial again is loaded from the cache
+            PolyCompiled* again = poly_compile(poly, &err);
+            assert(again && again->cached && again->hash == compiled->hash);
+            poly_compiled_free(again);
+            poly_compiled_free(compiled);
+            poly_free(poly);
+        }
+        poly_free(scratch);
+        free(points);
+        free(values);
+    }
+
+    PolyCompiled* refused = poly_compile(NULL, &err);
+    assert(refused == NULL && err == POLYNOMIAL_NULL_PTR);
+    poly = poly_create(GetIntTypeInfo(), POLY_COMPILE_MAX_DEGREE + 1, &err);
+    refused = poly_compile(poly, &err);
+    assert(refused == NULL && err == POLYNOMIAL_INVALID_DEGREE);
+    poly_free(poly);
+    poly = poly_create(GetComplexTypeInfo(), 2, &err);
+    ((Complex*)poly->coefficients[1])->imag = NAN;
+    refused = poly_compile(poly, &err);
+    assert(refused == NULL && err == POLYNOMIAL_INVALID_INPUT);
+    poly_free(poly);
+
+    // a compiler that fails leaves its log behind
+    setenv("POLY_COMPILE_CC", "false", 1);
+    poly = poly_create(GetIntTypeInfo(), 3, &err);
+    refused = poly_compile(poly, &err);
+    assert(refused == NULL && err == POLYNOMIAL_CALC_ERROR);
+    unsetenv("POLY_COMPILE_CC");
+
+    // an object others could have written is rebuilt rather than loaded,
+    // and a cache others can write is refused
+    PolyCompiled* compiled = poly_compile(poly, &err);
+    assert(compiled && err == POLYNOMIAL_OK);
+    char object[128];
+    snprintf(object, sizeof(object), "%s/poly-%016llx.so", dir, (unsigned long long)compiled->hash);
+    poly_compiled_free(compiled);
+    int rc = chmod(object, 0666);
+    assert(rc == 0);
+    compiled = poly_compile(poly, &err);
+    assert(compiled && err == POLYNOMIAL_OK && !compiled->cached);
+    poly_compiled_free(compiled);
+    rc = chmod(dir, 0777);
+    assert(rc == 0);
+    compiled = poly_compile(poly, &err);
+    assert(!compiled && err == POLYNOMIAL_CALC_ERROR);
+    rc = chmod(dir, 0700);
+    assert(rc == 0);
+    poly_free(poly);
+
+    err = poly_compile_clear_cache();
+    assert(err == POLYNOMIAL_OK);
+    rc = rmdir(dir);
+    assert(rc == 0);
+    err = poly_compile_set_cache_dir(NULL);
+    assert(err == POLYNOMIAL_OK);
+}
+
+static PolyMemStats mem_snapshot(void) {
+    PolyMemStats stats;
+    poly_mem_stats(&stats);
+    return stats;
+}
+
+static void* mem_create_worker(void* arg) {
+    PolynomialError err;
+    poly_free(poly_create(GetIntTypeInfo(), 10000, &err));
+    *(PolynomialError*)arg = err;
+    return NULL;
+}
+
+static Polynomial* mem_modint_poly(int degree, int seed) {
+    PolynomialError err;
+    Polynomial* poly = poly_create(GetModIntTypeInfo(), degree, &err);
+    for (int i = 0; i <= degree; i++) *(ModInt*)poly->coefficients[i] = (ModInt)((i * 7919u + seed) % MODINT_MODULUS);
+    return poly;
+}
+
+void test_memory_accounting() {
+    printf("=== Testing memory accounting and budgets ===\n");
+    PolynomialError err;
+
+    // a polynomial is charged to its creation and its type, and all given
+    // back when freed
+    PolyMemStats before = mem_snapshot();
+    Polynomial* p = poly_create(GetIntTypeInfo(), 999, &err);
+    PolyMemStats after = mem_snapshot();
+    size_t created = after.total.live - before.total.live;
+    assert(created >= sizeof(Polynomial) + 1000 * (sizeof(int) + sizeof(void*)));
+    assert(after.byOp[POLY_MEM_OP_CREATE].live - before.byOp[POLY_MEM_OP_CREATE].live == created);
+    assert(after.byType[POLY_KERNEL_int].live - before.byType[POLY_KERNEL_int].live == created);
+    poly_free(p);
+    assert(mem_snapshot().total.live == before.total.live);
+
+    // observed peaks stay within the estimates: an NTT product, and an int
+    // product computed in 64 bits that widens its result
+    Polynomial* a = mem_modint_poly(511, 1);
+    Polynomial* b = mem_modint_poly(511, 2);
+    Polynomial* fast = poly_create(GetModIntTypeInfo(), 1022, &err);
+    size_t estimate = poly_multiply_peak_bytes(a, b, fast);
+    poly_mem_reset_peaks();
+    before = mem_snapshot();
+    err = poly_multiply(a, b, fast);
+    assert(err == POLYNOMIAL_OK);
+    after = mem_snapshot();
+    size_t observed = after.total.peak - before.total.live;
+    assert(observed > 0 && observed <= estimate);
+    assert(after.byOp[POLY_MEM_OP_MULTIPLY].allocations > before.byOp[POLY_MEM_OP_MULTIPLY].allocations);
+    assert(after.byType[POLY_KERNEL_modint].allocations > before.byType[POLY_KERNEL_modint].allocations);
+
+    Polynomial* x = poly_create(GetIntTypeInfo(), 300, &err);
+    Polynomial* wide = poly_create(GetIntTypeInfo(), 600, &err);
+    for (int i = 0; i <= 300; i++) *(int*)x->coefficients[i] = 1 << 20;
+    size_t wideEstimate = poly_multiply_peak_bytes(x, x, wide);
+    poly_mem_reset_peaks();
+    before = mem_snapshot();
+    err = poly_multiply(x, x, wide);
+    assert(err == POLYNOMIAL_OK && wide->typeInfo == GetInt64TypeInfo());
+    after = mem_snapshot();
+    assert(after.total.peak - before.total.live <= wideEstimate);
+
+    // with the NTT's scratch over budget the direct kernel runs instead
+    Polynomial* lean = poly_create(GetModIntTypeInfo(), 1022, &err);
+    before = mem_snapshot();
+    poly_mem_set_budget(before.total.live + 1024);
+    err = poly_multiply(a, b, lean);
+    assert(err == POLYNOMIAL_OK);
+    after = mem_snapshot();
+    poly_mem_set_budget(0);
+    assert(poly_is_equal(lean, fast) && after.total.refused == before.total.refused);
+
+    // Brent-Kung's powers over budget: Horner's rule gives the same result
+    Polynomial* outer = mem_modint_poly(40, 3);
+    Polynomial* inner = mem_modint_poly(3, 4);
+    Polynomial* composed = poly_create(GetModIntTypeInfo(), 120, &err);
+    Polynomial* horner = poly_create(GetModIntTypeInfo(), 120, &err);
+    size_t composeEstimate = poly_compose_peak_bytes(outer, inner, composed);
+    poly_mem_reset_peaks();
+    before = mem_snapshot();
+    err = poly_compose(outer, inner, composed);
+    assert(err == POLYNOMIAL_OK);
+    assert(mem_snapshot().total.peak - before.total.live <= composeEstimate);
+    poly_mem_set_budget(before.total.live + composeEstimate - 1);
+    err = poly_compose(outer, inner, horner);
+    assert(err == POLYNOMIAL_OK);
+    after = mem_snapshot();
+    poly_mem_set_budget(0);
+    assert(poly_is_equal(composed, horner) && after.total.refused == before.total.refused);
+
+    // what cannot fit even its leanest path fails before any work, and an
+    // allocation over budget is refused
+    Polynomial* ones = poly_create(GetIntTypeInfo(), 2000, &err);
+    Polynomial* square = poly_create(GetIntTypeInfo(), 4000, &err);
+    for (int i = 0; i <= 2000; i++) *(int*)ones->coefficients[i] = 1;
+    *(int*)square->coefficients[0] = 7;
+    before = mem_snapshot();
+    poly_mem_set_budget(before.total.live + 1024);
+    err = poly_multiply(ones, ones, square);
+    assert(err == POLYNOMIAL_MEM_ALLOC_FAIL);
+    assert(*(int*)square->coefficients[0] == 7);
+    Polynomial* overBudget = poly_create(GetIntTypeInfo(), 100000, &err);
+    assert(overBudget == NULL && err == POLYNOMIAL_MEM_ALLOC_FAIL);
+    after = mem_snapshot();
+    poly_mem_set_budget(0);
+    long long refusals = after.total.refused - before.total.refused;
+    assert(refusals == 2);
+    assert(after.byOp[POLY_MEM_OP_MULTIPLY].refused - before.byOp[POLY_MEM_OP_MULTIPLY].refused == 1);
+    assert(after.byOp[POLY_MEM_OP_CREATE].refused - before.byOp[POLY_MEM_OP_CREATE].refused == 1);
+    assert(after.total.live == before.total.live && after.budget == before.total.live + 1024);
+
+    // a thread budget binds only the thread that set it
+    PolyMemCounter mine;
+    size_t threadBudget;
+    poly_mem_thread_stats(&mine, NULL);
+    poly_mem_set_thread_budget(mine.live + 1024);
+    overBudget = poly_create(GetIntTypeInfo(), 10000, &err);
+    assert(overBudget == NULL && err == POLYNOMIAL_MEM_ALLOC_FAIL);
+    PolynomialError otherErr = POLYNOMIAL_NULL_PTR;
+    pthread_t other;
+    int started = pthread_create(&other, NULL, mem_create_worker, &otherErr);
+    assert(started == 0);
+    pthread_join(other, NULL);
+    assert(otherErr == POLYNOMIAL_OK);
+    poly_mem_set_thread_budget(0);
+    poly_mem_thread_stats(&mine, &threadBudget);
+    assert(threadBudget == 0 && mine.refused > 0);
+
+    // blocks the pool multiplies are charged to the multivariate operation
+    MPolynomial* m = mpoly_create(GetIntTypeInfo(), 2, 0, &err);
+    MPolynomial* mm = mpoly_create(GetIntTypeInfo(), 2, 0, &err);
+    int one = 1;
+    for (int i = 0; i < 256; i++) {
+        int exps[2] = {i % 16, i / 16};
+        err = mpoly_add_term(m, exps, &one);
+        assert(err == POLYNOMIAL_OK);
+    }
+    before = mem_snapshot();
+    err = mpoly_multiply_parallel(m, m, mm);
+    assert(err == POLYNOMIAL_OK);
+    after = mem_snapshot();
+    assert(after.byOp[POLY_MEM_OP_OTHER].allocations == before.byOp[POLY_MEM_OP_OTHER].allocations);
+    assert(after.byOp[POLY_MEM_OP_MULTIVARIATE].allocations > before.byOp[POLY_MEM_OP_MULTIVARIATE].allocations);
+
+    poly_free(a);
+    poly_free(b);
+    poly_free(fast);
+    poly_free(lean);
+    poly_free(x);
+    poly_free(wide);
+    poly_free(outer);
+    poly_free(inner);
+    poly_free(composed);
+    poly_free(horner);
+    poly_free(ones);
+    poly_free(square);
+    mpoly_free(m);
+    mpoly_free(mm);
+}
+
+// Reads a value the way the operations menu does, from text
+static int ui_parse(const char* text, const TypeInfo* typeInfo, void* value) {
+    FILE* in = fmemopen((void*)text, strlen(text), "r");
+    int ok = ui_read_value(in, typeInfo, value);
+    fclose(in);
+    return ok;
+}
+
+void test_ui_promoted_values() {
+    printf("=== Testing menu input for promoted polynomials ===\n");
+    PolynomialError err;
+
+    // 100000x squared no longer fits an int, so the menu sees an int64 polynomial
+    int coeffs[] = {0, 100000};
+    Polynomial* p = poly_create_with_coeffs(GetIntTypeInfo(), 1, coeffs, &err);
+    Polynomial* square = poly_create(GetIntTypeInfo(), 2, &err);
+    err = poly_multiply(p, p, square);
+    assert(err == POLYNOMIAL_OK && square->typeInfo == GetInt64TypeInfo());
+    assert(strcmp(ui_value_hint(square->typeInfo), "integer") == 0);
+
+    int64_t x, value;
+    int ok = ui_parse("2\n", square->typeInfo, &x);
+    assert(ok && x == 2);
+    err = poly_evaluate(square, &x, &value);
+    assert(err == POLYNOMIAL_OK && value == 40000000000LL);
+
+    // the scalar is read at the polynomial's width and leaves it unchanged
+    int64_t scalar;
+    Polynomial* scaled = poly_create(square->typeInfo, 2, &err);
+    ok = ui_parse("1\n", square->typeInfo, &scalar);
+    assert(ok && scalar == 1);
+    err = poly_scalar_multiply(square, &scalar, scaled);
+    assert(err == POLYNOMIAL_OK && poly_is_equal(scaled, square));
+
+    // int128 reads take the full width; complex takes two parts
+    Int128 wide;
+    Complex c;
+    ok = ui_parse("-7\n", GetInt128TypeInfo(), &wide);
+    assert(ok && wide == -7);
+    ok = ui_parse(" 170141183460469231731687303715884105727\n", GetInt128TypeInfo(), &wide);
+    assert(ok && wide == (Int128)(~(PolyUInt128)0 >> 1));
+    ok = ui_parse("-170141183460469231731687303715884105728\n", GetInt128TypeInfo(), &wide);
+    assert(ok && wide == -(Int128)(~(PolyUInt128)0 >> 1) - 1);
+    ok = ui_parse("+36893488147419103232\n", GetInt128TypeInfo(), &wide);
+    assert(ok && wide == (Int128)1 << 65);
+    ok = ui_parse("170141183460469231731687303715884105728\n", GetInt128TypeInfo(), &wide);
+    assert(!ok);
+    ok = ui_parse("-\n", GetInt128TypeInfo(), &wide);
+    assert(!ok);
+    ok = ui_parse("1.5 -2\n", GetComplexTypeInfo(), &c);
+    assert(ok && c.real == 1.5 && c.imag == -2);
+    ok = ui_parse("x\n", GetInt64TypeInfo(), &x);
+    assert(!ok);
+    ok = ui_parse("1\n", GetModIntTypeInfo(), &x);
+    assert(!ok);
+
+    poly_free(p);
+    poly_free(square);
+    poly_free(scaled);
+}
+
 void run_all_tests() {
     test_int_poly_creation();
     test_complex_poly_addition();
@@ -292,5 +2492,28 @@ void run_all_tests() {
     test_zero_and_minimal_polynomials();
     test_large_numbers_and_high_degrees();
     test_diff_size_polynomials();
+    test_inplace_and_fma();
+    test_specialized_matches_generic();
+    test_pow_and_compose();
+    test_derivative_and_roots();
+    test_taylor_shift_and_scaling();
+    test_evaluation_schemes();
+    test_multivariate();
+    test_concurrent_operations();
+    test_server_roundtrip();
+    test_async_operations();
+    test_poly_format();
+    test_integer_promotion();
+    test_power_series();
+    test_real_root_isolation();
+    test_disk_multiply();
+    test_tiled_convolution();
+    test_batch_operations();
+    test_trace_replay();
+    test_eval_cache();
+    test_copy_on_write();
+    test_compiled_evaluate();
+    test_memory_accounting();
+    test_ui_promoted_values();
     printf("All tests completed successfully!\n");
 }
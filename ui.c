@@ -2,6 +2,8 @@
 #include "PolynomialDefines.h"
 #include "Integer.h"
 #include "Complex.h"
+#include "PolynomialMemory.h"
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,7 +18,8 @@ void print_main_menu() {
     printf("3. Delete polynomial\n");
     printf("4. Polynomial operations\n");
     printf("5. Run tests\n");
-    printf("6. Exit\n");
+    printf("6. Memory report\n");
+    printf("7. Exit\n");
     printf("Enter your choice: ");
 }
 
@@ -26,7 +29,8 @@ void print_operations_menu() {
     printf("2. Multiply polynomials\n");
     printf("3. Multiply polynomial by scalar\n");
     printf("4. Evaluate polynomial\n");
-    printf("5. Return to main menu\n");
+    printf("5. Copy or truncate polynomial\n");
+    printf("6. Return to main menu\n");
     printf("Enter your choice: ");
 }
 
@@ -261,6 +265,60 @@ void multiply_polynomials() {
     }
 }
 
+// Room for one coefficient of any type the menus create or promote to
+typedef union {
+    int i;
+    int64_t i64;
+    Int128 i128;
+    Complex c;
+} UiValue;
+
+// scanf has no 128-bit conversion: reads an optionally signed decimal
+// integer after any whitespace, failing when it does not fit
+static int ui_read_int128(FILE* in, Int128* value) {
+    int ch;
+    do {
+        ch = fgetc(in);
+    } while (isspace(ch));
+    int negative = ch == '-';
+    if (ch == '-' || ch == '+') ch = fgetc(in);
+    // accumulated negated, since INT128_MIN has no positive counterpart
+    Int128 v = 0;
+    int digits = 0, overflow = 0;
+    for (; isdigit(ch); ch = fgetc(in), digits++) {
+        overflow |= __builtin_mul_overflow(v, 10, &v) || __builtin_sub_overflow(v, ch - '0', &v);
+    }
+    if (ch != EOF) ungetc(ch, in);
+    if (!digits || overflow || (!negative && __builtin_sub_overflow((Int128)0, v, &v))) return 0;
+    *value = v;
+    return 1;
+}
+
+int ui_read_value(FILE* in, const TypeInfo* typeInfo, void* value) {
+    long long v;
+    switch (int_type_width(typeInfo)) {
+    case 32:
+        return fscanf(in, "%d", (int*)value) == 1;
+    case 64:
+        if (fscanf(in, "%lld", &v) != 1) return 0;
+        *(int64_t*)value = v;
+        return 1;
+    case 128:
+        return ui_read_int128(in, value);
+    default:
+        break;
+    }
+    if (typeInfo == GetComplexTypeInfo()) {
+        Complex* c = value;
+        return fscanf(in, "%lf %lf", &c->real, &c->imag) == 2;
+    }
+    return 0;
+}
+
+const char* ui_value_hint(const TypeInfo* typeInfo) {
+    return typeInfo == GetComplexTypeInfo() ? "complex (real imag)" : "integer";
+}
+
 void multiply_by_scalar() {
     print_polynomials_list();
     if (poly_count == 0) return;
@@ -279,27 +337,16 @@ void multiply_by_scalar() {
     Polynomial* result = poly_create(poly->typeInfo, poly->degree, &err);
     if (!result) return;
     
-    if (poly->typeInfo == GetIntTypeInfo()) {
-        int scalar;
-        printf("Enter integer scalar: ");
-        if (scanf("%d", &scalar) != 1) {
-            printf("Invalid input\n");
-            poly_free(result);
-            while(getchar() != '\n');
-            return;
-        }
-        err = poly_scalar_multiply(poly, &scalar, result);
-    } else {
-        Complex scalar;
-        printf("Enter complex scalar (real imag): ");
-        if (scanf("%lf %lf", &scalar.real, &scalar.imag) != 2) {
-            printf("Invalid input\n");
-            poly_free(result);
-            while(getchar() != '\n');
-            return;
-        }
-        err = poly_scalar_multiply(poly, &scalar, result);
+    // the scalar has the polynomial's type, which may be a promoted integer
+    UiValue scalar;
+    printf("Enter %s scalar: ", ui_value_hint(poly->typeInfo));
+    if (!ui_read_value(stdin, poly->typeInfo, &scalar)) {
+        printf("Invalid input\n");
+        poly_free(result);
+        while(getchar() != '\n');
+        return;
     }
+    err = poly_scalar_multiply(poly, &scalar, result);
     
     if (err != POLYNOMIAL_OK) {
         printf("Error: %s\n", polynomial_error_msg(err));
@@ -332,37 +379,81 @@ void evaluate_polynomial() {
     
     Polynomial* poly = polynomials[num-1];
     
-    if (poly->typeInfo == GetIntTypeInfo()) {
-        int x, res;
-        printf("Enter integer x value: ");
-        if (scanf("%d", &x) != 1) {
-            printf("Invalid input\n");
-            while(getchar() != '\n');
-            return;
-        }
-        PolynomialError err = poly_evaluate(poly, &x, &res);
-        if (err != POLYNOMIAL_OK) {
-            printf("Error: %s\n", polynomial_error_msg(err));
-            return;
-        }
-        printf("Result: %d\n", res);
+    UiValue x, res;
+    printf("Enter %s x value: ", ui_value_hint(poly->typeInfo));
+    if (!ui_read_value(stdin, poly->typeInfo, &x)) {
+        printf("Invalid input\n");
+        while(getchar() != '\n');
+        return;
+    }
+    PolynomialError err = poly_evaluate(poly, &x, &res);
+    if (err != POLYNOMIAL_OK) {
+        printf("Error: %s\n", polynomial_error_msg(err));
+        return;
+    }
+    printf("Result: ");
+    poly->typeInfo->print(&res);
+    printf("\n");
+}
+
+// The copy shares the original's coefficients until one of them changes
+void copy_polynomial() {
+    print_polynomials_list();
+    if (poly_count == 0) return;
+
+    int num;
+    printf("Select polynomial to copy (1-%d): ", poly_count);
+    if (scanf("%d", &num) != 1 || num < 1 || num > poly_count) {
+        printf("Invalid input\n");
+        while(getchar() != '\n');
+        return;
+    }
+
+    Polynomial* poly = polynomials[num-1];
+    int degree;
+    printf("Keep terms up to degree (0-%d): ", poly->degree);
+    if (scanf("%d", &degree) != 1 || degree < 0 || degree > poly->degree) {
+        printf("Invalid input\n");
+        while(getchar() != '\n');
+        return;
+    }
+
+    PolynomialError err;
+    Polynomial* result = poly_view(poly, 0, degree, &err);
+    if (!result) {
+        printf("Error: %s\n", polynomial_error_msg(err));
+        return;
+    }
+
+    printf("Result: ");
+    poly_print(result);
+
+    if (poly_count < MAX_POLYNOMIALS) {
+        polynomials[poly_count++] = result;
     } else {
-        Complex x, res;
-        printf("Enter complex x value (real imag): ");
-        if (scanf("%lf %lf", &x.real, &x.imag) != 2) {
-            printf("Invalid input\n");
-            while(getchar() != '\n');
-            return;
-        }
-        PolynomialError err = poly_evaluate(poly, &x, &res);
-        if (err != POLYNOMIAL_OK) {
-            printf("Error: %s\n", polynomial_error_msg(err));
-            return;
-        }
-        printf("Result: ");
-        complex_print(&res);
-        printf("\n");
+        printf("Cannot save result - maximum reached\n");
+        poly_free(result);
+    }
+}
+
+void print_memory_report() {
+    PolyMemoryReport report;
+    PolynomialError err = poly_memory_report((const Polynomial* const*)polynomials, poly_count, &report);
+    if (err != POLYNOMIAL_OK) {
+        printf("Error: %s\n", polynomial_error_msg(err));
+        return;
     }
+    printf("\n=== Memory Report ===\n");
+    printf("Polynomials: %d in %d coefficient buffers\n", report.polynomials, report.buffers);
+    printf("Bytes without sharing: %zu\n", report.logicalBytes);
+    printf("Bytes allocated: %zu\n", report.allocatedBytes);
+    // a short view can keep a longer, otherwise deleted buffer alive
+    printf("Saved by sharing: %lld bytes\n", (long long)report.logicalBytes - (long long)report.allocatedBytes);
+
+    PolyMemStats stats;
+    poly_mem_stats(&stats);
+    printf("\nLibrary allocations:\n");
+    poly_mem_print(&stats);
 }
 
 void run_operations_menu() {
@@ -385,10 +476,11 @@ void run_operations_menu() {
             case 2: multiply_polynomials(); break;
             case 3: multiply_by_scalar(); break;
             case 4: evaluate_polynomial(); break;
-            case 5: return;
+            case 5: copy_polynomial(); break;
+            case 6: return;
             default: printf("Invalid choice\n");
         }
-    } while (choice != 5);
+    } while (choice != 6);
 }
 
 void run_main_menu() {
@@ -407,10 +499,11 @@ void run_main_menu() {
             case 3: delete_polynomial(); break;
             case 4: run_operations_menu(); break;
             case 5: run_all_tests(); break;
-            case 6: break;
+            case 6: print_memory_report(); break;
+            case 7: break;
             default: printf("Invalid choice\n");
         }
-    } while (choice != 6);
+    } while (choice != 7);
     
     // Cleanup
     for (int i = 0; i < poly_count; i++) {
@@ -3,10 +3,18 @@
 
 #include "Polynomial.h"
 #include "tests.h"
+#include <stdio.h>
 
 #define MAX_POLYNOMIALS 20
 
 void run_main_menu();
 void run_operations_menu();
 
+// Reads one value of typeInfo's coefficient type from in, returning 1 on
+// success. Integers of every width are entered as 64-bit decimals, complex
+// values as "real imag".
+int ui_read_value(FILE* in, const TypeInfo* typeInfo, void* value);
+// What ui_read_value expects, for prompts
+const char* ui_value_hint(const TypeInfo* typeInfo);
+
 #endif
\ No newline at end of file